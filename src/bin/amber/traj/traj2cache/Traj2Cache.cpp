@@ -0,0 +1,227 @@
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include "Traj2Cache.hpp"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <AmberTrajectory.hpp>
+
+#include "Traj2Cache.hpp"
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTraj2Cache::CTraj2Cache(void)
+{
+
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CTraj2Cache::Init(int argc,char* argv[])
+{
+    // encode program options
+    int result = Options.ParseCmdLine(argc,argv);
+
+    // should we exit or was it error?
+    if( result != SO_CONTINUE ) return(result);
+
+    // print header --------------------------------------------------------------
+    if( Options.GetOptVerbose() ) {
+        CSmallTimeAndDate dt;
+        dt.GetActualTimeAndDate();
+
+        printf("\n");
+        printf("# ==============================================================================\n");
+        printf("# traj2cache (CATs utility) started at %s\n",(const char*)dt.GetSDateAndTime());
+        printf("# ==============================================================================\n");
+        printf("#\n");
+        printf("# Topology name      : %s\n",(const char*)Options.GetProgArg(0));
+        printf("# Trajectory cache   : %s\n",(const char*)Options.GetProgArg(1));
+        printf("# Input format       : %s\n",(const char*)Options.GetOptInputFormat());
+        if( Options.IsOptMaskSpecSet() == true ) {
+        printf("# Mask specification : %s\n",(const char*)Options.GetOptMaskSpec());
+        }
+        if( Options.IsOptMaskFileSet() == true ) {
+        printf("# Mask file name     : %s\n",(const char*)Options.GetOptMaskFile());
+        }
+        if( (Options.IsOptMaskSpecSet() != true) && (Options.IsOptMaskFileSet() != true) ) {
+        printf("# Mask specification : all atoms\n");
+        }
+        printf("# ------------------------------------------------------------------------------\n");
+        printf("\n");
+    }
+
+    return( result );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTraj2Cache::Run(void)
+{
+    // load topology
+    if( Topology.Load(Options.GetProgArg(0)) == false ) {
+        CSmallString error;
+        error << "unable to load specified topology: " << Options.GetProgArg(0);
+        ES_ERROR(error);
+        return(false);
+    }
+
+    Snapshot.AssignTopology(&Topology);
+    Snapshot.Create();
+
+    // init mask ----------------------------------------------
+    Mask.AssignTopology(&Topology);
+    Mask.SelectAllAtoms();
+
+    bool result = true;
+    if( Options.IsOptMaskSpecSet() == true ) {
+        result = Mask.SetMask(Options.GetOptMaskSpec());
+    }
+    if( Options.IsOptMaskFileSet() == true ) {
+        result = Mask.SetMaskFromFile(Options.GetOptMaskFile());
+    }
+    if( result == false ) {
+        fprintf(stderr,">>> ERROR: Unable to set specified mask!\n");
+        return(false);
+    }
+
+    // the cache is renamed when complete, thus readers never see partial data
+    CSmallString cache_name = Options.GetProgArg(1);
+    CSmallString tmp_name;
+    tmp_name << cache_name << ".tmp";
+
+    if( Cache.OpenForWriting(tmp_name,Topology.AtomList.GetNumberOfAtoms(),&Mask) == false ) {
+        CSmallString error;
+        error << "unable to create trajectory cache: " << cache_name;
+        ES_ERROR(error);
+        return(false);
+    }
+
+    for(int i=2; i < Options.GetNumberOfProgArgs(); i++) {
+        if( ConvertTrajectory(Options.GetProgArg(i)) == false ) {
+            Cache.Close();
+            unlink(tmp_name);
+            return(false);
+        }
+    }
+
+    int nsnapshots = Cache.GetNumberOfSnapshots();
+    if( Cache.Close() == false ) {
+        unlink(tmp_name);
+        ES_ERROR("unable to finalize trajectory cache");
+        return(false);
+    }
+
+    if( rename(tmp_name,cache_name) != 0 ) {
+        CSmallString error;
+        error << "unable to rename trajectory cache to " << cache_name << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        unlink(tmp_name);
+        return(false);
+    }
+
+    if( Options.GetOptVerbose() ) {
+        printf("Number of stored atoms     : %d\n",Mask.GetNumberOfSelectedAtoms());
+        printf("Number of stored snapshots : %d\n",nsnapshots);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTraj2Cache::Finalize(void)
+{
+    if( Options.GetOptVerbose() ) {
+        CSmallTimeAndDate dt;
+        dt.GetActualTimeAndDate();
+
+        fprintf(stdout,"\n");
+        fprintf(stdout,"# ==============================================================================\n");
+        fprintf(stdout,"# %s terminated at %s\n",(const char*)Options.GetProgramName(),(const char*)dt.GetSDateAndTime());
+        fprintf(stdout,"# ==============================================================================\n");
+    }
+
+    if( Options.GetOptVerbose() || ErrorSystem.IsError() ) {
+        ErrorSystem.PrintErrors(stderr);
+        fprintf(stdout,"\n");
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTraj2Cache::ConvertTrajectory(const CSmallString& name)
+{
+    ETrajectoryFormat format = AMBER_TRAJ_UNKNOWN;
+    if( Options.GetOptInputFormat() == "ascii" ) format = AMBER_TRAJ_ASCII;
+    if( Options.GetOptInputFormat() == "ascii.gzip" ) format = AMBER_TRAJ_ASCII_GZIP;
+    if( Options.GetOptInputFormat() == "ascii.bzip2" ) format = AMBER_TRAJ_ASCII_BZIP2;
+    if( Options.GetOptInputFormat() == "netcdf" ) format = AMBER_TRAJ_NETCDF;
+
+    CAmberTrajectory traj;
+    traj.AssignTopology(&Topology);
+    if( traj.OpenTrajectoryFile(name,format,AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ) == false ) {
+        CSmallString error;
+        error << "unable to open trajectory: " << name;
+        ES_ERROR(error);
+        return(false);
+    }
+
+    int count = 0;
+    int result;
+    while( (result = traj.ReadSnapshot(&Snapshot)) == 0 ) {
+        if( Cache.WriteSnapshot(&Snapshot) == false ) {
+            traj.CloseTrajectoryFile();
+            return(false);
+        }
+        count++;
+    }
+    traj.CloseTrajectoryFile();
+
+    if( result != 1 ) {
+        CSmallString error;
+        error << "unable to read snapshot " << count + 1 << " from trajectory: " << name;
+        ES_ERROR(error);
+        return(false);
+    }
+
+    if( Options.GetOptVerbose() ) {
+        printf("%-40s : %d snapshots\n",(const char*)name,count);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,99 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include "Traj2CacheOptions.hpp"
+#include <ErrorSystem.hpp>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTraj2CacheOptions::CTraj2CacheOptions(void)
+{
+    SetShowMiniUsage(true);
+}
+
+//------------------------------------------------------------------------------
+
+int CTraj2CacheOptions::CheckOptions(void)
+{
+    if( (GetOptInputFormat() != "auto") && (GetOptInputFormat() != "ascii") &&
+        (GetOptInputFormat() != "ascii.gzip") && (GetOptInputFormat() != "ascii.bzip2") &&
+        (GetOptInputFormat() != "netcdf") ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: unsupported input format '%s'\n",
+                (char*)GetProgramName(),(char*)GetOptInputFormat());
+        IsError = true;
+        return(SO_OPTS_ERROR);
+    }
+
+    if( IsOptMaskSpecSet() && IsOptMaskFileSet() ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: options --mask and --maskfile are mutually exclusive\n",
+                (char*)GetProgramName());
+        IsError = true;
+        return(SO_OPTS_ERROR);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CTraj2CacheOptions::FinalizeOptions(void)
+{
+    bool ret_opt = false;
+
+    if( GetOptHelp() == true ) {
+        PrintUsage();
+        ret_opt = true;
+    }
+
+    if( GetOptVersion() == true ) {
+        PrintVersion();
+        ret_opt = true;
+    }
+
+    if( ret_opt == true ) {
+        printf("\n");
+        return(SO_EXIT);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CTraj2CacheOptions::CheckArguments(void)
+{
+    if( GetNumberOfProgArgs() < 3 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: topology, cache, and at least one trajectory have to be specified\n",
+                (char*)GetProgramName());
+        IsError = true;
+        return(SO_OPTS_ERROR);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
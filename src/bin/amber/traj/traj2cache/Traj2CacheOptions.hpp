@@ -0,0 +1,140 @@
+#ifndef Traj2CacheOptionsH
+#define Traj2CacheOptionsH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleOptions.hpp>
+#include <CATsMainHeader.hpp>
+
+//------------------------------------------------------------------------------
+
+class CTraj2CacheOptions : public CSimpleOptions {
+public:
+    // constructor - tune option setup
+    CTraj2CacheOptions(void);
+
+// program name and description -----------------------------------------------
+    CSO_PROG_NAME_BEGIN
+    "traj2cache"
+    CSO_PROG_NAME_END
+
+    CSO_PROG_DESC_BEGIN
+    "Convert AMBER trajectories into the trajectory cache, which is memory mapped by TrajPool. "
+    "Snapshots are stored with single precision and can be restricted to a subset of atoms."
+    CSO_PROG_DESC_END
+
+    CSO_PROG_VERS_BEGIN
+    LibBuildVersion_CATs
+    CSO_PROG_VERS_END
+
+    CSO_PROG_ARGS_SHORT_DESC_BEGIN
+    "PARM CACHE TRAJ1 [TRAJ2 ...]"
+    CSO_PROG_ARGS_SHORT_DESC_END
+
+    CSO_PROG_ARGS_LONG_DESC_BEGIN
+    "Arguments:\n"
+    "   PARM                       topology file name\n"
+    "   CACHE                      output trajectory cache name\n"
+    "   TRAJ1 [TRAJ2 ...]          input trajectories, snapshots are stored in the given order\n"
+    CSO_PROG_ARGS_LONG_DESC_END
+
+// list of all options and arguments ------------------------------------------
+    CSO_LIST_BEGIN
+    // options ------------------------------
+    CSO_OPT(CSmallString,InputFormat)
+    CSO_OPT(CSmallString,MaskSpec)
+    CSO_OPT(CSmallString,MaskFile)
+    CSO_OPT(bool,Help)
+    CSO_OPT(bool,Version)
+    CSO_OPT(bool,Verbose)
+    CSO_LIST_END
+
+    CSO_MAP_BEGIN
+// description of options -----------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                InputFormat,                        /* option name */
+                "auto",                          /* default value */
+                false,                          /* is option mandatory */
+                'i',                           /* short option name */
+                "input",                      /* long option name */
+                "FORMAT",                           /* parametr name */
+                "specify format of input trajectories:\n"
+                "   <green>auto</green>        - autodetect format\n"
+                "   <green>ascii</green>       - ASCII format\n"
+                "   <green>ascii.gzip</green>  - compressed ASCII format\n"
+                "   <green>ascii.bzip2</green> - compressed ASCII format\n"
+                "   <green>netcdf</green>      - NETCDF format\n")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                MaskSpec,                        /* option name */
+                "",                          /* default value */
+                false,                          /* is option mandatory */
+                'm',                           /* short option name */
+                "mask",                      /* long option name */
+                "MASK",                           /* parametr name */
+                "only atoms selected according to MASK will be stored otherwise all atoms are used. Mutually exclusive with 'maskfile' option.")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                MaskFile,                        /* option name */
+                NULL,                          /* default value */
+                false,                          /* is option mandatory */
+                'f',                           /* short option name */
+                "maskfile",                      /* long option name */
+                "MASKFILE",                           /* parametr name */
+                "only atoms selected according to the mask will be stored otherwise all atoms are used. The mask specification is read from the first line of the file of name MASKFILE. Mutually exclusive with 'mask' option.")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Verbose,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'v',                           /* short option name */
+                "verbose",                      /* long option name */
+                NULL,                           /* parametr name */
+                "increase output verbosity")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Version,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "version",                      /* long option name */
+                NULL,                           /* parametr name */
+                "output version information and exit")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Help,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'h',                           /* short option name */
+                "help",                      /* long option name */
+                NULL,                           /* parametr name */
+                "display this help and exit")   /* option description */
+    CSO_MAP_END
+
+// final operation with options ------------------------------------------------
+private:
+    virtual int CheckOptions(void);
+    virtual int FinalizeOptions(void);
+    virtual int CheckArguments(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
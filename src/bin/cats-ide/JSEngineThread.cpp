@@ -65,6 +65,9 @@ void CJSEngineThread::RunCode(const QString &code)
 
 void CJSEngineThread::run()
 {
+    //The engine was registered in the GUI thread, bind it to this thread.
+    QCATsScriptable::SetCATsEngine(JSEngine);
+
     JSEngine->clearExceptions();
 
     Result = JSEngine->evaluate(JSCode);
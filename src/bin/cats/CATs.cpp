@@ -29,7 +29,10 @@
 #include <QTextStream>
 #include <QFile>
 #include <QCATs.hpp>
+#include <ParallelContext.hpp>
 #include "CATs.hpp"
+#include "CATsWorker.hpp"
+#include <vector>
 
 //------------------------------------------------------------------------------
 
@@ -49,7 +52,7 @@ QString      CCATs::Contents;
 
 CCATs::CCATs(void)
 {
-    QCATsScriptable::CATsEngine = &Engine;
+    QCATsScriptable::SetCATsEngine(&Engine);
 }
 
 //==============================================================================
@@ -167,6 +170,10 @@ bool CCATs::RunNonInteractive(QTextStream& stream)
         Contents += stream.readAll();
     }
 
+    if( Options.GetOptThreads() > 1 ){
+        return( RunParallel(lineno) );
+    }
+
     Engine.evaluate(Contents,"",lineno);
 
     if( Engine.hasUncaughtException() == true ){
@@ -178,6 +185,54 @@ bool CCATs::RunNonInteractive(QTextStream& stream)
 
 //------------------------------------------------------------------------------
 
+bool CCATs::RunParallel(int lineno)
+{
+    int nthreads = Options.GetOptThreads();
+    vout << "# Number of workers : " << nthreads << endl;
+
+    CParallelContext::Init(nthreads);
+
+    // start workers, the master is the worker with index zero
+    std::vector<CCATsWorker*> workers;
+    for(int i=1; i < nthreads; i++){
+        CCATsWorker* p_worker = new CCATsWorker(i,Contents,lineno);
+        if( p_worker->StartThread() == false ){
+            ES_ERROR("unable to start worker thread");
+            delete p_worker;
+            // collective operations must not wait for it
+            CParallelContext::EndThread();
+            continue;
+        }
+        workers.push_back(p_worker);
+    }
+
+    CParallelContext::BeginThread(0);
+    Engine.evaluate(Contents,"",lineno);
+    CParallelContext::EndThread();
+
+    bool result = ! Engine.hasUncaughtException();
+
+    QTextStream stream(stderr);
+    for(size_t i=0; i < workers.size(); i++){
+        workers[i]->WaitForThread();
+        if( workers[i]->HasError() ){
+            stream << "cats: worker " << workers[i]->GetIndex() << ", line "
+                   << workers[i]->GetErrorLineNumber() << " - " << workers[i]->GetErrorMessage() << Qt::endl;
+            result = false;
+        }
+        delete workers[i];
+    }
+
+    CParallelContext::Finalize();
+
+    if( result == false ){
+        QCATs::ExitValue = -1;
+    }
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
 bool CCATs::RunInteractive(void)
 {
     // this is used in mixed mode noninteractive/interactive execution
@@ -62,6 +62,9 @@ private:
     /// run interpreter in non-interactive mode reading input from stdin
     bool RunNonInteractive(QTextStream& stream);
 
+    /// run script by several workers
+    bool RunParallel(int lineno);
+
     /// print welcome text
     void PrintWelcomeText(void);
 
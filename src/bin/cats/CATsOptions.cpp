@@ -18,6 +18,7 @@
 //     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 // =============================================================================
 
+#include <stdio.h>
 #include "CATsOptions.hpp"
 #include <ErrorSystem.hpp>
 
@@ -36,6 +37,21 @@ CCATsOptions::CCATsOptions(void)
 
 int CCATsOptions::CheckOptions(void)
 {
+    if( GetOptThreads() <= 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: number of threads has to be greater than zero, but %d specified\n",
+                (char*)GetProgramName(),GetOptThreads());
+        IsError = true;
+        return(SO_OPTS_ERROR);
+    }
+
+    if( (GetOptThreads() > 1) && GetOptInteractive() ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: --threads cannot be combined with --interactive\n",(char*)GetProgramName());
+        IsError = true;
+        return(SO_OPTS_ERROR);
+    }
+
     return(SO_CONTINUE);
 }
 
@@ -57,6 +57,7 @@ public:
     // arguments ----------------------------
     // options ------------------------------
     CSO_OPT(bool,Interactive)
+    CSO_OPT(int,Threads)
     CSO_OPT(bool,Help)
     CSO_OPT(bool,Version)
     CSO_OPT(bool,Verbose)
@@ -73,6 +74,15 @@ public:
                 NULL,                           /* parametr name */
                 "run in interactive mode")   /* option description */
     //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                Threads,                        /* option name */
+                1,                          /* default value */
+                false,                          /* is option mandatory */
+                't',                           /* short option name */
+                "threads",                      /* long option name */
+                "NUM",                           /* parametr name */
+                "number of parallel workers running the script, TrajPool snapshots are distributed among them")   /* option description */
+    //----------------------------------------------------------------------
     CSO_MAP_OPT(bool,                           /* option type */
                 Verbose,                        /* option name */
                 false,                          /* default value */
@@ -0,0 +1,96 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2012 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2010 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <QScriptEngine>
+#include <QCATs.hpp>
+#include <ParallelContext.hpp>
+#include "CATsWorker.hpp"
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCATsWorker::CCATsWorker(int index,const QString& contents,int lineno)
+{
+    Index = index;
+    Contents = contents;
+    LineNumber = lineno;
+    Error = false;
+    ErrorLineNumber = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CCATsWorker::HasError(void) const
+{
+    return(Error);
+}
+
+//------------------------------------------------------------------------------
+
+int CCATsWorker::GetIndex(void) const
+{
+    return(Index);
+}
+
+//------------------------------------------------------------------------------
+
+int CCATsWorker::GetErrorLineNumber(void) const
+{
+    return(ErrorLineNumber);
+}
+
+//------------------------------------------------------------------------------
+
+const QString& CCATsWorker::GetErrorMessage(void) const
+{
+    return(ErrorMessage);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CCATsWorker::ExecuteThread(void)
+{
+    CParallelContext::BeginThread(Index);
+
+    // the engine has to live in the worker thread
+    QScriptEngine engine;
+    RegisterAllCATsClasses(engine);
+
+    engine.evaluate(Contents,"",LineNumber);
+
+    if( engine.hasUncaughtException() == true ){
+        Error = true;
+        ErrorLineNumber = engine.uncaughtExceptionLineNumber();
+        ErrorMessage = engine.uncaughtException().toString();
+    }
+
+    // do not block collective operations of remaining workers
+    CParallelContext::EndThread();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
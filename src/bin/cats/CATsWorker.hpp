@@ -0,0 +1,64 @@
+#ifndef CATsWorkerH
+#define CATsWorkerH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2012 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2010 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleThread.hpp>
+#include <QString>
+
+//------------------------------------------------------------------------------
+
+/// worker thread running its own copy of the script in parallel mode
+
+class CCATsWorker : public CSimpleThread {
+public:
+// constructor -----------------------------------------------------------------
+    CCATsWorker(int index,const QString& contents,int lineno);
+
+// information methods ---------------------------------------------------------
+    /// was the script terminated by an uncaught exception
+    bool HasError(void) const;
+
+    /// get worker index
+    int GetIndex(void) const;
+
+    /// get line of the uncaught exception
+    int GetErrorLineNumber(void) const;
+
+    /// get text of the uncaught exception
+    const QString& GetErrorMessage(void) const;
+
+// section of private data ----------------------------------------------------
+private:
+    int         Index;
+    QString     Contents;
+    int         LineNumber;
+    bool        Error;
+    int         ErrorLineNumber;
+    QString     ErrorMessage;
+
+    /// thread main routine
+    virtual void ExecuteThread(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -25,6 +25,11 @@
 #include <boost/format.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <vector>
+#include <algorithm>
+#include <string>
+#include <math.h>
+#include <errno.h>
+#include <string.h>
 
 //------------------------------------------------------------------------------
 
@@ -38,8 +43,13 @@ using namespace boost::algorithm;
 
 CCubeGridGen::CCubeGridGen(void)
 {
+    NX = 0;
+    NY = 0;
+    NZ = 0;
+
     TotalNumber = 0;
     ExcludedNumber = 0;
+    FinalNumber = 0;
     NumberOfBatches = 0;
 }
 
@@ -95,6 +105,7 @@ int CCubeGridGen::Init(int argc,char* argv[])
     if( Options.IsOptStructureSet() ){
     vout <<        "# Structure     : " << Options.GetOptStructure() <<  endl;
     vout << format("# Treshold      : %.2f") % Options.GetOptTreshold() << endl;
+    vout <<        "# Threads       : " << Options.GetOptThreads() << endl;
     vout << "# ------------------------------------------------------------------------------" << endl;
     }
     return( result );
@@ -116,45 +127,40 @@ bool CCubeGridGen::Run(void)
 
     // generate grid points
     TotalNumber = Options.GetOptNX() * Options.GetOptNY()* Options.GetOptNZ();
-    GridPoints.reserve(TotalNumber);
 
     double dx = (Options.GetOptNX()-1)*Options.GetOptSX();
     double dy = (Options.GetOptNY()-1)*Options.GetOptSY();
     double dz = (Options.GetOptNZ()-1)*Options.GetOptSZ();
 
-    CPoint corner(dx,dy,dz);
-    corner /= 2.0;
-    CPoint pos;
+    Corner = CPoint(dx,dy,dz);
+    Corner /= 2.0;
 
-    int nx,ny,nz;
     if( Options.GetOptSymmetryYZ() ){
-        nx = Options.GetOptNX()/2 + Options.GetOptNX() % 2;
+        NX = Options.GetOptNX()/2 + Options.GetOptNX() % 2;
     } else {
-        nx = Options.GetOptNX();
+        NX = Options.GetOptNX();
     }
     if( Options.GetOptSymmetryXZ() ){
-        ny = Options.GetOptNY()/2 + Options.GetOptNY() % 2;
+        NY = Options.GetOptNY()/2 + Options.GetOptNY() % 2;
     } else {
-        ny = Options.GetOptNY();
+        NY = Options.GetOptNY();
     }
     if( Options.GetOptSymmetryXY() ){
-        nz = Options.GetOptNZ()/2 + Options.GetOptNZ() % 2;
+        NZ = Options.GetOptNZ()/2 + Options.GetOptNZ() % 2;
     } else {
-        nz = Options.GetOptNZ();
+        NZ = Options.GetOptNZ();
     }
 
-    for(int i = 0; i < nx; i++ ){
-        for(int j = 0; j < ny; j++ ){
-            for(int k = 0; k < nz; k++ ){
-                pos = corner - CPoint(i*Options.GetOptSX(),j*Options.GetOptSY(),k*Options.GetOptSZ());
-                if( Options.IsOptStructureSet() ){
-                    if( IsPointValid(pos) ) GridPoints.push_back(pos);
-                } else {
-                    GridPoints.push_back(pos);
-                }
-            }
+    FinalNumber = NX*NY*NZ;
+    if( Options.IsOptStructureSet() ){
+        SetupCells();
+        FilterGridPoints();
+        FinalNumber = 0;
+        for(int i = 0; i < NX; i++ ){
+            FinalNumber += PlaneCounts[i];
         }
     }
+    ExcludedNumber = NX*NY*NZ - FinalNumber;
 
     // save grid points
     if( SaveGridPoints() == false ){
@@ -165,7 +171,7 @@ bool CCubeGridGen::Run(void)
     // print statistics
     vout << format("# Total number of points   : %d")%TotalNumber << endl;
     vout << format("# Excluded number of points: %d")%ExcludedNumber << endl;
-    vout << format("# Final number of points   : %d")%GridPoints.size() << endl;
+    vout << format("# Final number of points   : %d")%FinalNumber << endl;
     vout << format("# Number of batches        : %d")%NumberOfBatches << endl;
 
     return(true);
@@ -173,18 +179,96 @@ bool CCubeGridGen::Run(void)
 
 //------------------------------------------------------------------------------
 
-bool CCubeGridGen::IsPointValid(const CPoint& pos)
+const CPoint CCubeGridGen::GetGridPoint(int i,int j,int k) const
+{
+    return( Corner - CPoint(i*Options.GetOptSX(),j*Options.GetOptSY(),k*Options.GetOptSZ()) );
+}
+
+//------------------------------------------------------------------------------
+
+void CCubeGridGen::SetupCells(void)
+{
+    int natoms = Structure.GetNumberOfAtoms();
+    AtomPositions.resize(natoms);
+    for(int i=0; i < natoms; i++){
+        AtomPositions[i] = Structure.GetPosition(i);
+    }
+
+    // atoms closer than treshold are in the same or adjacent cells
+    Cells.Setup(AtomPositions,Options.GetOptTreshold());
+}
+
+//------------------------------------------------------------------------------
+
+bool CCubeGridGen::IsPointValid(const CPoint& pos) const
 {
+    if( AtomPositions.size() == 0 ) return(true);
+
     double thr = Options.GetOptTreshold();
-    for(int i=0; i < Structure.GetNumberOfAtoms(); i++){
-        CPoint apos = Structure.GetPosition(i);
-        if( Size(apos-pos) < thr ) return(false);
+
+    const std::vector<int>& cellstart = Cells.GetCellStart();
+    const std::vector<int>& cellatoms = Cells.GetCellPoints();
+    int nx = Cells.GetNX();
+    int ny = Cells.GetNY();
+    int nz = Cells.GetNZ();
+
+    // cells are at least as large as treshold, thus only adjacent cells are scanned
+    int cx,cy,cz;
+    Cells.GetCell(pos,cx,cy,cz);
+
+    int ixs = std::max(cx-1,0);
+    int ixe = std::min(cx+1,nx-1);
+    int iys = std::max(cy-1,0);
+    int iye = std::min(cy+1,ny-1);
+    int izs = std::max(cz-1,0);
+    int ize = std::min(cz+1,nz-1);
+
+    for(int iz=izs; iz <= ize; iz++){
+        for(int iy=iys; iy <= iye; iy++){
+            for(int ix=ixs; ix <= ixe; ix++){
+                int c = (iz*ny + iy)*nx + ix;
+                for(int a=cellstart[c]; a < cellstart[c+1]; a++){
+                    if( Size(AtomPositions[cellatoms[a]]-pos) < thr ) return(false);
+                }
+            }
+        }
     }
     return(true);
 }
 
 //------------------------------------------------------------------------------
 
+void CCubeGridGen::ExecuteWorker(int worker)
+{
+    for(int i = worker; i < NX; i += Options.GetOptThreads() ){
+        std::vector<bool>& mask = PlaneMasks[i];
+        mask.assign((size_t)NY*NZ,false);
+        int count = 0;
+        for(int j = 0; j < NY; j++ ){
+            for(int k = 0; k < NZ; k++ ){
+                if( IsPointValid(GetGridPoint(i,j,k)) ){
+                    mask[j*NZ+k] = true;
+                    count++;
+                }
+            }
+        }
+        PlaneCounts[i] = count;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CCubeGridGen::FilterGridPoints(void)
+{
+    PlaneMasks.resize(NX);
+    PlaneCounts.assign(NX,0);
+
+    // planes are distributed among workers, results do not depend on the order
+    RunWorkers(Options.GetOptThreads());
+}
+
+//------------------------------------------------------------------------------
+
 bool CCubeGridGen::SaveGridPoints(void)
 {
     // open output file
@@ -201,37 +285,70 @@ bool CCubeGridGen::SaveGridPoints(void)
         p_fout = stdout;
     }
 
-    int remnpoints = GridPoints.size();
+    // points are generated on the fly and written in blocks
+    const size_t    buffer_size = 1024*1024;
+    std::string     buffer;
+    char            line[256];
+    bool            result = true;
+
+    buffer.reserve(buffer_size + sizeof(line));
+
+    bool filter = Options.IsOptStructureSet();
+    int  remnpoints = FinalNumber;
+    int  ipoint = 0;
     NumberOfBatches = 0;
-    for(size_t i=0; i < GridPoints.size(); i++){
-        if( Options.GetOptBatchSize() == 0 ){
-            if( i == 0 ){
-                fprintf(p_fout,"%d\n",remnpoints);
-                fprintf(p_fout,"single batch\n");
-                NumberOfBatches++;
-            }
-        } else {
-            if( (i % Options.GetOptBatchSize()) == 0 ) {
-                if( remnpoints < Options.GetOptBatchSize() ){
-                    fprintf(p_fout,"%d\n",remnpoints);
+
+    for(int i = 0; (i < NX) && result; i++ ){
+        if( filter && (PlaneCounts[i] == 0) ) continue;
+        for(int j = 0; (j < NY) && result; j++ ){
+            for(int k = 0; k < NZ; k++ ){
+                if( filter && (PlaneMasks[i][j*NZ+k] == false) ) continue;
+                if( Options.GetOptBatchSize() == 0 ){
+                    if( ipoint == 0 ){
+                        snprintf(line,sizeof(line),"%d\nsingle batch\n",remnpoints);
+                        buffer += line;
+                        NumberOfBatches++;
+                    }
                 } else {
-                    fprintf(p_fout,"%d\n",Options.GetOptBatchSize());
+                    if( (ipoint % Options.GetOptBatchSize()) == 0 ) {
+                        NumberOfBatches++;
+                        snprintf(line,sizeof(line),"%d\nbatch %d\n",
+                                 std::min(remnpoints,Options.GetOptBatchSize()),NumberOfBatches);
+                        buffer += line;
+                    }
                 }
-                NumberOfBatches++;
-                fprintf(p_fout,"batch %d\n",NumberOfBatches);
+                CPoint pos = GetGridPoint(i,j,k);
+                snprintf(line,sizeof(line),"%2s %12.6f %12.6f %12.6f\n",(const char*)Options.GetOptSymbol(),pos.x,pos.y,pos.z);
+                buffer += line;
+                remnpoints--;
+                ipoint++;
+            }
+            if( buffer.size() >= buffer_size ){
+                if( fwrite(buffer.c_str(),1,buffer.size(),p_fout) != buffer.size() ) result = false;
+                buffer.clear();
             }
         }
-        CPoint pos = GridPoints[i];
-        fprintf(p_fout,"%2s %12.6f %12.6f %12.6f\n",(const char*)Options.GetOptSymbol(),pos.x,pos.y,pos.z);
-        remnpoints--;
+        // masks are not needed anymore
+        if( filter ) std::vector<bool>().swap(PlaneMasks[i]);
     }
 
+    if( result && (buffer.size() > 0) ){
+        if( fwrite(buffer.c_str(),1,buffer.size(),p_fout) != buffer.size() ) result = false;
+    }
+    if( ferror(p_fout) ) result = false;
+
     // close output file if necessary
     if( Options.GetArgGridPoints() != "-" ) {
         if( p_fout ) fclose(p_fout);
     }
 
-    return(true);
+    if( result == false ){
+        CSmallString error;
+        error << "unable to write grid points to " << Options.GetArgGridPoints();
+        ES_ERROR(error);
+    }
+
+    return(result);
 }
 
 //==============================================================================
@@ -26,10 +26,12 @@
 #include <vector>
 #include <Point.hpp>
 #include <XYZStructure.hpp>
+#include <CellGrid.hpp>
+#include <WorkerTask.hpp>
 
 //------------------------------------------------------------------------------
 
-class CCubeGridGen {
+class CCubeGridGen : private CWorkerTask {
 public:
     // constructor
     CCubeGridGen(void);
@@ -49,16 +51,40 @@ private:
     CCubeGridGenOptions Options;            // program options
     CTerminalStr        Console;
     CVerboseStr         vout;
-    std::vector<CPoint> GridPoints;
     CXYZStructure       Structure;
 
+    // grid
+    CPoint              Corner;
+    int                 NX,NY,NZ;           // generated part of the grid
+
+    // valid points, one mask per yz-plane so that threads never share data
+    std::vector< std::vector<bool> >    PlaneMasks;
+    std::vector<int>                    PlaneCounts;
+
+    // cell list of structure atoms
+    std::vector<CPoint> AtomPositions;
+    CCellGrid           Cells;
+
     // statistics
     int                 TotalNumber;
     int                 ExcludedNumber;
+    int                 FinalNumber;
     int                 NumberOfBatches;
 
+    // return position of grid point
+    const CPoint GetGridPoint(int i,int j,int k) const;
+
+    // sort structure atoms into the cell list
+    void SetupCells(void);
+
     // test grid point against the structure
-    bool IsPointValid(const CPoint& pos);
+    bool IsPointValid(const CPoint& pos) const;
+
+    // test planes assigned to the worker
+    virtual void ExecuteWorker(int worker);
+
+    // test all grid points in parallel
+    void FilterGridPoints(void);
 
     // save final data
     bool SaveGridPoints(void);
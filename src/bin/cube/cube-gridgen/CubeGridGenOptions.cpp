@@ -34,6 +34,22 @@ CCubeGridGenOptions::CCubeGridGenOptions(void)
 
 int CCubeGridGenOptions::CheckOptions(void)
 {
+    if( GetOptBatchSize() < 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: batch size has to be zero or positive, but %d is specified\n",
+                (char*)GetProgramName(),GetOptBatchSize());
+        IsError = true;
+    }
+
+    if( GetOptThreads() <= 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: number of threads has to be greater than zero, but %d is specified\n",
+                (char*)GetProgramName(),GetOptThreads());
+        IsError = true;
+    }
+
+    if( IsError == true ) return(SO_OPTS_ERROR);
+
     return(SO_CONTINUE);
 }
 
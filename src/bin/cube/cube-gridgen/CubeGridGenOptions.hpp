@@ -61,6 +61,7 @@ public:
     CSO_OPT(CSmallString,Symbol)
     CSO_OPT(CSmallString,Structure)
     CSO_OPT(double,Treshold)
+    CSO_OPT(int,Threads)
     CSO_OPT(bool,Help)
     CSO_OPT(bool,Version)
     CSO_OPT(bool,Verbose)     
@@ -192,6 +193,15 @@ public:
                 "REAL",                           /* parametr name */
                 "minimum allowed distance between grid point and any atom in the structure")   /* option description */
     //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                Threads,                        /* option name */
+                1,                          /* default value */
+                false,                          /* is option mandatory */
+                't',                           /* short option name */
+                "threads",                      /* long option name */
+                "INT",                           /* parametr name */
+                "number of threads used to filter grid points by the structure")   /* option description */
+    //----------------------------------------------------------------------
     CSO_MAP_OPT(bool,                           /* option type */
                 Verbose,                        /* option name */
                 false,                          /* default value */
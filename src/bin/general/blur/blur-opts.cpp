@@ -42,6 +42,29 @@ int CBlurOpts::CheckOptions(void)
         IsError = true;
     }
 
+    if( (GetOptInputFormat() != "xplor") && (GetOptInputFormat() != "cube")
+        && (GetOptInputFormat() != "binary") ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: unsupported input format %s\n",
+                (char*)GetProgramName(),(const char*)GetOptInputFormat());
+        IsError = true;
+    }
+
+    if( (GetOptOutputFormat() != "auto") && (GetOptOutputFormat() != "xplor")
+        && (GetOptOutputFormat() != "cube") && (GetOptOutputFormat() != "binary") ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: unsupported output format %s\n",
+                (char*)GetProgramName(),(const char*)GetOptOutputFormat());
+        IsError = true;
+    }
+
+    if( GetOptThreads() <= 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: number of threads has to be greater than zero, but %d is specified\n",
+                (char*)GetProgramName(),GetOptThreads());
+        IsError = true;
+    }
+
     if( IsError == true ) return(SO_OPTS_ERROR);
 
     return(SO_CONTINUE);
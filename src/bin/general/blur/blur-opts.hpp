@@ -38,7 +38,7 @@ public:
     CSO_PROG_NAME_END
 
     CSO_PROG_DESC_BEGIN
-    "Blur 3D-density map in X-Plore format by data filtering in reciprocal Fourier space."
+    "Blur 3D-density map in X-Plore or Gaussian cube format by data filtering in reciprocal Fourier space."
     CSO_PROG_DESC_END
 
     CSO_PROG_VERS_BEGIN
@@ -53,6 +53,10 @@ public:
     CSO_ARG(CSmallString,Output)
     // options ------------------------------
     CSO_OPT(CSmallString,FilterType)
+    CSO_OPT(CSmallString,InputFormat)
+    CSO_OPT(CSmallString,OutputFormat)
+    CSO_OPT(int,Threads)
+    CSO_OPT(CSmallString,Wisdom)
     CSO_OPT(bool,Help)
     CSO_OPT(bool,Version)
     CSO_OPT(bool,Verbose)
@@ -91,6 +95,42 @@ public:
                 "STRING",                           /* parametr name */
                 "filter type: either low-pass or gauss is implemeted")   /* option description */
     //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                InputFormat,                        /* option name */
+                "xplor",                          /* default value */
+                false,                          /* is option mandatory */
+                'i',                           /* short option name */
+                "input",                      /* long option name */
+                "FORMAT",                           /* parametr name */
+                "input format: xplor, cube, or binary")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                OutputFormat,                        /* option name */
+                "auto",                          /* default value */
+                false,                          /* is option mandatory */
+                'o',                           /* short option name */
+                "output",                      /* long option name */
+                "FORMAT",                           /* parametr name */
+                "output format: auto (text format of input data), xplor, cube, or binary")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                Threads,                        /* option name */
+                1,                          /* default value */
+                false,                          /* is option mandatory */
+                't',                           /* short option name */
+                "threads",                      /* long option name */
+                "NUMBER",                           /* parametr name */
+                "number of threads used by FFTW")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                Wisdom,                        /* option name */
+                NULL,                          /* default value */
+                false,                          /* is option mandatory */
+                'w',                           /* short option name */
+                "wisdom",                      /* long option name */
+                "FILE",                           /* parametr name */
+                "measure FFT plans and keep FFTW wisdom in the file for subsequent runs")   /* option description */
+    //----------------------------------------------------------------------
     CSO_MAP_OPT(bool,                           /* option type */
                 Verbose,                        /* option name */
                 false,                          /* default value */
@@ -23,6 +23,10 @@
 // =============================================================================
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
 #include <math.h>
 #include "blur.hpp"
 #include <ErrorSystem.hpp>
@@ -30,8 +34,39 @@
 //------------------------------------------------------------------------------
 
 #define GIDX(i,j,k) (Nz*(Ny*(i)+(j))+(k))
+#define HIDX(i,j,k) (NzC*(Ny*(i)+(j))+(k))
 #define sqrt_2_PI 2.5066282746310002416123552393401041627
 
+// binary map: magic, header format, Nx, Ny, Nz, length of text header,
+// text header, and Nx*Ny*Nz doubles in native byte order (GIDX order)
+static const char BlurBinaryMagic[8] = {'C','A','T','S','M','A','P','1'};
+
+//------------------------------------------------------------------------------
+
+// write formatted text into the buffer, the buffer is flushed to fout
+// when the text does not fit into its remaining space
+static bool BufferPrintf(std::vector<char>& buffer,size_t& len,FILE* fout,const char* format,...)
+{
+    for(;;) {
+        size_t  avail = buffer.size() - len;
+        va_list args;
+        va_start(args,format);
+        int n = vsnprintf(&buffer[len],avail,format,args);
+        va_end(args);
+        if( n < 0 ) return(false);
+        if( (size_t)n < avail ) {
+            len += n;
+            return(true);
+        }
+        if( len > 0 ) {
+            if( fwrite(&buffer[0],1,len,fout) != len ) return(false);
+            len = 0;
+        } else {
+            buffer.resize(n + 1);
+        }
+    }
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -43,10 +78,13 @@ CBlur::CBlur(void)
     OutputFile = NULL;
     OwnOutputFile = false;
 
+    SourceFormat = EBF_XPLOR;
+
     Nx = 0;
     Ny = 0;
     Nz = 0;
     N = 0;
+    NzC = 0;
 
     startX = 0;
     stopX = 0;
@@ -65,8 +103,11 @@ CBlur::CBlur(void)
     rY = 0;
     rZ = 0;
 
-    FirstArray = NULL;
-    SecondArray = NULL;
+    Data = NULL;
+    Spectrum = NULL;
+    ForwardPlan = NULL;
+    BackwardPlan = NULL;
+    ThreadsInitialized = false;
 }
 
 //==============================================================================
@@ -127,27 +168,57 @@ bool CBlur::Run(void)
 {
     if( (InputFile == NULL) && (OutputFile == NULL) ) return(false);   // files are not opened
 
-    // read input data
-    if( ReadDataXPLOR(InputFile) == false ) {
+    // read input header
+    bool result = false;
+    if( Options.GetOptInputFormat() == "xplor" ) {
+        result = ReadHeaderXPLOR(InputFile);
+    } else if( Options.GetOptInputFormat() == "cube" ) {
+        result = ReadHeaderCube(InputFile);
+    } else {
+        result = ReadHeaderBinary(InputFile);
+    }
+    if( result == false ) {
         fprintf(stderr,"%s: unable to read input file '%s'\n",
                 (char*)Options.GetProgramName(),(const char*)Options.GetArgInput());
         return(false);
     }
 
+    // output format
+    OutputFormat = Options.GetOptOutputFormat();
+    if( OutputFormat == "auto" ) {
+        OutputFormat = SourceFormat == EBF_CUBE ? "cube" : "xplor";
+    }
+    if( ((OutputFormat == "xplor") && (SourceFormat != EBF_XPLOR)) ||
+        ((OutputFormat == "cube") && (SourceFormat != EBF_CUBE)) ) {
+        fprintf(stderr,"%s: input map cannot be written in '%s' format\n",
+                (char*)Options.GetProgramName(),(const char*)OutputFormat);
+        return(false);
+    }
 
-    fftw_plan       plan;
-    int             F_PLAN;
+    // prepare transformations before data are loaded as measuring destroys arrays
+    if( AllocateArrays() == false ) return(false);
+    if( PlanTransforms() == false ) return(false);
+
+    // read input data
+    if( Options.GetOptInputFormat() == "binary" ) {
+        result = ReadValuesBinary(InputFile);
+    } else {
+        result = ReadValuesText(InputFile,Options.GetOptInputFormat() == "xplor");
+    }
+    if( result == false ) {
+        fprintf(stderr,"%s: unable to read input file '%s'\n",
+                (char*)Options.GetProgramName(),(const char*)Options.GetArgInput());
+        return(false);
+    }
 
     // perform forward FFT transformation ----------------------------------------
-    F_PLAN=FFTW_FORWARD;
-    plan = fftw_plan_dft_3d(Nx,Ny,Nz,FirstArray,SecondArray,F_PLAN,FFTW_ESTIMATE);
-    fftw_execute(plan);
+    fftw_execute(ForwardPlan);
 
     // filter map ----------------------------------------------------------------
     if( Options.GetOptFilterType() == "low-pass" ) {
-        LowPassFilter(SecondArray);
+        LowPassFilter(Spectrum);
     } else if( Options.GetOptFilterType() == "gauss" ) {
-        GaussFilter(SecondArray);
+        GaussFilter(Spectrum);
     } else {
         fprintf(stderr,"%s: not implemented filter '%s'\n",
                 (char*)Options.GetProgramName(),(const char*)Options.GetOptFilterType());
@@ -155,21 +226,22 @@ bool CBlur::Run(void)
     }
 
     // perform reverse FFT transformation ----------------------------------------
-    F_PLAN=FFTW_BACKWARD;
-    plan = fftw_plan_dft_3d(Nx,Ny,Nz,SecondArray,FirstArray,F_PLAN,FFTW_ESTIMATE);
-    fftw_execute (plan);
+    fftw_execute(BackwardPlan);
 
-    // data has to be normalized - only real part is considered
-    for(int i=0; i<Nx; i++) {
-        for(int j=0; j < Ny; j++) {
-            for(int k=0; k<Nz; k++) {
-                FirstArray[GIDX(i,j,k)][0] /= N;
-            }
-        }
+    // data has to be normalized
+    for(int i=0; i < N; i++) {
+        Data[i] /= N;
     }
 
     // write data
-    if( WriteDataXPLOR(OutputFile) == false ) {
+    if( OutputFormat == "xplor" ) {
+        result = WriteDataXPLOR(OutputFile);
+    } else if( OutputFormat == "cube" ) {
+        result = WriteDataCube(OutputFile);
+    } else {
+        result = WriteDataBinary(OutputFile);
+    }
+    if( result == false ) {
         fprintf(stderr,"%s: unable to write blured data into file '%s'\n",
                 (char*)Options.GetProgramName(),(const char*)Options.GetArgOutput());
         return(false);
@@ -194,11 +266,20 @@ bool CBlur::Finalize(void)
         OwnOutputFile = false;
     }
 
-    if( FirstArray != NULL ) fftw_free(FirstArray);
-    if( SecondArray != NULL ) fftw_free(SecondArray);
+    if( ForwardPlan != NULL ) fftw_destroy_plan(ForwardPlan);
+    if( BackwardPlan != NULL ) fftw_destroy_plan(BackwardPlan);
+    if( Data != NULL ) fftw_free(Data);
+    if( Spectrum != NULL ) fftw_free(Spectrum);
 
-    FirstArray = NULL;
-    SecondArray = NULL;
+    ForwardPlan = NULL;
+    BackwardPlan = NULL;
+    Data = NULL;
+    Spectrum = NULL;
+
+    if( ThreadsInitialized == true ) {
+        fftw_cleanup_threads();
+        ThreadsInitialized = false;
+    }
 
     return(true);
 }
@@ -218,15 +299,23 @@ void CBlur::PrintProgHeader(FILE* fout)
     } else {
         fprintf(stdout,"# Input file      : %s\n",(const char*)Options.GetArgInput());
     }
+    fprintf(stdout,"# Input format    : %s\n",(const char*)Options.GetOptInputFormat());
     if( Options.GetArgOutput() == "-" ) {
         fprintf(stdout,"# Output file     : standard output stream (stdout)\n");
     } else {
         fprintf(stdout,"# Output file     : %s\n",(const char*)Options.GetArgOutput());
     }
+    fprintf(stdout,"# Output format   : %s\n",(const char*)Options.GetOptOutputFormat());
     fprintf(stdout,"# ------------------------------------------------------------------------------\n");
     fprintf(stdout,"# Filter type     : %s\n",(const char*)Options.GetOptFilterType());
     fprintf(stdout,"# Treshold value  : %f\n",Options.GetArgFilterValue());
     fprintf(stdout,"# ------------------------------------------------------------------------------\n");
+    fprintf(stdout,"# FFTW threads    : %d\n",Options.GetOptThreads());
+    if( Options.IsOptWisdomSet() == true ) {
+        fprintf(stdout,"# FFTW wisdom     : %s\n",(const char*)Options.GetOptWisdom());
+    } else {
+        fprintf(stdout,"# FFTW wisdom     : -none- (estimated plans)\n");
+    }
     fprintf(stdout,"# Verbose         : %s\n",bool_to_str(Options.GetOptVerbose()));
     fprintf(stdout,"# ------------------------------------------------------------------------------\n");
     fprintf(stdout,"#\n");
@@ -236,13 +325,81 @@ void CBlur::PrintProgHeader(FILE* fout)
 //------------------------------------------------------------------------------
 //==============================================================================
 
-bool CBlur::ReadDataXPLOR(FILE *fin)
+bool CBlur::AllocateArrays(void)
+{
+    if( (Nx <= 0) || (Ny <= 0) || (Nz <= 0) ) {
+        ES_ERROR("illegal dimensions of 3D-density map");
+        return(false);
+    }
+
+    // init data array
+    N = Nx*Ny*Nz;
+    NzC = Nz/2 + 1;
+
+    // r2c transform needs only the non-redundant half of the spectrum
+    Data = (double*)fftw_malloc(sizeof(double) * (size_t)N);
+    Spectrum = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (size_t)Nx*Ny*NzC);
+
+    if( (Data == NULL) || (Spectrum == NULL) ) {
+        ES_ERROR("unable to allocate memory for 3D-density map arrays");
+        return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CBlur::PlanTransforms(void)
+{
+    if( Options.GetOptThreads() > 1 ) {
+        if( fftw_init_threads() == 0 ) {
+            ES_ERROR("unable to initialize FFTW threads");
+            return(false);
+        }
+        ThreadsInitialized = true;
+        fftw_plan_with_nthreads(Options.GetOptThreads());
+    }
+
+    unsigned int flags = FFTW_ESTIMATE;
+    if( Options.IsOptWisdomSet() == true ) {
+        // missing wisdom file is not an error, it is created below
+        fftw_import_wisdom_from_filename(Options.GetOptWisdom());
+        flags = FFTW_MEASURE;
+    }
+
+    ForwardPlan = fftw_plan_dft_r2c_3d(Nx,Ny,Nz,Data,Spectrum,flags);
+    BackwardPlan = fftw_plan_dft_c2r_3d(Nx,Ny,Nz,Spectrum,Data,flags);
+
+    if( (ForwardPlan == NULL) || (BackwardPlan == NULL) ) {
+        ES_ERROR("unable to create FFTW plans");
+        return(false);
+    }
+
+    if( Options.IsOptWisdomSet() == true ) {
+        if( fftw_export_wisdom_to_filename(Options.GetOptWisdom()) == 0 ) {
+            CSmallString warning;
+            warning << "unable to save FFTW wisdom to " << Options.GetOptWisdom();
+            ES_WARNING(warning);
+        }
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CBlur::ReadHeaderXPLOR(FILE *fin)
 {
     if( fin == NULL ) {
         ES_ERROR("fin is NULL");
         return(false);
     }
 
+    SourceFormat = EBF_XPLOR;
+
     char buf[1000];
 
     // skip 3 lines
@@ -267,50 +424,195 @@ bool CBlur::ReadDataXPLOR(FILE *fin)
         return(false);
     }
 
-    // init data array
-    N=Nx*Ny*Nz;
+    // skip line
+    cret = fgets(buf, sizeof(buf), fin);
+    if( cret == NULL ) return(false);
 
-    // allocate arrays
-    FirstArray = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
-    SecondArray = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N);
+    return(true);
+}
 
-    if( (FirstArray == NULL) || (SecondArray == NULL) ) {
-        if( FirstArray != NULL ) fftw_free(FirstArray);
-        if( SecondArray != NULL ) fftw_free(SecondArray);
-        ES_ERROR("unable to allocate memory for 3D-density map arrays");
+//------------------------------------------------------------------------------
+
+bool CBlur::ReadHeaderCube(FILE *fin)
+{
+    if( fin == NULL ) {
+        ES_ERROR("fin is NULL");
         return(false);
     }
 
-    // skip line
-    cret = fgets(buf, sizeof(buf), fin);
-    if( cret == NULL ) return(false);
+    SourceFormat = EBF_CUBE;
+    CubeHeader.clear();
 
-    for(int k=0; k<Nz; k++) {
-        int idxZ;
-        if( fscanf(fin,"%d ",&idxZ) != 1 ) {
-            ES_ERROR("unable to read idxZ item from input xplor file or stream");
-            if( FirstArray != NULL ) fftw_free(FirstArray);
-            if( SecondArray != NULL ) fftw_free(SecondArray);
-            FirstArray = NULL;
-            SecondArray = NULL;
+    char buf[1000];
+
+    // two comment lines
+    for(int i=0; i < 2; i++) {
+        if( fgets(buf, sizeof(buf), fin) == NULL ) return(false);
+        CubeHeader += buf;
+    }
+
+    // number of atoms and origin
+    int natoms = 0;
+    if( fgets(buf, sizeof(buf), fin) == NULL ) return(false);
+    if( sscanf(buf,"%d",&natoms) != 1 ) {
+        ES_ERROR("unable to read number of atoms from input cube file or stream");
+        return(false);
+    }
+    CubeHeader += buf;
+
+    // grid dimensions, negative values denote angstroms
+    int* dims[3] = { &Nx, &Ny, &Nz };
+    for(int i=0; i < 3; i++) {
+        if( fgets(buf, sizeof(buf), fin) == NULL ) return(false);
+        if( sscanf(buf,"%d",dims[i]) != 1 ) {
+            ES_ERROR("unable to read grid dimensions from input cube file or stream");
             return(false);
         }
-        for(int j=0; j<Ny; j++) {
-            for(int i=0; i<Nx; i++) {
-                if( fscanf(fin,"%lf ",&FirstArray[GIDX(i,j,k)][0]) != 1 ) {
-                    ES_ERROR("Unable to read data item from input xplor file or stream");
-                    if( FirstArray != NULL ) fftw_free(FirstArray);
-                    if( SecondArray != NULL ) fftw_free(SecondArray);
-                    return(false);
+        *dims[i] = abs(*dims[i]);
+        CubeHeader += buf;
+    }
+
+    // atoms and optional orbital indexes
+    int nlines = abs(natoms);
+    if( natoms < 0 ) nlines++;
+    for(int i=0; i < nlines; i++) {
+        if( fgets(buf, sizeof(buf), fin) == NULL ) {
+            ES_ERROR("unable to read atoms from input cube file or stream");
+            return(false);
+        }
+        CubeHeader += buf;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CBlur::ReadHeaderBinary(FILE *fin)
+{
+    if( fin == NULL ) {
+        ES_ERROR("fin is NULL");
+        return(false);
+    }
+
+    char    magic[8];
+    int32_t header[5];
+
+    if( (fread(magic,sizeof(magic),1,fin) != 1) || (memcmp(magic,BlurBinaryMagic,sizeof(magic)) != 0) ) {
+        ES_ERROR("input file or stream is not a binary map");
+        return(false);
+    }
+    if( fread(header,sizeof(header),1,fin) != 1 ) {
+        ES_ERROR("unable to read header of binary map");
+        return(false);
+    }
+    Nx = header[1];
+    Ny = header[2];
+    Nz = header[3];
+    if( (header[4] < 0) || (header[4] > 1024*1024) ) {
+        ES_ERROR("illegal header of binary map");
+        return(false);
+    }
+
+    std::vector<char> text(header[4]+1,'\0');
+    if( (header[4] > 0) && (fread(&text[0],header[4],1,fin) != 1) ) {
+        ES_ERROR("unable to read header of binary map");
+        return(false);
+    }
+
+    switch(header[0]) {
+        case EBF_XPLOR: {
+            SourceFormat = EBF_XPLOR;
+            int nx,ny,nz;
+            if( sscanf(&text[0], "%d%d%d%d%d%d%d%d%d%lf%lf%lf%lf%lf%lf",
+                       &nx, &startX, &stopX, &ny, &startY, &stopY, &nz, &startZ, &stopZ,
+                       &minX, &minY, &minZ, &maxX, &maxY, &maxZ) != 15 ) {
+                ES_ERROR("incorrect xplor header of binary map");
+                return(false);
+            }
+        }
+        break;
+        case EBF_CUBE:
+            SourceFormat = EBF_CUBE;
+            CubeHeader = &text[0];
+            break;
+        default:
+            ES_ERROR("unsupported header format of binary map");
+            return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CBlur::ReadValuesText(FILE *fin,bool xplor)
+{
+    // load rest of the file at once and parse it in memory
+    std::vector<char> buffer;
+    size_t len = 0;
+    size_t chunk = 4*1024*1024;
+    for(;;) {
+        buffer.resize(len + chunk);
+        size_t nread = fread(&buffer[len],1,chunk,fin);
+        len += nread;
+        if( nread < chunk ) break;
+    }
+    if( ferror(fin) ) {
+        ES_ERROR("unable to read data from input file or stream");
+        return(false);
+    }
+    buffer.resize(len);
+    buffer.push_back('\0');
+
+    char* p_str = &buffer[0];
+    char* p_end = NULL;
+
+    if( xplor ) {
+        for(int k=0; k<Nz; k++) {
+            strtol(p_str,&p_end,10);
+            if( p_end == p_str ) {
+                ES_ERROR("unable to read idxZ item from input xplor file or stream");
+                return(false);
+            }
+            p_str = p_end;
+            for(int j=0; j<Ny; j++) {
+                for(int i=0; i<Nx; i++) {
+                    Data[GIDX(i,j,k)] = strtod(p_str,&p_end);
+                    if( p_end == p_str ) {
+                        ES_ERROR("unable to read data item from input xplor file or stream");
+                        return(false);
+                    }
+                    p_str = p_end;
                 }
-                FirstArray[GIDX(i,j,k)][1]=0.0;
             }
         }
+    } else {
+        // cube data are in the same order as the map
+        for(int i=0; i < N; i++) {
+            Data[i] = strtod(p_str,&p_end);
+            if( p_end == p_str ) {
+                ES_ERROR("unable to read data item from input cube file or stream");
+                return(false);
+            }
+            p_str = p_end;
+        }
     }
 
     return(true);
 }
 
+//------------------------------------------------------------------------------
+
+bool CBlur::ReadValuesBinary(FILE *fin)
+{
+    if( fread(Data,sizeof(double),N,fin) != (size_t)N ) {
+        ES_ERROR("unable to read data from input binary map");
+        return(false);
+    }
+    return(true);
+}
+
 //---------------------------------------------------------------------------
 
 bool CBlur::WriteDataXPLOR(FILE *fout)
@@ -325,68 +627,155 @@ bool CBlur::WriteDataXPLOR(FILE *fout)
     fprintf(fout,"%12.3f%12.3f%12.3f%12.3f%12.3f%12.3f\n",minX,minY,minZ,maxX,maxY,maxZ);
     fprintf(fout,"ZYX\n");
 
+    // values are formatted in memory and written in large blocks
+    std::vector<char>   buffer(65536);
+    size_t              len = 0;
+
     for(int k=0; k<Nz; k++) {
-        fprintf(fout,"%8d\n",startZ-k);
+        if( BufferPrintf(buffer,len,fout,"%8d\n",startZ-k) == false ) return(false);
         int iColumnInd = 0;
 
         for(int j=0; j<Ny; j++) {
             for(int i=0; i<Nx; i++) {
-                fprintf(fout,"%12.5f",FirstArray[GIDX(i,j,k)][0]);
+                if( BufferPrintf(buffer,len,fout,"%12.5f",Data[GIDX(i,j,k)]) == false ) return(false);
                 iColumnInd++;
                 if(iColumnInd==6) {
                     iColumnInd=0;
-                    fprintf(fout,"\n");
+                    if( BufferPrintf(buffer,len,fout,"\n") == false ) return(false);
                 }
             }
         }
         if(iColumnInd!=0) {
             iColumnInd=0;
-            fprintf(fout,"\n");
+            if( BufferPrintf(buffer,len,fout,"\n") == false ) return(false);
         }
     }
+    if( fwrite(&buffer[0],1,len,fout) != len ) return(false);
 
-    return(true);
+    return(ferror(fout) == 0);
+}
+
+//---------------------------------------------------------------------------
+
+bool CBlur::WriteDataCube(FILE *fout)
+{
+    if( fout == NULL ) {
+        ES_ERROR("fout is NULL");
+        return(false);
+    }
+
+    if( fwrite(CubeHeader.c_str(),1,CubeHeader.size(),fout) != CubeHeader.size() ) return(false);
+
+    // values are formatted in memory and written in large blocks
+    std::vector<char>   buffer(65536);
+    size_t              len = 0;
+
+    for(int i=0; i<Nx; i++) {
+        for(int j=0; j<Ny; j++) {
+            bool nl = false;
+            for(int k=0; k<Nz; k++) {
+                if( BufferPrintf(buffer,len,fout,"% 12.5e",Data[GIDX(i,j,k)]) == false ) return(false);
+                nl = false;
+                if(k % 6 == 5){
+                    nl = true;
+                    if( BufferPrintf(buffer,len,fout,"\n") == false ) return(false);
+                }
+            }
+            if( nl == false ) {
+                if( BufferPrintf(buffer,len,fout,"\n") == false ) return(false);
+            }
+        }
+    }
+    if( fwrite(&buffer[0],1,len,fout) != len ) return(false);
+
+    return(ferror(fout) == 0);
+}
+
+//---------------------------------------------------------------------------
+
+bool CBlur::WriteDataBinary(FILE *fout)
+{
+    if( fout == NULL ) {
+        ES_ERROR("fout is NULL");
+        return(false);
+    }
+
+    // text header of the source format
+    std::string text;
+    if( SourceFormat == EBF_XPLOR ) {
+        char buf[1000];
+        snprintf(buf,sizeof(buf),"%d %d %d %d %d %d %d %d %d\n%.17g %.17g %.17g %.17g %.17g %.17g\n",
+                 Nx,startX,stopX,Ny,startY,stopY,Nz,startZ,stopZ,minX,minY,minZ,maxX,maxY,maxZ);
+        text = buf;
+    } else {
+        text = CubeHeader;
+    }
+
+    int32_t header[5];
+    header[0] = SourceFormat;
+    header[1] = Nx;
+    header[2] = Ny;
+    header[3] = Nz;
+    header[4] = text.size();
+
+    if( fwrite(BlurBinaryMagic,sizeof(BlurBinaryMagic),1,fout) != 1 ) return(false);
+    if( fwrite(header,sizeof(header),1,fout) != 1 ) return(false);
+    if( fwrite(text.c_str(),1,text.size(),fout) != text.size() ) return(false);
+    if( fwrite(Data,sizeof(double),N,fout) != (size_t)N ) return(false);
+
+    return(ferror(fout) == 0);
 }
 
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
 
+double CBlur::GetVirtualCoordinate(int m,int n)
+{
+    // m represents coordinate in original box, in which zero frequency point
+    // is spread over box corners, the returned coordinate is in virtual box,
+    // in which zero frequency point is situated in the box center
+    int i = m + n/2;
+    if( i >= n ) i -= n;
+    return( i - n/2.0 );
+}
+
+//---------------------------------------------------------------------------
+
+double CBlur::GetFrequency(int mi,int mj,int mk,bool mirror)
+{
+    if( mirror ) {
+        mi = (Nx - mi) % Nx;
+        mj = (Ny - mj) % Ny;
+        mk = (Nz - mk) % Nz;
+    }
+
+    double ix,iy,iz;
+    ix = GetVirtualCoordinate(mi,Nx);
+    iy = GetVirtualCoordinate(mj,Ny);
+    iz = GetVirtualCoordinate(mk,Nz);
+    return( sqrt(ix*ix+iy*iy+iz*iz) );
+}
+
+//---------------------------------------------------------------------------
+
 bool CBlur::LowPassFilter(fftw_complex* in)
 {
     if( Options.GetOptVerbose() ) {
         printf(" Low-pass filter with treshold at : %f\n",Options.GetArgFilterValue());
     }
 
+    // only the non-redundant half of the spectrum is filtered, thus the filter
+    // is symmetrized with its mirror image, it is the same as taking the real part
+    // of full complex backward transformation (it matters only for odd dimensions)
     for(int i=0; i<Nx; i++) {
         for(int j=0; j<Ny; j++) {
-            for(int k=0; k<Nz; k++) {
-                // i,j,k represent coordinates in virtual box,
-                // in which zero frequency point is situated in the box center
-                // we use this box to find such grid point that pass filter rules
-
-                double ix,iy,iz,r;
-                ix=i-Nx/2.0;
-                iy=j-Ny/2.0;
-                iz=k-Nz/2.0;
-                r=sqrt(ix*ix+iy*iy+iz*iz);
-
-                if( r > Options.GetArgFilterValue() ) {
-                    int mi,mj,mk;
-                    // mi,mj,mk represent coordinates in original box,
-                    // in which zero frequency point is spread over box corners
-
-                    // move by 1/2 of box
-                    mi = i - Nx/2;
-                    mj = j - Ny/2;
-                    mk = k - Nz/2;
-                    // image back to box
-                    if( mi < 0 ) mi += Nx;
-                    if( mj < 0 ) mj += Ny;
-                    if( mk < 0 ) mk += Nz;
-                    in[GIDX(mi,mj,mk)][0] = 0.0;
-                    in[GIDX(mi,mj,mk)][1] = 0.0;
-                }
+            for(int k=0; k<NzC; k++) {
+                double mult = 0.0;
+                if( GetFrequency(i,j,k,false) <= Options.GetArgFilterValue() ) mult += 0.5;
+                if( GetFrequency(i,j,k,true) <= Options.GetArgFilterValue() ) mult += 0.5;
+                in[HIDX(i,j,k)][0] *= mult;
+                in[HIDX(i,j,k)][1] *= mult;
             }
         }
     }
@@ -409,37 +798,14 @@ bool CBlur::GaussFilter(fftw_complex* in)
         printf(" Gauss filter with sigma : %f\n",Options.GetArgFilterValue());
     }
 
+    // the filter is symmetrized in the same way as in LowPassFilter
     for(int i=0; i<Nx; i++) {
         for(int j=0; j<Ny; j++) {
-            for(int k=0; k<Nz; k++) {
-                // i,j,k represent coordinates in virtual box,
-                // in which zero frequency point is situated in the box center
-                // we use this box to calculate distances between grid points and box center
-                // such distances are then used to calculate filter multiplicator
-
-                double ix,iy,iz,r;
-                ix=i-Nx/2.0;
-                iy=j-Ny/2.0;
-                iz=k-Nz/2.0;
-                r=sqrt(ix*ix+iy*iy+iz*iz);
-
-                double mult = Gauss(r,Options.GetArgFilterValue());
-
-                int mi,mj,mk;
-                // mi,mj,mk represent coordinates in original box,
-                // in which zero frequency point is spread over box corners
-
-                // move by 1/2 of box
-                mi = i - Nx/2;
-                mj = j - Ny/2;
-                mk = k - Nz/2;
-                // image back to box
-                if( mi < 0 ) mi += Nx;
-                if( mj < 0 ) mj += Ny;
-                if( mk < 0 ) mk += Nz;
-                in[GIDX(mi,mj,mk)][0] *= mult;
-                in[GIDX(mi,mj,mk)][1] *= mult;
-
+            for(int k=0; k<NzC; k++) {
+                double mult = 0.5*(Gauss(GetFrequency(i,j,k,false),Options.GetArgFilterValue())
+                                 + Gauss(GetFrequency(i,j,k,true),Options.GetArgFilterValue()));
+                in[HIDX(i,j,k)][0] *= mult;
+                in[HIDX(i,j,k)][1] *= mult;
             }
         }
     }
@@ -27,6 +27,16 @@
 #include <fftw3.h>
 #include <VerboseStr.hpp>
 #include <TerminalStr.hpp>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// format of map header
+enum EBlurFormat {
+    EBF_XPLOR   = 1,
+    EBF_CUBE    = 2
+};
 
 //------------------------------------------------------------------------------
 
@@ -57,21 +67,39 @@ private:
     /// print program header and specified options
     void PrintProgHeader(FILE* fout=NULL);
 
-    // input/output methods
-    bool ReadDataXPLOR(FILE* fin);
+    // input/output methods, headers are read before FFT planning
+    bool ReadHeaderXPLOR(FILE* fin);
+    bool ReadHeaderCube(FILE* fin);
+    bool ReadHeaderBinary(FILE* fin);
+    bool ReadValuesText(FILE* fin,bool xplor);
+    bool ReadValuesBinary(FILE* fin);
     bool WriteDataXPLOR(FILE* fout);
+    bool WriteDataCube(FILE* fout);
+    bool WriteDataBinary(FILE* fout);
+
+    // fft
+    bool AllocateArrays(void);
+    bool PlanTransforms(void);
 
     // filters
     bool    LowPassFilter(fftw_complex* in);
     double  Gauss(double dx, double o);
     bool    GaussFilter(fftw_complex* in);
+    double  GetFrequency(int mi,int mj,int mk,bool mirror);
+    double  GetVirtualCoordinate(int m,int n);
 
+    EBlurFormat         SourceFormat;       // format of map header
+    std::string         CubeHeader;         // verbatim header of cube file
     int                 Nx,Ny,Nz,N;
+    int                 NzC;                // last dimension of half spectrum
     int                 startX,stopX,startY,stopY,startZ,stopZ;
     double              minX,maxX,minY,maxY,minZ,maxZ,rX,rY,rZ;
 
-    fftw_complex*       FirstArray;
-    fftw_complex*       SecondArray;
+    double*             Data;               // real space map
+    fftw_complex*       Spectrum;           // non-redundant half of spectrum
+    fftw_plan           ForwardPlan;
+    fftw_plan           BackwardPlan;
+    bool                ThreadsInitialized;
 };
 
 //------------------------------------------------------------------------------
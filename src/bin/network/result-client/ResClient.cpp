@@ -24,6 +24,7 @@
 #include "ResClient.hpp"
 #include <XMLElement.hpp>
 #include <XMLBinData.hpp>
+#include <string>
 
 //------------------------------------------------------------------------------
 
@@ -232,7 +233,21 @@ bool CResClient::WriteData(void)
         ES_TRACE_ERROR("unable to get data key");
         return(false);
     }
-    if( CResultClient::WriteData(id,data_name) == false ){
+    // several data files can be separated by colons
+    std::vector<CSmallString> data_names;
+    std::string names(data_name);
+    size_t start = 0;
+    for(;;) {
+        size_t end = names.find(':',start);
+        std::string name = names.substr(start,end == std::string::npos ? std::string::npos : end - start);
+        if( name.size() > 0 ) data_names.push_back(name.c_str());
+        if( end == std::string::npos ) break;
+        start = end + 1;
+    }
+    // optional global frame index of the first record
+    int frame = -1;
+    ActionRequest.GetParameterKeyValue("frame",frame);
+    if( CResultClient::WriteData(id,data_names,frame) == false ){
         CSmallString error;
         error << "unable to write data to client " << id;
         ES_TRACE_ERROR(error);
@@ -68,7 +68,8 @@ public:
                 "which can be one of the following:\n"
                 "   <green>register</green>   = register client on server side (register?template=file.tmp)\n"
                 "   <green>unregister</green> = unregister client on server side (unregister?id=client_id)\n"
-                "   <green>write</green>      = write data to server (write?id=client_id,data=file.dat)\n"
+                "   <green>write</green>      = write data to server (write?id=client_id,data=file.dat[:file2.dat:...][,frame=index])\n"
+                "                several data files are sent in one request, their frames are index, index+1, ...\n"
                 "   <green>getstat</green>    = get data statistics (getstat?file=file.stat)\n"
                 "   <green>flush</green>      = flush accumulated statistics to output server file\n"
                 "   <green>info</green>       = prints information about registered clients\n"
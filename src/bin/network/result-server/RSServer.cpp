@@ -184,6 +184,7 @@ bool CRSServer::Run(void)
     printf("\n");
     printf("Number of processed transactions: %d\n",GetNumberOfTransactions());
     printf("Number of illegal transactions  : %d\n",GetNumberOfIllegalTransactions());
+    printf("Number of duplicate frame data  : %d\n",ResultFile.GetNumberOfDuplicates());
 
     RegClients.PrintInfo();
 
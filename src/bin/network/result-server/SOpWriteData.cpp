@@ -56,14 +56,8 @@ bool CRSProcessor::WriteData(void)
     }
 
     // write data -----------------------------------
-    CXMLElement* p_cele = CommandElement->GetFirstChildElement("DATA");
-    if( p_cele == NULL ) {
-        ES_ERROR("unable to open DATA element");
-        return(false);
-    }
-
-    // write results
-    if( RSServer.ResultFile.WriteData(p_cele,client_id) == false ) {
+    // the command can contain several DATA records
+    if( RSServer.ResultFile.WriteRecords(CommandElement,client_id) == false ) {
         ES_ERROR("unable to write results");
         return(false);
     }
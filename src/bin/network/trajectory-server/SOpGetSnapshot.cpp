@@ -68,13 +68,19 @@ bool CTSProcessor::GetSnapshot(void)
         return(false);
     }
 
-    bool result = true;
+    ESnapshotEncoding   encoding;
+    double              precision;
+    GetRequestedEncoding(encoding,precision);
+
+    // optional atom subset
+    CAmberMaskAtomsPtr p_mask = TSServer.GetClientMask(client_id);
 
-    // lock access to trajectory
-    TSServer.TrajectoryMutex.Lock();
+    bool result = true;
 
-    if( TSServer.ReadSnapshot() ) {
-        TSServer.SnapshotIndex++;
+    // pop decoded snapshot
+    std::vector<int> slots;
+    if( TSServer.Reader.PopSnapshots(1,slots) > 0 ) {
+        int slot = slots[0];
 
         // write data
         CXMLElement* p_sele = ResultElement->CreateChildElement("SNAPSHOT");
@@ -85,7 +91,7 @@ bool CTSProcessor::GetSnapshot(void)
 
         if( result == true ) {
             // save data
-            TSServer.Snapshot.SaveSnapshot(p_sele);
+            result = CSnapshotCodec::EncodeSnapshot(p_sele,TSServer.Reader.GetSnapshot(slot),encoding,precision,p_mask.get());
         }
 
         if( result == true ) {
@@ -93,9 +99,16 @@ bool CTSProcessor::GetSnapshot(void)
         }
 
         if( result == true ) {
-            ResultElement->SetAttribute("index",TSServer.SnapshotIndex);
+            ResultElement->SetAttribute("index",TSServer.Reader.GetSnapshotIndex(slot));
         }
 
+        // the snapshot is not delivered - hand it out again by GetSnapshots
+        if( (result == false) && TSServer.Leases.IsEnabled() ) {
+            TSServer.Leases.Requeue(TSServer.Reader.GetSnapshotIndex(slot));
+        }
+
+        TSServer.Reader.ReleaseSnapshot(slot);
+
         // register operation
         if( result != false ) p_client->RegisterOperation();
 
@@ -103,8 +116,6 @@ bool CTSProcessor::GetSnapshot(void)
         ResultElement->SetAttribute("status","eof");
     }
 
-    TSServer.TrajectoryMutex.Unlock();
-
     return(result);
 }
 
@@ -0,0 +1,186 @@
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <ErrorSystem.hpp>
+#include <RegClient.hpp>
+#include "TSProcessor.hpp"
+#include "TSServer.hpp"
+#include <XMLElement.hpp>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTSProcessor::WriteSnapshot(CAmberRestart* p_snap,int index,
+                                 ESnapshotEncoding encoding,double precision,CAmberMaskAtoms* p_mask)
+{
+    CXMLElement* p_sele = ResultElement->CreateChildElement("SNAPSHOT");
+    if( p_sele == NULL ) {
+        ES_ERROR("unable to create SNAPSHOT element");
+        return(false);
+    }
+    p_sele->SetAttribute("index",index);
+    return( CSnapshotCodec::EncodeSnapshot(p_sele,p_snap,encoding,precision,p_mask) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSProcessor::GetSnapshots(void)
+{
+    int client_id = -1;
+    int nsnapshots = 0;
+
+    // get client ID --------------------------------
+    if( CommandElement->GetAttribute("client_id",client_id) == false ) {
+        ES_ERROR("unable to get client_id");
+        return(false);
+    }
+
+    if( CommandElement->GetAttribute("count",nsnapshots) == false ) {
+        ES_ERROR("unable to get count");
+        return(false);
+    }
+
+    if( nsnapshots <= 0 ) {
+        CSmallString error;
+        error << "illegal number of requested snapshots (" << nsnapshots << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    CRegClient* p_client = TSServer.RegClients.FindClient(client_id);
+
+    if( p_client == NULL ) {
+        CSmallString error;
+        error << "unable to find client with id " << client_id;
+        ES_ERROR(error);
+        return(false);
+    }
+
+    if( p_client->GetClientStatus() != ERCS_REGISTERED ) {
+        CSmallString error;
+        error << "client " << client_id << " is not in active state";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    if( nsnapshots > TSServer.MaxSnapshotsPerRequest ) {
+        nsnapshots = TSServer.MaxSnapshotsPerRequest;
+    }
+
+    ESnapshotEncoding   encoding;
+    double              precision;
+    GetRequestedEncoding(encoding,precision);
+
+    // optional atom subset
+    CAmberMaskAtomsPtr p_mask = TSServer.GetClientMask(client_id);
+
+    // leased snapshots have to be acknowledged by the client
+    bool lease = false;
+    CommandElement->GetAttribute("lease",lease);
+
+    if( (lease == true) && (TSServer.Leases.IsEnabled() == false) ) {
+        ES_ERROR("leasing is disabled by zero lease timeout");
+        return(false);
+    }
+
+    // acknowledgements can be piggybacked on the request
+    if( ProcessAcknowledgements(client_id) == false ) {
+        return(false);
+    }
+
+    bool                result = true;
+    int                 count = 0;
+    std::vector<int>    leased;     // snapshots leased by this request
+
+    // snapshots of timed out or gone clients go first
+    if( lease == true ) {
+        CAmberRestart   snapshot;
+        bool            created = false;
+        int             index;
+        while( (result == true) && (count < nsnapshots) && TSServer.Leases.PopRequeued(index) ) {
+            if( created == false ) {
+                snapshot.AssignTopology(&TSServer.Topology);
+                snapshot.Create();
+                created = true;
+            }
+            // lease first so the snapshot is not lost if the transfer fails
+            TSServer.Leases.AddLease(index,client_id);
+            leased.push_back(index);
+            if( TSServer.Reader.ReadSnapshotAt(index,&snapshot) == false ) {
+                result = false;
+                break;
+            }
+            result = WriteSnapshot(&snapshot,index,encoding,precision,p_mask.get());
+            count++;
+        }
+    }
+
+    // pop decoded snapshots, the ring holds at most --prefetch snapshots
+    // thus larger requests are served in several rounds
+    std::vector<int> slots;
+    while( (result == true) && (count < nsnapshots) ) {
+        int nslots = TSServer.Reader.PopSnapshots(nsnapshots-count,slots);
+        if( nslots == 0 ) break;    // end of trajectory pool
+
+        for(int i=0; i < nslots; i++) {
+            int index = TSServer.Reader.GetSnapshotIndex(slots[i]);
+            // every popped snapshot is leased, even if an earlier one failed
+            if( lease == true ) {
+                TSServer.Leases.AddLease(index,client_id);
+                leased.push_back(index);
+            }
+            if( result == true ) {
+                result = WriteSnapshot(TSServer.Reader.GetSnapshot(slots[i]),index,encoding,precision,p_mask.get());
+                count++;
+            }
+            TSServer.Reader.ReleaseSnapshot(slots[i]);
+        }
+    }
+
+    if( result == false ) {
+        // the reply is not delivered - hand out the snapshots again
+        for(size_t i=0; i < leased.size(); i++) {
+            TSServer.Leases.Requeue(leased[i]);
+        }
+        return(false);
+    }
+
+    if( count > 0 ) {
+        ResultElement->SetAttribute("status","ok");
+        ResultElement->SetAttribute("count",count);
+        // register operation
+        p_client->RegisterOperation();
+    } else if( (lease == true) && TSServer.Leases.HasPendingLeases() ) {
+        // other clients still process snapshots that can be requeued
+        ResultElement->SetAttribute("status","wait");
+        ResultElement->SetAttribute("retry",1);
+        p_client->RegisterOperation();
+    } else {
+        ResultElement->SetAttribute("status","eof");
+    }
+
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
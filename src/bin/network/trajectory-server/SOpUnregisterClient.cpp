@@ -0,0 +1,59 @@
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <ErrorSystem.hpp>
+#include <RegClient.hpp>
+#include "TSProcessor.hpp"
+#include "TSServer.hpp"
+#include <XMLElement.hpp>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTSProcessor::UnregisterClient(void)
+{
+    int client_id = -1;
+
+    // get client ID --------------------------------
+    if( CommandElement->GetAttribute("client_id",client_id) == false ) {
+        ES_ERROR("unable to get client_id");
+        return(false);
+    }
+
+    // drop client projection and hand out its unprocessed snapshots again
+    TSServer.RemoveClientMask(client_id);
+    TSServer.Leases.ReleaseClient(client_id);
+
+    // and unregister it from the list
+    if( TSServer.RegClients.UnregisterClient(client_id) == false ) {
+        CSmallString error;
+        error << "unable to unregister client with id " << client_id;
+        ES_ERROR(error);
+        return(false);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,201 @@
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <stdio.h>
+#include <ErrorSystem.hpp>
+#include "TSLeaseList.hpp"
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTSLeaseList::CTSLeaseList(void)
+{
+    Timeout = 300;
+    NumOfRequeued = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void CTSLeaseList::SetTimeout(int timeout)
+{
+    Timeout = timeout;
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSLeaseList::IsEnabled(void)
+{
+    // leases of crashed clients would never expire without timeout
+    return(Timeout > 0);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CTSLeaseList::AddLease(int index,int client_id)
+{
+    LeaseMutex.Lock();
+
+    std::map<int,CLease>::iterator it = Leases.find(index);
+    if( it != Leases.end() ) RemoveLease(it);
+
+    CLease lease;
+    lease.ClientID = client_id;
+    lease.Expiry = Expiries.insert(std::make_pair(time(NULL),index));
+    Leases[index] = lease;
+
+    LeaseMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CTSLeaseList::Acknowledge(int client_id,int first,int last)
+{
+    LeaseMutex.Lock();
+
+    // the snapshot is processed - no matter which client holds the lease now
+    std::map<int,CLease>::iterator it = Leases.lower_bound(first);
+    while( (it != Leases.end()) && (it->first <= last) ) {
+        if( it->second.ClientID != client_id ) {
+            CSmallString warning;
+            warning << "snapshot " << it->first << " acknowledged by client " << client_id
+                    << " but leased to client " << it->second.ClientID;
+            ES_WARNING(warning);
+        }
+        RemoveLease(it++);
+    }
+
+    std::set<int>::iterator rit = Requeued.lower_bound(first);
+    while( (rit != Requeued.end()) && (*rit <= last) ) {
+        Requeued.erase(rit++);
+    }
+
+    LeaseMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CTSLeaseList::ReleaseClient(int client_id)
+{
+    LeaseMutex.Lock();
+
+    // called only when the client leaves the server, it is not on the hot path
+    std::map<int,CLease>::iterator it = Leases.begin();
+    while( it != Leases.end() ) {
+        if( it->second.ClientID == client_id ) {
+            Requeued.insert(it->first);
+            NumOfRequeued++;
+            RemoveLease(it++);
+        } else {
+            it++;
+        }
+    }
+
+    LeaseMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CTSLeaseList::Requeue(int index)
+{
+    LeaseMutex.Lock();
+
+    std::map<int,CLease>::iterator it = Leases.find(index);
+    if( it != Leases.end() ) RemoveLease(it);
+
+    Requeued.insert(index);
+    NumOfRequeued++;
+
+    LeaseMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSLeaseList::PopRequeued(int& index)
+{
+    LeaseMutex.Lock();
+
+    RequeueExpired();
+
+    if( Requeued.empty() ) {
+        LeaseMutex.Unlock();
+        return(false);
+    }
+
+    index = *Requeued.begin();
+    Requeued.erase(Requeued.begin());
+
+    LeaseMutex.Unlock();
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSLeaseList::HasPendingLeases(void)
+{
+    LeaseMutex.Lock();
+    bool result = (Leases.empty() == false) || (Requeued.empty() == false);
+    LeaseMutex.Unlock();
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+int CTSLeaseList::GetNumberOfRequeued(void)
+{
+    LeaseMutex.Lock();
+    int result = NumOfRequeued;
+    LeaseMutex.Unlock();
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CTSLeaseList::RemoveLease(std::map<int,CLease>::iterator it)
+{
+    Expiries.erase(it->second.Expiry);
+    Leases.erase(it);
+}
+
+//------------------------------------------------------------------------------
+
+void CTSLeaseList::RequeueExpired(void)
+{
+    if( Timeout <= 0 ) return;
+
+    // leases are ordered by time, only the expired ones at the front are visited
+    time_t now = time(NULL);
+
+    while( (Expiries.empty() == false) && (now - Expiries.begin()->first > Timeout) ) {
+        int index = Expiries.begin()->second;
+        Requeued.insert(index);
+        NumOfRequeued++;
+        RemoveLease(Leases.find(index));
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,95 @@
+#ifndef TSLeaseListH
+#define TSLeaseListH
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <SimpleMutex.hpp>
+#include <time.h>
+#include <map>
+#include <set>
+
+//------------------------------------------------------------------------------
+
+/// snapshots handed out to clients that were not acknowledged yet
+/// leases of clients that time out or leave the server are requeued
+/// and handed out again to other clients
+
+class CTSLeaseList {
+public:
+    // constructor
+    CTSLeaseList(void);
+
+// setup methods --------------------------------------------------------------
+    /// set lease timeout in seconds, zero disables leasing
+    void SetTimeout(int timeout);
+
+    /// is leasing enabled
+    bool IsEnabled(void);
+
+// lease management -----------------------------------------------------------
+    /// lease snapshot to the client
+    void AddLease(int index,int client_id);
+
+    /// acknowledge processed snapshots first..last (inclusive)
+    void Acknowledge(int client_id,int first,int last);
+
+    /// requeue all leases of the client leaving the server
+    void ReleaseClient(int client_id);
+
+    /// hand out snapshot again, e.g. it was not delivered to the client
+    void Requeue(int index);
+
+    /// get lowest snapshot index that must be handed out again
+    bool PopRequeued(int& index);
+
+    /// is there any unacknowledged snapshot
+    bool HasPendingLeases(void);
+
+    /// get number of requeued snapshots
+    int GetNumberOfRequeued(void);
+
+// section of private data ----------------------------------------------------
+private:
+    typedef std::multimap<time_t,int>   CExpiryMap;
+
+    class CLease {
+    public:
+        int                     ClientID;
+        CExpiryMap::iterator    Expiry;
+    };
+
+    CSimpleMutex            LeaseMutex;
+    int                     Timeout;
+    std::map<int,CLease>    Leases;     // index -> lease
+    CExpiryMap              Expiries;   // lease time -> index, the oldest lease first
+    std::set<int>           Requeued;   // indexes to be handed out again
+    int                     NumOfRequeued;
+
+    /// remove lease - not protected by mutex
+    void RemoveLease(std::map<int,CLease>::iterator it);
+
+    /// move expired leases to Requeued - not protected by mutex
+    void RequeueExpired(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
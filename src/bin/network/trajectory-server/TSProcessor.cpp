@@ -21,7 +21,10 @@
 #include <stdio.h>
 #include <ErrorSystem.hpp>
 #include <CATsOperation.hpp>
+#include <ExtraOperation.hpp>
 #include "TSProcessor.hpp"
+#include "TSServer.hpp"
+#include <XMLElement.hpp>
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -42,6 +45,18 @@ bool CTSProcessor::ProcessCommand(void)
     if( Operation == Operation_GetSnapshot ) {
         return( GetSnapshot());
     }
+    if( Operation == Operation_GetSnapshots ) {
+        return( GetSnapshots());
+    }
+    if( Operation == Operation_SetSnapshotMask ) {
+        return( SetSnapshotMask());
+    }
+    if( Operation == Operation_AckSnapshots ) {
+        return( AckSnapshots());
+    }
+    if( Operation == Operation_UnregisterClient ) {
+        return( UnregisterClient());
+    }
 
     CSmallString error;
     error << "operation " << Operation.GetStringForm() << " is not implemented";
@@ -50,6 +65,45 @@ bool CTSProcessor::ProcessCommand(void)
     return(false);
 }
 
+//------------------------------------------------------------------------------
+
+void CTSProcessor::GetRequestedEncoding(ESnapshotEncoding& encoding,double& precision)
+{
+    // optional, legacy clients do not negotiate encoding
+    CSmallString sencoding("xml");
+    CommandElement->GetAttribute("encoding",sencoding);
+    encoding = CSnapshotCodec::DecodeEncoding(sencoding);
+
+    precision = 1000.0;
+    CommandElement->GetAttribute("precision",precision);
+    if( precision <= 0.0 ) {
+        ES_WARNING("illegal precision, fallback to xml encoding");
+        encoding = ESE_XML;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSProcessor::ProcessAcknowledgements(int client_id)
+{
+    // ACK elements hold ranges of processed snapshots
+    CXMLElement* p_aele = CommandElement->GetFirstChildElement("ACK");
+    while( p_aele != NULL ) {
+        int first = 0;
+        int last = 0;
+        bool result = true;
+        result &= p_aele->GetAttribute("first",first);
+        result &= p_aele->GetAttribute("last",last);
+        if( result == false ) {
+            ES_ERROR("unable to get first or last attribute of ACK");
+            return(false);
+        }
+        TSServer.Leases.Acknowledge(client_id,first,last);
+        p_aele = p_aele->GetNextSiblingElement("ACK");
+    }
+    return(true);
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -21,6 +21,12 @@
 // =============================================================================
 
 #include <CmdProcessor.hpp>
+#include <SnapshotCodec.hpp>
+
+//------------------------------------------------------------------------------
+
+class CAmberRestart;
+class CAmberMaskAtoms;
 
 //------------------------------------------------------------------------------
 
@@ -33,8 +39,22 @@ public:
 private:
     virtual bool ProcessCommand(void);
 
+    /// get encoding of SNAPSHOT payload requested by client
+    void GetRequestedEncoding(ESnapshotEncoding& encoding,double& precision);
+
+    /// release leases of snapshots acknowledged by client
+    bool ProcessAcknowledgements(int client_id);
+
+    /// append SNAPSHOT element to the result
+    bool WriteSnapshot(CAmberRestart* p_snap,int index,
+                       ESnapshotEncoding encoding,double precision,CAmberMaskAtoms* p_mask);
+
 // implemented operations -----------------------------------------------------
     bool GetSnapshot(void);
+    bool GetSnapshots(void);
+    bool SetSnapshotMask(void);
+    bool AckSnapshots(void);
+    bool UnregisterClient(void);
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,263 @@
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <ErrorSystem.hpp>
+#include "TSReader.hpp"
+#include "TSServer.hpp"
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTSReader::CTSReader(void)
+{
+    CurrentItem = -1;
+    SnapshotIndex = 0;
+    EndOfPool = false;
+    Terminated = false;
+    RecoveryItem = -1;
+    RecoveryIndex = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTSReader::StartReader(int nslots)
+{
+    if( nslots <= 0 ) {
+        ES_ERROR("number of ring slots must be greater than zero");
+        return(false);
+    }
+
+    Trajectory.AssignTopology(&TSServer.Topology);
+    RecoveryTrajectory.AssignTopology(&TSServer.Topology);
+
+    Slots.resize(nslots);
+    SlotIndexes.resize(nslots);
+    for(int i=0; i < nslots; i++) {
+        Slots[i].AssignTopology(&TSServer.Topology);
+        Slots[i].Create();
+        SlotIndexes[i] = 0;
+        FreeSlots.push(i);
+    }
+
+    CurrentItem = -1;
+    SnapshotIndex = 0;
+    EndOfPool = false;
+    Terminated = false;
+
+    return( StartThread() );
+}
+
+//------------------------------------------------------------------------------
+
+void CTSReader::StopReader(void)
+{
+    RingMutex.Lock();
+    Terminated = true;
+    FreeCond.BroadcastSignal();
+    ReadyCond.BroadcastSignal();
+    RingMutex.Unlock();
+
+    WaitForThread();
+
+    RecoveryMutex.Lock();
+    RecoveryTrajectory.CloseTrajectoryFile();
+    RecoveryItem = -1;
+    RecoveryIndex = 0;
+    RecoveryMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CTSReader::PopSnapshots(int nsnapshots,std::vector<int>& slots)
+{
+    slots.clear();
+
+    // the request cannot be larger than the ring
+    if( nsnapshots > (int)Slots.size() ) nsnapshots = Slots.size();
+    if( nsnapshots <= 0 ) return(0);
+
+    RingMutex.Lock();
+
+    while( ((int)ReadySlots.size() < nsnapshots) && (EndOfPool == false) && (Terminated == false) ) {
+        ReadyCond.WaitForSignal(RingMutex);
+    }
+
+    while( ((int)slots.size() < nsnapshots) && (ReadySlots.empty() == false) ) {
+        slots.push_back(ReadySlots.front());
+        ReadySlots.pop();
+    }
+
+    RingMutex.Unlock();
+
+    return(slots.size());
+}
+
+//------------------------------------------------------------------------------
+
+CAmberRestart* CTSReader::GetSnapshot(int slot)
+{
+    return(&Slots[slot]);
+}
+
+//------------------------------------------------------------------------------
+
+int CTSReader::GetSnapshotIndex(int slot)
+{
+    return(SlotIndexes[slot]);
+}
+
+//------------------------------------------------------------------------------
+
+void CTSReader::ReleaseSnapshot(int slot)
+{
+    RingMutex.Lock();
+    FreeSlots.push(slot);
+    FreeCond.Signal();
+    RingMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTSReader::ReadSnapshotAt(int index,CAmberRestart* p_snap)
+{
+    if( index <= 0 ) {
+        ES_ERROR("illegal snapshot index");
+        return(false);
+    }
+
+    RecoveryMutex.Lock();
+
+    // trajectories are sequential streams - rewind if the snapshot is behind us
+    if( index <= RecoveryIndex ) {
+        RecoveryTrajectory.CloseTrajectoryFile();
+        RecoveryItem = -1;
+        RecoveryIndex = 0;
+    }
+
+    bool result = true;
+    while( (result == true) && (RecoveryIndex < index) ) {
+        result = ReadSnapshot(RecoveryTrajectory,RecoveryItem,p_snap);
+        if( result == true ) RecoveryIndex++;
+    }
+
+    if( result == false ) {
+        CSmallString error;
+        error << "unable to read snapshot " << index << " again";
+        ES_ERROR(error);
+        RecoveryTrajectory.CloseTrajectoryFile();
+        RecoveryItem = -1;
+        RecoveryIndex = 0;
+    }
+
+    RecoveryMutex.Unlock();
+
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CTSReader::ExecuteThread(void)
+{
+    for(;;) {
+        // get free slot
+        RingMutex.Lock();
+        while( FreeSlots.empty() && (Terminated == false) ) {
+            FreeCond.WaitForSignal(RingMutex);
+        }
+        if( Terminated == true ) {
+            RingMutex.Unlock();
+            break;
+        }
+        int slot = FreeSlots.front();
+        FreeSlots.pop();
+        RingMutex.Unlock();
+
+        // decode snapshot outside of the lock, the slot is owned by the reader
+        bool result = ReadSnapshot(Trajectory,CurrentItem,&Slots[slot]);
+
+        // publish snapshot
+        RingMutex.Lock();
+        if( result == true ) {
+            SnapshotIndex++;
+            SlotIndexes[slot] = SnapshotIndex;
+            ReadySlots.push(slot);
+        } else {
+            FreeSlots.push(slot);
+            EndOfPool = true;
+        }
+        ReadyCond.BroadcastSignal();
+        RingMutex.Unlock();
+
+        if( result == false ) break;
+    }
+
+    Trajectory.CloseTrajectoryFile();
+}
+
+//------------------------------------------------------------------------------
+
+bool CTSReader::ReadSnapshot(CAmberTrajectory& traj,int& item,CAmberRestart* p_snap)
+{
+    // is pool opened
+    if( item < 0 ){
+        item = 0;
+        if( item >= (int)TSServer.TrajectoryPool.size() ){
+            // no items in the pool
+            return(false);
+        }
+        if( traj.OpenTrajectoryFile(TSServer.TrajectoryPool[item].Name,
+                TSServer.DecodeFormat(TSServer.TrajectoryPool[item].Format), AMBER_TRAJ_CXYZB,  AMBER_TRAJ_READ) == false ){
+            return(false);
+        }
+    }
+
+    bool result = traj.ReadSnapshot(p_snap);
+    if( result == false ) {
+        traj.CloseTrajectoryFile();
+        item++;
+        if( item >= (int)TSServer.TrajectoryPool.size() ){
+            // no items in the pool
+            return(false);
+        }
+        if( traj.OpenTrajectoryFile(TSServer.TrajectoryPool[item].Name,
+                                      TSServer.DecodeFormat(TSServer.TrajectoryPool[item].Format),
+                                      AMBER_TRAJ_CXYZB,
+                                      AMBER_TRAJ_READ) == false ){
+            return(false);
+        }
+        // try to read again
+        result = traj.ReadSnapshot(p_snap);
+    }
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
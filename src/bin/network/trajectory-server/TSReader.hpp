@@ -0,0 +1,102 @@
+#ifndef TSReaderH
+#define TSReaderH
+// =============================================================================
+// PMFLib - Library Supporting Potential of Mean Force Calculations
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleThread.hpp>
+#include <SimpleMutex.hpp>
+#include <SimpleCond.hpp>
+#include <AmberRestart.hpp>
+#include <AmberTrajectory.hpp>
+#include <vector>
+#include <queue>
+
+//------------------------------------------------------------------------------
+
+/// read-ahead of trajectory pool snapshots into a bounded ring of buffers
+/// snapshots are decoded by the reader thread, request handlers only pop ready
+/// buffers and return them back once the data are serialized
+
+class CTSReader : public CSimpleThread {
+public:
+    // constructor
+    CTSReader(void);
+
+// main methods ---------------------------------------------------------------
+    /// allocate ring buffers and start reader thread
+    bool StartReader(int nslots);
+
+    /// terminate reader thread
+    void StopReader(void);
+
+// consumer methods -----------------------------------------------------------
+    /// pop up to nsnapshots consecutive snapshots, wait until they are decoded
+    /// at most the ring size (--prefetch) is popped at once, release the slots
+    /// and call it again for larger requests
+    /// return number of popped snapshots, zero means the end of trajectory pool
+    int PopSnapshots(int nsnapshots,std::vector<int>& slots);
+
+    /// get snapshot stored in the slot
+    CAmberRestart* GetSnapshot(int slot);
+
+    /// get global index of snapshot stored in the slot
+    int GetSnapshotIndex(int slot);
+
+    /// return slot back to the ring
+    void ReleaseSnapshot(int slot);
+
+// recovery methods -----------------------------------------------------------
+    /// read again snapshot with given global index (requeued leases)
+    /// it uses own trajectory stream thus the ring is not affected
+    bool ReadSnapshotAt(int index,CAmberRestart* p_snap);
+
+// section of private data ----------------------------------------------------
+private:
+    CAmberTrajectory            Trajectory;     // input trajectory
+    int                         CurrentItem;    // current trajectory pool item
+    int                         SnapshotIndex;  // index of last decoded snapshot
+
+    // ring buffer ------------------------------
+    std::vector<CAmberRestart>  Slots;
+    std::vector<int>            SlotIndexes;
+    std::queue<int>             FreeSlots;
+    std::queue<int>             ReadySlots;
+    CSimpleMutex                RingMutex;
+    CSimpleCond                 FreeCond;
+    CSimpleCond                 ReadyCond;
+    bool                        EndOfPool;
+    bool                        Terminated;
+
+    // recovery stream --------------------------
+    CSimpleMutex                RecoveryMutex;
+    CAmberTrajectory            RecoveryTrajectory;
+    int                         RecoveryItem;
+    int                         RecoveryIndex;  // index of last snapshot read by recovery stream
+
+    /// reader thread main loop
+    virtual void ExecuteThread(void);
+
+    /// read next snapshot from the trajectory pool
+    bool ReadSnapshot(CAmberTrajectory& traj,int& item,CAmberRestart* p_snap);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -29,9 +29,11 @@
 #include "TSServer.hpp"
 #include "TSProcessor.hpp"
 #include "TSFactory.hpp"
+#include <ExtraOperation.hpp>
 #include <iomanip>
 #include <FileSystem.hpp>
 #include <FileName.hpp>
+#include <TrajectoryIndex.hpp>
 #include <boost/format.hpp>
 
 using namespace std;
@@ -56,8 +58,7 @@ CTSServer::CTrajPoolItem::CTrajPoolItem(void)
 
 CTSServer::CTSServer(void)
 {
-    SnapshotIndex = 0;
-    CurrentItem = -1;
+    MaxSnapshotsPerRequest = 1000;
     SetProtocolName("trj");
 }
 
@@ -214,25 +215,33 @@ bool CTSServer::Run(void)
     vout << "=== Topology info" << endl;
     Topology.PrintInfo(true);
 
-    Snapshot.AssignTopology(&Topology);
-    Snapshot.Create();
-    Trajectory.AssignTopology(&Topology);
-    Trajectory.AssignRestart(&Snapshot);
-
     if( Options.GetOptNoTrajInfo() == false ) {
         if( PrintTrajectoryInfo() == false ) return(false);
     }
 
+    Leases.SetTimeout(Options.GetOptLeaseTimeout());
+
+    // start read-ahead of snapshots
+    if( Reader.StartReader(Options.GetOptPrefetch()) == false ) {
+        ES_ERROR("unable to start trajectory reader");
+        return(false);
+    }
+
     vout << "" << endl;
     vout << ":::::::::::::::::::::::::::::::: Trajectory Server :::::::::::::::::::::::::::::" << endl;
 
     // register operations
     CmdProcessorList.RegisterProcessor(Operation_GetSnapshot,&TSFactory);
+    CmdProcessorList.RegisterProcessor(Operation_GetSnapshots,&TSFactory);
+    CmdProcessorList.RegisterProcessor(Operation_SetSnapshotMask,&TSFactory);
+    CmdProcessorList.RegisterProcessor(Operation_AckSnapshots,&TSFactory);
+    CmdProcessorList.RegisterProcessor(Operation_UnregisterClient,&TSFactory);
 
     // set SIGINT hadler to cleanly shutdown server ----------
     signal(SIGINT,CtrlCSignalHandler);
 
     if( StartServer() == false ) {
+        Reader.StopReader();
         return(false);
     }
 
@@ -241,14 +250,16 @@ bool CTSServer::Run(void)
     vout << endl;
     vout << "Number of processed transactions: " << GetNumberOfTransactions() << endl;
     vout << "Number of illegal transactions  : " << GetNumberOfIllegalTransactions() << endl;
+    vout << "Number of requeued snapshots    : " << Leases.GetNumberOfRequeued() << endl;
 
     RegClients.PrintInfo();
 
     vout << "" << endl;
     vout << "::::::::::::::::::::::::::::::::::: Finalization :::::::::::::::::::::::::::::::" << endl;
     vout << "" << endl;
-    vout << "Closing trajectory ..." << endl;
-    Trajectory.CloseTrajectoryFile();
+    vout << "Stopping trajectory reader ..." << endl;
+    Reader.StopReader();
+    DestroyClientMasks();
 
     return(true);
 }
@@ -284,14 +295,16 @@ bool CTSServer::AddTrajFile(const CSmallString& name,const CSmallString& fmt)
     item.Name = name;
     item.Format = fmt;
 
-    CAmberTrajectory traj;
-    traj.AssignTopology(&Topology);
-    if( traj.OpenTrajectoryFile(name,DecodeFormat(fmt),AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ) == false ){
-        return(false);
+    // index avoids reading of entire trajectory
+    CTrajectoryIndex index;
+    if( index.Load(name,DecodeFormat(fmt),&Topology) == false ){
+        if( index.Build(name,DecodeFormat(fmt),&Topology) == false ){
+            return(false);
+        }
+        index.Save(name);
     }
-    item.Format = EncodeFormat(traj.GetFormat());
-    item.NumOfSnapshots = traj.GetNumberOfSnapshots();
-    traj.CloseTrajectoryFile();
+    item.Format = EncodeFormat(index.GetFormat());
+    item.NumOfSnapshots = index.GetNumberOfSnapshots();
 
     TrajectoryPool.push_back(item);
 
@@ -341,7 +354,7 @@ bool CTSServer::PrintTrajectoryInfo(void)
 // execute ---------------------------------------
     cout << "=== Trajectory pool" << endl;
     cout << "# Number of items : " << TrajectoryPool.size() << endl;
-    cout << "# Number of atoms : " << Trajectory.GetNumberOfAtoms() << endl;
+    cout << "# Number of atoms : " << Topology.AtomList.GetNumberOfAtoms() << endl;
     cout << "#" << endl;
     cout << "# Snapshots    Format   Name" << endl;
     cout << "# ---------- ---------- -----------------------------------------------------------" << endl;
@@ -364,41 +377,68 @@ bool CTSServer::PrintTrajectoryInfo(void)
     return(true);
 }
 
+//==============================================================================
 //------------------------------------------------------------------------------
+//==============================================================================
 
-bool CTSServer::ReadSnapshot(void)
+bool CTSServer::SetClientMask(int client_id,const CSmallString& mask,int& natoms)
 {
-    // is pool opened
-    if( CurrentItem < 0 ){
-        CurrentItem = 0;
-        if( CurrentItem >= (int)TrajectoryPool.size() ){
-            // no items in the pool
-            return(false);
-        }
-        if( Trajectory.OpenTrajectoryFile(TrajectoryPool[CurrentItem].Name,
-                DecodeFormat(TrajectoryPool[CurrentItem].Format), AMBER_TRAJ_CXYZB,  AMBER_TRAJ_READ) == false ){
-            return(false);
-        }
-    }
+    natoms = Topology.AtomList.GetNumberOfAtoms();
 
-    bool result = Trajectory.ReadSnapshot(&Snapshot);
-    if( result == false ) {
-        Trajectory.CloseTrajectoryFile();
-        CurrentItem++;
-        if( CurrentItem >= (int)TrajectoryPool.size() ){
-            // no items in the pool
-            return(false);
-        }
-        if( Trajectory.OpenTrajectoryFile(TrajectoryPool[CurrentItem].Name,
-                                      DecodeFormat(TrajectoryPool[CurrentItem].Format),
-                                      AMBER_TRAJ_CXYZB,
-                                      AMBER_TRAJ_READ) == false ){
+    CAmberMaskAtomsPtr p_mask;
+
+    // empty mask switches projection off
+    if( mask.GetLength() > 0 ) {
+        p_mask = CAmberMaskAtomsPtr(new CAmberMaskAtoms);
+        p_mask->AssignTopology(&Topology);
+        if( p_mask->SetMask(mask) == false ) {
+            CSmallString error;
+            error << "unable to set mask '" << mask << "'";
+            ES_ERROR(error);
             return(false);
         }
-        // try to read again
-        result = Trajectory.ReadSnapshot(&Snapshot);
+        natoms = p_mask->GetNumberOfSelectedAtoms();
     }
-    return(result);
+
+    // the old mask is released by the last operation that still projects through it
+    ClientMasksMutex.Lock();
+    ClientMasks.erase(client_id);
+    if( p_mask ) ClientMasks[client_id] = p_mask;
+    ClientMasksMutex.Unlock();
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+CAmberMaskAtomsPtr CTSServer::GetClientMask(int client_id)
+{
+    CAmberMaskAtomsPtr p_mask;
+
+    ClientMasksMutex.Lock();
+    std::map<int,CAmberMaskAtomsPtr>::iterator it = ClientMasks.find(client_id);
+    if( it != ClientMasks.end() ) p_mask = it->second;
+    ClientMasksMutex.Unlock();
+
+    return(p_mask);
+}
+
+//------------------------------------------------------------------------------
+
+void CTSServer::RemoveClientMask(int client_id)
+{
+    ClientMasksMutex.Lock();
+    ClientMasks.erase(client_id);
+    ClientMasksMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CTSServer::DestroyClientMasks(void)
+{
+    ClientMasksMutex.Lock();
+    ClientMasks.clear();
+    ClientMasksMutex.Unlock();
 }
 
 //==============================================================================
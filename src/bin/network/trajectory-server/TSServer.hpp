@@ -27,16 +27,24 @@
 #include <AmberTopology.hpp>
 #include <AmberRestart.hpp>
 #include <AmberTrajectory.hpp>
+#include <AmberMaskAtoms.hpp>
 #include <VerboseStr.hpp>
 #include <TerminalStr.hpp>
 #include <vector>
+#include <map>
+#include <boost/shared_ptr.hpp>
 
 #include "TSServerOptions.hpp"
+#include "TSReader.hpp"
+#include "TSLeaseList.hpp"
 
 //------------------------------------------------------------------------------
 
 class CTSRegClient;
 
+// projection masks are shared with running GetSnapshot(s) operations
+typedef boost::shared_ptr<CAmberMaskAtoms>  CAmberMaskAtomsPtr;
+
 //------------------------------------------------------------------------------
 
 class CTSServer : public CExtraServer {
@@ -74,14 +82,17 @@ private:
         int             NumOfSnapshots;
     };
     std::vector<CTrajPoolItem>  TrajectoryPool;
-    int                         CurrentItem;
 
     // global data -------------------------------
     CAmberTopology      Topology;
-    CAmberTrajectory    Trajectory;         // input trajectory
-    CAmberRestart       Snapshot;
-    CSimpleMutex        TrajectoryMutex;
-    int                 SnapshotIndex;
+    CTSReader           Reader;             // read-ahead of trajectory snapshots
+    int                 MaxSnapshotsPerRequest; // upper limit for GetSnapshots, the reply contains
+                                            // the number of returned snapshots in count
+    CTSLeaseList        Leases;             // snapshots not acknowledged by clients
+
+    // atom subsets projected for individual clients
+    std::map<int,CAmberMaskAtomsPtr>    ClientMasks;
+    CSimpleMutex                        ClientMasksMutex;
 
     /// Ctrl+C signal handler
     static void CtrlCSignalHandler(int signal);
@@ -94,9 +105,16 @@ private:
     ETrajectoryFormat DecodeFormat(const CSmallString& format);
     const CSmallString EncodeFormat(ETrajectoryFormat format);
     bool PrintTrajectoryInfo(void);
-    bool ReadSnapshot(void);
+
+    /// client projection helper methods
+    bool SetClientMask(int client_id,const CSmallString& mask,int& natoms);
+    CAmberMaskAtomsPtr GetClientMask(int client_id);
+    void RemoveClientMask(int client_id);
+    void DestroyClientMasks(void);
 
     friend class CTSProcessor;
+    friend class CTSReader;
+    friend class CTSLeaseList;
 };
 
 //------------------------------------------------------------------------------
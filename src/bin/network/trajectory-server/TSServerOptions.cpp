@@ -18,6 +18,7 @@
 //     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 // =============================================================================
 
+#include <stdio.h>
 #include "TSServerOptions.hpp"
 
 //==============================================================================
@@ -33,6 +34,22 @@ CTSServerOptions::CTSServerOptions(void)
 
 int CTSServerOptions::CheckOptions(void)
 {
+    if( GetOptPrefetch() <= 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: number of prefetched snapshots has to be greater than zero, but %d specified\n",
+                (char*)GetProgramName(),GetOptPrefetch());
+        IsError = true;
+    }
+
+    if( GetOptLeaseTimeout() < 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: lease timeout has to be greater or equal to zero, but %d specified\n",
+                (char*)GetProgramName(),GetOptLeaseTimeout());
+        IsError = true;
+    }
+
+    if( IsError == true ) return(SO_OPTS_ERROR);
+
     return(SO_CONTINUE);
 }
 
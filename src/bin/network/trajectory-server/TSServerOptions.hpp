@@ -49,6 +49,8 @@ public:
     CSO_ARG(CSmallString,ControlFile)
     // options ------------------------------
     CSO_OPT(bool,DoNotShutdown)
+    CSO_OPT(int,Prefetch)
+    CSO_OPT(int,LeaseTimeout)
     CSO_OPT(bool,NoTrajInfo)
     CSO_OPT(bool,Help)
     CSO_OPT(bool,Version)
@@ -73,6 +75,24 @@ public:
                 NULL,                           /* parametr name */
                 "do not shutdown automatically when all clients are unregistered")   /* option description */
     //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                Prefetch,                        /* option name */
+                16,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "prefetch",                      /* long option name */
+                "INT",                           /* parametr name */
+                "number of snapshots decoded ahead of client requests, larger batch requests are served in several rounds")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                LeaseTimeout,                        /* option name */
+                300,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "leasetimeout",                      /* long option name */
+                "SEC",                           /* parametr name */
+                "snapshots leased to clients and not acknowledged within SEC seconds are handed out again, zero disables leasing")   /* option description */
+    //----------------------------------------------------------------------
     CSO_MAP_OPT(bool,                           /* option type */
                 NoTrajInfo,                        /* option name */
                 false,                          /* default value */
@@ -77,6 +77,24 @@ bool CVSClient::GetData(CSmallString& molid)
     CSmallString file_name;
     p_ele->SetAttribute("structure",ActionRequest.GetParameterKeyValue("structure",file_name));
 
+    // optional - block of items, structures are not transferred
+    CSmallString count("1");
+    if(ActionRequest.GetParameterKeyValue("count",count) == true) {
+        if( (count.IsInt() == false) || (count.ToInt() < 1) ) {
+            CSmallString error;
+            error << "specified count '" << count << "' is not a positive integer number";
+            ES_ERROR(error);
+            delete p_command;
+            return(false);
+        }
+        if( (count.ToInt() > 1) && (file_name != NULL) ) {
+            ES_ERROR("structure cannot be requested for more than one item, use load command");
+            delete p_command;
+            return(false);
+        }
+        p_ele->SetAttribute("count",count);
+    }
+
     if(result == false) {
         ES_ERROR("unable to set client_id and/or type");
         delete p_command;
@@ -112,6 +130,14 @@ bool CVSClient::GetData(CSmallString& molid)
         return(true);
     }
 
+    // block of items
+    CSmallString molids;
+    if(p_rele->GetAttribute("molids",molids) == true) {
+        molid = molids;
+        delete p_command;
+        return(true);
+    }
+
     if(ReadStructure(p_rele) == false) {
         ES_ERROR("unable to read structure");
         delete p_command;
@@ -68,6 +68,7 @@ public:
                 "   <green>register</green>   = register client on server side\n"
                 "   <green>unregister</green> = unregister client on server side (unregister?id=client_id)\n"
                 "   <green>get</green>        = get unprocessed structure from database (get?id=client_id,structure=file.ext[,type=xyz])\n"
+                "                or comma separated list of up to N unprocessed molecule ids (get?id=client_id,count=N)\n"
                 "   <green>write</green>      = write data to database and set structure as processed (write?id=client_id,molid=molecule_id[,structure=file.ext,type=log])\n"
                 "   <green>load</green>       = load structure from database (load?id=client_id,molid=molecule_id[,structure=file.ext,type=xyz])\n"
                 "   <green>save</green>       = save structure to database (save?id=client_id,molid=molecule_id[,structure=file.ext,type=log])\n"
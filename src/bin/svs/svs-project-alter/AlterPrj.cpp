@@ -122,6 +122,18 @@ bool CAlterPrj::Run(void)
         result = ExecSQL(sqldb,"DROP INDEX idindx");
         result &= ExecSQL(sqldb,"CREATE UNIQUE INDEX idindx ON PROJECT(ID)");
 
+        //------------------------------------------------------
+    } else if(Options.GetArgCommand() == "addflagindx") {
+        result = ExecSQL(sqldb,"CREATE INDEX flagindx ON PROJECT(FLAG,ID)");
+
+        //------------------------------------------------------
+    } else if(Options.GetArgCommand() == "removeflagindx") {
+        result = ExecSQL(sqldb,"DROP INDEX flagindx");
+
+        //------------------------------------------------------
+    } else if(Options.GetArgCommand() == "wal") {
+        result = ExecSQL(sqldb,"PRAGMA journal_mode=WAL");
+
         //------------------------------------------------------
     } else if(Options.GetArgCommand() == "deleteall") {
         result = ExecSQL(sqldb,"DELETE FROM PROJECT");
@@ -75,6 +75,9 @@ public:
                 "   addindx     = add primary index to the ID column\n"
                 "   removeindx  = remove primary index from the ID solumn\n"
                 "   rebuildindx = removeindx + addindx\n"
+                "   addflagindx = add index to the FLAG column for fast selection of unprocessed items\n"
+                "   removeflagindx = remove index from the FLAG column\n"
+                "   wal         = switch project database into write-ahead logging mode\n"
                 "   deleteall   = delete all records from project database\n"
                )   /* argument description */
 // description of options -----------------------------------------------------
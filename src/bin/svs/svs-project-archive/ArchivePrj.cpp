@@ -0,0 +1,334 @@
+// =============================================================================
+// VScreen - Virtual Screening Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <ErrorSystem.hpp>
+#include <SmallTimeAndDate.hpp>
+#include <DirectoryEnum.hpp>
+#include <FileSystem.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "ArchivePrj.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+CArchivePrj ArchivePrj;
+
+// number of items packed in single index transaction
+#define PACK_BLOCK  1000
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CArchivePrj::CArchivePrj(void)
+{
+    NumOfItems = 0;
+    NumOfErrors = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CArchivePrj::Init(int argc,char* argv[])
+{
+    // encode program options, all check procedures are done inside of CArchivePrjOptions
+    int result = Options.ParseCmdLine(argc,argv);
+
+    // should we exit or was it error?
+    if(result != SO_CONTINUE) return(result);
+
+    // set output stream
+    MsgOut.Attach(Console);
+    MsgOut.Verbosity(CVerboseStr::low);
+    if(Options.GetOptVerbose()) MsgOut.Verbosity(CVerboseStr::high);
+
+    CSmallTimeAndDate dt;
+    dt.GetActualTimeAndDate();
+    MsgOut << high;
+    MsgOut << endl;
+    MsgOut << "# ==============================================================================" << endl;
+    MsgOut << "# svs-project-archive started at " << dt.GetSDateAndTime() << endl;
+    MsgOut << "# ==============================================================================" << endl;
+    MsgOut << "# Project database   : " << Options.GetArgProjectName() << endl;
+    MsgOut << "# Structure database : " << Options.GetArgStructurePath() << endl;
+    MsgOut << "# Archive            : " << Options.GetArgArchivePath() << endl;
+    MsgOut << "# Action             : " << Options.GetArgCommand() << endl;
+    MsgOut << "# ------------------------------------------------------------------------------" << endl;
+    MsgOut << "# Use hiearchy       : " << bool_to_str(Options.GetOptUseHiearchy()) << endl;
+    MsgOut << "# Structure prefix   : " << Options.GetOptUnisID() << endl;
+    MsgOut << "# Part size [MB]     : " << Options.GetOptPartSize() << endl;
+
+    return(SO_CONTINUE);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CArchivePrj::Run(void)
+{
+    MsgOut << endl;
+    MsgOut << ":::::::::::::::::::::::::::::::: Converting structures :::::::::::::::::::::::::" << endl;
+
+    if(CFileSystem::CreateDir(Options.GetArgArchivePath()) == false) {
+        CSmallString error;
+        error << "unable to create directory (" << Options.GetArgArchivePath() << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    if(Archive.Open(Options.GetArgProjectName(),CFileName(Options.GetArgArchivePath())) == false) {
+        MsgOut << endl;
+        MsgOut << "<red><b>>>> ERROR: Unable to open the '" << Options.GetArgArchivePath() << "' archive!</b></red>" << endl;
+        return(false);
+    }
+    Archive.SetMaxPartSize((size_t)Options.GetOptPartSize()*1024*1024);
+
+    MsgOut << low;
+
+    bool result;
+    if(Options.GetArgCommand() == "pack") {
+        if(Archive.BeginUpdate() == false) return(false);
+        if(Options.GetOptUseHiearchy() == true) {
+            result = PackHiearchy(CFileName(Options.GetArgStructurePath()),0);
+        } else {
+            result = PackFiles(CFileName(Options.GetArgStructurePath()));
+        }
+        result &= Archive.EndUpdate();
+        MsgOut << "Number of packed items       : " << NumOfItems << endl;
+    } else {
+        result = UnpackItems();
+        MsgOut << "Number of unpacked items     : " << NumOfItems << endl;
+    }
+    MsgOut << "Number of errors             : " << NumOfErrors << endl;
+
+    Archive.Close();
+
+    MsgOut << high;
+    if( result ) {
+        MsgOut << "Done." << endl;
+    }
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CArchivePrj::PackHiearchy(const CFileName& dir,int level)
+{
+    if(level == 3) {
+        return(PackFiles(dir));
+    }
+
+    CDirectoryEnum  denum(dir);
+
+    if(denum.StartFindFile("*") == false) {
+        ES_ERROR("unable to StartFindFile for directories");
+        return(false);
+    }
+
+    CFileName file;
+    while(denum.FindFile(file)) {
+        if(file == ".") continue;
+        if(file == "..") continue;
+        if(file.GetLength() != 2) continue;
+        CFileName newdir = dir / file;
+        if(CFileSystem::IsDirectory(newdir)) {
+            if(PackHiearchy(newdir,level+1) == false) {
+                return(false);
+            }
+        }
+    }
+
+    denum.EndFindFile();
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CArchivePrj::PackFiles(const CFileName& dir)
+{
+    CDirectoryEnum  denum(dir);
+
+    CSmallString filter;
+    filter << Options.GetOptUnisID() << "*.*";
+
+    if(denum.StartFindFile(filter) == false) {
+        ES_ERROR("unable to StartFindFile for structures");
+        return(false);
+    }
+
+    std::vector<char> buffer;
+
+    CFileName file;
+    while(denum.FindFile(file)) {
+        // UNIS id + 8 numbers + . + type
+        if( (file.GetLength() < 14) || (file[12] != '.') ) continue;
+        CSmallString smolid = file.GetSubString(4,8);
+        if( smolid.IsInt() == false ) continue;
+        CSmallString type = file.GetSubString(13,file.GetLength()-13);
+
+        if(Options.GetOptProgress()) {
+            cout << setw(8) << NumOfItems << " " << file << endl;
+        }
+
+        CFileName name = dir / file;
+        FILE* p_fin = fopen(name,"rb");
+        if(p_fin == NULL) {
+            CSmallString error;
+            error << "unable to open molecule file (" << name << ")";
+            ES_ERROR(error);
+            NumOfErrors++;
+            continue;
+        }
+        fseek(p_fin,0,SEEK_END);
+        long len = ftell(p_fin);
+        fseek(p_fin,0,SEEK_SET);
+        buffer.resize(len > 0 ? len : 1);
+        bool ok = (len >= 0) && ((len == 0) || (fread(&buffer[0],len,1,p_fin) == 1));
+        fclose(p_fin);
+        if( ok == false ) {
+            CSmallString error;
+            error << "unable to read molecule file (" << name << ")";
+            ES_ERROR(error);
+            NumOfErrors++;
+            continue;
+        }
+
+        if(Archive.AddItem(smolid.ToInt(),type,&buffer[0],len) == false) {
+            ES_ERROR("unable to add item to the archive");
+            denum.EndFindFile();
+            return(false);
+        }
+        NumOfItems++;
+
+        // commit index regularly
+        if( (NumOfItems % PACK_BLOCK) == 0 ) {
+            if( (Archive.EndUpdate() == false) || (Archive.BeginUpdate() == false) ) {
+                denum.EndFindFile();
+                return(false);
+            }
+        }
+    }
+
+    denum.EndFindFile();
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CArchivePrj::UnpackItems(void)
+{
+    std::vector<int>            molids;
+    std::vector<CSmallString>   types;
+
+    if(Archive.GetItemList(molids,types) == false) {
+        ES_ERROR("unable to get list of archived items");
+        return(false);
+    }
+
+    for(size_t i=0; i < molids.size(); i++) {
+        CSmallString smolid;
+        smolid.IntToStr(molids[i],"%08d");
+
+        CFileName dir(Options.GetArgStructurePath());
+        if(Options.GetOptUseHiearchy()) {
+            dir = dir / CFileName(smolid.GetSubString(0,2)) / CFileName(smolid.GetSubString(2,2))
+                  / CFileName(smolid.GetSubString(4,2));
+        }
+        if(CFileSystem::CreateDir(dir) == false) {
+            CSmallString error;
+            error << "unable to create directory (" << dir << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+
+        CFileName name = dir / Options.GetOptUnisID() + smolid + "." + types[i];
+
+        if(Options.GetOptProgress()) {
+            cout << setw(8) << NumOfItems << " " << name << endl;
+        }
+
+        const char* p_data = NULL;
+        size_t      len = 0;
+        if(Archive.GetItem(molids[i],types[i],p_data,len) == false) {
+            CSmallString error;
+            error << "unable to read archived item (" << name << ")";
+            ES_ERROR(error);
+            NumOfErrors++;
+            continue;
+        }
+
+        FILE* p_fout = fopen(name,"wb");
+        if(p_fout == NULL) {
+            CSmallString error;
+            error << "unable to open molecule file (" << name << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+        bool ok = (len == 0) || (fwrite(p_data,len,1,p_fout) == 1);
+        if( fclose(p_fout) != 0 ) ok = false;
+        if( ok == false ) {
+            CSmallString error;
+            error << "unable to write molecule file (" << name << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+        NumOfItems++;
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CArchivePrj::Finalize(void)
+{
+    CSmallTimeAndDate dt;
+    dt.GetActualTimeAndDate();
+
+    MsgOut << high;
+    MsgOut << endl;
+    MsgOut << "# ==============================================================================" << endl;
+    MsgOut << "# svs-project-archive terminated at " << dt.GetSDateAndTime() << endl;
+    MsgOut << "# ==============================================================================" << endl;
+
+    if(ErrorSystem.IsError() ||  Options.GetOptVerbose() || (NumOfErrors > 0)) {
+        ErrorSystem.PrintErrors(stderr);
+        fprintf(stderr,"\n");
+    } else{
+        MsgOut << endl;
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,97 @@
+// =============================================================================
+// VScreen - Virtual Screening Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include "ArchivePrjOptions.hpp"
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CArchivePrjOptions::CArchivePrjOptions(void)
+{
+    SetShowMiniUsage(true);
+}
+
+//------------------------------------------------------------------------------
+
+int CArchivePrjOptions::CheckOptions(void)
+{
+    if( GetOptUnisID().GetLength() != 4 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: structure prefix ID has to have four characters, but '%s' is specified\n",
+                (char*)GetProgramName(),(const char*)GetOptUnisID());
+        IsError = true;
+    }
+
+    if( GetOptPartSize() <= 0 ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: size of archive parts has to be greater than zero, but %d is specified\n",
+                (char*)GetProgramName(),GetOptPartSize());
+        IsError = true;
+    }
+
+    if( IsError == true ) return(SO_OPTS_ERROR);
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CArchivePrjOptions::FinalizeOptions(void)
+{
+    bool ret_opt = false;
+
+    if(GetOptHelp() == true) {
+        PrintUsage();
+        ret_opt = true;
+    }
+
+    if(GetOptVersion() == true) {
+        PrintVersion();
+        ret_opt = true;
+    }
+
+    if(ret_opt == true) {
+        printf("\n");
+        return(SO_EXIT);
+    }
+
+    return(SO_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+
+int CArchivePrjOptions::CheckArguments(void)
+{
+    if( (GetArgCommand() != "pack") && (GetArgCommand() != "unpack") ) {
+        if( IsError == false ) fprintf(stderr,"\n");
+        fprintf(stderr,"%s: unsupported command %s\n",
+                (char*)GetProgramName(),(const char*)GetArgCommand());
+        IsError = true;
+    }
+
+    if( IsError == true ) return(SO_OPTS_ERROR);
+
+    return(SO_CONTINUE);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
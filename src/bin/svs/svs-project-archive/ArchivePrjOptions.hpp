@@ -0,0 +1,170 @@
+#ifndef ArchivePrjOptionsH
+#define ArchivePrjOptionsH
+// =============================================================================
+// VScreen - Virtual Screening Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SimpleOptions.hpp>
+#include <CATsMainHeader.hpp>
+
+//------------------------------------------------------------------------------
+
+class CArchivePrjOptions : public CSimpleOptions {
+public:
+    // constructor - tune option setup
+    CArchivePrjOptions(void);
+
+// program name and description -----------------------------------------------
+    CSO_PROG_NAME_BEGIN
+    "svs-project-archive"
+    CSO_PROG_NAME_END
+
+    CSO_PROG_DESC_BEGIN
+    "Convert the structure database between one file per molecule layout and the packed archive. "
+    "The archive consists of large append-only parts, positions of structures and results are kept in the project database."
+    CSO_PROG_DESC_END
+
+    CSO_PROG_VERS_BEGIN
+    LibBuildVersion_CATs
+    CSO_PROG_VERS_END
+
+// list of all options and arguments ------------------------------------------
+    CSO_LIST_BEGIN
+    // arguments ----------------------------
+    CSO_ARG(CSmallString,ProjectName)
+    CSO_ARG(CSmallString,StructurePath)
+    CSO_ARG(CSmallString,ArchivePath)
+    CSO_ARG(CSmallString,Command)
+    // options ------------------------------
+    CSO_OPT(bool,UseHiearchy)
+    CSO_OPT(CSmallString,UnisID)
+    CSO_OPT(int,PartSize)
+    CSO_OPT(bool,Progress)
+    CSO_OPT(bool,Help)
+    CSO_OPT(bool,Version)
+    CSO_OPT(bool,Verbose)
+    CSO_LIST_END
+
+    CSO_MAP_BEGIN
+// description of arguments ---------------------------------------------------
+    CSO_MAP_ARG(CSmallString,                   /* argument type */
+                ProjectName,                          /* argument name */
+                NULL,                           /* default value */
+                true,                           /* is argument mandatory */
+                "projectdb",                        /* parametr name */
+                "filename with the project database")   /* argument description */
+    //----------------------------------------------------------------------
+    CSO_MAP_ARG(CSmallString,                   /* argument type */
+                StructurePath,                          /* argument name */
+                NULL,                           /* default value */
+                true,                           /* is argument mandatory */
+                "structuredb",                        /* parametr name */
+                "pathname to the structure database with one file per molecule")   /* argument description */
+    //----------------------------------------------------------------------
+    CSO_MAP_ARG(CSmallString,                   /* argument type */
+                ArchivePath,                          /* argument name */
+                NULL,                           /* default value */
+                true,                           /* is argument mandatory */
+                "archivedb",                        /* parametr name */
+                "pathname to the directory with the packed archive")   /* argument description */
+    //----------------------------------------------------------------------
+    CSO_MAP_ARG(CSmallString,                   /* argument type */
+                Command,                          /* argument name */
+                NULL,                           /* default value */
+                true,                           /* is argument mandatory */
+                "command",                        /* parametr name */
+                "Supported commands:\n"
+                "   pack        = append all files from structuredb to the archive\n"
+                "   unpack      = write all archived items as files into structuredb\n"
+               )   /* argument description */
+// description of options -----------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                UseHiearchy,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'u',                           /* short option name */
+                "usehiearchy",                      /* long option name */
+                NULL,                           /* parametr name */
+                "use hiearchy in structuredb")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(CSmallString,                           /* option type */
+                UnisID,                        /* option name */
+                "UNIS",                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "unisid",                      /* long option name */
+                "ID",                           /* parametr name */
+                "structure prefix ID")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(int,                           /* option type */
+                PartSize,                        /* option name */
+                1024,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "partsize",                      /* long option name */
+                "MB",                           /* parametr name */
+                "size of archive parts in MB")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Progress,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'p',                           /* short option name */
+                "progress",                      /* long option name */
+                NULL,                           /* parametr name */
+                "print progress")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Verbose,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'v',                           /* short option name */
+                "verbose",                      /* long option name */
+                NULL,                           /* parametr name */
+                "increase output verbosity")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Version,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                '\0',                           /* short option name */
+                "version",                      /* long option name */
+                NULL,                           /* parametr name */
+                "output version information and exit")   /* option description */
+    //----------------------------------------------------------------------
+    CSO_MAP_OPT(bool,                           /* option type */
+                Help,                        /* option name */
+                false,                          /* default value */
+                false,                          /* is option mandatory */
+                'h',                           /* short option name */
+                "help",                      /* long option name */
+                NULL,                           /* parametr name */
+                "display this help and exit")   /* option description */
+    CSO_MAP_END
+
+// final operation with options ------------------------------------------------
+private:
+    virtual int CheckOptions(void);
+    virtual int FinalizeOptions(void);
+    virtual int CheckArguments(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
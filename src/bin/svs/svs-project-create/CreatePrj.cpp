@@ -126,6 +126,30 @@ bool CCreatePrj::Run(void)
         }
     }
 
+    if( rcode == SQLITE_OK ) {
+        // ********* ADD FLAG INDEX - unprocessed items are then found without table scan
+        sql = "CREATE INDEX flagindx ON PROJECT(FLAG,ID)";
+        rcode = sqlite3_exec(sqldb, sql, NULL, 0, &zErrMsg);
+        if( rcode != SQLITE_OK ){
+            ES_ERROR(zErrMsg);
+            sqlite3_free(zErrMsg);
+            MsgOut << endl;
+            MsgOut << "<red><b>>>> ERROR: Unable to set flag index!</b></red>" << endl;
+        }
+    }
+
+    if( rcode == SQLITE_OK ) {
+        // ********* WAL MODE - clients are served while results are written
+        sql = "PRAGMA journal_mode=WAL";
+        rcode = sqlite3_exec(sqldb, sql, NULL, 0, &zErrMsg);
+        if( rcode != SQLITE_OK ){
+            ES_ERROR(zErrMsg);
+            sqlite3_free(zErrMsg);
+            MsgOut << endl;
+            MsgOut << "<red><b>>>> ERROR: Unable to set WAL journal mode!</b></red>" << endl;
+        }
+    }
+
     // close database
     sqlite3_close(sqldb);
 
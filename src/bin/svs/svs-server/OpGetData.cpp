@@ -19,6 +19,7 @@
 // =============================================================================
 
 #include <stdio.h>
+#include <string.h>
 #include <ErrorSystem.hpp>
 #include <RegClient.hpp>
 #include "VSProcessor.hpp"
@@ -27,6 +28,7 @@
 #include <XMLBinData.hpp>
 #include <ServerCommand.hpp>
 #include <XMLIterator.hpp>
+#include <vector>
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -65,48 +67,52 @@ bool CVSProcessor::GetData(void)
     }
 
 
+    // optional number of requested items
+    int count = 1;
+    CommandElement->GetAttribute("count",count);
+    if( count < 1 ) count = 1;
+    if( count > VSServer.MaxClaim ) count = VSServer.MaxClaim;
+
     bool result = true;
+    std::vector<int> molids;
 
     //*********** LOCKED DATABASE ACCESS ******************
 
     VSServer.DBMutex.Lock();
 
-    // select new item
-    sqlite3_reset(VSServer.SelectSTM);
-    int rcode = sqlite3_step(VSServer.SelectSTM);
-    if( rcode != SQLITE_ROW ){
-        if( rcode != SQLITE_DONE ){
-            ES_ERROR(sqlite3_errmsg(VSServer.SqlDB));
-        }
-        ResultElement->SetAttribute("molid","eof");     // no more structures
-        VSServer.DBMutex.Unlock();
-        return(true);
-    }
-
-    // get molid
-    int molid = sqlite3_column_int(VSServer.SelectSTM,0);
+    // select and mark new items in single transaction
+    result = VSServer.ClaimItems(count,molids);
 
-    // update FLAG to 1
-    sqlite3_reset(VSServer.P1STM);
-
-    CSmallString smolid;
-    smolid.IntToStr(molid,"%08d");
+    VSServer.DBMutex.Unlock();
 
-    rcode =  sqlite3_bind_int(VSServer.P1STM,1,molid);
+    //*********** END OF LOCKED DATABASE ACCESS ******************
 
-    rcode = sqlite3_step(VSServer.P1STM);
-    if( rcode != SQLITE_DONE ){
-        CMD_ERROR(Command,"unable to update FLAG to 1");
-        VSServer.DBMutex.Unlock();
+    if( result == false ){
+        CMD_ERROR(Command,"unable to claim unprocessed items");
         return(false);
     }
 
-    VSServer.DBMutex.Unlock();
-
-    //*********** END OF LOCKED DATABASE ACCESS ******************
+    if( molids.size() == 0 ){
+        ResultElement->SetAttribute("molid","eof");     // no more structures
+        return(true);
+    }
 
+    // the first item is always in the molid attribute, the full list only for blocks
+    int molid = molids[0];
     ResultElement->SetAttribute("molid",molid);
 
+    if( molids.size() > 1 ){
+        CSmallString smolids;
+        for(size_t i=0; i < molids.size(); i++){
+            if( i > 0 ) smolids << ",";
+            smolids << molids[i];
+        }
+        ResultElement->SetAttribute("molids",smolids);
+        // structures are not sent for multiple items, use load operation to obtain them
+        p_client->RegisterOperation();
+        return(true);
+    }
+
     bool send_str = false;
     CommandElement->GetAttribute("structure",send_str);
     if(send_str == false) {
@@ -122,32 +128,10 @@ bool CVSProcessor::GetData(void)
         return(false);
     }
 
-    CFileName molname(VSServer.StructureDir);
-
-    if(VSServer.UseHiearchy) {
-        molname = molname / CFileName(smolid.GetSubString(0,2)) / CFileName(smolid.GetSubString(2,2))
-                  / CFileName(smolid.GetSubString(4,2));
-    }
-
-    molname = molname / VSServer.UnisID + smolid + "." + str_type;
-
-    FILE* p_fin = fopen(molname,"rb");
-    if(p_fin == NULL) {
-        CSmallString error;
-        error << "unable to open molecule file (" << molname << ")";
-        CMD_ERROR(Command,error);
+    if(ReadStructureData(molid,str_type,p_moldata) == false) {
         return(false);
     }
 
-    fseek(p_fin,0,SEEK_END);
-    long molfilelen=ftell(p_fin);
-    fseek(p_fin,0,SEEK_SET);
-
-    p_moldata->SetLength(molfilelen,EXBDT_CHAR);
-
-    fread(p_moldata->GetData(),molfilelen,sizeof(char),p_fin);
-    fclose(p_fin);
-
     // register successfull operation
     p_client->RegisterOperation();
 
@@ -201,6 +185,38 @@ bool CVSProcessor::LoadStructure(void)
         return(false);
     }
 
+    if(ReadStructureData(molid,str_type,p_moldata) == false) {
+        return(false);
+    }
+
+    // register successfull operation
+    p_client->RegisterOperation();
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CVSProcessor::ReadStructureData(int molid,const CSmallString& type,CXMLBinData* p_data)
+{
+    // packed archive
+    if(VSServer.UseArchive) {
+        const char* p_item = NULL;
+        size_t      length = 0;
+        if(VSServer.Archive.GetItem(molid,type,p_item,length) == false) {
+            CSmallString error;
+            error << "unable to find molecule " << molid << " (" << type << ") in the archive";
+            CMD_ERROR(Command,error);
+            return(false);
+        }
+        p_data->SetLength(length,EXBDT_CHAR);
+        if(length > 0) memcpy(p_data->GetData(),p_item,length);
+        return(true);
+    }
+
+    // one file per molecule
     CFileName molname(VSServer.StructureDir);
 
     CSmallString smolid;
@@ -211,7 +227,7 @@ bool CVSProcessor::LoadStructure(void)
                   / CFileName(smolid.GetSubString(4,2));
     }
 
-    molname = molname / VSServer.UnisID + smolid + "." + str_type;
+    molname = molname / VSServer.UnisID + smolid + "." + type;
 
     FILE* p_fin = fopen(molname,"rb");
     if(p_fin == NULL) {
@@ -225,14 +241,11 @@ bool CVSProcessor::LoadStructure(void)
     long molfilelen=ftell(p_fin);
     fseek(p_fin,0,SEEK_SET);
 
-    p_moldata->SetLength(molfilelen,EXBDT_CHAR);
+    p_data->SetLength(molfilelen,EXBDT_CHAR);
 
-    fread(p_moldata->GetData(),molfilelen,sizeof(char),p_fin);
+    fread(p_data->GetData(),molfilelen,sizeof(char),p_fin);
     fclose(p_fin);
 
-    // register successfull operation
-    p_client->RegisterOperation();
-
     return(true);
 }
 
@@ -92,28 +92,9 @@ bool CVSProcessor::WriteData(void)
         str_type = "log";
         CommandElement->GetAttribute("type",str_type);
 
-        CFileName molname(VSServer.StructureDir);
-
-        CSmallString smolid;
-        smolid.IntToStr(molid,"%08d");
-
-        if(VSServer.UseHiearchy) {
-            molname = molname / CFileName(smolid.GetSubString(0,2)) / CFileName(smolid.GetSubString(2,2))
-                      / CFileName(smolid.GetSubString(4,2));
-        }
-
-        molname = molname / VSServer.UnisID + smolid + "." + str_type;
-
-        FILE* p_fout = fopen(molname,"wb");
-        if(p_fout == NULL) {
-            CSmallString error;
-            error << "unable to open molecule file (" << molname << ")";
-            CMD_ERROR(Command,error);
+        if(WriteStructureData(molid,str_type,p_sele) == false) {
             return(false);
         }
-
-        fwrite(p_sele->GetData(),p_sele->GetLength(),sizeof(char),p_fout);
-        fclose(p_fout);
     }
 
     return(true);
@@ -163,30 +144,55 @@ bool CVSProcessor::SaveStructure(void)
         str_type = "log";
         CommandElement->GetAttribute("type",str_type);
 
-        CFileName molname(VSServer.StructureDir);
-
-        CSmallString smolid;
-        smolid.IntToStr(molid,"%08d");
-
-        if(VSServer.UseHiearchy) {
-            molname = molname / CFileName(smolid.GetSubString(0,2)) / CFileName(smolid.GetSubString(2,2))
-                      / CFileName(smolid.GetSubString(4,2));
+        if(WriteStructureData(molid,str_type,p_sele) == false) {
+            return(false);
         }
+    }
 
-        molname = molname / VSServer.UnisID + smolid + "." + str_type;
+    return(true);
+}
 
-        FILE* p_fout = fopen(molname,"wb");
-        if(p_fout == NULL) {
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CVSProcessor::WriteStructureData(int molid,const CSmallString& type,CXMLBinData* p_data)
+{
+    // packed archive
+    if(VSServer.UseArchive) {
+        if(VSServer.Archive.AddItem(molid,type,p_data->GetData(),p_data->GetLength()) == false) {
             CSmallString error;
-            error << "unable to open molecule file (" << molname << ")";
+            error << "unable to add molecule " << molid << " (" << type << ") to the archive";
             CMD_ERROR(Command,error);
             return(false);
         }
+        return(true);
+    }
+
+    // one file per molecule
+    CFileName molname(VSServer.StructureDir);
+
+    CSmallString smolid;
+    smolid.IntToStr(molid,"%08d");
 
-        fwrite(p_sele->GetData(),p_sele->GetLength(),sizeof(char),p_fout);
-        fclose(p_fout);
+    if(VSServer.UseHiearchy) {
+        molname = molname / CFileName(smolid.GetSubString(0,2)) / CFileName(smolid.GetSubString(2,2))
+                  / CFileName(smolid.GetSubString(4,2));
     }
 
+    molname = molname / VSServer.UnisID + smolid + "." + type;
+
+    FILE* p_fout = fopen(molname,"wb");
+    if(p_fout == NULL) {
+        CSmallString error;
+        error << "unable to open molecule file (" << molname << ")";
+        CMD_ERROR(Command,error);
+        return(false);
+    }
+
+    fwrite(p_data->GetData(),p_data->GetLength(),sizeof(char),p_fout);
+    fclose(p_fout);
+
     return(true);
 }
 
@@ -25,6 +25,10 @@
 
 //------------------------------------------------------------------------------
 
+class CXMLBinData;
+
+//------------------------------------------------------------------------------
+
 class CVSProcessor : public CCmdProcessor {
 public:
     // constructor
@@ -56,6 +60,12 @@ private:
     //! get client application name
     bool GetClientAppName(void);
 
+    //! read structure or results from the structure database
+    bool ReadStructureData(int molid,const CSmallString& type,CXMLBinData* p_data);
+
+    //! write structure or results to the structure database
+    bool WriteStructureData(int molid,const CSmallString& type,CXMLBinData* p_data);
+
     bool CreateArchive(CXMLElement* p_root,const CFileName& root_path,const CFileName& dir_name);
     bool CreateFile(CXMLElement* p_root,const CFileName& root_path,const CFileName& file_name);
 };
@@ -51,13 +51,18 @@ CVSServer::CVSServer(void)
 {
     SetProtocolName("svs");
     UseHiearchy = false;
+    UseArchive = false;
     NumOfResults = 0;
+    MaxClaim = 100;
     NumOfItems = 0;
     UnisID = "UNIS";
     SqlDB = NULL;
     SelectSTM = NULL;
     P1STM = NULL;
     P2STM = NULL;
+    BeginSTM = NULL;
+    CommitSTM = NULL;
+    RollbackSTM = NULL;
 }
 
 //==============================================================================
@@ -167,12 +172,28 @@ bool CVSServer::ProcessProjectControl(CPrmFile& prmfile)
         MsgOut << format("Use hiearchy in structure database (hiearchy)  = %6s                (default)") % bool_to_str(UseHiearchy) << endl;
     }
 
+    if(prmfile.GetLogicalByKey("archive",UseArchive) == true) {
+        MsgOut << format("Packed structure archive (archive)             = %6s") % bool_to_str(UseArchive) << endl;
+    } else {
+        MsgOut << format("Packed structure archive (archive)             = %6s                (default)") % bool_to_str(UseArchive) << endl;
+    }
+
     if(prmfile.GetStringByKey("unisid",UnisID) == true) {
         MsgOut << format("Structure prefix ID (unisid)                   = %s") % UnisID << endl;
     } else {
         MsgOut << format("Structure prefix ID (unisid)                   = %6s                (default)") % UnisID << endl;
     }
 
+    if(prmfile.GetIntegerByKey("maxclaim",MaxClaim) == true) {
+        MsgOut << format("Max items claimed by single request (maxclaim) = %6d") % MaxClaim << endl;
+    } else {
+        MsgOut << format("Max items claimed by single request (maxclaim) = %6d                (default)") % MaxClaim << endl;
+    }
+    if( MaxClaim < 1 ){
+        ES_ERROR("maxclaim has to be greater than zero");
+        return(false);
+    }
+
     return(true);
 }
 
@@ -227,6 +248,7 @@ bool CVSServer::Run(void)
     MsgOut << "Project database    : " << ProjectName << endl;
     MsgOut << "Structure database  : " << StructureDir << endl;
     MsgOut << "Use hiearchy        : " << bool_to_str(UseHiearchy) << endl;
+    MsgOut << "Use archive         : " << bool_to_str(UseArchive) << endl;
 
     MsgOut << endl;
     MsgOut << ":::::::::::::::::::::::::::::: Initializing database :::::::::::::::::::::::::::" << endl;
@@ -241,36 +263,37 @@ bool CVSServer::Run(void)
         return(false);
     }
 
-    CSmallString sql;
+    // the archive index is updated from another connection
+    sqlite3_busy_timeout(SqlDB,60000);
 
-    sql = "SELECT ID FROM PROJECT WHERE FLAG = 0 LIMIT 1";
-    rcode = sqlite3_prepare_v2(SqlDB,sql,-1,&SelectSTM,NULL);
-    if( rcode != SQLITE_OK ) {
-        ES_ERROR(sql);
-        ES_ERROR(sqlite3_errmsg(SqlDB));
+    // WAL mode allows readers during writes, the synchronous mode NORMAL is safe in it
+    // older projects do not have FLAG index, without it each claim scans the table
+    char* zErrMsg;
+    rcode = sqlite3_exec(SqlDB,"PRAGMA journal_mode=WAL;"
+                               "PRAGMA synchronous=NORMAL;"
+                               "CREATE INDEX IF NOT EXISTS flagindx ON PROJECT(FLAG,ID);",NULL,0,&zErrMsg);
+    if( rcode != SQLITE_OK ){
+        ES_ERROR(zErrMsg);
+        sqlite3_free(zErrMsg);
         MsgOut << endl;
-        MsgOut << "<red><b>>>> ERROR: Unable to prepare the SelectSTM SQL statement!</b></red>" << endl;
+        MsgOut << "<red><b>>>> ERROR: Unable to setup the project database!</b></red>" << endl;
         return(false);
     }
 
-    sql = "UPDATE PROJECT SET FLAG = 1 WHERE ID = ?";
-    rcode = sqlite3_prepare_v2(SqlDB,sql,-1,&P1STM,NULL);
-    if( rcode != SQLITE_OK ) {
-        ES_ERROR(sql);
-        ES_ERROR(sqlite3_errmsg(SqlDB));
-        MsgOut << endl;
-        MsgOut << "<red><b>>>> ERROR: Unable to prepare the P1STM SQL statement!</b></red>" << endl;
-        return(false);
-    }
+    if( PrepareSTM("SELECT rowid,ID FROM PROJECT WHERE FLAG = 0 LIMIT ?",&SelectSTM) == false ) return(false);
+    if( PrepareSTM("UPDATE PROJECT SET FLAG = 1 WHERE rowid = ?",&P1STM) == false ) return(false);
+    if( PrepareSTM("UPDATE PROJECT SET FLAG = 2 WHERE ID = ?",&P2STM) == false ) return(false);
+    if( PrepareSTM("BEGIN IMMEDIATE",&BeginSTM) == false ) return(false);
+    if( PrepareSTM("COMMIT",&CommitSTM) == false ) return(false);
+    if( PrepareSTM("ROLLBACK",&RollbackSTM) == false ) return(false);
 
-    sql = "UPDATE PROJECT SET FLAG = 2 WHERE ID = ?";
-    rcode = sqlite3_prepare_v2(SqlDB,sql,-1,&P2STM,NULL);
-    if( rcode != SQLITE_OK ) {
-        ES_ERROR(sql);
-        ES_ERROR(sqlite3_errmsg(SqlDB));
-        MsgOut << endl;
-        MsgOut << "<red><b>>>> ERROR: Unable to prepare the P2STM SQL statement!</b></red>" << endl;
-        return(false);
+    // open packed structure archive
+    if( UseArchive ){
+        if( Archive.Open(ProjectName,StructureDir) == false ){
+            MsgOut << endl;
+            MsgOut << "<red><b>>>> ERROR: Unable to open the '" << StructureDir << "' structure archive!</b></red>" << endl;
+            return(false);
+        }
     }
 
     // number of total items
@@ -335,6 +358,70 @@ bool CVSServer::Run(void)
 
 //------------------------------------------------------------------------------
 
+bool CVSServer::PrepareSTM(const CSmallString& sql,sqlite3_stmt** p_stm)
+{
+    int rcode = sqlite3_prepare_v2(SqlDB,sql,-1,p_stm,NULL);
+    if( rcode != SQLITE_OK ) {
+        ES_ERROR(sql);
+        ES_ERROR(sqlite3_errmsg(SqlDB));
+        MsgOut << endl;
+        MsgOut << "<red><b>>>> ERROR: Unable to prepare the '" << sql << "' SQL statement!</b></red>" << endl;
+        return(false);
+    }
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSServer::ClaimItems(int count,std::vector<int>& molids)
+{
+    molids.clear();
+
+    sqlite3_reset(BeginSTM);
+    if( sqlite3_step(BeginSTM) != SQLITE_DONE ){
+        ES_ERROR(sqlite3_errmsg(SqlDB));
+        return(false);
+    }
+
+    // select unprocessed items
+    std::vector<sqlite3_int64> rowids;
+    sqlite3_reset(SelectSTM);
+    sqlite3_bind_int(SelectSTM,1,count);
+    int rcode;
+    while( (rcode = sqlite3_step(SelectSTM)) == SQLITE_ROW ){
+        rowids.push_back(sqlite3_column_int64(SelectSTM,0));
+        molids.push_back(sqlite3_column_int(SelectSTM,1));
+    }
+    sqlite3_reset(SelectSTM);
+
+    bool result = rcode == SQLITE_DONE;
+    if( result == false ) ES_ERROR(sqlite3_errmsg(SqlDB));
+
+    // and mark them as being processed
+    for(size_t i=0; (i < rowids.size()) && result; i++){
+        sqlite3_reset(P1STM);
+        sqlite3_bind_int64(P1STM,1,rowids[i]);
+        if( sqlite3_step(P1STM) != SQLITE_DONE ){
+            ES_ERROR(sqlite3_errmsg(SqlDB));
+            result = false;
+        }
+    }
+    sqlite3_reset(P1STM);
+
+    if( result ){
+        sqlite3_reset(CommitSTM);
+        if( sqlite3_step(CommitSTM) == SQLITE_DONE ) return(true);
+        ES_ERROR(sqlite3_errmsg(SqlDB));
+    }
+
+    sqlite3_reset(RollbackSTM);
+    sqlite3_step(RollbackSTM);
+    molids.clear();
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
 static int callback(void *NotUsed, int argc, char **argv, char **azColName)
 {
     CVSServer::NItems = 0;
@@ -375,7 +462,11 @@ bool CVSServer::Finalize(void)
     if( SelectSTM ) sqlite3_finalize(SelectSTM);
     if( P1STM ) sqlite3_finalize(P1STM);
     if( P2STM ) sqlite3_finalize(P2STM);
+    if( BeginSTM ) sqlite3_finalize(BeginSTM);
+    if( CommitSTM ) sqlite3_finalize(CommitSTM);
+    if( RollbackSTM ) sqlite3_finalize(RollbackSTM);
     if( SqlDB ) sqlite3_close(SqlDB);
+    Archive.Close();
 
     // remove current server key
     CFileSystem::RemoveFile(GetServerKeyName());
@@ -26,6 +26,8 @@
 #include <VerboseStr.hpp>
 #include <TerminalStr.hpp>
 #include <sqlite3.h>
+#include <VSArchive.hpp>
+#include <vector>
 
 #include "VSServerOptions.hpp"
 
@@ -60,7 +62,10 @@ private:
     CSmallString        ProjectName;    // project name
     CSmallString        StructureDir;   // where structures are located
     bool                UseHiearchy;    // use hiearchy storage of structures
+    bool                UseArchive;     // structures are packed in archive
+    CVSArchive          Archive;
     int                 NumOfResults;   // number of results
+    int                 MaxClaim;       // max number of items claimed by single request
 
     // client package -----------------------------
     bool                ClientPackageAvailable;
@@ -73,6 +78,9 @@ private:
     sqlite3_stmt*       SelectSTM;
     sqlite3_stmt*       P1STM;
     sqlite3_stmt*       P2STM;
+    sqlite3_stmt*       BeginSTM;
+    sqlite3_stmt*       CommitSTM;
+    sqlite3_stmt*       RollbackSTM;
     int                 NumOfItems;
     CSmallString        UnisID;
 
@@ -85,6 +93,12 @@ private:
     //! process client package control section
     bool ProcessClientPkgControl(CPrmFile& prmfile);
 
+    //! prepare SQL statement
+    bool PrepareSTM(const CSmallString& sql,sqlite3_stmt** p_stm);
+
+    //! claim up to count unprocessed items in one transaction, DBMutex has to be locked
+    bool ClaimItems(int count,std::vector<int>& molids);
+
     //! get project db stat
     int GetNumberFromSQL(sqlite3* sqldb,const CSmallString& cond);
 
@@ -27,12 +27,15 @@
 #include <boost/format.hpp>
 #include <ErrorSystem.hpp>
 #include <TerminalStr.hpp>
+#include <ParallelContext.hpp>
+#include <SimpleMutex.hpp>
 
 // core support -------------------------------
 #include <QTopology.hpp>
 #include <QSnapshot.hpp>
 #include <QSelection.hpp>
 #include <QRSelection.hpp>
+#include <QDistanceMask.hpp>
 #include <QTrajectory.hpp>
 #include <QTrajPool.hpp>
 #include <QOBMol.hpp>
@@ -51,6 +54,7 @@
 #include <QGeometry.hpp>
 #include <QPMFLib.hpp>
 #include <QCovarMatrix.hpp>
+#include <QFitContext.hpp>
 
 // data analysis ------------------------------
 #include <QPropSum.hpp>
@@ -84,12 +88,18 @@ int         QCATs::ExitValue = 0;
 bool        QCATs::ExitScript = false;
 QStringList QCATs::ScriptArguments;
 
+// parallel workers share stdout - keep lines together
+static CSimpleMutex OutputMutex;
+
+// exit() can be called by several workers at once
+static CSimpleMutex ExitMutex;
+
 //------------------------------------------------------------------------------
 
 void RegisterAllCATsClasses(QScriptEngine& engine)
 {
     // register engine for QCATsScriptable
-    QCATsScriptable::CATsEngine = &engine;
+    QCATsScriptable::SetCATsEngine(&engine);
 
     // register objects --------------------------
     QCATs::Register(engine);
@@ -99,6 +109,7 @@ void RegisterAllCATsClasses(QScriptEngine& engine)
     QSnapshot::Register(engine);
     QSelection::Register(engine);
     QRSelection::Register(engine);
+    QDistanceMask::Register(engine);
     QTrajectory::Register(engine);
     QTrajPool::Register(engine);
     QOBMol::Register(engine);
@@ -117,6 +128,7 @@ void RegisterAllCATsClasses(QScriptEngine& engine)
     QGeometry::Register(engine);
     QPMFLib::Register(engine);
     QCovarMatrix::Register(engine);
+    QFitContext::Register(engine);
 
     // data analysis ------------------------------
     QPropSum::Register(engine);
@@ -308,6 +320,93 @@ QScriptValue QCATs::argument(void)
 //------------------------------------------------------------------------------
 //==============================================================================
 
+QScriptValue QCATs::getNumOfThreads(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int getNumOfThreads()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(CParallelContext::GetNumberOfThreads());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCATs::getThreadIndex(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int getThreadIndex()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(CParallelContext::GetThreadIndex());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCATs::isMaster(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool isMaster()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(CParallelContext::IsMaster());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCATs::barrier(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: barrier()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    CParallelContext::Barrier();
+    return(value);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 QScriptValue QCATs::sprintf(QScriptContext* p_context, QScriptEngine* p_engine)
 {
     return( sprintf("sprintf",p_context,p_engine).c_str() );
@@ -318,7 +417,9 @@ QScriptValue QCATs::sprintf(QScriptContext* p_context, QScriptEngine* p_engine)
 QScriptValue QCATs::printf(QScriptContext* p_context, QScriptEngine* p_engine)
 {
     std:: string str = sprintf("printf",p_context,p_engine);
+    OutputMutex.Lock();
     cout << str;
+    OutputMutex.Unlock();
     return(QScriptValue());
 }
 
@@ -331,11 +432,12 @@ QScriptValue QCATs::exit(QScriptContext* p_context, QScriptEngine* p_engine)
         return(QScriptValue());
     }
 
+    ExitMutex.Lock();
     ExitScript = true;
-
     if( p_context->argument(0).isNumber() ){
         ExitValue = p_context->argument(0).toNumber();
     }
+    ExitMutex.Unlock();
 
     p_engine->abortEvaluation( p_context->argument(0) );
     return(QScriptValue());
@@ -404,12 +506,15 @@ const std::string QCATs::sprintf(const CSmallString& fname, QScriptContext* p_co
 
 QScriptValue QCATs::print(QScriptContext* p_context, QScriptEngine* p_engine)
 {
+    std::string str;
     for(int i = 0; i < p_context->argumentCount(); i++){
         QScriptValue val = p_context->argument(i);
         QString sval = val.toString();
-        cout << sval.toStdString();
+        str += sval.toStdString();
     }
-    cout << endl;
+    OutputMutex.Lock();
+    cout << str << endl;
+    OutputMutex.Unlock();
     return(QScriptValue());
 }
 
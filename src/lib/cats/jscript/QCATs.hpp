@@ -78,6 +78,23 @@ public slots:
     /// include(name)
     QScriptValue include(void);
 
+// parallel execution ----------------------------------------------------------
+    /// get number of parallel workers (cats --threads)
+    /// int getNumOfThreads()
+    QScriptValue getNumOfThreads(void);
+
+    /// get index of the worker running the script, the master has index zero
+    /// int getThreadIndex()
+    QScriptValue getThreadIndex(void);
+
+    /// is the script run by the master worker
+    /// bool isMaster()
+    QScriptValue isMaster(void);
+
+    /// wait for all workers
+    /// barrier()
+    QScriptValue barrier(void);
+
 // global functions ------------------------------------------------------------
 public:
     /// printf
@@ -97,6 +114,8 @@ private:
     static const std::string sprintf(const CSmallString& fname, QScriptContext* p_context, QScriptEngine* p_engine);
 
 public:
+    // shared by parallel workers - exit state is written under a mutex and read
+    // after workers finish, arguments are set before workers start
     static int          ExitValue;
     static bool         ExitScript;
     static QStringList  ScriptArguments;
@@ -32,7 +32,8 @@ using namespace boost::algorithm;
 
 //------------------------------------------------------------------------------
 
-QScriptEngine* QCATsScriptable::CATsEngine = NULL;
+// each worker thread runs its own engine
+static thread_local QScriptEngine* CATsEngine = NULL;
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -434,6 +435,20 @@ QScriptValue QCATsScriptable::setIsNotAllowed(const QScriptValue& value)
 //------------------------------------------------------------------------------
 //==============================================================================
 
+void QCATsScriptable::SetCATsEngine(QScriptEngine* p_engine)
+{
+    CATsEngine = p_engine;
+}
+
+//------------------------------------------------------------------------------
+
+QScriptEngine* QCATsScriptable::GetCATsEngine(void)
+{
+    return(CATsEngine);
+}
+
+//------------------------------------------------------------------------------
+
 QScriptContext* QCATsScriptable::Context(void)
 {
     if( CATsEngine == NULL ) return(NULL);
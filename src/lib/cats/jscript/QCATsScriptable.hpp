@@ -137,7 +137,11 @@ private:
     std::map<int,bool>   ArgUsageFlags;
 
 public:
-    static QScriptEngine* CATsEngine;
+    /// set script engine of the calling thread
+    static void SetCATsEngine(QScriptEngine* p_engine);
+
+    /// get script engine of the calling thread
+    static QScriptEngine* GetCATsEngine(void);
 };
 
 //------------------------------------------------------------------------------
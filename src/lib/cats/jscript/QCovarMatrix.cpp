@@ -25,6 +25,10 @@
 #include <moc_QCovarMatrix.cpp>
 #include <QTopology.hpp>
 #include <QSnapshot.hpp>
+#include <QSelection.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <AmberAtom.hpp>
+#include <math.h>
 #include <SciLapack.hpp>
 #include <iomanip>
 #include <fstream>
@@ -80,14 +84,20 @@ QScriptValue QCovarMatrix::New(QScriptContext *context,
 QCovarMatrix::QCovarMatrix(QTopology* p_parent)
     : QCATsScriptable("CovarMatrix")
 {
-    int natoms = p_parent->Topology.AtomList.GetNumberOfAtoms();
-    Matrix.CreateMatrix(3*natoms,3*natoms);
-    EigenValues.CreateVector(3*natoms);
+    // the matrix is allocated when the atom map is known (begin or load)
+    NumOfAtoms = p_parent->Topology.AtomList.GetNumberOfAtoms();
+    AtomMap.resize(NumOfAtoms);
+    Weights.resize(NumOfAtoms);
+    for(int i=0; i < NumOfAtoms; i++){
+        AtomMap[i] = i;
+        Weights[i] = 1.0;
+    }
+    MassWeighted = false;
     SamplingMode = false;
     NumOfSamples = 0;
     NumOfVectors = 0;
-    RefHelper.CreateVector(3*natoms);
-    CrdHelper.CreateVector(3*natoms);
+    BatchSize = 32;
+    NumOfBatched = 0;
 }
 
 //==============================================================================
@@ -96,7 +106,7 @@ QCovarMatrix::QCovarMatrix(QTopology* p_parent)
 
 int QCovarMatrix::GetDimension(void) const
 {
-    return(Matrix.GetNumberOfColumns());
+    return(3*AtomMap.size());
 }
 
 //------------------------------------------------------------------------------
@@ -106,6 +116,26 @@ int QCovarMatrix::GetNumOfVectors(void) const
     return(NumOfVectors);
 }
 
+//------------------------------------------------------------------------------
+
+int QCovarMatrix::GetBatchSize(void) const
+{
+    return(BatchSize);
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::SetBatchSize(int size)
+{
+    if( size < 1 ) size = 1;
+    if( SamplingMode == true ){
+        // do not lose already batched samples
+        FlushBatch();
+        Batch.resize((size_t)size*GetDimension());
+    }
+    BatchSize = size;
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -122,18 +152,123 @@ void QCovarMatrix::begin(QObject* p_qref)
     }
     QSnapshot* p_ref = dynamic_cast<QSnapshot*>(p_qref);
     if( p_ref == NULL ){
-        context()->throwError("CovarMatrix::addSample(ref,crd) - ref must be snapshot");
+        context()->throwError("CovarMatrix::begin(ref) - ref must be snapshot");
         return;
     }
-    if( GetDimension() != 3*p_ref->Restart.GetNumberOfAtoms() ){
-        CSmallString error;
-        error << "CovarMatrix::begin(ref) - inconsistent dimensions, ref (";
-        error << p_ref->Restart.GetNumberOfAtoms() << "), matrix (" << GetDimension() << ")";
-        context()->throwError(QString(error));
+    if( CheckSnapshot(p_ref,"CovarMatrix::begin(ref)") == false ) return;
+
+    BeginSampling(p_ref,NULL,false);
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::begin(QObject* p_qref,QObject* p_qsel)
+{
+    if( argumentCount() != 2 ) {
+        context()->throwError("CovarMatrix::begin(ref,selection) - illegal number of arguments, two are expected");
+        return;
+    }
+    if( SamplingMode == true ){
+        context()->throwError("CovarMatrix::begin(ref,selection) - already in sampling mode");
         return;
     }
-    for(int i=0; i < p_ref->Restart.GetNumberOfAtoms(); i++ ){
-        CPoint pos = p_ref->Restart.GetPosition(i);
+    QSnapshot* p_ref = dynamic_cast<QSnapshot*>(p_qref);
+    if( p_ref == NULL ){
+        context()->throwError("CovarMatrix::begin(ref,selection) - ref must be snapshot");
+        return;
+    }
+    QSelection* p_sel = dynamic_cast<QSelection*>(p_qsel);
+    if( p_sel == NULL ){
+        context()->throwError("CovarMatrix::begin(ref,selection) - selection must be selection");
+        return;
+    }
+    if( CheckSnapshot(p_ref,"CovarMatrix::begin(ref,selection)") == false ) return;
+    if( p_sel->Mask.GetNumberOfSelectedAtoms() == 0 ){
+        context()->throwError("CovarMatrix::begin(ref,selection) - selection is empty");
+        return;
+    }
+
+    BeginSampling(p_ref,p_sel,false);
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::begin(QObject* p_qref,QObject* p_qsel,const QString& mode)
+{
+    if( argumentCount() != 3 ) {
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - illegal number of arguments, three are expected");
+        return;
+    }
+    if( SamplingMode == true ){
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - already in sampling mode");
+        return;
+    }
+    QSnapshot* p_ref = dynamic_cast<QSnapshot*>(p_qref);
+    if( p_ref == NULL ){
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - ref must be snapshot");
+        return;
+    }
+    QSelection* p_sel = dynamic_cast<QSelection*>(p_qsel);
+    if( p_sel == NULL ){
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - selection must be selection");
+        return;
+    }
+    if( (mode != "massweighted") && (mode != "cartesian") ){
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - mode must be massweighted or cartesian");
+        return;
+    }
+    if( CheckSnapshot(p_ref,"CovarMatrix::begin(ref,selection,mode)") == false ) return;
+    if( p_sel->Mask.GetNumberOfSelectedAtoms() == 0 ){
+        context()->throwError("CovarMatrix::begin(ref,selection,mode) - selection is empty");
+        return;
+    }
+
+    BeginSampling(p_ref,p_sel,mode == "massweighted");
+}
+
+//------------------------------------------------------------------------------
+
+bool QCovarMatrix::BeginSampling(QSnapshot* p_ref,QSelection* p_sel,bool massweighted)
+{
+    // compact atom map - the matrix covers only selected atoms
+    std::vector<int>    map;
+    std::vector<double> weights;
+    if( p_sel != NULL ){
+        int nsel = p_sel->Mask.GetNumberOfSelectedAtoms();
+        map.resize(nsel);
+        for(int i=0; i < nsel; i++){
+            map[i] = p_sel->Mask.GetSelectedAtomCondensed(i)->GetAtomIndex();
+        }
+    } else {
+        map.resize(NumOfAtoms);
+        for(int i=0; i < NumOfAtoms; i++){
+            map[i] = i;
+        }
+    }
+
+    weights.resize(map.size());
+    for(size_t i=0; i < map.size(); i++){
+        weights[i] = 1.0;
+        if( massweighted ){
+            double mass = p_ref->Restart.GetTopology()->AtomList.GetAtom(map[i])->GetMass();
+            if( mass <= 0.0 ){
+                CSmallString error;
+                error << "CovarMatrix::begin(ref,selection,mode) - atom " << map[i]+1 << " has no mass";
+                context()->throwError(QString(error));
+                return(false);
+            }
+            weights[i] = sqrt(mass);
+        }
+    }
+
+    AtomMap = map;
+    Weights = weights;
+    MassWeighted = massweighted;
+
+    AllocateMatrix();
+
+    for(size_t i=0; i < AtomMap.size(); i++ ){
+        CPoint pos = p_ref->Restart.GetPosition(AtomMap[i]);
         for(int j=0; j < 3; j++){
             RefHelper[i*3+j] = pos[j];
         }
@@ -141,9 +276,51 @@ void QCovarMatrix::begin(QObject* p_qref)
 
     CrdHelper.SetZero();
     Matrix.SetZero();
+    Batch.resize((size_t)BatchSize*GetDimension());
+    NumOfBatched = 0;
     SamplingMode = true;
     NumOfSamples = 0;
     NumOfVectors = 0;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::AllocateMatrix(void)
+{
+    int ndim = GetDimension();
+    if( (int)Matrix.GetNumberOfColumns() == ndim ) return;
+    Matrix.CreateMatrix(ndim,ndim);
+    EigenValues.CreateVector(ndim);
+    RefHelper.CreateVector(ndim);
+    CrdHelper.CreateVector(ndim);
+}
+
+//------------------------------------------------------------------------------
+
+bool QCovarMatrix::CheckSnapshot(QSnapshot* p_crd,const char* p_usage)
+{
+    if( p_crd->Restart.GetNumberOfAtoms() != NumOfAtoms ){
+        CSmallString error;
+        error << p_usage << " - inconsistent number of atoms, snapshot (";
+        error << p_crd->Restart.GetNumberOfAtoms() << "), topology (" << NumOfAtoms << ")";
+        context()->throwError(QString(error));
+        return(false);
+    }
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::LoadDisplacement(QSnapshot* p_crd)
+{
+    for(size_t i=0; i < AtomMap.size(); i++ ){
+        CPoint pos = p_crd->Restart.GetPosition(AtomMap[i]);
+        for(int j=0; j < 3; j++){
+            CrdHelper[i*3+j] = (pos[j] - RefHelper[i*3+j])*Weights[i];
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -165,40 +342,62 @@ void QCovarMatrix::addSample(QObject* p_qcrd)
         return;
     }
 
-    if( GetDimension() != 3*p_crd->Restart.GetNumberOfAtoms() ){
-        CSmallString error;
-        error << "CovarMatrix::addSample(crd) - inconsistent dimensions, crd (";
-        error << p_crd->Restart.GetNumberOfAtoms() << "), matrix (" << GetDimension() << ")";
-        context()->throwError(QString(error));
-        return;
-    }
-    for(int i=0; i < p_crd->Restart.GetNumberOfAtoms(); i++ ){
-        CPoint pos = p_crd->Restart.GetPosition(i);
+    if( CheckSnapshot(p_crd,"CovarMatrix::addSample(crd)") == false ) return;
+
+    // store weighted displacement of mapped atoms into the batch
+    int     dim = GetDimension();
+    double* p_x = &Batch[(size_t)NumOfBatched*dim];
+    for(size_t i=0; i < AtomMap.size(); i++ ){
+        CPoint pos = p_crd->Restart.GetPosition(AtomMap[i]);
         for(int j=0; j < 3; j++){
-            CrdHelper[i*3+j] = pos[j] - RefHelper[i*3+j];
+            p_x[i*3+j] = (pos[j] - RefHelper[i*3+j])*Weights[i];
         }
     }
+    NumOfBatched++;
 
-    // highly optimized code :-)
-    // matrix is symmetric
-    int dim = GetDimension();
-    double* p_d1 = CrdHelper.GetRawDataField();
+    if( NumOfBatched >= BatchSize ){
+        FlushBatch();
+    }
+
+    NumOfSamples++;
+}
+
+//------------------------------------------------------------------------------
+
+void QCovarMatrix::FlushBatch(void)
+{
+    if( NumOfBatched == 0 ) return;
+
+    // symmetric rank-k update (dsyrk-like) of the upper triangle
+    // Matrix is column-major, upper triangle of column c is rows 0..c
+    // the matrix is processed in tiles, which stay in cache for all batched samples
+    // offsets are in size_t, dim*dim overflows int above ~15000 atoms
+    const int tile = 64;
+
+    int     dim = GetDimension();
     double* p_m = Matrix.GetRawDataField();
-    for(int i=0; i < dim; i++){
-        double v1 = *p_d1;
-        p_d1++;
-        double* p_d2 = CrdHelper.GetRawDataField();
-        for(int j=0; j < dim; j++){
-            double v2 = *p_d2;
-            p_d2++;
-            double m = *p_m;
-            m += v1*v2;
-            *p_m = m;
-            p_m++;
+    double* p_b = &Batch[0];
+
+    for(int cb=0; cb < dim; cb += tile){
+        int ce = cb + tile < dim ? cb + tile : dim;
+        for(int rb=0; rb <= cb; rb += tile){
+            int re = rb + tile < dim ? rb + tile : dim;
+            for(int k=0; k < NumOfBatched; k++){
+                const double* p_x = p_b + (size_t)k*dim;
+                for(int c=cb; c < ce; c++){
+                    double  xc = p_x[c];
+                    double* p_col = p_m + (size_t)c*dim;
+                    int     last = re < c + 1 ? re : c + 1;
+                    // contiguous in both operands - vectorized by compiler
+                    for(int r=rb; r < last; r++){
+                        p_col[r] += p_x[r]*xc;
+                    }
+                }
+            }
         }
     }
 
-    NumOfSamples++;
+    NumOfBatched = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -214,16 +413,21 @@ void QCovarMatrix::finish(void)
         return;
     }
 
-    if( NumOfSamples > 0 ){
-        for(unsigned int i=0; i < Matrix.GetNumberOfRows(); i++){
-            for(unsigned int j=0; j < Matrix.GetNumberOfRows(); j++){
-                double value = Matrix[i][j];
-                value /= NumOfSamples;
-                Matrix[i][j] = value;
-            }
+    FlushBatch();
+
+    // normalize upper triangle and mirror it to the lower one
+    int     dim = GetDimension();
+    double* p_m = Matrix.GetRawDataField();
+    double  scale = NumOfSamples > 0 ? 1.0/NumOfSamples : 1.0;
+    for(int c=0; c < dim; c++){
+        for(int r=0; r <= c; r++){
+            double value = p_m[(size_t)c*dim+r]*scale;
+            p_m[(size_t)c*dim+r] = value;
+            p_m[(size_t)r*dim+c] = value;
         }
     }
 
+    Batch.clear();
     SamplingMode = false;
 }
 
@@ -243,6 +447,10 @@ bool QCovarMatrix::diagonalize(void)
         context()->throwError("CovarMatrix::diagonalize() - already diagonalized");
         return(false);
     }
+    if( (int)Matrix.GetNumberOfColumns() != GetDimension() ){
+        context()->throwError("CovarMatrix::diagonalize() - no data, call begin() first");
+        return(false);
+    }
 
     NumOfVectors = GetDimension();
 
@@ -254,6 +462,199 @@ bool QCovarMatrix::diagonalize(void)
 
 //------------------------------------------------------------------------------
 
+bool QCovarMatrix::diagonalize(int nvectors)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("CovarMatrix::diagonalize(nvectors) - illegal number of arguments, only one is expected");
+        return(false);
+    }
+    if( SamplingMode == true ){
+        context()->throwError("CovarMatrix::diagonalize(nvectors) - still in sampling mode");
+        return(false);
+    }
+    if( NumOfVectors > 0 ){
+        context()->throwError("CovarMatrix::diagonalize(nvectors) - already diagonalized");
+        return(false);
+    }
+    if( (int)Matrix.GetNumberOfColumns() != GetDimension() ){
+        context()->throwError("CovarMatrix::diagonalize(nvectors) - no data, call begin() first");
+        return(false);
+    }
+    int ndim = GetDimension();
+    if( (nvectors < 1) || (nvectors > ndim) ){
+        CSmallString error;
+        error << "CovarMatrix::diagonalize(nvectors) - nvectors is out-of-range, nvectors (";
+        error << nvectors << "), ndim (" << ndim << ")";
+        context()->throwError(QString(error));
+        return(false);
+    }
+
+    // the subspace would be close to the full problem - diagonalize it directly
+    if( 2*(nvectors + 10) >= ndim ){
+        NumOfVectors = ndim;
+        int result = CSciLapack::syev('V','U',Matrix,EigenValues);
+        return(result == 0);
+    }
+
+    if( DiagonalizePartial(nvectors) == false ){
+        context()->throwError("CovarMatrix::diagonalize(nvectors) - subspace iteration failed");
+        return(false);
+    }
+
+    NumOfVectors = nvectors;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+// orthonormalize columns of n x p column-major block, modified Gram-Schmidt
+// applied twice, degenerated columns are replaced by pseudo-random vectors
+// the generator state is owned by the caller, so concurrent diagonalizations
+// do not share it and each one is reproducible
+
+static double CovarRandom(unsigned int& seed)
+{
+    seed = seed*1103515245 + 12345;
+    return( ((seed >> 8) & 0xFFFF)/65535.0 - 0.5 );
+}
+
+static void CovarOrthonormalize(std::vector<double>& q,int n,int p,unsigned int& seed)
+{
+    for(int j=0; j < p; j++){
+        double* p_qj = &q[j*n];
+        for(int attempt=0; attempt < 3; attempt++){
+            for(int pass=0; pass < 2; pass++){
+                for(int k=0; k < j; k++){
+                    const double* p_qk = &q[k*n];
+                    double dot = 0.0;
+                    for(int i=0; i < n; i++) dot += p_qk[i]*p_qj[i];
+                    for(int i=0; i < n; i++) p_qj[i] -= dot*p_qk[i];
+                }
+            }
+            double norm = 0.0;
+            for(int i=0; i < n; i++) norm += p_qj[i]*p_qj[i];
+            norm = sqrt(norm);
+            if( norm > 1.0e-12 ){
+                for(int i=0; i < n; i++) p_qj[i] /= norm;
+                break;
+            }
+            // rank deficient matrix (few samples) - continue with random direction
+            for(int i=0; i < n; i++) p_qj[i] = CovarRandom(seed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool QCovarMatrix::DiagonalizePartial(int nvectors)
+{
+    // block subspace iteration with Rayleigh-Ritz projection
+    // only C*Q products are needed, the matrix is symmetric thus its columns
+    // can be streamed regardless of the storage order
+
+    const int   maxiters = 300;
+    const double tol = 1.0e-6;     // residual norm relative to the largest eigenvalue
+
+    int n = GetDimension();
+    int p = nvectors + 10;      // oversampling improves convergence of the last vectors
+
+    std::vector<double> q(n*p);
+    std::vector<double> y(n*p);
+    std::vector<double> r(n);
+
+    CFortranMatrix  b;
+    CVector         w;
+    b.CreateMatrix(p,p);
+    w.CreateVector(p);
+
+    unsigned int seed = 12345;
+    for(int i=0; i < n*p; i++) q[i] = CovarRandom(seed);
+    CovarOrthonormalize(q,n,p,seed);
+
+    const double* p_m = Matrix.GetRawDataField();
+    bool converged = false;
+
+    for(int iter=0; iter < maxiters; iter++){
+        // y = C*q
+        for(int i=0; i < n*p; i++) y[i] = 0.0;
+        for(int c=0; c < n; c++){
+            const double* p_col = p_m + (size_t)c*n;
+            for(int j=0; j < p; j++){
+                double  a = q[j*n+c];
+                double* p_yj = &y[j*n];
+                for(int i=0; i < n; i++) p_yj[i] += a*p_col[i];
+            }
+        }
+
+        // Rayleigh-Ritz - b = qT*C*q
+        for(int j=0; j < p; j++){
+            for(int k=0; k <= j; k++){
+                double dot = 0.0;
+                for(int i=0; i < n; i++) dot += q[k*n+i]*y[j*n+i];
+                b[k][j] = dot;
+                b[j][k] = dot;
+            }
+        }
+        if( CSciLapack::syev('V','U',b,w) != 0 ) return(false);
+
+        // residuals of Ritz pairs - C*v = y*b[:,col] since y = C*q
+        // eigenvalues are in ascending order
+        double maxres = 0.0;
+        double maxval = fabs(w[p-1]) > 1.0e-300 ? fabs(w[p-1]) : 1.0;
+        for(int v=1; v <= nvectors; v++){
+            int col = p - v;
+            for(int i=0; i < n; i++) r[i] = 0.0;
+            for(int k=0; k < p; k++){
+                double a = b[k][col];
+                double l = w[col];
+                for(int i=0; i < n; i++) r[i] += a*(y[k*n+i] - l*q[k*n+i]);
+            }
+            double res = 0.0;
+            for(int i=0; i < n; i++) res += r[i]*r[i];
+            res = sqrt(res);
+            if( res > maxres ) maxres = res;
+        }
+        if( maxres <= tol*maxval ){
+            converged = true;
+            break;
+        }
+
+        // keep q consistent with b for the Ritz vectors below
+        if( iter == maxiters - 1 ) break;
+
+        q = y;
+        CovarOrthonormalize(q,n,p,seed);
+    }
+
+    if( converged == false ){
+        ES_ERROR("subspace iteration did not converge");
+        return(false);
+    }
+
+    // Ritz vectors - stored in the same reversed order as syev results
+    // y is reused as storage since the matrix columns are overwritten
+    for(int v=1; v <= nvectors; v++){
+        int col = p - v;
+        double* p_yv = &y[(v-1)*n];
+        for(int i=0; i < n; i++) p_yv[i] = 0.0;
+        for(int k=0; k < p; k++){
+            double a = b[k][col];
+            for(int i=0; i < n; i++) p_yv[i] += a*q[k*n+i];
+        }
+    }
+    for(int v=1; v <= nvectors; v++){
+        int rvector = n - v;
+        EigenValues[rvector] = w[p-v];
+        for(int i=0; i < n; i++){
+            Matrix[i][rvector] = y[(v-1)*n+i];
+        }
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
 double QCovarMatrix::projectSnapshot(QObject* p_qsnap,int vector)
 {
     if( argumentCount() != 2 ) {
@@ -271,15 +672,8 @@ double QCovarMatrix::projectSnapshot(QObject* p_qsnap,int vector)
         return(0.0);
     }
 
-    int natoms = p_crd->Restart.GetNumberOfAtoms();
+    if( CheckSnapshot(p_crd,"CovarMatrix::projectSnapshot(crd,vector)") == false ) return(0.0);
     int ndim = GetDimension();
-    if( ndim != 3*natoms ){
-        CSmallString error;
-        error << "CovarMatrix::projectSnapshot(crd,vector) - inconsistent dimensions, crd (";
-        error << 3*natoms << "), matrix (" << ndim << ")";
-        context()->throwError(QString(error));
-        return(0.0);
-    }
 
     int nvecs = GetNumOfVectors();
     if( (vector < 1) || (vector > nvecs) ){
@@ -292,12 +686,8 @@ double QCovarMatrix::projectSnapshot(QObject* p_qsnap,int vector)
     // revers and fix to zero-indexing
     vector = ndim - vector;
 
-    for(int i=0; i < natoms; i++ ){
-        CPoint pos = p_crd->Restart.GetPosition(i);
-        for(int j=0; j < 3; j++){
-            CrdHelper[i*3+j] = pos[j] - RefHelper[i*3+j];
-        }
-    }
+    LoadDisplacement(p_crd);
+
     double proj = 0;
     for(int i=0; i < ndim; i++ ){
         proj += CrdHelper[i]*Matrix[i][vector];
@@ -323,17 +713,9 @@ void QCovarMatrix::filterSnapshot(QObject* p_qsnap,int vector1,int vector2)
         return;
     }
 
-    int natoms = p_crd->Restart.GetNumberOfAtoms();
+    if( CheckSnapshot(p_crd,"CovarMatrix::filterSnapshot(crd,vect1,vect2)") == false ) return;
     int ndim = GetDimension();
 
-    if( ndim != 3*natoms ){
-        CSmallString error;
-        error << "CovarMatrix::filterSnapshot(crd,vect1,vect2) - inconsistent dimensions, crd (";
-        error << 3*natoms << "), matrix (" << ndim << ")";
-        context()->throwError(QString(error));
-        return;
-    }
-
     int nvecs = GetNumOfVectors();
     if( (vector1 < 1) || (vector1 > nvecs) ){
         CSmallString error;
@@ -362,12 +744,7 @@ void QCovarMatrix::filterSnapshot(QObject* p_qsnap,int vector1,int vector2)
     vector1 = ndim - vector1;
     vector2 = ndim - vector2;
 
-    for(int i=0; i < natoms; i++ ){
-        CPoint pos = p_crd->Restart.GetPosition(i);
-        for(int j=0; j < 3; j++){
-            CrdHelper[i*3+j] = pos[j] - RefHelper[i*3+j];
-        }
-    }
+    LoadDisplacement(p_crd);
 
     // calculate projections
     vector<double> projections;
@@ -381,19 +758,21 @@ void QCovarMatrix::filterSnapshot(QObject* p_qsnap,int vector1,int vector2)
 
     for(int i=0; i < ndim; i++ ){
         int proji = 0;
-        CrdHelper[i] = RefHelper[i];
+        double disp = 0.0;
         for(int vect = vector2; vect <= vector1; vect++){
-            CrdHelper[i] +=  projections[proji]*Matrix[i][vect];
+            disp +=  projections[proji]*Matrix[i][vect];
             proji++;
         }
+        CrdHelper[i] = RefHelper[i] + disp/Weights[i/3];
     }
 
-    for(int i=0; i < natoms; i++ ){
+    // atoms not included in PCA are kept untouched
+    for(size_t i=0; i < AtomMap.size(); i++ ){
         CPoint pos;
         for(int j=0; j < 3; j++){
             pos[j] = CrdHelper[i*3+j];
         }
-        p_crd->Restart.SetPosition(i,pos);
+        p_crd->Restart.SetPosition(AtomMap[i],pos);
     }
 
 }
@@ -417,17 +796,9 @@ void QCovarMatrix::updateSnapshot(QObject* p_qsnap,int vector,double proj)
         return;
     }
 
-    int natoms = p_crd->Restart.GetNumberOfAtoms();
+    if( CheckSnapshot(p_crd,"CovarMatrix::updateSnapshot(crd,vector,proj)") == false ) return;
     int ndim = GetDimension();
 
-    if( ndim != 3*natoms ){
-        CSmallString error;
-        error << "CovarMatrix::updateSnapshot(crd,vector,proj) - inconsistent dimensions, crd (";
-        error << 3*natoms << "), matrix (" << ndim << ")";
-        context()->throwError(QString(error));
-        return;
-    }
-
     int nvecs = GetNumOfVectors();
 
     if( (vector < 1) || (vector > nvecs) ){
@@ -442,15 +813,15 @@ void QCovarMatrix::updateSnapshot(QObject* p_qsnap,int vector,double proj)
     vector = ndim - vector;
 
     for(int i=0; i < ndim; i++ ){
-        CrdHelper[i] = RefHelper[i] + proj*Matrix[i][vector];
+        CrdHelper[i] = RefHelper[i] + proj*Matrix[i][vector]/Weights[i/3];
     }
 
-    for(int i=0; i < natoms; i++ ){
-        CPoint pos = p_crd->Restart.GetPosition(i);
+    for(size_t i=0; i < AtomMap.size(); i++ ){
+        CPoint pos = p_crd->Restart.GetPosition(AtomMap[i]);
         for(int j=0; j < 3; j++){
             pos[j] += CrdHelper[i*3+j];
         }
-        p_crd->Restart.SetPosition(i,pos);
+        p_crd->Restart.SetPosition(AtomMap[i],pos);
     }
 }
 
@@ -670,12 +1041,52 @@ bool QCovarMatrix::LoadAll(std::istream& vin)
     int ndim, nvec, nsamples;
     vin >> ndim >> nvec >> nsamples;
 
-    NumOfSamples = nsamples;
-    NumOfVectors = nvec;
+    // optional atom map -------------------------
+    std::vector<int>    map;
+    std::vector<double> weights;
+    bool                massweighted = false;
+
+    found = false;
+    while( vin ){
+        getline(vin,line);
+        if( line.empty() ) continue;
+        if( line == "[reference]" ) found = true;
+        break;
+    }
+    if( line == "[map]" ){
+        int nmap = 0, mw = 0;
+        vin >> nmap >> mw;
+        massweighted = mw != 0;
+        if( (nmap <= 0) || (nmap > NumOfAtoms) ){
+            CSmallString error;
+            error << "illegal number of mapped atoms (" << nmap << "), natoms (" << NumOfAtoms << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+        map.resize(nmap);
+        weights.resize(nmap);
+        for(int i=0; i < nmap; i++){
+            vin >> map[i] >> weights[i];
+            map[i]--;
+            if( (map[i] < 0) || (map[i] >= NumOfAtoms) || (weights[i] <= 0.0) ){
+                CSmallString error;
+                error << "illegal map record " << i+1;
+                ES_ERROR(error);
+                return(false);
+            }
+        }
+    } else {
+        map.resize(NumOfAtoms);
+        weights.resize(NumOfAtoms);
+        for(int i=0; i < NumOfAtoms; i++){
+            map[i] = i;
+            weights[i] = 1.0;
+        }
+    }
 
-    if( ndim != GetDimension() ){
+    if( ndim != 3*(int)map.size() ){
         CSmallString error;
-        error << "dimensions mismatch: ndim (" << GetDimension() << "), ndim file (" << ndim << ")";
+        error << "dimensions mismatch: ndim (" << 3*map.size() << "), ndim file (" << ndim << ")";
         ES_ERROR(error);
         return(false);
     }
@@ -686,8 +1097,16 @@ bool QCovarMatrix::LoadAll(std::istream& vin)
         return(false);
     }
 
+    AtomMap = map;
+    Weights = weights;
+    MassWeighted = massweighted;
+    AllocateMatrix();
+
+    NumOfSamples = nsamples;
+    NumOfVectors = nvec;
+
     // load reference ----------------------------
-    while( vin ){
+    while( (found == false) && vin ){
         getline(vin,line);
         if( line == "[reference]" ){
             found = true;
@@ -739,6 +1158,16 @@ void QCovarMatrix::SaveAll(std::ostream& vout)
     vout << "[EDA]" << endl;
     vout << setw(6) << ndim << " " << setw(6) << nvec << " " << setw(8) << NumOfSamples << endl;
 
+    // atom map - only if PCA does not cover whole system
+    if( ((int)AtomMap.size() != NumOfAtoms) || MassWeighted ){
+        vout << "[map]" << endl;
+        vout << setw(6) << AtomMap.size() << " " << setw(1) << (MassWeighted ? 1 : 0) << endl;
+        vout << fixed << setprecision(9);
+        for(size_t i=0; i < AtomMap.size(); i++){
+            vout << setw(8) << AtomMap[i]+1 << " " << setw(16) << Weights[i] << endl;
+        }
+    }
+
     // reference structure
     vout << "[reference]" << endl;
     vout << fixed << setprecision(9);
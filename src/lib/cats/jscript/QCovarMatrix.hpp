@@ -28,10 +28,13 @@
 #include <FortranMatrix.hpp>
 #include <Vector.hpp>
 #include <QCATsScriptable.hpp>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
 class QTopology;
+class QSnapshot;
+class QSelection;
 
 //------------------------------------------------------------------------------
 
@@ -48,6 +51,7 @@ public:
 // properties ------------------------------------------------------------------
     Q_PROPERTY(int dimension READ GetDimension)
     Q_PROPERTY(int nvecs READ GetNumOfVectors)
+    Q_PROPERTY(int batchSize READ GetBatchSize WRITE SetBatchSize)
 
 // methods ---------------------------------------------------------------------
 public slots:
@@ -55,6 +59,12 @@ public slots:
     /// begin data accumulation
     void begin(QObject* p_qref);
 
+    /// begin data accumulation over selected atoms
+    void begin(QObject* p_qref,QObject* p_qsel);
+
+    /// begin data accumulation over selected atoms, mode can be "massweighted"
+    void begin(QObject* p_qref,QObject* p_qsel,const QString& mode);
+
     /// add sample
     void addSample(QObject* p_qcrd);
 
@@ -64,6 +74,9 @@ public slots:
     /// diagonalize matrix
     bool diagonalize(void);
 
+    /// calculate only nvectors eigenvectors with the largest eigenvalues
+    bool diagonalize(int nvectors);
+
 // projections -----------------------------------------------------------------
     /// project a snapshot to the essential vector
     double projectSnapshot(QObject* p_qsnap,int vector);
@@ -96,12 +109,18 @@ public slots:
 
 // access methods --------------------------------------------------------------
 public:
-    /// return the size of matrix
+    /// return the size of matrix (three times number of atoms in PCA)
     int  GetDimension(void) const;
 
     /// return number of eigenvectors
     int  GetNumOfVectors(void) const;
 
+    /// return number of samples accumulated before the matrix is updated
+    int  GetBatchSize(void) const;
+
+    /// set number of samples accumulated before the matrix is updated
+    void SetBatchSize(int size);
+
     /// save eigen values
     void SaveEigenValues(std::ostream& vout,int num);
 
@@ -120,6 +139,35 @@ private:
     int             NumOfVectors;   // number of calculated vectors
     CVector         RefHelper;
     CVector         CrdHelper;
+
+    // atoms included in PCA
+    int                 NumOfAtoms;     // number of atoms in topology
+    std::vector<int>    AtomMap;        // matrix atom -> topology atom
+    std::vector<double> Weights;        // sqrt(mass) or one
+    bool                MassWeighted;
+
+    /// start sampling with given atom map, masses are taken from the reference
+    bool BeginSampling(QSnapshot* p_ref,QSelection* p_sel,bool massweighted);
+
+    /// allocate matrix and helpers for current atom map
+    void AllocateMatrix(void);
+
+    /// check if the snapshot has the same number of atoms as topology
+    bool CheckSnapshot(QSnapshot* p_crd,const char* p_usage);
+
+    /// fill CrdHelper by weighted displacement of mapped atoms from the reference
+    void LoadDisplacement(QSnapshot* p_crd);
+
+    /// calculate largest eigenpairs by subspace iteration
+    bool DiagonalizePartial(int nvectors);
+
+    // batched samples - the matrix is updated by rank-k update of its upper triangle
+    int                 BatchSize;
+    int                 NumOfBatched;
+    std::vector<double> Batch;          // sample displacements, one sample after another
+
+    /// add batched samples to the upper triangle of the matrix
+    void FlushBatch(void);
 };
 
 //------------------------------------------------------------------------------
@@ -134,7 +134,7 @@ QScriptValue QCurvesP::analyze(void)
     WorkDir = CFileName(tmp_dir.path());
 	
     // write input data
-    if( WriteInputData(p_qsnap,p_qsel) == false ){
+    if( WriteInputData(p_qsnap,p_qsel,"QCurvesP") == false ){
         CSmallString error;
         error << "unable to write an input data into the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -148,7 +148,7 @@ QScriptValue QCurvesP::analyze(void)
     }
 
     // parse output data
-    if( ParseOutputData() == false ){
+    if( ParseOutputData("QCurvesP") == false ){
         CSmallString error;
         error << "unable to parse output, temporary data were left in the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -164,6 +164,299 @@ QScriptValue QCurvesP::analyze(void)
 //------------------------------------------------------------------------------
 //==============================================================================
 
+QScriptValue QCurvesP::setNumOfWorkers(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: CurvesP::setNumOfWorkers(n)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("n",1);
+    if( value.isError() ) return(value);
+
+    int n;
+    value = GetArgAsInt("n","n",1,n);
+    if( value.isError() ) return(value);
+
+    if( n <= 0 ){
+        return( ThrowError("n","number of workers must be greater than zero") );
+    }
+    if( Queue.size() > 0 ){
+        return( ThrowError("n","number of workers cannot be changed when snapshots are queued") );
+    }
+
+// execute ---------------------------------------
+    Workers.SetNumberOfWorkers(n);
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::getNumOfWorkers(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int CurvesP::getNumOfWorkers()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(Workers.GetNumberOfWorkers());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::queue(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int CurvesP::queue(snapshot[,selection])" << endl;
+        sout << "       the snapshot is analyzed later by analyzeQueue()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot[,selection]",1,2);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qsnap = NULL;
+    value = GetArgAsObject<QSnapshot*>("snapshot[,selection]","snapshot","Snapshot",1,p_qsnap);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel = NULL;
+    if( GetArgumentCount() > 1 ){
+        value = GetArgAsObject<QSelection*>("snapshot,selection","selection","Selection",2,p_qsel);
+        if( value.isError() ) return(value);
+    }
+
+// queue snapshot --------------------------------
+    if( Workers.InitWorkDirs("curvesp") == false ){
+        return( ThrowError("snapshot[,selection]","unable to create working directories") );
+    }
+
+    int frame = Queue.size();
+    WorkDir = Workers.GetWorkDir(Workers.GetFrameWorker(frame));
+
+    // coordinates are written immediately, current results are kept
+    CCurvesPFrame data;
+    data.ResIDMap.swap(ResIDMap);
+    bool result = WriteInputData(p_qsnap,p_qsel,CNABatchWorkers::GetFrameName(frame));
+    data.ResIDMap.swap(ResIDMap);
+
+    if( result == false ){
+        CSmallString error;
+        error << "unable to write an input data into the working directory: " << WorkDir;
+        return( ThrowError("snapshot[,selection]",error) );
+    }
+
+    Queue.push_back(data);
+    return(frame);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::getNumOfQueued(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int CurvesP::getNumOfQueued()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return((int)Queue.size());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::analyzeQueue(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int CurvesP::analyzeQueue()" << endl;
+        sout << "       results are accessible via selectResult(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// do Curves+ analysis ----------------------------
+    int nframes = Queue.size();
+    Results.clear();
+    ClearAll();
+    if( nframes == 0 ) return(0);
+
+    // base pairs of all frames are found first
+    int nworkers = Workers.GetNumberOfWorkers();
+    std::vector<CSmallString> commands(nworkers);
+    bool result = true;
+    for(int w=0; w < nworkers; w++){
+        int count = Workers.WriteFrameList(w,nframes);
+        if( count < 0 ){
+            result = false;
+            break;
+        }
+        if( count == 0 ) continue;
+        commands[w] << "while read f; do find_pair $f.pdb $f.fp >> find_pair.stdout 2>&1 || exit 1; done < frames.lst";
+    }
+
+    if( result == true ){
+        result = Workers.RunCommands(commands);
+    }
+
+    // then each worker gets one Cur+ input with namelists of all its frames
+    std::vector<ofstream*> inputs(nworkers,(ofstream*)NULL);
+    for(int w=0; (result == true) && (w < nworkers); w++){
+        if( commands[w] == NULL ) continue;
+        CFileName fileName = Workers.GetWorkDir(w) / "QCurvesP.inp";
+        inputs[w] = new ofstream(fileName);
+        if( inputs[w]->fail() ){
+            CSmallString error;
+            error << "unable to create Cur+ input file " << fileName;
+            error << " (" << strerror(errno) << ")";
+            ES_ERROR(error);
+            result = false;
+        }
+    }
+
+    Results.resize(nframes);
+    for(int frame=0; (result == true) && (frame < nframes); frame++){
+        CSmallString job = CNABatchWorkers::GetFrameName(frame);
+        int worker = Workers.GetFrameWorker(frame);
+        WorkDir = Workers.GetWorkDir(worker);
+
+        ClearAll();
+        ResIDMap.swap(Queue[frame].ResIDMap);
+        result = ParseFindPairOutputData(job) && WriteCurvesInput(*inputs[worker],job);
+        SwapFrame(Results[frame]);
+    }
+
+    for(int w=0; w < nworkers; w++){
+        if( inputs[w] != NULL ){
+            inputs[w]->close();
+            if( inputs[w]->fail() ) result = false;
+            delete inputs[w];
+        }
+        if( commands[w] == NULL ) continue;
+        commands[w] = "Cur+ < QCurvesP.inp > QCurvesP.stdout 2>&1";
+    }
+
+    if( result == true ){
+        result = Workers.RunCommands(commands);
+    }
+
+    // parse output data
+    for(int frame=0; (result == true) && (frame < nframes); frame++){
+        CSmallString job = CNABatchWorkers::GetFrameName(frame);
+        WorkDir = Workers.GetWorkDir(Workers.GetFrameWorker(frame));
+
+        ClearAll();
+        SwapFrame(Results[frame]);
+        result = ParseOutputData(job);
+        SwapFrame(Results[frame]);
+    }
+
+    if( result == false ){
+        CSmallString error;
+        error << "unable to run analysis, temporary data were left in the working directories: " << Workers.GetWorkDirList();
+        ClearAll();
+        Results.clear();
+        Workers.KeepWorkDirs();
+        Queue.clear();
+        return( ThrowError("",error) );
+    }
+
+    // working directories are reused by the next batch
+    Workers.CleanWorkDirs();
+    Queue.clear();
+
+    return(nframes);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::getNumOfResults(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int CurvesP::getNumOfResults()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return((int)Results.size());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QCurvesP::selectResult(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: CurvesP::selectResult(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("index",1);
+    if( value.isError() ) return(value);
+
+    int index;
+    value = GetArgAsInt("index","index",1,index);
+    if( value.isError() ) return(value);
+
+    if( (index < 0) || (index >= (int)Results.size()) ){
+        CSmallString error;
+        error << "index " << index << " is out-of-range <0;" << (int)Results.size()-1 << ">";
+        return( ThrowError("index", error) );
+    }
+
+// execute ---------------------------------------
+    LoadFrame(Results[index]);
+    return(value);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 QScriptValue QCurvesP::getNumOfBasePairs(void)
 {
     QScriptValue value;
@@ -318,12 +611,34 @@ void QCurvesP::ClearAll(void)
 
 //------------------------------------------------------------------------------
 
-bool QCurvesP::WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel)
+void QCurvesP::SwapFrame(CCurvesPFrame& frame)
+{
+    ResIDMap.swap(frame.ResIDMap);
+    BPIDs.swap(frame.BPIDs);
+    BPPar.swap(frame.BPPar);
+    HelAxisPositions.swap(frame.HelAxisPositions);
+}
+
+//------------------------------------------------------------------------------
+
+void QCurvesP::LoadFrame(const CCurvesPFrame& frame)
+{
+    ResIDMap = frame.ResIDMap;
+    BPIDs = frame.BPIDs;
+    BPPar = frame.BPPar;
+    HelAxisPositions = frame.HelAxisPositions;
+}
+
+//------------------------------------------------------------------------------
+
+bool QCurvesP::WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel,const CSmallString& job)
 {
 // create PDB file -------------------------------
     // open output file
     FILE* p_fout;
-    CFileName fileName = WorkDir / "QCurvesP.pdb";   // / - is overloaded operator - it merges two strings by path delimiter (/)
+    CSmallString name;
+    name << job << ".pdb";
+    CFileName fileName = WorkDir / CFileName(name);   // / - is overloaded operator - it merges two strings by path delimiter (/)
     if( (p_fout = fopen(fileName,"w")) == NULL ) {
         CSmallString error;
         error << "unable to open output file " << fileName;
@@ -403,7 +718,7 @@ bool QCurvesP::RunAnalysis(void)
         return(false);
     }
 
-    if( ParseFindPairOutputData() == false ){
+    if( ParseFindPairOutputData("QCurvesP") == false ){
         return(false);
     }
 
@@ -412,25 +727,7 @@ bool QCurvesP::RunAnalysis(void)
 
     CFileName fileName = WorkDir / "QCurvesP.inp";
     ofs.open( fileName );
-    ofs << " &inp" << endl;
-    ofs << " file=QCurvesP.pdb," << endl;
-    ofs << " lis=QCurvesP," << endl;
-    ofs << " fit=.t.," << endl;
-    ofs << " lib=" << getenv("CURVES_HOME") << "/standard," << endl;
-    ofs << " isym=1," << endl;
-    ofs << " test=.t.," << endl;
-    ofs << " &end" << endl;
-    ofs << " 2 1 -1 0 0" << endl;
-    for(size_t i=0; i < BPIDs.size(); i++){
-        CNABPID bpid = BPIDs[i];
-        ofs << " " << bpid.ResIDA+1;
-    }
-    ofs << endl;
-    for(size_t i=0; i < BPIDs.size(); i++){
-        CNABPID bpid = BPIDs[i];
-        ofs << " " << bpid.ResIDB+1;
-    }
-    ofs << endl;
+    WriteCurvesInput(ofs,"QCurvesP");
 
     if( ofs.fail() ) {
         CSmallString error;
@@ -459,13 +756,42 @@ bool QCurvesP::RunAnalysis(void)
 
 //------------------------------------------------------------------------------
 
-bool QCurvesP::ParseFindPairOutputData(void)
+bool QCurvesP::WriteCurvesInput(std::ofstream& ofs,const CSmallString& job)
+{
+    ofs << " &inp" << endl;
+    ofs << " file=" << job << ".pdb," << endl;
+    ofs << " lis=" << job << "," << endl;
+    ofs << " fit=.t.," << endl;
+    ofs << " lib=" << getenv("CURVES_HOME") << "/standard," << endl;
+    ofs << " isym=1," << endl;
+    ofs << " test=.t.," << endl;
+    ofs << " &end" << endl;
+    ofs << " 2 1 -1 0 0" << endl;
+    for(size_t i=0; i < BPIDs.size(); i++){
+        CNABPID bpid = BPIDs[i];
+        ofs << " " << bpid.ResIDA+1;
+    }
+    ofs << endl;
+    for(size_t i=0; i < BPIDs.size(); i++){
+        CNABPID bpid = BPIDs[i];
+        ofs << " " << bpid.ResIDB+1;
+    }
+    ofs << endl;
+
+    return( ! ofs.fail() );
+}
+
+//------------------------------------------------------------------------------
+
+bool QCurvesP::ParseFindPairOutputData(const CSmallString& job)
 {
     ifstream ifs;
 
 // parse BP indexes -----------------------------------
     // open file
-    CFileName fileName = WorkDir / "QCurvesP.fp";
+    CSmallString name;
+    name << job << ".fp";
+    CFileName fileName = WorkDir / CFileName(name);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
@@ -492,7 +818,7 @@ bool QCurvesP::ParseFindPairOutputData(void)
 
 //------------------------------------------------------------------------------
 
-bool QCurvesP::ParseOutputData(void)
+bool QCurvesP::ParseOutputData(const CSmallString& job)
 {
     ifstream    ifs;
     CFileName   fileName;
@@ -500,7 +826,9 @@ bool QCurvesP::ParseOutputData(void)
 // parse BP  -----------------------------------
 
     // open file
-    fileName = WorkDir / "QCurvesP.lis";
+    CSmallString name;
+    name << job << ".lis";
+    fileName = WorkDir / CFileName(name);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
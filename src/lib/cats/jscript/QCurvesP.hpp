@@ -33,11 +33,24 @@
 #include <QSelection.hpp>
 #include <FileName.hpp>
 #include <QNAHelper.hpp>
+#include <QNABatch.hpp>
 #include <Point.hpp>
 #include <map>
 
 //------------------------------------------------------------------------------
 
+/// results of one frame analyzed in the batch mode
+
+class CATS_PACKAGE CCurvesPFrame {
+public:
+    std::map<int,int>           ResIDMap;
+    std::map<int,CNABPID>       BPIDs;
+    std::vector<CNABPPar>       BPPar;
+    std::vector<CPoint>         HelAxisPositions;
+};
+
+//------------------------------------------------------------------------------
+
 /// interface to Curves+
 
 class CATS_PACKAGE QCurvesP : public QObject, protected QScriptable, protected QCATsScriptable {
@@ -57,6 +70,36 @@ public slots:
     /// analyze(snapshot[,selection])
     QScriptValue analyze(void);
 
+// batch mode ------------------------------------------------------------------
+    /// set number of concurrent workers used by analyzeQueue()
+    /// setNumOfWorkers(n)
+    QScriptValue setNumOfWorkers(void);
+
+    /// get number of concurrent workers
+    /// int getNumOfWorkers()
+    QScriptValue getNumOfWorkers(void);
+
+    /// queue snapshot for the batch analysis, return index of the queued frame
+    /// int queue(snapshot[,selection])
+    QScriptValue queue(void);
+
+    /// get number of queued snapshots
+    /// int getNumOfQueued()
+    QScriptValue getNumOfQueued(void);
+
+    /// analyze all queued snapshots by single run of Cur+ per worker
+    /// int analyzeQueue()
+    QScriptValue analyzeQueue(void);
+
+    /// get number of frames analyzed by the last analyzeQueue()
+    /// int getNumOfResults()
+    QScriptValue getNumOfResults(void);
+
+    /// make results of the analyzed frame current
+    /// selectResult(index)
+    QScriptValue selectResult(void);
+
+// results ---------------------------------------------------------------------
     /// get number of base pairs
     /// int getNumOfBasePairs()
     QScriptValue getNumOfBasePairs(void);
@@ -91,20 +134,34 @@ private:
     std::vector<CNABPPar>       BPPar;
     std::vector<CPoint>         HelAxisPositions;
 
+    // batch mode
+    CNABatchWorkers             Workers;
+    std::vector<CCurvesPFrame>  Queue;              // residue maps of queued frames
+    std::vector<CCurvesPFrame>  Results;            // frames analyzed by analyzeQueue()
+
     /// clear all parsed results
     void ClearAll(void);
 
-    /// create input data
-    bool WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel);
+    /// create input data, job is the base name of files in WorkDir
+    bool WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel,const CSmallString& job);
 
     /// run analysis
     bool RunAnalysis(void);
 
     /// parse find_pairs output data
-    bool ParseFindPairOutputData(void);
+    bool ParseFindPairOutputData(const CSmallString& job);
+
+    /// write Cur+ namelist for the job
+    bool WriteCurvesInput(std::ofstream& ofs,const CSmallString& job);
 
     /// parse output data
-    bool ParseOutputData(void);
+    bool ParseOutputData(const CSmallString& job);
+
+    /// exchange current results with the frame
+    void SwapFrame(CCurvesPFrame& frame);
+
+    /// make frame results current
+    void LoadFrame(const CCurvesPFrame& frame);
 
     /// create PDB file from QSnapshot
     bool WritePDB(CAmberTopology* p_top,CAmberRestart* p_crd,CAmberMaskAtoms* p_mask,FILE* p_fout);
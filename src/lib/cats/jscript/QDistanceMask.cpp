@@ -0,0 +1,430 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <iostream>
+#include <QScriptEngine>
+#include <QDistanceMask.hpp>
+#include <moc_QDistanceMask.cpp>
+#include <QTopology.hpp>
+#include <QSnapshot.hpp>
+#include <QSelection.hpp>
+#include <TerminalStr.hpp>
+#include <CellGrid.hpp>
+#include <algorithm>
+#include <stdio.h>
+#include <math.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void QDistanceMask::Register(QScriptEngine& engine)
+{
+    QScriptValue ctor = engine.newFunction(QDistanceMask::New);
+    QScriptValue metaObject = engine.newQMetaObject(&QDistanceMask::staticMetaObject, ctor);
+    engine.globalObject().setProperty("DistanceMask", metaObject);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::New(QScriptContext *context,QScriptEngine *engine)
+{
+    QCATsScriptable scriptable("DistanceMask");
+    QScriptValue    value;
+
+// print help ------------------------------------
+    if( scriptable.IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "DistanceMask object" << endl;
+        sout << endl;
+        sout << "Constructors:" << endl;
+        sout << "   new DistanceMask(topology,target,reference,cutoff[,skin])" << endl;
+        sout << endl;
+        sout << "Selects target atoms that are closer than cutoff to any reference atom." << endl;
+        sout << "Both masks are parsed only once and they cannot contain distance operators." << endl;
+        sout << "The pair list is rebuilt when some atom moves more than skin/2 (default skin is 2.0 A)." << endl;
+        return(scriptable.GetUndefinedValue());
+    }
+
+// check arguments -------------------------------
+    value = scriptable.IsCalledAsConstructor();
+    if( value.isError() ) return(value);
+
+    QString args = "topology,target,reference,cutoff[,skin]";
+
+    value = scriptable.CheckNumberOfArguments(args,4,5);
+    if( value.isError() ) return(value);
+
+    QTopology* p_qtop;
+    value = scriptable.GetArgAsObject<QTopology*>(args,"topology","Topology",1,p_qtop);
+    if( value.isError() ) return(value);
+
+    QString target;
+    value = scriptable.GetArgAsString(args,"target",2,target);
+    if( value.isError() ) return(value);
+
+    QString reference;
+    value = scriptable.GetArgAsString(args,"reference",3,reference);
+    if( value.isError() ) return(value);
+
+    double cutoff;
+    value = scriptable.GetArgAsRNumber(args,"cutoff",4,cutoff);
+    if( value.isError() ) return(value);
+    if( cutoff <= 0.0 ){
+        return( scriptable.ThrowError(args,"cutoff must be greater than zero") );
+    }
+
+    double skin = 2.0;
+    if( context->argumentCount() == 5 ){
+        value = scriptable.GetArgAsRNumber(args,"skin",5,skin);
+        if( value.isError() ) return(value);
+        if( skin < 0.0 ){
+            return( scriptable.ThrowError(args,"skin must not be negative") );
+        }
+    }
+
+// execute ---------------------------------------
+    QDistanceMask* p_qmask = new QDistanceMask(scriptable.GetArgument(1));
+    p_qmask->Cutoff = cutoff;
+    p_qmask->Skin = skin;
+
+    if( p_qmask->CompileMasks(target,reference) == false ){
+        delete p_qmask;
+        return( scriptable.ThrowError(args,"unable to setup target or reference mask") );
+    }
+
+    return engine->newQObject(p_qmask, QScriptEngine::ScriptOwnership);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+QDistanceMask::QDistanceMask(const QScriptValue& top)
+    : QCATsScriptable("DistanceMask")
+{
+    RegisterAsWeakObject(top);
+    TargetMask.AssignTopology(&GetQTopology()->Topology);
+    ReferenceMask.AssignTopology(&GetQTopology()->Topology);
+    Cutoff = 0.0;
+    Skin = 0.0;
+    NumOfRebuilds = 0;
+    PairsValid = false;
+}
+
+//------------------------------------------------------------------------------
+
+void QDistanceMask::CleanData(void)
+{
+    TargetMask.Reset();
+    ReferenceMask.Reset();
+    TargetAtoms.clear();
+    ReferenceAtoms.clear();
+    PairsValid = false;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+QScriptValue QDistanceMask::getTopology(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: topology DistanceMask::getTopology()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(JSTopology);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::update(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int DistanceMask::update(snapshot,selection)" << endl;
+        sout << "note:  the selection is set to target atoms within cutoff from reference atoms," << endl;
+        sout << "       the number of selected atoms is returned" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot,selection",2);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qsnap;
+    value = GetArgAsObject<QSnapshot*>("snapshot,selection","snapshot","Snapshot",1,p_qsnap);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel;
+    value = GetArgAsObject<QSelection*>("snapshot,selection","selection","Selection",2,p_qsel);
+    if( value.isError() ) return(value);
+
+    if( TargetMask.GetNumberOfTopologyAtoms() != p_qsnap->Restart.GetNumberOfAtoms() ){
+        return( ThrowError("snapshot,selection","snapshot and distance mask do not have the same number of atoms") );
+    }
+    if( p_qsel->Mask.GetNumberOfTopologyAtoms() != TargetMask.GetNumberOfTopologyAtoms() ){
+        return( ThrowError("snapshot,selection","selection and distance mask do not have the same number of atoms") );
+    }
+
+// execute ---------------------------------------
+    if( (PairsValid == false) || (ArePairsValid(p_qsnap) == false) ){
+        BuildPairs(p_qsnap);
+    }
+
+    // only pairs within cutoff+skin are tested
+    std::vector<int>    selected;
+    std::vector<bool>   flags(TargetAtoms.size(),false);
+    double              cutoff2 = Cutoff*Cutoff;
+
+    for(size_t p=0; p < PairTargets.size(); p++){
+        int t = PairTargets[p];
+        if( flags[t] ) continue;
+        CPoint dv = p_qsnap->Restart.GetPosition(TargetAtoms[t])
+                  - p_qsnap->Restart.GetPosition(ReferenceAtoms[PairReferences[p]]);
+        if( Square(dv) < cutoff2 ){
+            flags[t] = true;
+            selected.push_back(t);
+        }
+    }
+
+    // target atoms are in ascending order
+    std::sort(selected.begin(),selected.end());
+    for(size_t i=0; i < selected.size(); i++){
+        selected[i] = TargetAtoms[selected[i]];
+    }
+
+    if( p_qsel->SetByIndexes(selected) == false ){
+        return( ThrowError("snapshot,selection","unable to set selection") );
+    }
+
+    return( (int)selected.size() );
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::getCutoff(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double DistanceMask::getCutoff()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(Cutoff);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::getSkin(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double DistanceMask::getSkin()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(Skin);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::getNumOfRebuilds(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int DistanceMask::getNumOfRebuilds()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(NumOfRebuilds);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QDistanceMask::printInfo(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: DistanceMask::printInfo()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    cout << "=== Distance mask" << endl;
+    cout << "# Target mask             : " << TargetMask.GetMask() << endl;
+    cout << "# Number of target atoms  : " << TargetAtoms.size() << endl;
+    cout << "# Reference mask          : " << ReferenceMask.GetMask() << endl;
+    cout << "# Number of ref. atoms    : " << ReferenceAtoms.size() << endl;
+    cout << "# Cutoff [A]              : " << Cutoff << endl;
+    cout << "# Skin [A]                : " << Skin << endl;
+    cout << "# Number of pairs         : " << PairTargets.size() << endl;
+    cout << "# Number of rebuilds      : " << NumOfRebuilds << endl;
+
+    return(value);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool QDistanceMask::CompileMasks(const QString& target,const QString& reference)
+{
+    if( TargetMask.SetMask(target.toLatin1().constData()) == false ) return(false);
+    if( ReferenceMask.SetMask(reference.toLatin1().constData()) == false ) return(false);
+
+    TargetAtoms.resize(TargetMask.GetNumberOfSelectedAtoms());
+    for(size_t i=0; i < TargetAtoms.size(); i++){
+        TargetAtoms[i] = TargetMask.GetSelectedAtomCondensed(i)->GetAtomIndex();
+    }
+    ReferenceAtoms.resize(ReferenceMask.GetNumberOfSelectedAtoms());
+    for(size_t i=0; i < ReferenceAtoms.size(); i++){
+        ReferenceAtoms[i] = ReferenceMask.GetSelectedAtomCondensed(i)->GetAtomIndex();
+    }
+
+    PairsValid = false;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool QDistanceMask::ArePairsValid(QSnapshot* p_qsnap)
+{
+    // pairs closer than cutoff cannot be missed if no atom moved more than skin/2
+    double limit2 = 0.25*Skin*Skin;
+
+    for(size_t i=0; i < TargetAtoms.size(); i++){
+        CPoint dv = p_qsnap->Restart.GetPosition(TargetAtoms[i]) - TargetPositions[i];
+        if( Square(dv) > limit2 ) return(false);
+    }
+    for(size_t i=0; i < ReferenceAtoms.size(); i++){
+        CPoint dv = p_qsnap->Restart.GetPosition(ReferenceAtoms[i]) - ReferencePositions[i];
+        if( Square(dv) > limit2 ) return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void QDistanceMask::BuildPairs(QSnapshot* p_qsnap)
+{
+    NumOfRebuilds++;
+    PairsValid = true;
+    PairTargets.clear();
+    PairReferences.clear();
+
+    int ntargets = TargetAtoms.size();
+    TargetPositions.resize(ntargets);
+    for(int i=0; i < ntargets; i++){
+        TargetPositions[i] = p_qsnap->Restart.GetPosition(TargetAtoms[i]);
+    }
+    ReferencePositions.resize(ReferenceAtoms.size());
+    for(size_t i=0; i < ReferenceAtoms.size(); i++){
+        ReferencePositions[i] = p_qsnap->Restart.GetPosition(ReferenceAtoms[i]);
+    }
+
+    if( (ntargets == 0) || (ReferenceAtoms.size() == 0) ) return;
+
+    // cell list of target atoms, pairs are in the same or adjacent cells
+    double rlist = Cutoff + Skin;
+    CCellGrid grid;
+    grid.Setup(TargetPositions,rlist);
+
+    const std::vector<int>& cellstart = grid.GetCellStart();
+    const std::vector<int>& cellatoms = grid.GetCellPoints();
+    int nx = grid.GetNX();
+    int ny = grid.GetNY();
+    int nz = grid.GetNZ();
+
+    // reference atoms outside of the grid have no neighbour cells
+    double rlist2 = rlist*rlist;
+    for(size_t r=0; r < ReferencePositions.size(); r++){
+        const CPoint& pr = ReferencePositions[r];
+        int cx,cy,cz;
+        grid.GetCell(pr,cx,cy,cz);
+        for(int z=std::max(cz-1,0); z <= std::min(cz+1,nz-1); z++){
+            for(int y=std::max(cy-1,0); y <= std::min(cy+1,ny-1); y++){
+                for(int x=std::max(cx-1,0); x <= std::min(cx+1,nx-1); x++){
+                    int c = (z*ny + y)*nx + x;
+                    for(int k=cellstart[c]; k < cellstart[c+1]; k++){
+                        int t = cellatoms[k];
+                        CPoint dv = TargetPositions[t] - pr;
+                        if( Square(dv) >= rlist2 ) continue;
+                        PairTargets.push_back(t);
+                        PairReferences.push_back(r);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
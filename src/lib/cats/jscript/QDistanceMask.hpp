@@ -0,0 +1,114 @@
+#ifndef QDistanceMaskH
+#define QDistanceMaskH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <QObject>
+#include <QScriptValue>
+#include <QScriptable>
+#include <QCATsScriptable.hpp>
+#include <QTopology.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <Point.hpp>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+class QSnapshot;
+
+//------------------------------------------------------------------------------
+
+/// compiled distance selection - target atoms within cutoff of reference atoms
+/// both masks are parsed only once, pairs within cutoff+skin are found by cell list
+/// and they are reused until some atom moves more than half of skin
+
+class CATS_PACKAGE QDistanceMask : public QTopologyObject, protected QScriptable, protected QCATsScriptable {
+    Q_OBJECT
+public:
+// constructor -----------------------------------------------------------------
+    QDistanceMask(const QScriptValue& top);
+    static QScriptValue New(QScriptContext *context,QScriptEngine *engine);
+    static void Register(QScriptEngine& engine);
+
+// properties ------------------------------------------------------------------
+    Q_PROPERTY(QScriptValue cutoff          READ getCutoff WRITE setIsNotAllowed)
+    Q_PROPERTY(QScriptValue skin            READ getSkin WRITE setIsNotAllowed)
+    Q_PROPERTY(QScriptValue numOfRebuilds   READ getNumOfRebuilds WRITE setIsNotAllowed)
+
+// methods ---------------------------------------------------------------------
+public slots:
+    /// get topology
+    QScriptValue getTopology(void);
+
+    /// select target atoms within cutoff from reference atoms
+    /// int update(snapshot,selection)
+    QScriptValue update(void);
+
+    /// get distance cutoff
+    /// double getCutoff()
+    QScriptValue getCutoff(void);
+
+    /// get skin distance
+    /// double getSkin()
+    QScriptValue getSkin(void);
+
+    /// get number of pair list rebuilds
+    /// int getNumOfRebuilds()
+    QScriptValue getNumOfRebuilds(void);
+
+    /// print info about distance mask
+    QScriptValue printInfo(void);
+
+// section of private data -----------------------------------------------------
+private:
+    CAmberMaskAtoms     TargetMask;
+    CAmberMaskAtoms     ReferenceMask;
+    double              Cutoff;
+    double              Skin;
+    int                 NumOfRebuilds;
+
+    // compiled masks
+    std::vector<int>    TargetAtoms;
+    std::vector<int>    ReferenceAtoms;
+
+    // pair list within cutoff+skin
+    bool                PairsValid;
+    std::vector<int>    PairTargets;    // index to TargetAtoms
+    std::vector<int>    PairReferences; // index to ReferenceAtoms
+    std::vector<CPoint> TargetPositions;    // positions at pair list build
+    std::vector<CPoint> ReferencePositions;
+
+    /// parse masks and collect atom indexes
+    bool CompileMasks(const QString& target,const QString& reference);
+
+    /// is pair list still valid for the snapshot?
+    bool ArePairsValid(QSnapshot* p_qsnap);
+
+    /// find pairs within cutoff+skin
+    void BuildPairs(QSnapshot* p_qsnap);
+
+    /// clear object data if topology is cleaned - only weak objects
+    virtual void CleanData(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,470 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2010 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <iostream>
+#include <QScriptEngine>
+#include <QFitContext.hpp>
+#include <moc_QFitContext.cpp>
+#include <QSnapshot.hpp>
+#include <QSelection.hpp>
+#include <QSimpleVector.hpp>
+#include <AmberAtom.hpp>
+#include <Transformation.hpp>
+#include <TerminalStr.hpp>
+#include <math.h>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void QFitContext::Register(QScriptEngine& engine)
+{
+    QScriptValue ctor = engine.newFunction(QFitContext::New);
+    QScriptValue metaObject = engine.newQMetaObject(&QFitContext::staticMetaObject, ctor);
+    engine.globalObject().setProperty("FitContext", metaObject);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QFitContext::New(QScriptContext *context,
+                              QScriptEngine *engine)
+{
+    QCATsScriptable scriptable("FitContext");
+    QScriptValue    value;
+
+// print help ------------------------------------
+    if( scriptable.IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "FitContext object" << endl;
+        sout << endl;
+        sout << "Constructors:" << endl;
+        sout << "   new FitContext(snapshot[,selection][,nomass])" << endl;
+        return(scriptable.GetUndefinedValue());
+    }
+
+// check arguments -------------------------------
+    value = scriptable.IsCalledAsConstructor();
+    if( value.isError() ) return(value);
+
+    value = scriptable.CheckNumberOfArguments("snapshot[,selection][,nomass]",1,3);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qref = NULL;
+    value = scriptable.GetArgAsObject<QSnapshot*>("snapshot[,selection][,nomass]","snapshot","Snapshot",1,p_qref);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel = NULL;
+    scriptable.FindArgAsObject<QSelection*>("snapshot[,selection][,nomass]","Selection",p_qsel,false);
+
+    bool nomass = scriptable.IsArgumentKeySelected("nomass");
+
+    value = scriptable.CheckArgumentsUsage("snapshot[,selection][,nomass]");
+    if( value.isError() ) return(value);
+
+    if( p_qsel ){
+        if( p_qsel->Mask.GetNumberOfTopologyAtoms() != p_qref->Restart.GetNumberOfAtoms() ){
+            CSmallString error;
+            error << "number of atoms does not match, topology associated with selection ("
+                  << p_qsel->Mask.GetNumberOfTopologyAtoms() << "), reference snapshot (" << p_qref->Restart.GetNumberOfAtoms() << ")";
+            return( scriptable.ThrowError("snapshot[,selection][,nomass]",error) );
+        }
+    }
+
+// create object ---------------------------------
+    QFitContext* p_obj = new QFitContext();
+    p_obj->SetupAtoms(p_qref,p_qsel,nomass);
+
+    if( p_obj->TotalWeight < 0.01 ){
+        delete p_obj;
+        return( scriptable.ThrowError("snapshot[,selection][,nomass]","no atoms to fit, total mass is zero") );
+    }
+
+    p_obj->SetupReference(p_qref);
+
+    return(engine->newQObject(p_obj, QScriptEngine::ScriptOwnership));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+QFitContext::QFitContext(void)
+    : QCATsScriptable("FitContext")
+{
+    NumOfTopologyAtoms = 0;
+    TotalWeight = 0.0;
+    RefSquares = 0.0;
+    Quaternion[0] = 1.0;
+    Quaternion[1] = 0.0;
+    Quaternion[2] = 0.0;
+    Quaternion[3] = 0.0;
+    LastRMSD = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void QFitContext::SetupAtoms(QSnapshot* p_qref,QSelection* p_qsel,bool nomass)
+{
+    NumOfTopologyAtoms = p_qref->Restart.GetNumberOfAtoms();
+
+    int natoms = p_qsel ? p_qsel->Mask.GetNumberOfSelectedAtoms() : NumOfTopologyAtoms;
+    Indexes.resize(natoms);
+    Weights.resize(natoms);
+
+    TotalWeight = 0.0;
+    for(int s=0; s < natoms; s++){
+        int i = p_qsel ? p_qsel->Mask.GetSelectedAtomCondensed(s)->GetAtomIndex() : s;
+        Indexes[s] = i;
+        Weights[s] = nomass ? 1.0 : p_qref->Restart.GetMass(i);
+        TotalWeight += Weights[s];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void QFitContext::SetupReference(QSnapshot* p_qref)
+{
+    int natoms = Indexes.size();
+
+    RefX.resize(natoms);
+    RefY.resize(natoms);
+    RefZ.resize(natoms);
+
+    RefCOM = CPoint();
+    for(int s=0; s < natoms; s++){
+        const CPoint& pos = p_qref->Restart.GetPosition(Indexes[s]);
+        RefX[s] = pos.x;
+        RefY[s] = pos.y;
+        RefZ[s] = pos.z;
+        RefCOM += pos*Weights[s];
+    }
+    RefCOM /= TotalWeight;
+
+    RefSquares = 0.0;
+    for(int s=0; s < natoms; s++){
+        RefX[s] -= RefCOM.x;
+        RefY[s] -= RefCOM.y;
+        RefZ[s] -= RefCOM.z;
+        RefSquares += Weights[s]*(RefX[s]*RefX[s] + RefY[s]*RefY[s] + RefZ[s]*RefZ[s]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QFitContext::CheckSnapshot(const QString& args,QSnapshot* p_qsnap)
+{
+    if( p_qsnap->Restart.GetNumberOfAtoms() != NumOfTopologyAtoms ){
+        CSmallString error;
+        error << "number of atoms does not match, reference ("
+              << NumOfTopologyAtoms << "), target (" << p_qsnap->Restart.GetNumberOfAtoms() << ")";
+        return( ThrowError(args,error) );
+    }
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int QFitContext::GetNumOfAtoms(void)
+{
+    return(Indexes.size());
+}
+
+//------------------------------------------------------------------------------
+
+double QFitContext::GetRMSD(void)
+{
+    return(LastRMSD);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+QScriptValue QFitContext::setReference(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: FitContext::setReference(snapshot)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot",1);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qref = NULL;
+    value = GetArgAsObject<QSnapshot*>("snapshot","snapshot","Snapshot",1,p_qref);
+    if( value.isError() ) return(value);
+
+    value = CheckSnapshot("snapshot",p_qref);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    SetupReference(p_qref);
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QFitContext::fit(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double FitContext::fit(snapshot[,rmsdonly])" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot[,rmsdonly]",1,2);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qsnap = NULL;
+    value = GetArgAsObject<QSnapshot*>("snapshot[,rmsdonly]","snapshot","Snapshot",1,p_qsnap);
+    if( value.isError() ) return(value);
+
+    bool rmsdonly = IsArgumentKeySelected("rmsdonly");
+
+    value = CheckArgumentsUsage("snapshot[,rmsdonly]");
+    if( value.isError() ) return(value);
+
+    value = CheckSnapshot("snapshot[,rmsdonly]",p_qsnap);
+    if( value.isError() ) return(value);
+
+    if( ! rmsdonly ){
+        if( p_qsnap->Restart.IsBoxPresent() == true ){
+            return( ThrowError("snapshot[,rmsdonly]","target snapshot cannot contain box") );
+        }
+    }
+
+// execute ---------------------------------------
+    // single pass - the reference is centred, thus the correlation
+    // does not depend on the target COM
+    int     natoms = Indexes.size();
+    double  tx = 0.0, ty = 0.0, tz = 0.0, tss = 0.0;
+    double  xxyx = 0.0, xxyy = 0.0, xxyz = 0.0;
+    double  xyyx = 0.0, xyyy = 0.0, xyyz = 0.0;
+    double  xzyx = 0.0, xzyy = 0.0, xzyz = 0.0;
+
+    const int*      p_idx = &Indexes[0];
+    const double*   p_w = &Weights[0];
+    const double*   p_rx = &RefX[0];
+    const double*   p_ry = &RefY[0];
+    const double*   p_rz = &RefZ[0];
+
+    for(int s=0; s < natoms; s++){
+        const CPoint& pos = p_qsnap->Restart.GetPosition(p_idx[s]);
+        double w  = p_w[s];
+        double wx = w*pos.x;
+        double wy = w*pos.y;
+        double wz = w*pos.z;
+
+        tx  += wx;
+        ty  += wy;
+        tz  += wz;
+        tss += wx*pos.x + wy*pos.y + wz*pos.z;
+
+        xxyx += p_rx[s]*wx;
+        xxyy += p_rx[s]*wy;
+        xxyz += p_rx[s]*wz;
+        xyyx += p_ry[s]*wx;
+        xyyy += p_ry[s]*wy;
+        xyyz += p_ry[s]*wz;
+        xzyx += p_rz[s]*wx;
+        xzyy += p_rz[s]*wy;
+        xzyz += p_rz[s]*wz;
+    }
+
+    CPoint com(tx/TotalWeight,ty/TotalWeight,tz/TotalWeight);
+    tss -= TotalWeight*Square(com);
+
+// quadratic form matrix
+    CSimpleSquareMatrix<double,4>   helper;
+    double                          q[4];
+
+    helper.Field[0][0] = xxyx + xyyy + xzyz;
+
+    helper.Field[0][1] = xzyy - xyyz;
+    helper.Field[1][1] = xxyx - xyyy - xzyz;
+
+    helper.Field[0][2] = xxyz - xzyx;
+    helper.Field[1][2] = xxyy + xyyx;
+    helper.Field[2][2] = xyyy - xzyz - xxyx;
+
+    helper.Field[0][3] = xyyx - xxyy;
+    helper.Field[1][3] = xzyx + xxyz;
+    helper.Field[2][3] = xyyz + xzyy;
+    helper.Field[3][3] = xzyz - xxyx - xyyy;
+
+    helper.Field[1][0] = helper.Field[0][1];
+
+    helper.Field[2][0] = helper.Field[0][2];
+    helper.Field[2][1] = helper.Field[1][2];
+
+    helper.Field[3][0] = helper.Field[0][3];
+    helper.Field[3][1] = helper.Field[1][3];
+    helper.Field[3][2] = helper.Field[2][3];
+
+// diagonalize helper matrix, the largest eigenvalue is the last one
+    helper.EigenProblem(q);
+
+    // rmsd after the optimal rotation
+    double msd = (RefSquares + tss - 2.0*q[3]) / TotalWeight;
+    LastRMSD = msd > 0.0 ? sqrt(msd) : 0.0;
+
+    // the quaternion sign is arbitrary - keep the scalar part positive
+    double sign = helper.Field[0][3] < 0.0 ? -1.0 : 1.0;
+    for(int k=0; k < 4; k++){
+        Quaternion[k] = sign*helper.Field[k][3];
+    }
+
+    if( rmsdonly ) return(LastRMSD);
+
+// generate the rotation matrix
+    q[0] = Quaternion[0];
+    q[1] = Quaternion[1];
+    q[2] = Quaternion[2];
+    q[3] = Quaternion[3];
+
+    helper.SetUnit();
+
+    helper.Field[0][0] = q[0]*q[0] + q[1]*q[1] - q[2]*q[2] - q[3]*q[3];
+    helper.Field[1][0] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+    helper.Field[2][0] = 2.0 * (q[1] * q[3] + q[0] * q[2]);
+
+    helper.Field[0][1] = 2.0 * (q[2] * q[1] + q[0] * q[3]);
+    helper.Field[1][1] = q[0]*q[0] - q[1]*q[1] + q[2]*q[2] - q[3]*q[3];
+    helper.Field[2][1] = 2.0 * (q[2] * q[3] - q[0] * q[1]);
+
+    helper.Field[0][2] = 2.0 * (q[3] * q[1] - q[0] * q[2]);
+    helper.Field[1][2] = 2.0 * (q[3] * q[2] + q[0] * q[1]);
+    helper.Field[2][2] = q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3];
+
+    CTransformation trans;
+    trans.Translate(-com);
+    trans.MultFromRightWith(helper);
+    trans.Translate(RefCOM);
+
+    // transform snapshot
+    CPoint zero;
+    for(int i=0; i < p_qsnap->Restart.GetNumberOfAtoms(); i++) {
+        CPoint tpos = p_qsnap->Restart.GetPosition(i);
+        trans.Apply(tpos);
+        p_qsnap->Restart.SetPosition(i,tpos);
+        if( p_qsnap->Restart.AreVelocitiesLoaded() ){
+            // FIXME - should velocity be rotated as well?
+            p_qsnap->Restart.SetVelocity(i,zero);
+        }
+    }
+
+    return(LastRMSD);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QFitContext::getRMSD(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double FitContext::getRMSD(snapshot)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot",1);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qsnap = NULL;
+    value = GetArgAsObject<QSnapshot*>("snapshot","snapshot","Snapshot",1,p_qsnap);
+    if( value.isError() ) return(value);
+
+    value = CheckSnapshot("snapshot",p_qsnap);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    int     natoms = Indexes.size();
+    double  rms = 0.0;
+
+    for(int s=0; s < natoms; s++){
+        const CPoint& pos = p_qsnap->Restart.GetPosition(Indexes[s]);
+        double dx = pos.x - RefCOM.x - RefX[s];
+        double dy = pos.y - RefCOM.y - RefY[s];
+        double dz = pos.z - RefCOM.z - RefZ[s];
+        rms += Weights[s]*(dx*dx + dy*dy + dz*dz);
+    }
+
+    return( sqrt(rms / TotalWeight) );
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QFitContext::getQuaternion(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: vector FitContext::getQuaternion([vector])" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("[vector]",0,1);
+    if( value.isError() ) return(value);
+
+    QSimpleVector* p_qvec = NULL;
+    if( GetArgumentCount() == 1 ){
+        value = GetArgAsObject<QSimpleVector*>("[vector]","vector","Vector",1,p_qvec);
+        if( value.isError() ) return(value);
+    }
+
+// execute ---------------------------------------
+    if( p_qvec == NULL ){
+        QSimpleVector* p_obj = new QSimpleVector(4);
+        for(int k=0; k < 4; k++) p_obj->Vector[k] = Quaternion[k];
+        return( engine()->newQObject(p_obj, QScriptEngine::ScriptOwnership) );
+    }
+
+    if( p_qvec->Vector.GetLength() != 4 ){
+        p_qvec->Vector.CreateVector(4);
+    }
+    for(int k=0; k < 4; k++) p_qvec->Vector[k] = Quaternion[k];
+    return(GetArgument(1));
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
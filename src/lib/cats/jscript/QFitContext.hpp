@@ -0,0 +1,106 @@
+#ifndef QFitContextH
+#define QFitContextH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2010 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <QObject>
+#include <QScriptValue>
+#include <QScriptable>
+#include <Point.hpp>
+#include <QCATsScriptable.hpp>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+class QSnapshot;
+class QSelection;
+
+//------------------------------------------------------------------------------
+
+/// prepared rmsd fit to the reference structure
+/// selected atoms, their weights, and the centred reference are cached,
+/// thus each frame is processed in a single pass
+
+class CATS_PACKAGE QFitContext : public QObject, protected QScriptable, protected QCATsScriptable {
+Q_OBJECT
+public:
+// constructor -----------------------------------------------------------------
+    QFitContext(void);
+    static QScriptValue New(QScriptContext *context,QScriptEngine *engine);
+    static void Register(QScriptEngine& engine);
+
+// properties ------------------------------------------------------------------
+    Q_PROPERTY(int numatoms READ GetNumOfAtoms)
+    Q_PROPERTY(double rmsd READ GetRMSD)
+
+// methods ---------------------------------------------------------------------
+public slots:
+    /// update reference structure, selection and weights are kept
+    /// setReference(snapshot)
+    QScriptValue setReference(void);
+
+    /// fit snapshot to the reference structure, return rmsd after fit
+    /// double fit(snapshot[,rmsdonly])
+    QScriptValue fit(void);
+
+    /// get rmsd to the reference structure without fitting
+    /// double getRMSD(snapshot)
+    QScriptValue getRMSD(void);
+
+    /// get quaternion of the last fit (w,x,y,z)
+    /// vector getQuaternion([vector])
+    QScriptValue getQuaternion(void);
+
+// access methods --------------------------------------------------------------
+public:
+    /// return number of fitted atoms
+    int     GetNumOfAtoms(void);
+
+    /// return rmsd of the last fit
+    double  GetRMSD(void);
+
+// section of private data -----------------------------------------------------
+private:
+    int                 NumOfTopologyAtoms;
+    std::vector<int>    Indexes;        // selected atoms
+    std::vector<double> Weights;        // atom masses or ones
+    double              TotalWeight;
+    std::vector<double> RefX;           // centred reference
+    std::vector<double> RefY;
+    std::vector<double> RefZ;
+    double              RefSquares;     // sum of w*r^2 of centred reference
+    CPoint              RefCOM;
+    double              Quaternion[4];
+    double              LastRMSD;
+
+    /// initialize atom list and weights
+    void SetupAtoms(QSnapshot* p_qref,QSelection* p_qsel,bool nomass);
+
+    /// pack and centre the reference structure
+    void SetupReference(QSnapshot* p_qref);
+
+    /// check if snapshot is compatible with the context
+    QScriptValue CheckSnapshot(const QString& args,QSnapshot* p_qsnap);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
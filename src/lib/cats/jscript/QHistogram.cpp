@@ -27,6 +27,7 @@
 #include <SmallString.hpp>
 #include <math.h>
 #include <TerminalStr.hpp>
+#include <ParallelContext.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -454,6 +455,79 @@ QScriptValue QHistogram::addSample(void)
 
 //------------------------------------------------------------------------------
 
+QScriptValue QHistogram::reduce(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: Histogram::reduce()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    if( CParallelContext::IsParallel() == false ) return(value);
+
+    // histograms must have the same setup, each worker publishes its own
+    // setup in its slot, thus all workers compare exactly the same table,
+    // slots of workers that already finished remain empty
+    int nbins = Histogram.size();
+    int nthreads = CParallelContext::GetNumberOfThreads();
+    int index = CParallelContext::GetThreadIndex();
+    std::vector<double> setup(4*nthreads,0.0);
+    setup[4*index]      = 1.0;
+    setup[4*index+1]    = nbins;
+    setup[4*index+2]    = MinValue;
+    setup[4*index+3]    = MaxValue;
+    if( CParallelContext::AllReduce(setup) == false ){
+        return( ThrowError("","unable to reduce histogram setup") );
+    }
+    for(int i=0; i < nthreads; i++){
+        if( setup[4*i] == 0.0 ) continue;
+        if( (setup[4*i+1] != nbins) || (setup[4*i+2] != MinValue) || (setup[4*i+3] != MaxValue) ){
+            return( ThrowError("","workers provided histograms with different number of bins or range") );
+        }
+    }
+
+    // all data in one block
+    std::vector<double> data(2+4*nbins);
+    data[0] = NumOfSamples;
+    data[1] = NumOfSamplesWithin;
+    for(int i=0; i < nbins; i++){
+        data[2+i]           = Histogram[i];
+        data[2+nbins+i]     = DataN[i];
+        data[2+2*nbins+i]   = DataSum[i];
+        data[2+3*nbins+i]   = Data2Sum[i];
+    }
+
+    if( CParallelContext::AllReduce(data) == false ){
+        return( ThrowError("","workers provided histograms with different number of bins") );
+    }
+
+    if( CParallelContext::IsMaster() == false ){
+        resetInternal();
+        return(value);
+    }
+
+    NumOfSamples        = data[0];
+    NumOfSamplesWithin  = data[1];
+    for(int i=0; i < nbins; i++){
+        Histogram[i]    = data[2+i];
+        DataN[i]        = data[2+nbins+i];
+        DataSum[i]      = data[2+2*nbins+i];
+        Data2Sum[i]     = data[2+3*nbins+i];
+    }
+
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
 QScriptValue QHistogram::multBy(void)
 {
     QScriptValue value;
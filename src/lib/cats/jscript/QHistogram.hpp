@@ -95,6 +95,11 @@ public slots:
     /// reset()
     QScriptValue reset(void);
 
+    /// merge data of all parallel workers into the master, other workers are reset
+    /// it must be called by all workers
+    /// reduce()
+    QScriptValue reduce(void);
+
     /// mult by factor
     /// multBy(factor)
     QScriptValue multBy(void);
@@ -86,7 +86,9 @@ QScriptValue QMolSurf::New(QScriptContext *context,
 QMolSurf::QMolSurf(void)
     : QCATsScriptable("MolSurf")
 {
-
+    probeRadius = 1.4;
+    UseMSMS     = false;
+    MSMSFallback = true;
 }
 
 //==============================================================================
@@ -101,6 +103,8 @@ QScriptValue QMolSurf::analyze(void)
     if( IsHelpRequested() ){
         CTerminalStr sout;
         sout << "usage: bool MolSurf::analyze(snapshot[,selection])" << endl;
+        sout << "       SASA is calculated natively unless the msms backend is selected," << endl;
+        sout << "       in the auto mode, getSESA() runs msms for the same input" << endl;
         return(false);
     }
 
@@ -121,7 +125,22 @@ QScriptValue QMolSurf::analyze(void)
 // do Molalysis -------------------------------
     // clear previous data
     ClearAll();
-    
+
+    // check if topology or selections contains atoms
+    if( (p_qsnap->Restart.GetTopology()->AtomList.GetNumberOfAtoms() == 0) ||
+        ((p_qsel != NULL) && (p_qsel->Mask.GetNumberOfSelectedAtoms() == 0)) ){
+        SASA[0]=0.0;
+        SESA[0]=0.0;
+        return(true);
+    }
+
+    if( UseMSMS == false ){
+        if( RunNativeAnalysis(p_qsnap,p_qsel) == false ){
+            return( ThrowError("snapshot[,selection]","unable to calculate SASA") );
+        }
+        return(true);
+    }
+
     // create temporary directory
     QTemporaryDir tmp_dir;
     tmp_dir.setAutoRemove(false); // keep files in the case of failure
@@ -134,13 +153,6 @@ QScriptValue QMolSurf::analyze(void)
 	
     //FIXME - put to the error message the pathname to the working directory
 
-    // check if topology or selections contains atoms
-    if(p_qsnap->Restart.GetTopology()->AtomList.GetNumberOfAtoms() == 0 ||  p_qsel->Mask.GetNumberOfSelectedAtoms() == 0){
-        SASA[0]=0.0;
-        SESA[0]=0.0;
-        return(true);
-    }
-
     // write input data
     if( WriteInputData(p_qsnap,p_qsel) == false ){
         return( ThrowError("snapshot[,selection]","unable to write input data") );
@@ -219,6 +231,113 @@ QScriptValue QMolSurf::getProbeRadius(void)
 
 // ------------------------------------------------------------------------
 
+/// set backend
+/// setBackend(name)
+QScriptValue QMolSurf::setBackend(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: MolSurf::setBackend(name)" << endl;
+        sout << "       name: auto   - native SASA, SESA is calculated by msms on request (default)" << endl;
+        sout << "             native - Shrake-Rupley SASA calculated in process" << endl;
+        sout << "             msms   - external MSMS program, provides SASA and SESA" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("name",1);
+    if( value.isError() ) return(value);
+
+    QString name;
+    value = GetArgAsString("name","name",1,name);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    if( name == "auto" ){
+        UseMSMS = false;
+        MSMSFallback = true;
+    } else if( name == "native" ){
+        UseMSMS = false;
+        MSMSFallback = false;
+    } else if( name == "msms" ){
+        UseMSMS = true;
+        MSMSFallback = false;
+    } else {
+        return( ThrowError("name","unsupported backend, use auto, native or msms") );
+    }
+    ClearAll();
+    return(value);
+}
+
+// ------------------------------------------------------------------------
+
+/// set number of threads of the native backend
+/// setNumOfThreads(n)
+QScriptValue QMolSurf::setNumOfThreads(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: MolSurf::setNumOfThreads(n)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("n",1);
+    if( value.isError() ) return(value);
+
+    int n;
+    value = GetArgAsInt("n","n",1,n);
+    if( value.isError() ) return(value);
+
+    if( n <= 0 ){
+        return( ThrowError("n","number of threads must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    SASACalculator.SetNumberOfThreads(n);
+    return(value);
+}
+
+// ------------------------------------------------------------------------
+
+/// set number of test points per atom of the native backend
+/// setNumOfPoints(n)
+QScriptValue QMolSurf::setNumOfPoints(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: MolSurf::setNumOfPoints(n)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("n",1);
+    if( value.isError() ) return(value);
+
+    int n;
+    value = GetArgAsInt("n","n",1,n);
+    if( value.isError() ) return(value);
+
+    if( n <= 0 ){
+        return( ThrowError("n","number of points must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    SASACalculator.SetNumberOfPoints(n);
+    return(value);
+}
+
+// ------------------------------------------------------------------------
+
 
 /// get solvent accesible surface area
 /// double getSASA()
@@ -301,6 +420,17 @@ QScriptValue QMolSurf::getSESA(void)
         return(false);
     }
 
+    if( (UseMSMS == false) && (MSMSFallback == false) ){
+        return( ThrowError("","SESA is not available with the native backend, see setBackend") );
+    }
+
+    // native analysis provides only SASA - calculate SESA for the same input
+    if( (UseMSMS == false) && SESA.empty() && (Positions.empty() == false) ){
+        if( RunFallbackAnalysis() == false ){
+            return( ThrowError("","unable to calculate SESA by msms") );
+        }
+    }
+
 // check arguments & execute -------------------------------
 
     // double getSESA()
@@ -360,6 +490,77 @@ void QMolSurf::ClearAll(void)
     SASA.clear();
     SESA.clear();
     AtomIDMap.clear();
+    Positions.clear();
+    Radii.clear();
+}
+
+//------------------------------------------------------------------------------
+
+bool QMolSurf::RunNativeAnalysis(QSnapshot* p_qsnap,QSelection* p_qsel)
+{
+    CAmberMaskAtoms  fake_mask;
+    CAmberMaskAtoms* p_mask = NULL;
+    if( p_qsel != NULL ){
+        p_mask = &p_qsel->Mask;
+    } else {
+        fake_mask.AssignTopology(p_qsnap->Restart.GetTopology());
+        fake_mask.SelectAllAtoms();
+        p_mask = &fake_mask;
+    }
+
+    // atoms are processed in the same order as in the XYZR file
+    for(int i = 0; i < p_mask->GetNumberOfSelectedAtoms(); i++){
+        CAmberAtom* p_atom = p_mask->GetSelectedAtomCondensed(i);
+        int index = p_atom->GetAtomIndex();
+        Positions.push_back(p_qsnap->Restart.GetPosition(index));
+        Radii.push_back(p_atom->GetRadius());
+        AtomIDMap[index] = i;
+    }
+
+    std::vector<double> areas;
+    SASACalculator.SetProbeRadius(probeRadius);
+    if( SASACalculator.Calculate(Positions,Radii,areas) == false ) return(false);
+
+    for(int i = 0; i < (int)areas.size(); i++){
+        SASA[i] = areas[i];
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool QMolSurf::RunFallbackAnalysis(void)
+{
+    QTemporaryDir tmp_dir;
+    tmp_dir.setAutoRemove(false); // keep files in the case of failure
+    if( ! tmp_dir.isValid() ){
+        ES_ERROR("unable to create tmp dir");
+        return(false);
+    }
+    WorkDir = CFileName(tmp_dir.path());
+
+    FILE* p_fout;
+    CFileName fileName = WorkDir / "QMolSurf.xyzr";
+    if( (p_fout = fopen(fileName,"w")) == NULL ) {
+        CSmallString error;
+        error << "unable to open output file " << fileName;
+        error << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+    WriteXYZR(Positions,Radii,p_fout);
+    int ret = ferror(p_fout);
+    fclose(p_fout);
+    if( ret != 0 ) return(false);
+
+    if( RunAnalysis() == false ) return(false);
+
+    // SASA values of the native analysis are kept
+    if( ParseOutputData() == false ) return(false);
+
+    tmp_dir.remove();
+    return(true);
 }
 
 //------------------------------------------------------------------------------
@@ -488,3 +689,14 @@ bool QMolSurf::WriteXYZR(CAmberTopology* p_top,CAmberRestart* p_crd,CAmberMaskAt
 
 //------------------------------------------------------------------------------
 
+bool QMolSurf::WriteXYZR(const std::vector<CPoint>& positions,const std::vector<double>& radii,FILE* p_fout)
+{
+    for(size_t i=0; i < positions.size(); i++ ) {
+        fprintf(p_fout,"%8.3f%8.3f%8.3f %6.3f\n",
+                positions[i].x, positions[i].y, positions[i].z, radii[i]);
+    }
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
@@ -30,6 +30,7 @@
 #include <QSnapshot.hpp>
 #include <QSelection.hpp>
 #include <FileName.hpp>
+#include <SASACalculator.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -71,6 +72,18 @@ public slots:
     /// set probe radius
     QScriptValue setProbeRadius(const QScriptValue& dummy);
 
+    /// select auto (default), native or msms backend, SESA requires msms
+    /// setBackend(name)
+    QScriptValue setBackend(void);
+
+    /// set number of threads of the native backend
+    /// setNumOfThreads(n)
+    QScriptValue setNumOfThreads(void);
+
+    /// set number of test points per atom of the native backend
+    /// setNumOfPoints(n)
+    QScriptValue setNumOfPoints(void);
+
 // access methods --------------------------------------------------------------
 private:
     CFileName               WorkDir;    // scratch directory
@@ -78,10 +91,21 @@ private:
     std::map<int,double>    SESA;
     std::map<int, int>      AtomIDMap;
     double                  probeRadius;
+    bool                    UseMSMS;
+    bool                    MSMSFallback;   // SESA after native analysis is calculated by msms
+    CSASACalculator         SASACalculator;
+    std::vector<CPoint>     Positions;      // input of the last native analysis
+    std::vector<double>     Radii;
 
     /// clear all parsed results
     void ClearAll(void);
 
+    /// calculate SASA by the native backend
+    bool RunNativeAnalysis(QSnapshot* p_qsnap,QSelection* p_qsel);
+
+    /// calculate SESA by msms for the input of the last native analysis
+    bool RunFallbackAnalysis(void);
+
     /// create input data
     bool WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel);
 
@@ -93,6 +117,7 @@ private:
 
     /// create XYZR file
     bool WriteXYZR(CAmberTopology* p_top,CAmberRestart* p_crd,CAmberMaskAtoms* p_mask,FILE* p_fout);
+    bool WriteXYZR(const std::vector<CPoint>& positions,const std::vector<double>& radii,FILE* p_fout);
 };
 
 //------------------------------------------------------------------------------
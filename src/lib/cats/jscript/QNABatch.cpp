@@ -0,0 +1,235 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <QNABatch.hpp>
+#include <ErrorSystem.hpp>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QDir>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CNABatchWorkers::CNABatchWorkers(void)
+{
+    NumOfWorkers = 1;
+}
+
+//------------------------------------------------------------------------------
+
+CNABatchWorkers::~CNABatchWorkers(void)
+{
+    RemoveWorkDirs();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CNABatchWorkers::SetNumberOfWorkers(int nworkers)
+{
+    if( nworkers < 1 ) nworkers = 1;
+    if( nworkers == NumOfWorkers ) return;
+    RemoveWorkDirs();
+    NumOfWorkers = nworkers;
+}
+
+//------------------------------------------------------------------------------
+
+int CNABatchWorkers::GetNumberOfWorkers(void) const
+{
+    return(NumOfWorkers);
+}
+
+//------------------------------------------------------------------------------
+
+bool CNABatchWorkers::InitWorkDirs(const CSmallString& prefix)
+{
+    if( (int)Dirs.size() == NumOfWorkers ) return(true);
+    RemoveWorkDirs();
+
+    // prefer tmpfs - analyzers produce many small files
+    QString base = QDir::tempPath();
+    QFileInfo shm("/dev/shm");
+    if( shm.isDir() && shm.isWritable() ){
+        base = "/dev/shm";
+    }
+    QString templ = base + "/cats-" + QString(prefix) + "-XXXXXX";
+
+    for(int i=0; i < NumOfWorkers; i++){
+        QTemporaryDir* p_dir = new QTemporaryDir(templ);
+        if( ! p_dir->isValid() ){
+            delete p_dir;
+            CSmallString error;
+            error << "unable to create a working directory in " << CSmallString(base);
+            ES_ERROR(error);
+            RemoveWorkDirs();
+            return(false);
+        }
+        Dirs.push_back(p_dir);
+        WorkDirs.push_back(CFileName(p_dir->path()));
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+const CFileName& CNABatchWorkers::GetWorkDir(int worker) const
+{
+    return(WorkDirs[worker]);
+}
+
+//------------------------------------------------------------------------------
+
+int CNABatchWorkers::GetFrameWorker(int frame) const
+{
+    return(frame % NumOfWorkers);
+}
+
+//------------------------------------------------------------------------------
+
+const CSmallString CNABatchWorkers::GetFrameName(int frame)
+{
+    char buffer[32];
+    snprintf(buffer,sizeof(buffer),"frame_%06d",frame);
+    return(buffer);
+}
+
+//------------------------------------------------------------------------------
+
+const CSmallString CNABatchWorkers::GetWorkDirList(void) const
+{
+    CSmallString list;
+    for(size_t i=0; i < WorkDirs.size(); i++){
+        if( i > 0 ) list << ", ";
+        list << WorkDirs[i];
+    }
+    return(list);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CNABatchWorkers::WriteFrameList(int worker,int nframes)
+{
+    FILE* p_fout;
+    CFileName fileName = WorkDirs[worker] / "frames.lst";
+    if( (p_fout = fopen(fileName,"w")) == NULL ) {
+        CSmallString error;
+        error << "unable to open output file " << fileName;
+        error << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(-1);
+    }
+
+    int count = 0;
+    for(int frame = worker; frame < nframes; frame += NumOfWorkers){
+        fprintf(p_fout,"%s\n",(const char*)GetFrameName(frame));
+        count++;
+    }
+
+    int ret = ferror(p_fout);
+    fclose(p_fout);
+
+    if( ret != 0 ) return(-1);
+    return(count);
+}
+
+//------------------------------------------------------------------------------
+
+bool CNABatchWorkers::RunCommands(const std::vector<CSmallString>& commands)
+{
+    int nworkers = commands.size();
+    Commands.assign(nworkers,CSmallString());
+    Statuses.assign(nworkers,0);
+    for(int i=0; i < nworkers; i++){
+        if( commands[i] == NULL ) continue;
+        Commands[i] << "cd " << WorkDirs[i] << " > /dev/null 2>&1 && ( " << commands[i] << " )";
+    }
+
+    RunWorkers(nworkers);
+
+    bool result = true;
+    for(int i=0; i < nworkers; i++){
+        if( Statuses[i] != 0 ){
+            CSmallString error;
+            error << "command failed in the working directory " << WorkDirs[i];
+            ES_ERROR(error);
+            result = false;
+        }
+    }
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CNABatchWorkers::ExecuteWorker(int worker)
+{
+    if( Commands[worker] == NULL ) return;
+    Statuses[worker] = system(Commands[worker]);
+}
+
+//------------------------------------------------------------------------------
+
+void CNABatchWorkers::CleanWorkDirs(void)
+{
+    for(size_t i=0; i < Dirs.size(); i++){
+        QDir dir(Dirs[i]->path());
+        QStringList files = dir.entryList(QDir::Files | QDir::Hidden);
+        for(int j=0; j < files.size(); j++){
+            dir.remove(files[j]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CNABatchWorkers::KeepWorkDirs(void)
+{
+    for(size_t i=0; i < Dirs.size(); i++){
+        Dirs[i]->setAutoRemove(false);
+    }
+    RemoveWorkDirs();
+}
+
+//------------------------------------------------------------------------------
+
+void CNABatchWorkers::RemoveWorkDirs(void)
+{
+    for(size_t i=0; i < Dirs.size(); i++){
+        delete Dirs[i];
+    }
+    Dirs.clear();
+    WorkDirs.clear();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
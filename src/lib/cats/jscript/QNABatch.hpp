@@ -0,0 +1,106 @@
+#ifndef QNABatchH
+#define QNABatchH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <SmallString.hpp>
+#include <FileName.hpp>
+#include <WorkerTask.hpp>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+class QTemporaryDir;
+
+//------------------------------------------------------------------------------
+
+/// working directories for batched runs of external nucleic acid analyzers
+/// directories are created on tmpfs if available and reused between batches,
+/// queued frames are distributed among workers in round-robin fashion
+
+class CATS_PACKAGE CNABatchWorkers : private CWorkerTask {
+public:
+// constructor and destructor --------------------------------------------------
+    CNABatchWorkers(void);
+    ~CNABatchWorkers(void);
+
+// setup methods ---------------------------------------------------------------
+    /// set number of concurrent workers
+    void SetNumberOfWorkers(int nworkers);
+
+    /// get number of concurrent workers
+    int GetNumberOfWorkers(void) const;
+
+    /// create working directories, existing directories are reused
+    bool InitWorkDirs(const CSmallString& prefix);
+
+// access methods --------------------------------------------------------------
+    /// return working directory of worker
+    const CFileName& GetWorkDir(int worker) const;
+
+    /// return worker processing the frame
+    int GetFrameWorker(int frame) const;
+
+    /// return base name of frame files
+    static const CSmallString GetFrameName(int frame);
+
+    /// return list of working directories for error messages
+    const CSmallString GetWorkDirList(void) const;
+
+// executive methods -----------------------------------------------------------
+    /// write names of frames processed by worker into frames.lst
+    /// return number of frames or -1 on error
+    int WriteFrameList(int worker,int nframes);
+
+    /// execute commands in working directories concurrently
+    /// empty commands are skipped
+    bool RunCommands(const std::vector<CSmallString>& commands);
+
+    /// remove frame data but keep working directories
+    void CleanWorkDirs(void);
+
+    /// leave working directories with data on disk, e.g., after failure
+    void KeepWorkDirs(void);
+
+// section of private data -----------------------------------------------------
+private:
+    int                         NumOfWorkers;
+    std::vector<QTemporaryDir*> Dirs;
+    std::vector<CFileName>      WorkDirs;
+
+    // commands of the current RunCommands call and their exit statuses
+    std::vector<CSmallString>   Commands;
+    std::vector<int>            Statuses;
+
+    /// run command of the worker in its working directory
+    virtual void ExecuteWorker(int worker);
+
+    /// remove working directories
+    void RemoveWorkDirs(void);
+
+    // disable copying
+    CNABatchWorkers(const CNABatchWorkers&);
+    CNABatchWorkers& operator = (const CNABatchWorkers&);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
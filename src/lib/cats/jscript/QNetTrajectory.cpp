@@ -24,6 +24,7 @@
 #include <moc_QNetTrajectory.cpp>
 #include <QTopology.hpp>
 #include <QSnapshot.hpp>
+#include <QSelection.hpp>
 
 using namespace std;
 
@@ -70,6 +71,13 @@ QNetTrajectory::QNetTrajectory(QTopology* p_parent)
     : QCATsScriptable("NetTrajectory")
 {
     ClientID = -1;
+    Encoding = ESE_XML;
+    Precision = 1000.0;
+    BatchSize = 1;
+    Leasing = false;
+    LastIndex = -1;
+    BufferPos = 0;
+    BufferLen = 0;
 }
 
 //==============================================================================
@@ -145,6 +153,99 @@ bool QNetTrajectory::setServerKey(const QString& name)
 
 //------------------------------------------------------------------------------
 
+void QNetTrajectory::setBatchSize(int size)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::setBatchSize(size)");
+        return;
+    }
+    if( size <= 0 ) {
+        context()->throwError("size must be greater than zero\nusage: NetTrajectory::setBatchSize(size)");
+        return;
+    }
+    BatchSize = size;
+}
+
+//------------------------------------------------------------------------------
+
+int QNetTrajectory::getBatchSize(void)
+{
+    if( argumentCount() != 0 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::getBatchSize()");
+        return(-1);
+    }
+    return(BatchSize);
+}
+
+//------------------------------------------------------------------------------
+
+void QNetTrajectory::setEncoding(const QString& name)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::setEncoding(name)");
+        return;
+    }
+    if( (name != "xml") && (name != "float") && (name != "quantized") ) {
+        context()->throwError("unsupported encoding, it must be xml, float, or quantized\nusage: NetTrajectory::setEncoding(name)");
+        return;
+    }
+    Encoding = CSnapshotCodec::DecodeEncoding(name.toLatin1().constData());
+    TrajClient.SetEncoding(Encoding,Precision);
+}
+
+//------------------------------------------------------------------------------
+
+void QNetTrajectory::setPrecision(double precision)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::setPrecision(precision)");
+        return;
+    }
+    if( precision <= 0.0 ) {
+        context()->throwError("precision must be greater than zero\nusage: NetTrajectory::setPrecision(precision)");
+        return;
+    }
+    Precision = precision;
+    TrajClient.SetEncoding(Encoding,Precision);
+}
+
+//------------------------------------------------------------------------------
+
+void QNetTrajectory::setLeasing(bool set)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::setLeasing(set)");
+        return;
+    }
+    Leasing = set;
+    TrajClient.SetLeasing(Leasing);
+}
+
+//------------------------------------------------------------------------------
+
+bool QNetTrajectory::setSelection(QObject* p_sel)
+{
+    if( argumentCount() != 1 ) {
+        context()->throwError("illegal number of arguments\nusage: NetTrajectory::setSelection(selection)");
+        return(false);
+    }
+    QSelection* p_qsel = dynamic_cast<QSelection*>(p_sel);
+    if( p_qsel == NULL ) {
+        context()->throwError("illegal argument\nusage: NetTrajectory::setSelection(selection)");
+        return(false);
+    }
+    if( ClientID == -1 ) {
+        context()->throwError("client is not registered\nusage: NetTrajectory::setSelection(selection)");
+        return(false);
+    }
+    // drop frames buffered with the previous projection
+    BufferPos = 0;
+    BufferLen = 0;
+    return( TrajClient.SetSnapshotMask(ClientID,p_qsel->Mask.GetTopology(),p_qsel->Mask.GetMask()) );
+}
+
+//------------------------------------------------------------------------------
+
 bool QNetTrajectory::registerClient(void)
 {
     if( argumentCount() != 0 ) {
@@ -168,8 +269,37 @@ int QNetTrajectory::read(QObject* p_snap)
         context()->throwError("illegal argument\nusage: NetTrajectory::read(snapshot)");
         return(false);
     }
-    int result = TrajClient.GetSnapshot(ClientID,&p_qsnap->Restart,"next",false);
-    return(result);
+
+    // the previous snapshot was processed
+    if( (Leasing == true) && (LastIndex > 0) ) {
+        TrajClient.AcknowledgeSnapshot(LastIndex);
+    }
+    LastIndex = -1;
+
+    // leased snapshots are always transferred by GetSnapshots
+    if( (BatchSize <= 1) && (Leasing == false) ) {
+        int result = TrajClient.GetSnapshot(ClientID,&p_qsnap->Restart,"next",false);
+        return(result);
+    }
+
+    // refill local buffer
+    if( BufferPos >= BufferLen ) {
+        if( (int)Buffer.size() != BatchSize ) {
+            Buffer.clear();
+            Buffer.resize(BatchSize,p_qsnap->Restart);
+        }
+        BufferPos = 0;
+        BufferLen = TrajClient.GetSnapshots(ClientID,Buffer,BufferIndexes);
+        if( BufferLen <= 0 ) {
+            int result = BufferLen;
+            BufferLen = 0;
+            return(result);
+        }
+    }
+
+    p_qsnap->Restart = Buffer[BufferPos];
+    LastIndex = BufferIndexes[BufferPos++];
+    return(LastIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -185,6 +315,10 @@ int QNetTrajectory::readVelocities(QObject* p_snap)
         context()->throwError("illegal argument\nusage: NetTrajectory::readVelocities(snapshot)");
         return(false);
     }
+    if( Leasing == true ) {
+        context()->throwError("velocities cannot be read with leasing\nusage: NetTrajectory::readVelocities(snapshot)");
+        return(false);
+    }
     int result = TrajClient.GetSnapshot(ClientID,&p_qsnap->Restart,"next",true);
     return(result);
 }
@@ -198,8 +332,18 @@ bool QNetTrajectory::unregisterClient(void)
         return(false);
     }
 
-    bool result = TrajClient.UnregisterClient(ClientID);
+    bool result = true;
+    if( Leasing == true ) {
+        // buffered but unread snapshots are requeued by the server
+        if( LastIndex > 0 ) TrajClient.AcknowledgeSnapshot(LastIndex);
+        result &= TrajClient.FlushAcknowledgements(ClientID);
+    }
+    LastIndex = -1;
+
+    result &= TrajClient.UnregisterClient(ClientID);
     ClientID = -1;
+    BufferPos = 0;
+    BufferLen = 0;
     return(result);
 }
 
@@ -27,6 +27,8 @@
 #include <QScriptable>
 #include <TrajectoryClient.hpp>
 #include <QCATsScriptable.hpp>
+#include <AmberRestart.hpp>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
@@ -63,6 +65,25 @@ public slots:
     /// set server key
     bool setServerKey(const QString& name);
 
+    /// set number of snapshots fetched from the server in one request
+    void setBatchSize(int size);
+
+    /// get number of snapshots fetched from the server in one request
+    int getBatchSize(void);
+
+    /// set encoding of transferred coordinates (xml, float, quantized)
+    void setEncoding(const QString& name);
+
+    /// set precision of quantized coordinates (steps per angstrom)
+    void setPrecision(double precision);
+
+    /// snapshots must be acknowledged, the previous one is acknowledged by read()
+    /// snapshots of failed clients are then handed out to other clients
+    void setLeasing(bool set);
+
+    /// ask the server to send only atoms from the selection
+    bool setSelection(QObject* p_sel);
+
     /// register client
     bool registerClient(void);
 
@@ -82,6 +103,17 @@ public slots:
 private:
     CTrajectoryClient   TrajClient;
     int                 ClientID;
+    ESnapshotEncoding   Encoding;
+    double              Precision;
+    bool                Leasing;
+    int                 LastIndex;  // last snapshot returned by read()
+
+    // batched snapshots
+    int                         BatchSize;
+    std::vector<CAmberRestart>  Buffer;
+    std::vector<int>            BufferIndexes;
+    int                         BufferPos;
+    int                         BufferLen;
 };
 
 //------------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include <QSelection.hpp>
 #include <iomanip>
 #include <TerminalStr.hpp>
+#include <ParallelContext.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -169,6 +170,46 @@ QScriptValue QPropSum::addSample(void)
 
 //------------------------------------------------------------------------------
 
+QScriptValue QPropSum::reduce(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: PropSum::reduce()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    if( CParallelContext::IsParallel() == false ) return(value);
+
+    std::vector<double> data(3);
+    data[0] = N;
+    data[1] = SX;
+    data[2] = SX2;
+
+    if( CParallelContext::AllReduce(data) == false ){
+        return( ThrowError("","workers provided inconsistent data") );
+    }
+
+    if( CParallelContext::IsMaster() ){
+        N   = data[0];
+        SX  = data[1];
+        SX2 = data[2];
+    } else {
+        resetInternal();
+    }
+
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
 QScriptValue QPropSum::getNumOfSamples(void)
 {
     QScriptValue value;
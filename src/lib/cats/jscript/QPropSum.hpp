@@ -60,6 +60,11 @@ public slots:
     /// addSample(double)
     QScriptValue addSample(void);
 
+    /// merge samples of all parallel workers into the master, other workers are reset
+    /// it must be called by all workers
+    /// reduce()
+    QScriptValue reduce(void);
+
     /// get number of samples
     /// double getNumOfSamples()
     QScriptValue getNumOfSamples(void);
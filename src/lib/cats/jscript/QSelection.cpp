@@ -20,6 +20,7 @@
 // =============================================================================
 
 #include <iostream>
+#include <stdio.h>
 #include <QScriptEngine>
 #include <QSelection.hpp>
 #include <moc_QSelection.cpp>
@@ -104,6 +105,8 @@ QSelection::QSelection(const QScriptValue& top)
 void QSelection::CleanData(void)
 {
     Mask.Reset();
+    IndexAtoms.clear();
+    IndexMask = NULL;
 }
 
 //==============================================================================
@@ -336,3 +339,51 @@ QScriptValue QSelection::getAtom(void)
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
+
+bool QSelection::SetByIndexes(const std::vector<int>& indexes)
+{
+    // the same atoms as in the previous call and the mask was not changed meanwhile
+    if( (IndexMask != NULL) && (indexes == IndexAtoms) && (Mask.GetMask() == IndexMask) ){
+        return(true);
+    }
+
+    // the ASL parser has no interface for atom by atom selection,
+    // thus consecutive atoms are encoded as ranges of the index mask
+    CSmallString mask;
+    if( indexes.size() == 0 ){
+        mask = "!@*";
+    } else {
+        mask = "@";
+        char    buffer[32];
+        size_t  i = 0;
+        while( i < indexes.size() ){
+            int first = indexes[i];
+            int last = first;
+            i++;
+            while( (i < indexes.size()) && (indexes[i] == last + 1) ){
+                last++;
+                i++;
+            }
+            if( first == last ){
+                snprintf(buffer,sizeof(buffer),"%s%d",mask.GetLength() > 1 ? "," : "",first+1);
+            } else {
+                snprintf(buffer,sizeof(buffer),"%s%d-%d",mask.GetLength() > 1 ? "," : "",first+1,last+1);
+            }
+            mask << buffer;
+        }
+    }
+
+    if( Mask.SetMask(mask) == false ){
+        IndexAtoms.clear();
+        IndexMask = NULL;
+        return(false);
+    }
+
+    IndexAtoms = indexes;
+    IndexMask = Mask.GetMask();
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
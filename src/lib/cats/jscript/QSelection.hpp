@@ -78,17 +78,27 @@ public slots:
 
 // section of private data -----------------------------------------------------
 private:
-    CAmberMaskAtoms Mask;
+    CAmberMaskAtoms     Mask;
+    std::vector<int>    IndexAtoms;     // atoms of the last SetByIndexes
+    CSmallString        IndexMask;      // and the mask compiled for them
+
+    /// select atoms given by ascending zero-based indexes
+    /// the mask is compiled only if the set of atoms changes
+    bool SetByIndexes(const std::vector<int>& indexes);
 
     friend class QGeometry;
     friend class QTopology;
     friend class QSnapshot;
     friend class QAverageSnapshot;
     friend class QTransformation;
+    friend class QFitContext;
     friend class Qx3DNA;
     friend class QMolSurf;
     friend class QCurvesP;
     friend class QTinySpline;
+    friend class QNetTrajectory;
+    friend class QTrajectory;
+    friend class QDistanceMask;
 
     /// clear object data if topology is cleaned - only weak objects
     virtual void CleanData(void);
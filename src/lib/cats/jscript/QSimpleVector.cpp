@@ -269,6 +269,64 @@ QScriptValue QSimpleVector::getPoint(int index)
     return(obj);
 }
 
+//------------------------------------------------------------------------------
+
+QScriptValue QSimpleVector::getValue(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double Vector::getValue(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("index",1);
+    if( value.isError() ) return(value);
+
+    int index = 0;
+    value = GetArgAsInt("index","index",1,index);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    int nitems = Vector.GetLength();
+    if( (index < 1) || (index > nitems) ){
+        CSmallString error;
+        error << "index is out-of-range, index (" << index << "), size (" << nitems << ")";
+        return( ThrowError("index",error) );
+    }
+
+    return(Vector[index-1]);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QSimpleVector::toArray(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: array Vector::toArray()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    int nitems = Vector.GetLength();
+    QScriptValue array = engine()->newArray(nitems);
+    for(int i=0; i < nitems; i++){
+        array.setProperty(i,Vector[i]);
+    }
+    return(array);
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
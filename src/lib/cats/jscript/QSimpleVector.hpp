@@ -64,6 +64,14 @@ public slots:
     /// get point
     QScriptValue getPoint(int index);
 
+    /// get vector item
+    /// double getValue(index)
+    QScriptValue getValue(void);
+
+    /// convert vector to array in one call
+    /// array toArray()
+    QScriptValue toArray(void);
+
 // access methods --------------------------------------------------------------
 public:   
     CVector Vector;
@@ -26,9 +26,13 @@
 #include <QTopology.hpp>
 #include <QSelection.hpp>
 #include <QPoint.hpp>
+#include <QSimpleVector.hpp>
 #include <QAverageSnapshot.hpp>
 #include <Transformation.hpp>
 #include <TerminalStr.hpp>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
 
 using namespace std;
 
@@ -1415,6 +1419,478 @@ QScriptValue QSnapshot::getCOM(void)
 //------------------------------------------------------------------------------
 //==============================================================================
 
+// minimum image convention, the cell vectors form upper triangular matrix
+// (a along x, b in xy plane)
+
+class CBulkImage {
+public:
+    CBulkImage(void) {
+        ax = bx = by = cx = cy = cz = 1.0;
+        Active = false;
+        Triclinic = false;
+    }
+
+    void Setup(CAmberRestart& rst) {
+        CPoint box = rst.GetBox();
+        CPoint ang = rst.GetAngles();
+        Triclinic = (fabs(ang.x - 90.0) > 1e-6) || (fabs(ang.y - 90.0) > 1e-6) || (fabs(ang.z - 90.0) > 1e-6);
+        ang = ang*(M_PI/180.0);
+        ax = box.x;
+        bx = box.y*cos(ang.z);
+        by = box.y*sin(ang.z);
+        cx = box.z*cos(ang.y);
+        cy = box.z*(cos(ang.x) - cos(ang.y)*cos(ang.z))/sin(ang.z);
+        cz = sqrt(box.z*box.z - cx*cx - cy*cy);
+        if( Triclinic == false ){
+            bx = cx = cy = 0.0;
+        }
+        Active = true;
+    }
+
+    inline void Image(double& dx,double& dy,double& dz) const {
+        // rounding of fractional coordinates - exact for orthorhombic boxes
+        double sz = floor(dz/cz + 0.5);
+        dx -= sz*cx;
+        dy -= sz*cy;
+        dz -= sz*cz;
+        double sy = floor(dy/by + 0.5);
+        dx -= sy*bx;
+        dy -= sy*by;
+        double sx = floor(dx/ax + 0.5);
+        dx -= sx*ax;
+        if( Triclinic ) Refine(dx,dy,dz);
+    }
+
+    // the closest image of skewed box can be in neighbouring cell
+    void Refine(double& dx,double& dy,double& dz) const {
+        double bx0 = dx, by0 = dy, bz0 = dz;
+        double best = dx*dx + dy*dy + dz*dz;
+        for(int k=-1; k <= 1; k++){
+            for(int j=-1; j <= 1; j++){
+                for(int i=-1; i <= 1; i++){
+                    double x = bx0 + i*ax + j*bx + k*cx;
+                    double y = by0 + j*by + k*cy;
+                    double z = bz0 + k*cz;
+                    double d2 = x*x + y*y + z*z;
+                    if( d2 < best ){
+                        best = d2;
+                        dx = x;
+                        dy = y;
+                        dz = z;
+                    }
+                }
+            }
+        }
+    }
+
+    double  ax,bx,by,cx,cy,cz;
+    bool    Active;
+    bool    Triclinic;
+};
+
+//------------------------------------------------------------------------------
+
+bool QSnapshot::CheckSelection(QSelection* p_qsel,CSmallString& error)
+{
+    if( p_qsel->Mask.GetNumberOfTopologyAtoms() != Restart.GetNumberOfAtoms() ){
+        error << "number of atoms does not match, topology associated with selection ("
+              << p_qsel->Mask.GetNumberOfTopologyAtoms() << "), target snapshot (" << Restart.GetNumberOfAtoms() << ")";
+        return(false);
+    }
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void QSnapshot::GatherPositions(QSelection* p_qsel,std::vector<double>& x,
+                                std::vector<double>& y,std::vector<double>& z)
+{
+    int natoms = p_qsel->Mask.GetNumberOfSelectedAtoms();
+    x.resize(natoms);
+    y.resize(natoms);
+    z.resize(natoms);
+    for(int s=0; s < natoms; s++) {
+        int i = p_qsel->Mask.GetSelectedAtomCondensed(s)->GetAtomIndex();
+        const CPoint& pos = Restart.GetPosition(i);
+        x[s] = pos.x;
+        y[s] = pos.y;
+        z[s] = pos.z;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QSnapshot::getDistances(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: vector Snapshot::getDistances(selection1,selection2[,vector][,pbc])" << endl;
+        return(false);
+    }
+
+// arguments -------------------------------------
+    value = CheckMinimumNumberOfArguments("selection1,selection2[,vector][,pbc]",2);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel1 = NULL;
+    value = GetArgAsObject<QSelection*>("selection1,selection2[,vector][,pbc]","selection1","Selection",1,p_qsel1);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel2 = NULL;
+    value = GetArgAsObject<QSelection*>("selection1,selection2[,vector][,pbc]","selection2","Selection",2,p_qsel2);
+    if( value.isError() ) return(value);
+
+    QSimpleVector* p_qvec = NULL;
+    FindArgAsObject<QSimpleVector*>("selection1,selection2[,vector][,pbc]","Vector",p_qvec,false);
+
+    bool pbc = IsArgumentKeySelected("pbc");
+
+    value = CheckArgumentsUsage("selection1,selection2[,vector][,pbc]");
+    if( value.isError() ) return(value);
+
+// other checks ----------------------------------
+    CSmallString error;
+    if( (CheckSelection(p_qsel1,error) == false) || (CheckSelection(p_qsel2,error) == false) ){
+        return( ThrowError("selection1,selection2[,vector][,pbc]",error) );
+    }
+    if( pbc && (Restart.IsBoxPresent() == false) ){
+        return( ThrowError("selection1,selection2[,vector][,pbc]","pbc requested but snapshot does not contain box") );
+    }
+
+    int n1 = p_qsel1->Mask.GetNumberOfSelectedAtoms();
+    int n2 = p_qsel2->Mask.GetNumberOfSelectedAtoms();
+    if( (n1 == 0) || (n2 == 0) ){
+        return( ThrowError("selection1,selection2[,vector][,pbc]","no atoms in selection") );
+    }
+    // vectors are indexed by int
+    size_t npairs = (size_t)n1*(size_t)n2;
+    if( npairs > (size_t)INT_MAX ){
+        CSmallString error;
+        error << "too many distances (" << n1 << " x " << n2 << ")";
+        return( ThrowError("selection1,selection2[,vector][,pbc]",error) );
+    }
+
+// execute code ----------------------------------
+    QSimpleVector* p_obj = p_qvec;
+    if( p_obj == NULL ){
+        p_obj = new QSimpleVector((int)npairs);
+    } else if( (size_t)p_obj->Vector.GetLength() != npairs ){
+        p_obj->Vector.CreateVector(npairs);
+    }
+
+    CBulkImage image;
+    if( pbc ) image.Setup(Restart);
+
+    std::vector<double> x1,y1,z1,x2,y2,z2;
+    GatherPositions(p_qsel1,x1,y1,z1);
+    GatherPositions(p_qsel2,x2,y2,z2);
+
+    double* p_dst = p_obj->Vector.GetRawDataField();
+    for(int i=0; i < n1; i++){
+        double  px = x1[i];
+        double  py = y1[i];
+        double  pz = z1[i];
+        double* p_row = &p_dst[(size_t)i*n2];
+        if( image.Active ){
+            for(int j=0; j < n2; j++){
+                double dx = x2[j] - px;
+                double dy = y2[j] - py;
+                double dz = z2[j] - pz;
+                image.Image(dx,dy,dz);
+                p_row[j] = sqrt(dx*dx + dy*dy + dz*dz);
+            }
+        } else {
+            for(int j=0; j < n2; j++){
+                double dx = x2[j] - px;
+                double dy = y2[j] - py;
+                double dz = z2[j] - pz;
+                p_row[j] = sqrt(dx*dx + dy*dy + dz*dz);
+            }
+        }
+    }
+
+    if( p_qvec == NULL ){
+        return( engine()->newQObject(p_obj, QScriptEngine::ScriptOwnership) );
+    }
+    for(int i=1;i<=GetArgumentCount();i++){
+        if( IsArgumentObject<QSimpleVector*>(i) ) return(GetArgument(i));
+    }
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QSnapshot::getDistancesToPoint(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: vector Snapshot::getDistancesToPoint(selection,point[,vector][,pbc])" << endl;
+        return(false);
+    }
+
+// arguments -------------------------------------
+    value = CheckMinimumNumberOfArguments("selection,point[,vector][,pbc]",2);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel = NULL;
+    value = GetArgAsObject<QSelection*>("selection,point[,vector][,pbc]","selection","Selection",1,p_qsel);
+    if( value.isError() ) return(value);
+
+    QPoint* p_qpt = NULL;
+    value = GetArgAsObject<QPoint*>("selection,point[,vector][,pbc]","point","Point",2,p_qpt);
+    if( value.isError() ) return(value);
+
+    QSimpleVector* p_qvec = NULL;
+    FindArgAsObject<QSimpleVector*>("selection,point[,vector][,pbc]","Vector",p_qvec,false);
+
+    bool pbc = IsArgumentKeySelected("pbc");
+
+    value = CheckArgumentsUsage("selection,point[,vector][,pbc]");
+    if( value.isError() ) return(value);
+
+// other checks ----------------------------------
+    CSmallString error;
+    if( CheckSelection(p_qsel,error) == false ){
+        return( ThrowError("selection,point[,vector][,pbc]",error) );
+    }
+    if( pbc && (Restart.IsBoxPresent() == false) ){
+        return( ThrowError("selection,point[,vector][,pbc]","pbc requested but snapshot does not contain box") );
+    }
+
+    int n1 = p_qsel->Mask.GetNumberOfSelectedAtoms();
+    if( n1 == 0 ){
+        return( ThrowError("selection,point[,vector][,pbc]","no atoms in selection") );
+    }
+
+// execute code ----------------------------------
+    QSimpleVector* p_obj = p_qvec;
+    if( p_obj == NULL ){
+        p_obj = new QSimpleVector(n1);
+    } else if( (int)p_obj->Vector.GetLength() != n1 ){
+        p_obj->Vector.CreateVector(n1);
+    }
+
+    CBulkImage image;
+    if( pbc ) image.Setup(Restart);
+
+    std::vector<double> x1,y1,z1;
+    GatherPositions(p_qsel,x1,y1,z1);
+
+    double  px = p_qpt->Point.x;
+    double  py = p_qpt->Point.y;
+    double  pz = p_qpt->Point.z;
+    double* p_dst = p_obj->Vector.GetRawDataField();
+
+    if( image.Active ){
+        for(int i=0; i < n1; i++){
+            double dx = x1[i] - px;
+            double dy = y1[i] - py;
+            double dz = z1[i] - pz;
+            image.Image(dx,dy,dz);
+            p_dst[i] = sqrt(dx*dx + dy*dy + dz*dz);
+        }
+    } else {
+        for(int i=0; i < n1; i++){
+            double dx = x1[i] - px;
+            double dy = y1[i] - py;
+            double dz = z1[i] - pz;
+            p_dst[i] = sqrt(dx*dx + dy*dy + dz*dz);
+        }
+    }
+
+    if( p_qvec == NULL ){
+        return( engine()->newQObject(p_obj, QScriptEngine::ScriptOwnership) );
+    }
+    for(int i=1;i<=GetArgumentCount();i++){
+        if( IsArgumentObject<QSimpleVector*>(i) ) return(GetArgument(i));
+    }
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QSnapshot::getMinDistance(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: double Snapshot::getMinDistance(selection1,selection2[,pbc])" << endl;
+        return(false);
+    }
+
+// arguments -------------------------------------
+    value = CheckMinimumNumberOfArguments("selection1,selection2[,pbc]",2);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel1 = NULL;
+    value = GetArgAsObject<QSelection*>("selection1,selection2[,pbc]","selection1","Selection",1,p_qsel1);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel2 = NULL;
+    value = GetArgAsObject<QSelection*>("selection1,selection2[,pbc]","selection2","Selection",2,p_qsel2);
+    if( value.isError() ) return(value);
+
+    bool pbc = IsArgumentKeySelected("pbc");
+
+    value = CheckArgumentsUsage("selection1,selection2[,pbc]");
+    if( value.isError() ) return(value);
+
+// other checks ----------------------------------
+    CSmallString error;
+    if( (CheckSelection(p_qsel1,error) == false) || (CheckSelection(p_qsel2,error) == false) ){
+        return( ThrowError("selection1,selection2[,pbc]",error) );
+    }
+    if( pbc && (Restart.IsBoxPresent() == false) ){
+        return( ThrowError("selection1,selection2[,pbc]","pbc requested but snapshot does not contain box") );
+    }
+
+    int n1 = p_qsel1->Mask.GetNumberOfSelectedAtoms();
+    int n2 = p_qsel2->Mask.GetNumberOfSelectedAtoms();
+    if( (n1 == 0) || (n2 == 0) ){
+        return( ThrowError("selection1,selection2[,pbc]","no atoms in selection") );
+    }
+
+// execute code ----------------------------------
+    CBulkImage image;
+    if( pbc ) image.Setup(Restart);
+
+    std::vector<double> x1,y1,z1,x2,y2,z2;
+    GatherPositions(p_qsel1,x1,y1,z1);
+    GatherPositions(p_qsel2,x2,y2,z2);
+
+    // squared distances, sqrt only once at the end
+    double mind2 = DBL_MAX;
+    for(int i=0; i < n1; i++){
+        double px = x1[i];
+        double py = y1[i];
+        double pz = z1[i];
+        double rowmin = DBL_MAX;
+        if( image.Active ){
+            for(int j=0; j < n2; j++){
+                double dx = x2[j] - px;
+                double dy = y2[j] - py;
+                double dz = z2[j] - pz;
+                image.Image(dx,dy,dz);
+                double d2 = dx*dx + dy*dy + dz*dz;
+                rowmin = d2 < rowmin ? d2 : rowmin;
+            }
+        } else {
+            for(int j=0; j < n2; j++){
+                double dx = x2[j] - px;
+                double dy = y2[j] - py;
+                double dz = z2[j] - pz;
+                double d2 = dx*dx + dy*dy + dz*dz;
+                rowmin = d2 < rowmin ? d2 : rowmin;
+            }
+        }
+        if( rowmin < mind2 ) mind2 = rowmin;
+    }
+
+    return( sqrt(mind2) );
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QSnapshot::getResidueCOMs(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: vector Snapshot::getResidueCOMs([selection][,vector][,nomass])" << endl;
+        sout << "       COMs are stored in the order of residues in the topology," << endl;
+        sout << "       residues without selected atoms are skipped" << endl;
+        return(false);
+    }
+
+// arguments -------------------------------------
+    QSelection* p_qsel = NULL;
+    FindArgAsObject<QSelection*>("[selection][,vector][,nomass]","Selection",p_qsel,false);
+
+    QSimpleVector* p_qvec = NULL;
+    FindArgAsObject<QSimpleVector*>("[selection][,vector][,nomass]","Vector",p_qvec,false);
+
+    bool nomass = IsArgumentKeySelected("nomass");
+
+    value = CheckArgumentsUsage("[selection][,vector][,nomass]");
+    if( value.isError() ) return(value);
+
+    if( p_qsel ){
+        CSmallString error;
+        if( CheckSelection(p_qsel,error) == false ){
+            return( ThrowError("[selection][,vector][,nomass]",error) );
+        }
+    }
+
+// execute code ----------------------------------
+    CAmberTopology* p_top = Restart.GetTopology();
+    int nres = p_top->ResidueList.GetNumberOfResidues();
+
+    // accumulate per residue sums
+    std::vector<double> sx(nres,0.0),sy(nres,0.0),sz(nres,0.0),sm(nres,0.0);
+    std::vector<int>    count(nres,0);
+
+    int natoms = p_qsel ? p_qsel->Mask.GetNumberOfSelectedAtoms() : Restart.GetNumberOfAtoms();
+    for(int s=0; s < natoms; s++) {
+        int i = p_qsel ? p_qsel->Mask.GetSelectedAtomCondensed(s)->GetAtomIndex() : s;
+        CAmberAtom* p_atom = p_top->AtomList.GetAtom(i);
+        int r = p_atom->GetResidue()->GetIndex();
+        double mass = nomass ? 1.0 : p_atom->GetMass();
+        const CPoint& pos = Restart.GetPosition(i);
+        sx[r] += mass*pos.x;
+        sy[r] += mass*pos.y;
+        sz[r] += mass*pos.z;
+        sm[r] += mass;
+        count[r]++;
+    }
+
+    int nused = 0;
+    for(int r=0; r < nres; r++){
+        if( count[r] > 0 ) nused++;
+    }
+    if( nused == 0 ){
+        return( ThrowError("[selection][,vector][,nomass]","no atoms in selection") );
+    }
+
+    QSimpleVector* p_obj = p_qvec;
+    if( p_obj == NULL ){
+        p_obj = new QSimpleVector(3*nused);
+    } else if( (int)p_obj->Vector.GetLength() != 3*nused ){
+        p_obj->Vector.CreateVector(3*nused);
+    }
+
+    double* p_dst = p_obj->Vector.GetRawDataField();
+    for(int r=0; r < nres; r++){
+        if( count[r] == 0 ) continue;
+        // the same convention as getCOM - massless residue has zero COM
+        double m = sm[r] > 0.0 ? sm[r] : 0.0;
+        *p_dst++ = m > 0.0 ? sx[r] / m : 0.0;
+        *p_dst++ = m > 0.0 ? sy[r] / m : 0.0;
+        *p_dst++ = m > 0.0 ? sz[r] / m : 0.0;
+    }
+
+    if( p_qvec == NULL ){
+        return( engine()->newQObject(p_obj, QScriptEngine::ScriptOwnership) );
+    }
+    for(int i=1;i<=GetArgumentCount();i++){
+        if( IsArgumentObject<QSimpleVector*>(i) ) return(GetArgument(i));
+    }
+    return(false);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 QScriptValue QSnapshot::getNumOfAtoms(void)
 {
     QScriptValue value;
@@ -24,10 +24,12 @@
 #include <QCATsScriptable.hpp>
 #include <QTopology.hpp>
 #include <AmberRestart.hpp>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
 class QTopology;
+class QSelection;
 
 //------------------------------------------------------------------------------
 
@@ -139,6 +141,26 @@ public slots:
     /// point getCOM([selection][,point][,key1,...])
     QScriptValue getCOM(void);
 
+// bulk geometry methods -------------------------------------------------------
+    /// get all distances between atoms of two selections
+    /// distances are stored row-wise, i.e., (i-1)*n2+j for i-th atom of selection1
+    /// vector getDistances(selection1,selection2[,vector][,pbc])
+    QScriptValue getDistances(void);
+
+    /// get distances between atoms of selection and point
+    /// vector getDistancesToPoint(selection,point[,vector][,pbc])
+    QScriptValue getDistancesToPoint(void);
+
+    /// get minimum distance between atoms of two selections
+    /// double getMinDistance(selection1,selection2[,pbc])
+    QScriptValue getMinDistance(void);
+
+    /// get COMs of residues, only selected atoms are considered if selection is provided
+    /// COMs are stored in the order of residues in the topology (ascending residue index),
+    /// residues without selected atoms are skipped, use vector.getPoint(index) to access COMs
+    /// vector getResidueCOMs([selection][,vector][,nomass])
+    QScriptValue getResidueCOMs(void);
+
 // atom access methods ---------------------------------------------------------
     /// get number of atoms
     /// int getNumOfAtoms()
@@ -171,6 +193,13 @@ public:
 private:
     CAmberRestart   Restart;
 
+    /// copy positions of selected atoms into separate coordinate arrays
+    void GatherPositions(QSelection* p_qsel,std::vector<double>& x,
+                         std::vector<double>& y,std::vector<double>& z);
+
+    /// check that selection is compatible with the snapshot
+    bool CheckSelection(QSelection* p_qsel,CSmallString& error);
+
     friend class QSelection;
     friend class QRSelection;
     friend class QAverageSnapshot;
@@ -179,6 +208,7 @@ private:
     friend class QTrajPool;
     friend class QPMFLibCVs;
     friend class QCovarMatrix;
+    friend class QFitContext;
     friend class QTransformation;
     friend class QVolumeData;
     friend class QPMFLib;
@@ -186,6 +216,7 @@ private:
     friend class QMolSurf;
     friend class QTinySpline;
     friend class QCurvesP;
+    friend class QDistanceMask;
 
     /// clear object data if topology is cleaned - only weak objects
     virtual void CleanData(void);
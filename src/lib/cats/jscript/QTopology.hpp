@@ -130,6 +130,7 @@ private:
     friend class QTrajPool;
     friend class QSelection;
     friend class QRSelection ;
+    friend class QDistanceMask;
     friend class QPMFLibCVs;
     friend class QCovarMatrix;
     friend class QResidue;
@@ -31,6 +31,7 @@
 #include <ErrorSystem.hpp>
 #include <TerminalStr.hpp>
 #include <FileSystem.hpp>
+#include <TrajectoryIndex.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -46,6 +47,160 @@ QTrajPool::CTrajPoolItem::CTrajPoolItem(void)
     NumOfSnapshots = -1;
 }
 
+//------------------------------------------------------------------------------
+
+QTrajPool::CPoolCursor::CPoolCursor(void)
+{
+    StreamItem = 0;
+    StreamSnapshot = 0;
+    StreamGlobal = 0;
+    RandomItem = -1;
+    CacheItem = -1;
+    NextSnapshot = 1;
+    FirstSnapshot = 1;
+    LastSnapshot = 0;
+    Stride = 1;
+    Item = -1;
+    ItemSnapshot = 0;
+    GlobalSnapshot = 0;
+}
+
+//------------------------------------------------------------------------------
+
+QTrajPool::CSharedReader::CSharedReader(void)
+{
+    Initialized = false;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+QTrajPool::CReadAhead::CReadAhead(QTrajPool* p_owner)
+{
+    Owner = p_owner;
+    FinalResult = 1;
+    Finished = false;
+    Terminated = false;
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajPool::CReadAhead::Start(int nslots,const CPoolCursor& cursor,const std::vector<CTrajPoolItem>& items)
+{
+    Items = items;
+
+    Cursor.Trajectory.AssignTopology(cursor.Trajectory.GetTopology());
+    Cursor.FirstSnapshot = cursor.FirstSnapshot;
+    Cursor.LastSnapshot = cursor.LastSnapshot;
+    Cursor.Stride = cursor.Stride;
+    Cursor.NextSnapshot = cursor.NextSnapshot;
+
+    Slots.resize(nslots);
+    SlotItems.resize(nslots);
+    SlotItemSnapshots.resize(nslots);
+    SlotGlobalSnapshots.resize(nslots);
+    for(int i=0; i < nslots; i++) {
+        Slots[i].AssignTopology(cursor.Trajectory.GetTopology());
+        Slots[i].Create();
+        FreeSlots.push(i);
+    }
+
+    FinalResult = 1;
+    Finished = false;
+    Terminated = false;
+
+    return( StartThread() );
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::CReadAhead::Stop(void)
+{
+    RingMutex.Lock();
+    Terminated = true;
+    FreeCond.BroadcastSignal();
+    ReadyCond.BroadcastSignal();
+    RingMutex.Unlock();
+
+    WaitForThread();
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajPool::CReadAhead::Pop(int& slot)
+{
+    RingMutex.Lock();
+
+    while( ReadySlots.empty() && (Finished == false) && (Terminated == false) ) {
+        ReadyCond.WaitForSignal(RingMutex);
+    }
+
+    bool result = false;
+    if( ReadySlots.empty() == false ) {
+        slot = ReadySlots.front();
+        ReadySlots.pop();
+        result = true;
+    }
+
+    RingMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::CReadAhead::Release(int slot)
+{
+    RingMutex.Lock();
+    FreeSlots.push(slot);
+    FreeCond.Signal();
+    RingMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::CReadAhead::ExecuteThread(void)
+{
+    for(;;) {
+        // get free slot
+        RingMutex.Lock();
+        while( FreeSlots.empty() && (Terminated == false) ) {
+            FreeCond.WaitForSignal(RingMutex);
+        }
+        if( Terminated == true ) {
+            RingMutex.Unlock();
+            break;
+        }
+        int slot = FreeSlots.front();
+        FreeSlots.pop();
+        RingMutex.Unlock();
+
+        // decode snapshot outside of the lock, the next segment is opened
+        // as soon as the previous one is exhausted
+        int result = Owner->ReadCursor(Cursor,Items,&Slots[slot],Cursor.Stride);
+
+        // publish snapshot
+        RingMutex.Lock();
+        if( result == 0 ) {
+            SlotItems[slot] = Cursor.Item;
+            SlotItemSnapshots[slot] = Cursor.ItemSnapshot;
+            SlotGlobalSnapshots[slot] = Cursor.GlobalSnapshot;
+            ReadySlots.push(slot);
+        } else {
+            FreeSlots.push(slot);
+            FinalResult = result;
+            Finished = true;
+        }
+        ReadyCond.BroadcastSignal();
+        RingMutex.Unlock();
+
+        if( result != 0 ) break;
+    }
+
+    Owner->ResetCursor(Cursor);
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -71,7 +226,9 @@ QScriptValue QTrajPool::New(QScriptContext *context,
         sout << "Trajectory pool object" << endl;
         sout << endl;
         sout << "Constructors:" << endl;
-        sout << "   new TrajPool(topology)" << endl;
+        sout << "   new TrajPool(topology[,name])" << endl;
+        sout << endl;
+        sout << "In parallel mode, pools with the same name share the reader of all workers." << endl;
         return(scriptable.GetUndefinedValue());
     }
 
@@ -79,14 +236,25 @@ QScriptValue QTrajPool::New(QScriptContext *context,
     value = scriptable.IsCalledAsConstructor();
     if( value.isError() ) return(value);
 
-    value = scriptable.CheckNumberOfArguments("topology",1);
+    value = scriptable.CheckNumberOfArguments("topology[,name]",1,2);
     if( value.isError() ) return(value);
 
     QTopology* p_qtop;
-    value = scriptable.GetArgAsObject<QTopology*>("topology","topology","Topology",1,p_qtop);
+    value = scriptable.GetArgAsObject<QTopology*>("topology[,name]","topology","Topology",1,p_qtop);
     if( value.isError() ) return(value);
 
-    QTrajPool* p_obj = new QTrajPool(scriptable.GetArgument(1));
+    QString name("trajpool");
+    if( scriptable.GetArgumentCount() > 1 ){
+        value = scriptable.GetArgAsString("topology[,name]","name",2,name);
+        if( value.isError() ) return(value);
+    }
+
+    if( CParallelContext::IsParallel() && (CParallelContext::ClaimObjectName(name.toStdString()) == false) ){
+        QString error = "pool name '" + name + "' is already used, pools must have unique names in parallel mode";
+        return( scriptable.ThrowError("topology[,name]",error) );
+    }
+
+    QTrajPool* p_obj = new QTrajPool(scriptable.GetArgument(1),name);
     return(engine->newQObject(p_obj, QScriptEngine::ScriptOwnership));
 }
 
@@ -94,31 +262,49 @@ QScriptValue QTrajPool::New(QScriptContext *context,
 //------------------------------------------------------------------------------
 //==============================================================================
 
-QTrajPool::QTrajPool(const QScriptValue& top)
+QTrajPool::QTrajPool(const QScriptValue& top,const QString& name)
     : QCATsScriptable("TrajPool")
 {
     RegisterAsWeakObject(top);
-    Trajectory.AssignTopology(&GetQTopology()->Topology);
+    Cursor.Trajectory.AssignTopology(&GetQTopology()->Topology);
     CurrentItem = -1;
     ProgressStarted = false;
     CurrentSnapshot = 0;
     ItemSnapshot = 0;
+    GlobalSnapshot = 0;
     PrevCurrSnapshot = -1;
     DefaultTmpName = "prod%03d.traj";
     IgnoreMissingFiles = true;
+    UseIndexFiles = true;
+    SharedName = name.toStdString();
+    SharedReader = NULL;
+    ReadAheadSize = 0;
+    ReadAhead = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+QTrajPool::~QTrajPool(void)
+{
+    StopReadAhead();
 }
 
 //------------------------------------------------------------------------------
 
 void QTrajPool::CleanData(void)
 {
+    StopReadAhead();
     Items.clear();
     CurrentItem = -1;
     ProgressStarted = false;
     CurrentSnapshot = 0;
     ItemSnapshot = 0;
+    GlobalSnapshot = 0;
     PrevCurrSnapshot = -1;
-    Trajectory.CloseTrajectoryFile();
+    Cursor.FirstSnapshot = 1;
+    Cursor.LastSnapshot = 0;
+    Cursor.Stride = 1;
+    ResetCursor(Cursor);
 }
 
 //==============================================================================
@@ -158,6 +344,7 @@ QScriptValue QTrajPool::addTrajectory(void)
         sout << "               ascii.gzip - compressed ASCII format" << endl;
         sout << "               ascii.bzip - compressed ASCII format" << endl;
         sout << "               netcdf     - NETCDF format" << endl;
+        sout << "               cache      - trajectory cache created by traj2cache" << endl;
         return(false);
     }
 
@@ -207,6 +394,7 @@ QScriptValue QTrajPool::addTrajList(void)
         sout << "               ascii.gzip - compressed ASCII format" << endl;
         sout << "               ascii.bzip - compressed ASCII format" << endl;
         sout << "               netcdf     - NETCDF format" << endl;
+        sout << "               cache      - trajectory cache created by traj2cache" << endl;
         return(false);
     }
 
@@ -270,6 +458,7 @@ QScriptValue QTrajPool::addTrajListFrom(void)
         sout << "               ascii.gzip - compressed ASCII format" << endl;
         sout << "               ascii.bzip - compressed ASCII format" << endl;
         sout << "               netcdf     - NETCDF format" << endl;
+        sout << "               cache      - trajectory cache created by traj2cache" << endl;
         return(false);
     }
 
@@ -331,6 +520,9 @@ QScriptValue QTrajPool::addTrajListFrom(void)
 
 int QTrajPool::addTrajFile(const QString& name,const QString& fmt)
 {
+    // decoding thread works with a copy of items
+    StopReadAhead();
+
     CTrajPoolItem item;
     item.Name = name;
     item.Format = fmt;
@@ -342,8 +534,73 @@ int QTrajPool::addTrajFile(const QString& name,const QString& fmt)
         return(1);
     }
 
+    if( (fmt == "cache") || ((decodeFormat(fmt) == AMBER_TRAJ_UNKNOWN) && CTrajectoryCache::IsTrajectoryCache(CSmallString(name))) ){
+        // the cache header contains everything
+        CTrajectoryCache cache;
+        if( cache.OpenForReading(CSmallString(name)) == false ) return(-1);
+        int natoms = Cursor.Trajectory.GetTopology()->AtomList.GetNumberOfAtoms();
+        if( natoms != cache.GetNumberOfAtoms() ){
+            CSmallString error;
+            if( natoms == cache.GetNumberOfTopologyAtoms() ){
+                error << "trajectory cache '" << name << "' contains only a subset of atoms ("
+                      << cache.GetNumberOfAtoms() << " of " << natoms << "), use the topology of the subset";
+            } else {
+                error << "trajectory cache '" << name << "' does not match the topology";
+            }
+            ES_ERROR(error);
+            return(-1);
+        }
+        item.Format = "cache";
+        item.NumOfSnapshots = cache.GetNumberOfSnapshots();
+        Items.push_back(item);
+        return(0);
+    }
+
+    if( UseIndexFiles ){
+        // try to avoid opening of the entire trajectory
+        CTrajectoryIndex    index;
+        CSmallString        sname(name);
+        ETrajectoryFormat   format = decodeFormat(fmt);
+        CAmberTopology*     p_top = Cursor.Trajectory.GetTopology();
+        bool                loaded = false;
+
+        if( CParallelContext::IsParallel() ){
+            // workers share the same files - the master builds missing index,
+            // the others load it once it is saved
+            std::vector<double> status(1,0.0);
+            if( CParallelContext::IsMaster() ){
+                loaded = index.Load(sname,format,p_top);
+                if( loaded == false ){
+                    loaded = index.Build(sname,format,p_top);
+                    if( loaded ) index.Save(sname);
+                }
+                status[0] = loaded ? 1.0 : 0.0;
+            }
+            CParallelContext::AllReduce(status);
+            if( status[0] == 0.0 ) return(-1);
+            if( CParallelContext::IsMaster() == false ){
+                loaded = index.Load(sname,format,p_top);
+            }
+        } else {
+            loaded = index.Load(sname,format,p_top);
+        }
+
+        if( loaded == false ){
+            // missing index or it could not be saved by the master
+            if( index.Build(sname,format,p_top) == false ){
+                return(-1);
+            }
+            if( CParallelContext::IsParallel() == false ) index.Save(sname);
+        }
+        item.Format = encodeFormat(index.GetFormat());
+        item.NumOfSnapshots = index.GetNumberOfSnapshots();
+        item.Index = index;
+        Items.push_back(item);
+        return(0);
+    }
+
     CAmberTrajectory traj;
-    traj.AssignTopology(Trajectory.GetTopology());
+    traj.AssignTopology(Cursor.Trajectory.GetTopology());
     if( traj.OpenTrajectoryFile(name,decodeFormat(fmt),AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ) == false ){
         return(-1);
     }
@@ -358,6 +615,65 @@ int QTrajPool::addTrajFile(const QString& name,const QString& fmt)
 
 //------------------------------------------------------------------------------
 
+QScriptValue QTrajPool::useIndexFiles(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: TrajPool::useIndexFiles(set)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("set",1);
+    if( value.isError() ) return(value);
+
+    bool set;
+    value = GetArgAsBool("set","set",1,set);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    UseIndexFiles = set;
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajPool::setReadAhead(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: TrajPool::setReadAhead(nsnapshots)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("nsnapshots",1);
+    if( value.isError() ) return(value);
+
+    int nsnapshots;
+    value = GetArgAsInt("nsnapshots","nsnapshots",1,nsnapshots);
+    if( value.isError() ) return(value);
+
+    if( nsnapshots < 0 ){
+        return( ThrowError("nsnapshots","nsnapshots must not be negative") );
+    }
+
+// execute ---------------------------------------
+    StopReadAhead();
+    // workers already overlap reading with analysis
+    if( CParallelContext::IsParallel() ) return(value);
+    ReadAheadSize = nsnapshots;
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
 QScriptValue QTrajPool::clear(void)
 {
     QScriptValue value;
@@ -374,13 +690,22 @@ QScriptValue QTrajPool::clear(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
+    StopReadAhead();
     Items.clear();
     CurrentItem = -1;
     ProgressStarted = false;
     CurrentSnapshot = 0;
     ItemSnapshot = 0;
+    GlobalSnapshot = 0;
     PrevCurrSnapshot = -1;
-    Trajectory.CloseTrajectoryFile();
+    Cursor.FirstSnapshot = 1;
+    Cursor.LastSnapshot = 0;
+    Cursor.Stride = 1;
+    ResetCursor(Cursor);
+
+    if( CParallelContext::IsParallel() ){
+        ResetSharedReader(true);
+    }
 
     return(value);
 }
@@ -403,12 +728,18 @@ QScriptValue QTrajPool::rewind(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
+    StopReadAhead();
     CurrentItem = -1;
     ProgressStarted = false;
     CurrentSnapshot = 0;
     ItemSnapshot = 0;
+    GlobalSnapshot = 0;
     PrevCurrSnapshot = -1;
-    Trajectory.CloseTrajectoryFile();
+    ResetCursor(Cursor);
+
+    if( CParallelContext::IsParallel() ){
+        ResetSharedReader(false);
+    }
 
     return(value);
 }
@@ -425,99 +756,537 @@ QScriptValue QTrajPool::read(void)
     if( IsHelpRequested() ){
         CTerminalStr sout;
         sout << "usage: snapshot TrajPool::read(snapshot)" << endl;
+        sout << "       snapshot TrajPool::read(snapshot,stride)" << endl;
+        sout << "       snapshot TrajPool::read(stride)" << endl;
         sout << "       snapshot TrajPool::read()" << endl;
         return(false);
     }
 
 // check arguments -------------------------------
-    value = CheckNumberOfArguments("[snapshot]",0,1);
+    value = CheckNumberOfArguments("[snapshot][,stride]",0,2);
     if( value.isError() ) return(value);
 
     QSnapshot* p_qsnap = NULL;
-    if( GetArgumentCount() == 1 ){
-        value = GetArgAsObject<QSnapshot*>("snapshot","snapshot","Snapshot",1,p_qsnap);
+    bool       snap_provided = false;
+    int        stride = Cursor.Stride;
+
+    if( (GetArgumentCount() >= 1) && IsArgumentObject<QSnapshot*>(1) ){
+        value = GetArgAsObject<QSnapshot*>("snapshot[,stride]","snapshot","Snapshot",1,p_qsnap);
         if( value.isError() ) return(value);
-    } else {
+        snap_provided = true;
+        if( GetArgumentCount() == 2 ){
+            value = GetArgAsInt("snapshot,stride","stride",2,stride);
+            if( value.isError() ) return(value);
+        }
+    } else if( GetArgumentCount() == 1 ){
+        value = GetArgAsInt("stride","stride",1,stride);
+        if( value.isError() ) return(value);
+    } else if( GetArgumentCount() == 2 ){
+        return( ThrowError("snapshot,stride","snapshot is not Snapshot object") );
+    }
+
+    if( stride <= 0 ){
+        return( ThrowError("[snapshot,]stride","stride must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    if( snap_provided == false ){
         p_qsnap = new QSnapshot(JSTopology);
     }
 
+    int result;
+    if( CParallelContext::IsParallel() ){
+        result = ReadSharedSnapshot(&p_qsnap->Restart,stride);
+    } else {
+        result = ReadSnapshot(&p_qsnap->Restart,stride);
+    }
+
+    if( result == 0 ) {
+        if( snap_provided ){
+            return(GetArgument(1));
+        } else {
+            return(engine()->newQObject(p_qsnap, QScriptEngine::ScriptOwnership));
+        }
+    }
+
+    if( snap_provided == false ){
+        delete p_qsnap;
+    }
+
+    switch(result){
+        case 1:
+            // end of pool
+            return( GetUndefinedValue() );
+        case -1:
+            return( ThrowError("[snapshot][,stride]","unable to open the next trajectory segment") );
+        default:
+            return( ThrowError("[snapshot][,stride]","unable to read the trajectory") );
+    }
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajPool::seek(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool TrajPool::seek(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("index",1);
+    if( value.isError() ) return(value);
+
+    int index;
+    value = GetArgAsInt("index","index",1,index);
+    if( value.isError() ) return(value);
+
+    if( index <= 0 ){
+        return( ThrowError("index","index must be greater than zero") );
+    }
+
 // execute ---------------------------------------
+    StopReadAhead();
+    Cursor.NextSnapshot = index;
 
-    // is pool opened
-    if( CurrentItem < 0 ){
-        CurrentItem = 0;
-        ItemSnapshot = 0;
-        if( CurrentItem >= (int)Items.size() ){
-            // no items in the pool
-            return(false);
+    if( CParallelContext::IsParallel() ){
+        UpdateSharedRange();
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajPool::setRange(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool TrajPool::setRange(first[,last[,stride]])" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("first[,last[,stride]]",1,3);
+    if( value.isError() ) return(value);
+
+    int first;
+    value = GetArgAsInt("first[,last[,stride]]","first",1,first);
+    if( value.isError() ) return(value);
+
+    int last = 0;
+    if( GetArgumentCount() > 1 ){
+        value = GetArgAsInt("first,last[,stride]","last",2,last);
+        if( value.isError() ) return(value);
+    }
+
+    int stride = 1;
+    if( GetArgumentCount() > 2 ){
+        value = GetArgAsInt("first,last,stride","stride",3,stride);
+        if( value.isError() ) return(value);
+    }
+
+    if( first <= 0 ){
+        return( ThrowError("first[,last[,stride]]","first must be greater than zero") );
+    }
+    if( (last != 0) && (last < first) ){
+        return( ThrowError("first,last[,stride]","last must not be smaller than first") );
+    }
+    if( stride <= 0 ){
+        return( ThrowError("first,last,stride","stride must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    StopReadAhead();
+    Cursor.FirstSnapshot = first;
+    Cursor.LastSnapshot = last;
+    Cursor.Stride = stride;
+    Cursor.NextSnapshot = first;
+
+    if( CParallelContext::IsParallel() ){
+        UpdateSharedRange();
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::ReadSnapshot(CAmberRestart* p_rst,int stride)
+{
+    if( ReadAheadSize > 0 ){
+        if( stride == Cursor.Stride ) return(ReadPrefetchedSnapshot(p_rst));
+        // prefetched snapshots follow the range stride
+        StopReadAhead();
+    }
+
+    int result = ReadCursor(Cursor,Items,p_rst,stride);
+    UpdatePosition(Cursor,result);
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::ReadPrefetchedSnapshot(CAmberRestart* p_rst)
+{
+    if( ReadAhead == NULL ){
+        ReadAhead = new CReadAhead(this);
+        if( ReadAhead->Start(ReadAheadSize,Cursor,Items) == false ){
+            ES_WARNING("unable to start read-ahead thread, snapshots are read synchronously");
+            delete ReadAhead;
+            ReadAhead = NULL;
+            ReadAheadSize = 0;
+            int result = ReadCursor(Cursor,Items,p_rst,Cursor.Stride);
+            UpdatePosition(Cursor,result);
+            return(result);
         }
-        CurrentSnapshot = 0;
-        if( Trajectory.OpenTrajectoryFile(Items[CurrentItem].Name,
-                decodeFormat(Items[CurrentItem].Format), AMBER_TRAJ_CXYZB,  AMBER_TRAJ_READ) == false ){
-            if( GetArgumentCount() == 0 ){
-                delete p_qsnap;
-            }
-            return( ThrowError("snapshot","unable to open the next trajectory segment") );
+    }
+
+    int slot;
+    if( ReadAhead->Pop(slot) == false ){
+        int result = ReadAhead->FinalResult;
+        UpdatePosition(Cursor,result);
+        return(result);
+    }
+
+    CopySnapshot(p_rst,&ReadAhead->Slots[slot]);
+
+    // the local cursor follows the delivered snapshots
+    Cursor.Item = ReadAhead->SlotItems[slot];
+    Cursor.ItemSnapshot = ReadAhead->SlotItemSnapshots[slot];
+    Cursor.GlobalSnapshot = ReadAhead->SlotGlobalSnapshots[slot];
+    Cursor.NextSnapshot = Cursor.GlobalSnapshot + Cursor.Stride;
+
+    ReadAhead->Release(slot);
+
+    UpdatePosition(Cursor,0);
+    return(0);
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::StopReadAhead(void)
+{
+    if( ReadAhead == NULL ) return;
+    ReadAhead->Stop();
+    delete ReadAhead;
+    ReadAhead = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::CopySnapshot(CAmberRestart* p_dst,CAmberRestart* p_src)
+{
+    for(int i=0; i < p_src->GetNumberOfAtoms(); i++){
+        p_dst->SetPosition(i,p_src->GetPosition(i));
+    }
+    if( p_src->IsBoxPresent() ){
+        p_dst->SetBox(p_src->GetBox());
+        p_dst->SetAngles(p_src->GetAngles());
+    }
+    p_dst->SetTime(p_src->GetTime());
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::ReadSharedSnapshot(CAmberRestart* p_rst,int stride)
+{
+    CSharedReader* p_reader = GetSharedReader();
+
+    p_reader->ReaderMutex.Lock();
+
+    if( p_reader->Initialized == false ){
+        // the first worker provides the pool setup
+        p_reader->Items = Items;
+        p_reader->Cursor.Trajectory.AssignTopology(Cursor.Trajectory.GetTopology());
+        p_reader->Cursor.FirstSnapshot = Cursor.FirstSnapshot;
+        p_reader->Cursor.LastSnapshot = Cursor.LastSnapshot;
+        p_reader->Cursor.Stride = Cursor.Stride;
+        p_reader->Cursor.NextSnapshot = Cursor.NextSnapshot;
+        p_reader->Initialized = true;
+    }
+
+    int result = ReadCursor(p_reader->Cursor,p_reader->Items,p_rst,stride);
+
+    // local copy of the position of the delivered snapshot
+    UpdatePosition(p_reader->Cursor,result);
+
+    p_reader->ReaderMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::ReadCursor(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,CAmberRestart* p_rst,int stride)
+{
+    int target = cursor.NextSnapshot;
+    if( (cursor.LastSnapshot > 0) && (target > cursor.LastSnapshot) ) return(1);
+
+    int item = -1;
+    int local = 0;
+    int result = 0;
+
+    int located = LocateSnapshot(items,target,item,local);
+    if( located == 1 ) return(1);
+
+    if( (located == 0) && (items[item].Format == "cache") ){
+        // cached snapshots are always accessed directly
+        if( OpenCache(cursor,items,item) == false ) return(-1);
+        if( cursor.Cache.ReadSnapshot(local-1,p_rst) == false ) return(-2);
+    } else if( target == cursor.StreamGlobal + 1 ){
+        // sequential reading
+        result = ReadStream(cursor,items,p_rst);
+        if( result != 0 ) return(result);
+        item = cursor.StreamItem;
+        local = cursor.StreamSnapshot;
+    } else if( (located == 0) && OpenRandomReader(cursor,items,item) ){
+        // direct access
+        if( cursor.RandomReader.ReadSnapshot(local-1,p_rst) == false ) return(-2);
+    } else {
+        // compressed trajectories are streams
+        if( target > cursor.StreamGlobal + 1 ){
+            result = SkipStream(cursor,items,target,p_rst);
+        } else {
+            ResetCursor(cursor);
+            cursor.NextSnapshot = target;
+            result = SkipStream(cursor,items,target,p_rst);
         }
+        if( result == 0 ) result = ReadStream(cursor,items,p_rst);
+        if( result != 0 ) return(result);
+        item = cursor.StreamItem;
+        local = cursor.StreamSnapshot;
     }
 
-    int result = Trajectory.ReadSnapshot(&p_qsnap->Restart);
-    if( result == 0 ){
-        CurrentSnapshot++;
-        ItemSnapshot++;
-    } else if( result == 1 ) {
-        ItemSnapshot = 0;
-        // end of file
-        PrevCurrSnapshot = CurrentSnapshot;
-        Trajectory.CloseTrajectoryFile();
-        CurrentItem++;
-        if( CurrentItem >= (int)Items.size() ){
+    cursor.Item = item;
+    cursor.ItemSnapshot = local;
+    cursor.GlobalSnapshot = target;
+    cursor.NextSnapshot = target + stride;
+
+    return(0);
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::ReadStream(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,CAmberRestart* p_rst)
+{
+    for(;;){
+        if( cursor.StreamItem >= (int)items.size() ){
             // no items in the pool
-            if( GetArgumentCount() == 0 ){
-                delete p_qsnap;
+            return(1);
+        }
+        if( items[cursor.StreamItem].Format == "cache" ){
+            if( cursor.StreamSnapshot < items[cursor.StreamItem].NumOfSnapshots ){
+                if( OpenCache(cursor,items,cursor.StreamItem) == false ) return(-1);
+                if( cursor.Cache.ReadSnapshot(cursor.StreamSnapshot,p_rst) == false ) return(-2);
+                cursor.StreamSnapshot++;
+                cursor.StreamGlobal++;
+                return(0);
             }
-            return( GetUndefinedValue() );
+            cursor.StreamItem++;
+            cursor.StreamSnapshot = 0;
+            continue;
         }
-        if( Trajectory.OpenTrajectoryFile(Items[CurrentItem].Name,
-                                      decodeFormat(Items[CurrentItem].Format),
-                                      AMBER_TRAJ_CXYZB,
-                                      AMBER_TRAJ_READ) == false ){
-            if( GetArgumentCount() == 0 ){
-                delete p_qsnap;
+        if( cursor.Trajectory.IsItOpened() == false ){
+            if( cursor.Trajectory.OpenTrajectoryFile(items[cursor.StreamItem].Name,
+                                          decodeFormat(items[cursor.StreamItem].Format),
+                                          AMBER_TRAJ_CXYZB,
+                                          AMBER_TRAJ_READ) == false ){
+                return(-1);
             }
-            return( ThrowError("snapshot","unable to open the next trajectory segment") );
+            cursor.StreamSnapshot = 0;
         }
-        // try to read again
-        CurrentSnapshot = 0;
-        result = Trajectory.ReadSnapshot(&p_qsnap->Restart);
+
+        int result = cursor.Trajectory.ReadSnapshot(p_rst);
         if( result == 0 ){
-            CurrentSnapshot++;
-            ItemSnapshot++;
+            cursor.StreamSnapshot++;
+            cursor.StreamGlobal++;
+            return(0);
         }
+        if( result != 1 ) return(-2);
+
+        // end of file - try the next item
+        cursor.Trajectory.CloseTrajectoryFile();
+        cursor.StreamItem++;
+        cursor.StreamSnapshot = 0;
     }
+}
 
-    if( result == 0 ) {
-        if( GetArgumentCount() == 1 ){
-            return(GetArgument(1));
-        } else {
-            return(engine()->newQObject(p_qsnap, QScriptEngine::ScriptOwnership));
+//------------------------------------------------------------------------------
+
+int QTrajPool::SkipStream(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int target,CAmberRestart* p_rst)
+{
+    while( cursor.StreamGlobal < target - 1 ){
+        if( cursor.StreamItem >= (int)items.size() ) return(1);
+
+        // skip entire items without opening them
+        int nsnaps = items[cursor.StreamItem].NumOfSnapshots;
+        if( (cursor.Trajectory.IsItOpened() == false) && (cursor.StreamSnapshot == 0) &&
+            (nsnaps >= 0) && (cursor.StreamGlobal + nsnaps < target) ){
+            cursor.StreamGlobal += nsnaps;
+            cursor.StreamItem++;
+            continue;
         }
-    } else if ( result == 1 ){
-        // end of file
-        if( GetArgumentCount() == 0 ){
-            delete p_qsnap;
+
+        int result = ReadStream(cursor,items,p_rst);
+        if( result != 0 ) return(result);
+    }
+    return(0);
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajPool::LocateSnapshot(std::vector<CTrajPoolItem>& items,int target,int& item,int& local)
+{
+    int first = 1;
+    for(int i=0; i < (int)items.size(); i++){
+        if( items[i].NumOfSnapshots < 0 ) return(-1);
+        if( target < first + items[i].NumOfSnapshots ){
+            item = i;
+            local = target - first + 1;
+            return(0);
         }
-        return( GetUndefinedValue() );
-    } else {
-        if( GetArgumentCount() == 0 ){
-            delete p_qsnap;
+        first += items[i].NumOfSnapshots;
+    }
+    return(1);
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajPool::OpenRandomReader(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int item)
+{
+    if( cursor.RandomItem == item ) return(true);
+
+    cursor.RandomReader.Close();
+    cursor.RandomItem = -1;
+
+    CTrajPoolItem&      pitem = items[item];
+    ETrajectoryFormat   format = decodeFormat(pitem.Format);
+    if( (format != AMBER_TRAJ_ASCII) && (format != AMBER_TRAJ_NETCDF) ) return(false);
+
+    CSmallString name(pitem.Name);
+    if( pitem.Index.GetNumberOfSnapshots() < 0 ){
+        // index files are not used, the index is cheap for these formats
+        if( pitem.Index.Build(name,format,cursor.Trajectory.GetTopology()) == false ) return(false);
+    }
+    if( cursor.RandomReader.Open(name,pitem.Index) == false ) return(false);
+
+    cursor.RandomItem = item;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajPool::OpenCache(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int item)
+{
+    if( cursor.CacheItem == item ) return(true);
+
+    cursor.CacheItem = -1;
+    if( cursor.Cache.OpenForReading(CSmallString(items[item].Name)) == false ) return(false);
+
+    cursor.CacheItem = item;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::ResetCursor(CPoolCursor& cursor)
+{
+    cursor.Trajectory.CloseTrajectoryFile();
+    cursor.StreamItem = 0;
+    cursor.StreamSnapshot = 0;
+    cursor.StreamGlobal = 0;
+    cursor.RandomReader.Close();
+    cursor.RandomItem = -1;
+    cursor.Cache.Close();
+    cursor.CacheItem = -1;
+    cursor.NextSnapshot = cursor.FirstSnapshot;
+    cursor.Item = -1;
+    cursor.ItemSnapshot = 0;
+    cursor.GlobalSnapshot = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::UpdatePosition(const CPoolCursor& cursor,int result)
+{
+    if( result == 0 ){
+        if( (CurrentItem >= 0) && (CurrentItem != cursor.Item) ){
+            // finish progress of the previous item
+            PrevCurrSnapshot = CurrentSnapshot;
         }
-        return( ThrowError("snapshot","unable to read the trajectory") );
+        CurrentItem = cursor.Item;
+        CurrentSnapshot = cursor.ItemSnapshot;
+        ItemSnapshot = cursor.ItemSnapshot;
+        GlobalSnapshot = cursor.GlobalSnapshot;
+        return;
+    }
+
+    if( (result == 1) && (CurrentItem < (int)Items.size()) ){
+        // end of pool
+        if( CurrentItem >= 0 ) PrevCurrSnapshot = CurrentSnapshot;
+        CurrentItem = Items.size();
+        ItemSnapshot = 0;
     }
 }
 
 //------------------------------------------------------------------------------
 
+QTrajPool::CSharedReader* QTrajPool::GetSharedReader(void)
+{
+    if( SharedReader == NULL ){
+        SharedReader = dynamic_cast<CSharedReader*>(CParallelContext::RegisterObject(SharedName,new CSharedReader));
+    }
+    return(SharedReader);
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::ResetSharedReader(bool clear)
+{
+    CParallelContext::Barrier();
+    if( CParallelContext::IsMaster() ){
+        CSharedReader* p_reader = GetSharedReader();
+        p_reader->ReaderMutex.Lock();
+        if( clear ){
+            p_reader->Items.clear();
+            p_reader->Initialized = false;
+            p_reader->Cursor.FirstSnapshot = 1;
+            p_reader->Cursor.LastSnapshot = 0;
+            p_reader->Cursor.Stride = 1;
+        }
+        ResetCursor(p_reader->Cursor);
+        p_reader->ReaderMutex.Unlock();
+    }
+    CParallelContext::Barrier();
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajPool::UpdateSharedRange(void)
+{
+    CParallelContext::Barrier();
+    if( CParallelContext::IsMaster() ){
+        CSharedReader* p_reader = GetSharedReader();
+        p_reader->ReaderMutex.Lock();
+        p_reader->Cursor.FirstSnapshot = Cursor.FirstSnapshot;
+        p_reader->Cursor.LastSnapshot = Cursor.LastSnapshot;
+        p_reader->Cursor.Stride = Cursor.Stride;
+        p_reader->Cursor.NextSnapshot = Cursor.NextSnapshot;
+        p_reader->ReaderMutex.Unlock();
+    }
+    CParallelContext::Barrier();
+}
+
+//------------------------------------------------------------------------------
+
 ETrajectoryFormat QTrajPool::decodeFormat(const QString& format)
 {
     if( format == "ascii" ){
@@ -572,7 +1341,7 @@ QScriptValue QTrajPool::printInfo(void)
 // execute ---------------------------------------
     cout << "=== Trajectory pool" << endl;
     cout << "# Number of items : " << Items.size() << endl;
-    cout << "# Number of atoms : " << Trajectory.GetNumberOfAtoms() << endl;
+    cout << "# Number of atoms : " << Cursor.Trajectory.GetNumberOfAtoms() << endl;
     cout << "#" << endl;
     cout << "# Snapshots    Format   Name" << endl;
     cout << "# ---------- ---------- -----------------------------------------------------------" << endl;
@@ -613,6 +1382,9 @@ QScriptValue QTrajPool::printProgress(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
+    // only master reports progress
+    if( CParallelContext::IsParallel() && (CParallelContext::IsMaster() == false) ) return(value);
+
     if( (PrevCurrSnapshot >= 0) && (ProgressStarted == true) ){
         // finish previous progress
         if( ProgressSnaphost != PrevCurrSnapshot ){
@@ -638,7 +1410,7 @@ QScriptValue QTrajPool::printProgress(void)
         PrevCurrSnapshot = -1;
         ProgressStarted = false;
     }
-    if( CurrentItem >= (int)Items.size() ) return(value);
+    if( (CurrentItem < 0) || (CurrentItem >= (int)Items.size()) ) return(value);
 
     if( ProgressStarted == false ){
         QString name = Items[CurrentItem].Name.section('/', -1);
@@ -647,25 +1419,26 @@ QScriptValue QTrajPool::printProgress(void)
         ProgressSnaphost = 0;
     }
     if( ProgressStarted ){
-        if( ProgressSnaphost > Trajectory.GetNumberOfSnapshots() ) return(value);
+        int nsnaps = Items[CurrentItem].NumOfSnapshots;
+        if( ProgressSnaphost > nsnaps ) return(value);
         for(int i=ProgressSnaphost;i < CurrentSnapshot; i++){
-            if( Trajectory.GetNumberOfSnapshots() > 80 ){
-                if( i % (Trajectory.GetNumberOfSnapshots()/80) == 0 ){
+            if( nsnaps > 80 ){
+                if( i % (nsnaps/80) == 0 ){
                     cout << "=";
                 }
             }
-            if( i == Trajectory.GetNumberOfSnapshots()/4 ){
+            if( i == nsnaps/4 ){
                 cout << " 25% ";
             }
-            if( i == Trajectory.GetNumberOfSnapshots()/2 ){
+            if( i == nsnaps/2 ){
                 cout << " 50% ";
             }
-            if( i == 3*Trajectory.GetNumberOfSnapshots()/4 ){
+            if( i == 3*nsnaps/4 ){
                 cout << " 75% ";
             }
         }
         ProgressSnaphost = CurrentSnapshot;
-        if( CurrentSnapshot == Trajectory.GetNumberOfSnapshots() ){
+        if( CurrentSnapshot == nsnaps ){
                 cout << "|" << endl;
         }
         cout.flush();
@@ -716,7 +1489,7 @@ QScriptValue QTrajPool::getGlobalSnapshotIndex(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
-    return(CurrentSnapshot);
+    return(GlobalSnapshot);
 }
 
 //------------------------------------------------------------------------------
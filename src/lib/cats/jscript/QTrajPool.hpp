@@ -29,6 +29,14 @@
 #include <vector>
 #include <QCATsScriptable.hpp>
 #include <QTopology.hpp>
+#include <ParallelContext.hpp>
+#include <TrajectoryIndex.hpp>
+#include <TrajectoryFrameReader.hpp>
+#include <TrajectoryCache.hpp>
+#include <SimpleThread.hpp>
+#include <SimpleMutex.hpp>
+#include <SimpleCond.hpp>
+#include <queue>
 
 //------------------------------------------------------------------------------
 
@@ -41,7 +49,8 @@ class CATS_PACKAGE QTrajPool : public QTopologyObject, protected QScriptable, pr
     Q_OBJECT
 public:
 // constructor -----------------------------------------------------------------
-    QTrajPool(const QScriptValue& top);
+    QTrajPool(const QScriptValue& top,const QString& name);
+    ~QTrajPool(void);
     static QScriptValue New(QScriptContext *context,QScriptEngine *engine);
     static void Register(QScriptEngine& engine);
 
@@ -65,17 +74,46 @@ public slots:
     /// addTrajListFrom(first,last,path,tmpname,format)
     QScriptValue addTrajListFrom(void);
 
+    /// enable or disable index files (.NAME.cidx) caching number of snapshots
+    /// index files are enabled by default, in parallel execution all workers
+    /// must add the same files since missing index files are built by the master
+    /// useIndexFiles(set)
+    QScriptValue useIndexFiles(void);
+
+    /// decode up to nsnapshots snapshots in advance by a background thread
+    /// zero disables read-ahead (default), it is ignored in parallel mode
+    /// setReadAhead(nsnapshots)
+    QScriptValue setReadAhead(void);
+
     /// clear pool
+    /// it must be called by all workers in parallel mode
     QScriptValue clear(void);
 
     /// rewind to begining
+    /// it must be called by all workers in parallel mode
     QScriptValue rewind(void);
 
     /// read snapshot
+    /// in parallel mode (cats --threads), all workers share one reader
+    /// and each snapshot is delivered to only one of them
+    /// stride overrides the stride set by setRange for the following read
     /// snapshot read()
     /// snapshot read(snapshot)
+    /// snapshot read([snapshot,]stride)
     QScriptValue read(void);
 
+    /// set global index of the snapshot returned by the next read, the first snapshot has index one
+    /// segments are located by their number of snapshots without opening them
+    /// it must be called by all workers in parallel mode
+    /// bool seek(index)
+    QScriptValue seek(void);
+
+    /// restrict reading to global snapshots first, first+stride, ... not exceeding last
+    /// the range is kept after rewind, last equal to zero means the last snapshot
+    /// it must be called by all workers in parallel mode
+    /// bool setRange(first[,last[,stride]])
+    QScriptValue setRange(void);
+
     /// print info about entire pool
     QScriptValue printInfo(void);
 
@@ -111,27 +149,157 @@ private:
     class CTrajPoolItem {
     public:
         CTrajPoolItem(void);
-        QString     Name;
-        QString     Format;
-        int         NumOfSnapshots;
+        QString             Name;
+        QString             Format;
+        int                 NumOfSnapshots;
+        CTrajectoryIndex    Index;          // empty if index files are not used
+    };
+
+    // reading position in the pool
+    class CPoolCursor {
+    public:
+        CPoolCursor(void);
+        CAmberTrajectory        Trajectory;     // sequential stream
+        int                     StreamItem;     // item of the stream
+        int                     StreamSnapshot; // snapshots consumed from the stream item
+        int                     StreamGlobal;   // snapshots consumed from the stream in total
+        CTrajectoryFrameReader  RandomReader;
+        int                     RandomItem;     // item opened by RandomReader, -1 if none
+        CTrajectoryCache        Cache;
+        int                     CacheItem;      // item opened by Cache, -1 if none
+        int                     NextSnapshot;   // global index of snapshot returned by the next read
+        int                     FirstSnapshot;
+        int                     LastSnapshot;   // zero - last snapshot in the pool
+        int                     Stride;
+        int                     Item;           // position of the last read snapshot
+        int                     ItemSnapshot;
+        int                     GlobalSnapshot;
+    };
+
+    // reader shared by all parallel workers
+    class CSharedReader : public CParallelObject {
+    public:
+        CSharedReader(void);
+        CSimpleMutex                ReaderMutex;
+        bool                        Initialized;
+        std::vector<CTrajPoolItem>  Items;
+        CPoolCursor                 Cursor;
+    };
+
+    // background decoding of snapshots into a bounded ring of buffers
+    class CReadAhead : public CSimpleThread {
+    public:
+        CReadAhead(QTrajPool* p_owner);
+
+        /// allocate buffers and start decoding from the position of the cursor
+        bool Start(int nslots,const CPoolCursor& cursor,const std::vector<CTrajPoolItem>& items);
+
+        /// terminate decoding thread
+        void Stop(void);
+
+        /// wait for decoded snapshot, false if the decoding finished
+        bool Pop(int& slot);
+
+        /// return slot back to the ring
+        void Release(int slot);
+
+        std::vector<CAmberRestart>  Slots;
+        std::vector<int>            SlotItems;          // position of decoded snapshots
+        std::vector<int>            SlotItemSnapshots;
+        std::vector<int>            SlotGlobalSnapshots;
+        int                         FinalResult;        // result that finished decoding
+
+    private:
+        QTrajPool*                  Owner;
+        CPoolCursor                 Cursor;             // own files of the decoding thread
+        std::vector<CTrajPoolItem>  Items;
+        std::queue<int>             FreeSlots;
+        std::queue<int>             ReadySlots;
+        CSimpleMutex                RingMutex;
+        CSimpleCond                 FreeCond;
+        CSimpleCond                 ReadyCond;
+        bool                        Finished;
+        bool                        Terminated;
+
+        virtual void ExecuteThread(void);
     };
 
     QString                     DefaultTmpName;
     std::vector<CTrajPoolItem>  Items;
     int                         CurrentItem;
-    CAmberTrajectory            Trajectory;
+    CPoolCursor                 Cursor;
     bool                        IgnoreMissingFiles;
+    bool                        UseIndexFiles;
 
     // progress
     bool                ProgressStarted;    
     int                 CurrentSnapshot;
     int                 ItemSnapshot;
+    int                 GlobalSnapshot;
     int                 ProgressSnaphost;
     int                 PrevCurrSnapshot;
     int                 PrevNumOfSnapshots;
 
+    // parallel mode - pools of all workers with the same name share the reader
+    std::string         SharedName;
+    CSharedReader*      SharedReader;
+
+    // read-ahead
+    int                 ReadAheadSize;
+    CReadAhead*         ReadAhead;
+
     /// clear object data if topology is cleaned - only weak objects
     virtual void CleanData(void);
+
+    /// read next snapshot from the pool
+    /// 0 - OK, 1 - end of pool, < 0 - error
+    int ReadSnapshot(CAmberRestart* p_rst,int stride);
+
+    /// read next snapshot decoded by the read-ahead thread
+    int ReadPrefetchedSnapshot(CAmberRestart* p_rst);
+
+    /// terminate read-ahead, it is started again by the next read
+    void StopReadAhead(void);
+
+    /// copy coordinates and box
+    static void CopySnapshot(CAmberRestart* p_dst,CAmberRestart* p_src);
+
+    /// read next snapshot using the reader shared by all workers
+    int ReadSharedSnapshot(CAmberRestart* p_rst,int stride);
+
+    /// read snapshot at the cursor position and advance the cursor
+    int ReadCursor(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,CAmberRestart* p_rst,int stride);
+
+    /// read next snapshot from the stream, continue with the next item at the end of file
+    int ReadStream(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,CAmberRestart* p_rst);
+
+    /// move the stream just before the snapshot, items are skipped without opening if possible
+    int SkipStream(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int target,CAmberRestart* p_rst);
+
+    /// find item and local index of snapshot
+    /// 0 - found, 1 - behind the last snapshot, -1 - number of snapshots is not known for some items
+    int LocateSnapshot(std::vector<CTrajPoolItem>& items,int target,int& item,int& local);
+
+    /// open item for random access
+    bool OpenRandomReader(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int item);
+
+    /// map trajectory cache of the item
+    bool OpenCache(CPoolCursor& cursor,std::vector<CTrajPoolItem>& items,int item);
+
+    /// close all files and move to the beginning of the range
+    void ResetCursor(CPoolCursor& cursor);
+
+    /// update position of the last read snapshot
+    void UpdatePosition(const CPoolCursor& cursor,int result);
+
+    /// get shared reader, it is created by the first worker
+    CSharedReader* GetSharedReader(void);
+
+    /// reset shared reader by the master worker
+    void ResetSharedReader(bool clear);
+
+    /// copy range and position of the local cursor to the shared reader
+    void UpdateSharedRange(void);
 };
 
 //------------------------------------------------------------------------------
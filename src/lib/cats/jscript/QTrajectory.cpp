@@ -26,6 +26,8 @@
 #include <QTopology.hpp>
 #include <QSnapshot.hpp>
 #include <QAverageSnapshot.hpp>
+#include <QSelection.hpp>
+#include <AmberSubTopology.hpp>
 #include <iomanip>
 #include <TerminalStr.hpp>
 
@@ -89,12 +91,9 @@ QScriptValue QTrajectory::New(QScriptContext *context, QScriptEngine *engine)
         QTrajectory* p_obj = new QTrajectory(scriptable.GetArgument(1));
 
         p_obj->ProgressStarted = false;
-        p_obj->CurrentSnapshot = 0;
-        bool result = p_obj->Trajectory.OpenTrajectoryFile(name,AMBER_TRAJ_UNKNOWN,AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ);
+        p_obj->ResetPosition();
+        bool result = p_obj->OpenFile(name,AMBER_TRAJ_UNKNOWN,AMBER_TRAJ_READ,false);
         if( result ){
-            p_obj->Name = name;
-            p_obj->Format = p_obj->Trajectory.GetFormat();
-            p_obj->OpenMode = p_obj->Trajectory.GetOpenMode();
             return(engine->newQObject(p_obj, QScriptEngine::ScriptOwnership));
         } else {
             // FIXME
@@ -116,7 +115,11 @@ QTrajectory::QTrajectory(const QScriptValue& top)
     RegisterAsWeakObject(top);
     Trajectory.AssignTopology(&GetQTopology()->Topology);
     ProgressStarted = false;
-    CurrentSnapshot = 0;
+    FirstSnapshot = 1;
+    LastSnapshot = 0;
+    Stride = 1;
+    Quantized = false;
+    ResetPosition();
 }
 
 //------------------------------------------------------------------------------
@@ -124,12 +127,28 @@ QTrajectory::QTrajectory(const QScriptValue& top)
 void QTrajectory::CleanData(void)
 {
     Trajectory.CloseTrajectoryFile();
+    QuantizedFile.Close();
+    Quantized = false;
 
     ProgressStarted = false;
-    CurrentSnapshot = 0;
     Name = "";
     Format = AMBER_TRAJ_UNKNOWN;
     OpenMode = AMBER_TRAJ_READ;
+    FirstSnapshot = 1;
+    LastSnapshot = 0;
+    Stride = 1;
+    ResetPosition();
+}
+
+//------------------------------------------------------------------------------
+
+void QTrajectory::ResetPosition(void)
+{
+    CurrentSnapshot = 0;
+    NextSnapshot = FirstSnapshot;
+    StreamSnapshot = 0;
+    RandomReader.Close();
+    RandomState = 0;
 }
 
 //==============================================================================
@@ -171,6 +190,8 @@ QScriptValue QTrajectory::open(void)
         sout << "               ascii.gzip - compressed ASCII format" << endl;
         sout << "               ascii.bzip - compressed ASCII format" << endl;
         sout << "               netcdf     - NETCDF format" << endl;
+        sout << "               quantized  - compact format with quantized coordinates" << endl;
+        sout << "                            (see setPrecision and write with selection)" << endl;
         return(false);
     }
 
@@ -205,6 +226,7 @@ QScriptValue QTrajectory::open(void)
     if( IsArgumentKeySelected("netcdf") == true ){
         traj_format = AMBER_TRAJ_NETCDF;
     }
+    bool quantized = IsArgumentKeySelected("quantized");
     value = CheckArgumentsUsage("name[,key1,key2,...]");
     if( value.isError() ) return(value);
 
@@ -214,14 +236,8 @@ QScriptValue QTrajectory::open(void)
     }
 
     ProgressStarted = false;
-    CurrentSnapshot = 0;
-    bool result = Trajectory.OpenTrajectoryFile(name,traj_format,AMBER_TRAJ_CXYZB,emode);
-    if( result ){
-        Name = name;
-        Format = Trajectory.GetFormat();
-        OpenMode = Trajectory.GetOpenMode();
-    }
-    return(result);
+    ResetPosition();
+    return( OpenFile(name,traj_format,emode,quantized) );
 }
 
 //------------------------------------------------------------------------------
@@ -234,40 +250,62 @@ QScriptValue QTrajectory::read(void)
     if( IsHelpRequested() ){
         CTerminalStr sout;
         sout << "usage: snapshot Trajectory::read(snapshot)" << endl;
+        sout << "       snapshot Trajectory::read(snapshot,stride)" << endl;
+        sout << "       snapshot Trajectory::read(stride)" << endl;
         sout << "       snapshot Trajectory::read()" << endl;
         return(false);
     }
 
 // check arguments -------------------------------
-    value = CheckNumberOfArguments("[snapshot]",0,1);
+    value = CheckNumberOfArguments("[snapshot][,stride]",0,2);
     if( value.isError() ) return(value);
 
     QSnapshot* p_qsnap = NULL;
-    if( GetArgumentCount() == 1 ){
-        value = GetArgAsObject<QSnapshot*>("snapshot","snapshot","Snapshot",1,p_qsnap);
+    bool       snap_provided = false;
+    int        stride = Stride;
+
+    if( (GetArgumentCount() >= 1) && IsArgumentObject<QSnapshot*>(1) ){
+        value = GetArgAsObject<QSnapshot*>("snapshot[,stride]","snapshot","Snapshot",1,p_qsnap);
         if( value.isError() ) return(value);
-    } else {
-        p_qsnap = new QSnapshot(JSTopology);
+        snap_provided = true;
+        if( GetArgumentCount() == 2 ){
+            value = GetArgAsInt("snapshot,stride","stride",2,stride);
+            if( value.isError() ) return(value);
+        }
+    } else if( GetArgumentCount() == 1 ){
+        value = GetArgAsInt("stride","stride",1,stride);
+        if( value.isError() ) return(value);
+    } else if( GetArgumentCount() == 2 ){
+        return( ThrowError("snapshot,stride","snapshot is not Snapshot object") );
+    }
+
+    if( stride <= 0 ){
+        return( ThrowError("[snapshot,]stride","stride must be greater than zero") );
     }
 
 // execute ---------------------------------------
-    if( Trajectory.GetOpenMode() != AMBER_TRAJ_READ ){
-        return( ThrowError("snapshot","trajectory is not opened for reading") );
-    }
-    int result = Trajectory.ReadSnapshot(&p_qsnap->Restart);
-    if( result ==0 ){
-        CurrentSnapshot++;
-    } else if( result == 1 ) {
-        // end of file
-        if( GetArgumentCount() == 0 ){
+    if( GetOpenMode() != AMBER_TRAJ_READ ){
+        return( ThrowError("[snapshot][,stride]","trajectory is not opened for reading") );
+    }
+
+    if( snap_provided == false ){
+        p_qsnap = new QSnapshot(JSTopology);
+    }
+
+    int result = ReadSnapshot(&p_qsnap->Restart,stride);
+    if( result != 0 ){
+        if( snap_provided == false ){
             delete p_qsnap;
         }
-        return( GetUndefinedValue() );
-    } else {
+        if( result == 1 ) {
+            // end of file
+            return( GetUndefinedValue() );
+        }
         // some error, terminate the script
-        return( ThrowError("snapshot","unable to read the trajectory") );
+        return( ThrowError("[snapshot][,stride]","unable to read the trajectory") );
     }
-    if( GetArgumentCount() == 1 ){
+
+    if( snap_provided ){
         return(GetArgument(1));
     } else {
         return(engine()->newQObject(p_qsnap, QScriptEngine::ScriptOwnership));
@@ -276,45 +314,223 @@ QScriptValue QTrajectory::read(void)
 
 //------------------------------------------------------------------------------
 
-QScriptValue QTrajectory::write(void)
+QScriptValue QTrajectory::seek(void)
 {
     QScriptValue value;
 
 // help ------------------------------------------
     if( IsHelpRequested() ){
         CTerminalStr sout;
-        sout << "usage: bool Trajectory::write(snapshot)" << endl;
+        sout << "usage: bool Trajectory::seek(index)" << endl;
         return(false);
     }
 
 // check arguments -------------------------------
-    value = CheckNumberOfArguments("snapshot",1);
+    value = CheckNumberOfArguments("index",1);
+    if( value.isError() ) return(value);
+
+    int index;
+    value = GetArgAsInt("index","index",1,index);
     if( value.isError() ) return(value);
 
+    if( index <= 0 ){
+        return( ThrowError("index","index must be greater than zero") );
+    }
+
 // execute ---------------------------------------
-    if( IsArgumentObject<QSnapshot*>(1) == true ){
-        QSnapshot* p_qsnap;
-        value = GetArgAsObject<QSnapshot*>("snapshot","snapshot","Snapshot",1,p_qsnap);
+    if( GetOpenMode() != AMBER_TRAJ_READ ){
+        return( ThrowError("index","trajectory is not opened for reading") );
+    }
+
+    NextSnapshot = index;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajectory::setRange(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool Trajectory::setRange(first[,last[,stride]])" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("first[,last[,stride]]",1,3);
+    if( value.isError() ) return(value);
+
+    int first;
+    value = GetArgAsInt("first[,last[,stride]]","first",1,first);
+    if( value.isError() ) return(value);
+
+    int last = 0;
+    if( GetArgumentCount() > 1 ){
+        value = GetArgAsInt("first,last[,stride]","last",2,last);
         if( value.isError() ) return(value);
+    }
 
-        if( Trajectory.GetOpenMode() != AMBER_TRAJ_WRITE ){
-            return( ThrowError("snapshot","trajectory is not opened for writing") );
-        }
-        return(Trajectory.WriteSnapshot(&p_qsnap->Restart));
+    int stride = 1;
+    if( GetArgumentCount() > 2 ){
+        value = GetArgAsInt("first,last,stride","stride",3,stride);
+        if( value.isError() ) return(value);
+    }
+
+    if( first <= 0 ){
+        return( ThrowError("first[,last[,stride]]","first must be greater than zero") );
+    }
+    if( (last != 0) && (last < first) ){
+        return( ThrowError("first,last[,stride]","last must not be smaller than first") );
     }
+    if( stride <= 0 ){
+        return( ThrowError("first,last,stride","stride must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    FirstSnapshot = first;
+    LastSnapshot = last;
+    Stride = stride;
+    NextSnapshot = first;
+    return(true);
+}
 
-    if( IsArgumentObject<QAverageSnapshot*>(1) == true ){
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajectory::write(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool Trajectory::write(snapshot[,selection])" << endl;
+        sout << "       only selected atoms are written, it is supported by the quantized format" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot[,selection]",1,2);
+    if( value.isError() ) return(value);
+
+    CAmberRestart* p_rst = NULL;
+    if( IsArgumentObject<QSnapshot*>(1) == true ){
+        QSnapshot* p_qsnap;
+        value = GetArgAsObject<QSnapshot*>("snapshot[,selection]","snapshot","Snapshot",1,p_qsnap);
+        if( value.isError() ) return(value);
+        p_rst = &p_qsnap->Restart;
+    } else if( IsArgumentObject<QAverageSnapshot*>(1) == true ){
         QAverageSnapshot* p_qsnap;
-        value = GetArgAsObject<QAverageSnapshot*>("snapshot","snapshot","AverageSnapshot",1,p_qsnap);
+        value = GetArgAsObject<QAverageSnapshot*>("snapshot[,selection]","snapshot","AverageSnapshot",1,p_qsnap);
         if( value.isError() ) return(value);
+        p_rst = &p_qsnap->Restart;
+    } else {
+        return( ThrowError("Snapshot/AverageSnapshot","the first argument is not unsupported type") );
+    }
 
-        if( Trajectory.GetOpenMode() != AMBER_TRAJ_WRITE ){
-            return( ThrowError("snapshot","trajectory is not opened for writing") );
-        }
-        return(Trajectory.WriteSnapshot(&p_qsnap->Restart));
+    QSelection* p_qsel = NULL;
+    if( GetArgumentCount() == 2 ){
+        value = GetArgAsObject<QSelection*>("snapshot,selection","selection","Selection",2,p_qsel);
+        if( value.isError() ) return(value);
+    }
+
+// execute ---------------------------------------
+    if( GetOpenMode() != AMBER_TRAJ_WRITE ){
+        return( ThrowError("snapshot[,selection]","trajectory is not opened for writing") );
+    }
+
+    if( Quantized ){
+        return(QuantizedFile.WriteSnapshot(p_rst,p_qsel != NULL ? &p_qsel->Mask : NULL));
+    }
+
+    if( p_qsel != NULL ){
+        return( ThrowError("snapshot,selection","selection can be written only to the quantized trajectory") );
+    }
+    return(Trajectory.WriteSnapshot(p_rst));
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajectory::setPrecision(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool Trajectory::setPrecision(precision)" << endl;
+        sout << "       precision is number of quanta per A (default 1000)," << endl;
+        sout << "       it must be set before the first snapshot is written" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("precision",1);
+    if( value.isError() ) return(value);
+
+    double precision;
+    value = GetArgAsRNumber("precision","precision",1,precision);
+    if( value.isError() ) return(value);
+
+    if( precision <= 0.0 ){
+        return( ThrowError("precision","precision must be greater than zero") );
+    }
+
+// execute ---------------------------------------
+    if( (Quantized == false) || (GetOpenMode() != AMBER_TRAJ_WRITE) ){
+        return( ThrowError("precision","quantized trajectory is not opened for writing") );
+    }
+
+    return(QuantizedFile.SetPrecision(precision));
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue QTrajectory::writeTopology(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: bool Trajectory::writeTopology(name,selection[,key1,...])" << endl;
+        sout << "       writes topology of selected atoms matching snapshots written with the selection" << endl;
+        sout << "            Keys:        box          - keep box" << endl;
+        sout << "                         noerrors     - do not stop on errors" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckMinimumNumberOfArguments("name,selection",2);
+    if( value.isError() ) return(value);
+
+    QString name;
+    value = GetArgAsString("name,selection[,key1,...]","name",1,name);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel;
+    value = GetArgAsObject<QSelection*>("name,selection[,key1,...]","selection","Selection",2,p_qsel);
+    if( value.isError() ) return(value);
+
+    bool copy_box = IsArgumentKeySelected("box");
+    bool ignore_errors = IsArgumentKeySelected("noerrors");
+
+    value = CheckArgumentsUsage("name,selection[,key1,...]");
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    if( p_qsel->Mask.GetNumberOfSelectedAtoms() == 0 ){
+        return( ThrowError("name,selection[,key1,...]","no atoms are selected") );
+    }
+
+    CAmberSubTopology sub_topology;
+    if( sub_topology.InitSubTopology(&p_qsel->Mask,copy_box,ignore_errors,false) == false ){
+        return( ThrowError("name,selection[,key1,...]","unable to create topology of selected atoms") );
     }
 
-return( ThrowError("Snapshot/AverageSnapshot","the first argument is not unsupported type") );
+    return(sub_topology.Save(name));
 }
 
 //------------------------------------------------------------------------------
@@ -336,12 +552,17 @@ QScriptValue QTrajectory::close(void)
 
 // execute ---------------------------------------
     ProgressStarted = false;
-    CurrentSnapshot = 0;
+    ResetPosition();
 
     Name = "";
     Format = AMBER_TRAJ_UNKNOWN;
     OpenMode = AMBER_TRAJ_READ;
 
+    if( Quantized ){
+        QuantizedFile.Close();
+        Quantized = false;
+        return(true);
+    }
     return(Trajectory.CloseTrajectoryFile());
 }
 
@@ -363,7 +584,7 @@ QScriptValue QTrajectory::rewind(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
-    if( Trajectory.IsItOpened() == false ){
+    if( IsFileOpened() == false ){
         return( ThrowError("","trajectory is not opened") );
     }
 
@@ -371,9 +592,13 @@ QScriptValue QTrajectory::rewind(void)
         return( ThrowError("","trajectory is not opened for reading") );
     }
 
-    Trajectory.CloseTrajectoryFile();
     ProgressStarted = false;
-    CurrentSnapshot = 0;
+    ResetPosition();
+
+    // quantized snapshots are accessed directly
+    if( Quantized ) return(true);
+
+    Trajectory.CloseTrajectoryFile();
 
     bool result = Trajectory.OpenTrajectoryFile(Name,Format,AMBER_TRAJ_CXYZB,OpenMode);
     if( ! result ){
@@ -402,7 +627,7 @@ QScriptValue QTrajectory::isOpened(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
-    return(Trajectory.IsItOpened());
+    return(IsFileOpened());
 }
 
 //------------------------------------------------------------------------------
@@ -427,7 +652,7 @@ QScriptValue QTrajectory::setTitle(const QScriptValue& tmp)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
-    if( Trajectory.IsItOpened() ){
+    if( IsFileOpened() ){
         return( ThrowError("title","trajectory is already opened") );
     }
     Trajectory.SetTitle(title);
@@ -473,6 +698,7 @@ QScriptValue QTrajectory::getFormat(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
+    if( Quantized ) return("quantized");
     ETrajectoryFormat form = Trajectory.GetFormat();
     return(encodeFormat(form));
 }
@@ -505,11 +731,20 @@ QScriptValue QTrajectory::printInfo(void)
         } else {
         cout << " Title  : " << Trajectory.GetTitle() << endl;
         }
+        if( Quantized ){
+        cout << " Format : " << "quantized" << endl;
+        cout << " Precision : " << QuantizedFile.GetPrecision() << " quanta per A" << endl;
+        } else {
         cout << " Format : " << encodeFormat(Trajectory.GetFormat()).toStdString() << endl;
-        cout << " Mode   : " << encodeOpenMode(Trajectory.GetOpenMode()).toStdString() << endl;
+        }
+        cout << " Mode   : " << encodeOpenMode(GetOpenMode()).toStdString() << endl;
+        if( Quantized ){
+        cout << " Number of atoms     : " << QuantizedFile.GetNumberOfAtoms() << endl;
+        } else {
         cout << " Number of atoms     : " << Trajectory.GetNumberOfAtoms() << endl;
-        if( Trajectory.GetNumberOfSnapshots() >= 0 ){
-        cout << " Number of snapshots : " << Trajectory.GetNumberOfSnapshots() << endl;
+        }
+        if( GetNumberOfSnapshots() >= 0 ){
+        cout << " Number of snapshots : " << GetNumberOfSnapshots() << endl;
         } else {
         cout << " Number of snapshots : " << "0" << endl;
         }
@@ -536,7 +771,7 @@ QScriptValue  QTrajectory::printProgress(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
-    if( Trajectory.IsItOpened() == false ){
+    if( IsFileOpened() == false ){
         return(ThrowError("","trajectory is not opened"));
     }
 
@@ -546,26 +781,26 @@ QScriptValue  QTrajectory::printProgress(void)
         ProgressSnapshot = 0;
     }
     if( ProgressStarted ){
-        if( ProgressSnapshot > Trajectory.GetNumberOfSnapshots() ) return(value);
+        if( ProgressSnapshot > GetNumberOfSnapshots() ) return(value);
 
         for(int i=ProgressSnapshot;i < CurrentSnapshot; i++){
-            if( Trajectory.GetNumberOfSnapshots() > 80 ){
-                if( i % (Trajectory.GetNumberOfSnapshots()/80) == 0 ){
+            if( GetNumberOfSnapshots() > 80 ){
+                if( i % (GetNumberOfSnapshots()/80) == 0 ){
                     cout << "=";
                 }
             }
-            if( i == Trajectory.GetNumberOfSnapshots()/4 ){
+            if( i == GetNumberOfSnapshots()/4 ){
                 cout << " 25% ";
             }
-            if( i == Trajectory.GetNumberOfSnapshots()/2 ){
+            if( i == GetNumberOfSnapshots()/2 ){
                 cout << " 50% ";
             }
-            if( i == 3*Trajectory.GetNumberOfSnapshots()/4 ){
+            if( i == 3*GetNumberOfSnapshots()/4 ){
                 cout << " 75% ";
             }
         }
         ProgressSnapshot = CurrentSnapshot;
-        if( CurrentSnapshot == Trajectory.GetNumberOfSnapshots() ){
+        if( CurrentSnapshot == GetNumberOfSnapshots() ){
                 cout << "|" << endl;
         }
         cout.flush();
@@ -592,9 +827,138 @@ QScriptValue  QTrajectory::getNumOfSnapshots(void)
     if( value.isError() ) return(value);
 
 // execute ---------------------------------------
+    return(GetNumberOfSnapshots());
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int QTrajectory::ReadSnapshot(CAmberRestart* p_rst,int stride)
+{
+    int target = NextSnapshot;
+    if( (LastSnapshot > 0) && (target > LastSnapshot) ) return(1);
+
+    if( Quantized ){
+        int result = QuantizedFile.ReadSnapshot(target-1,p_rst);
+        if( result != 0 ) return(result);
+        CurrentSnapshot = target;
+        NextSnapshot = target + stride;
+        return(0);
+    }
+
+    if( target != StreamSnapshot + 1 ){
+        // jump directly if the format allows it
+        if( OpenRandomReader() == true ){
+            if( target > Index.GetNumberOfSnapshots() ) return(1);
+            if( RandomReader.ReadSnapshot(target-1,p_rst) == false ) return(-1);
+            CurrentSnapshot = target;
+            NextSnapshot = target + stride;
+            return(0);
+        }
+
+        // compressed trajectories are streams - reopen if the snapshot is behind us
+        if( target <= StreamSnapshot ){
+            Trajectory.CloseTrajectoryFile();
+            StreamSnapshot = 0;
+            if( Trajectory.OpenTrajectoryFile(Name,Format,AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ) == false ){
+                return(-1);
+            }
+        }
+        while( StreamSnapshot < target - 1 ){
+            int result = Trajectory.ReadSnapshot(p_rst);
+            if( result != 0 ) return(result);
+            StreamSnapshot++;
+        }
+    }
+
+    int result = Trajectory.ReadSnapshot(p_rst);
+    if( result != 0 ) return(result);
+
+    StreamSnapshot++;
+    CurrentSnapshot = target;
+    NextSnapshot = target + stride;
+    return(0);
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajectory::OpenFile(const QString& name,ETrajectoryFormat format,ETrajectoryOpenMode mode,bool quantized)
+{
+    Trajectory.CloseTrajectoryFile();
+    QuantizedFile.Close();
+
+    CSmallString sname(name);
+    if( (mode == AMBER_TRAJ_READ) && (format == AMBER_TRAJ_UNKNOWN) ){
+        quantized |= CQuantizedTrajectory::IsQuantizedTrajectory(sname);
+    }
+    Quantized = quantized;
+
+    bool result;
+    if( Quantized ){
+        if( mode == AMBER_TRAJ_WRITE ){
+            result = QuantizedFile.OpenForWriting(sname);
+        } else {
+            result = QuantizedFile.OpenForReading(sname);
+        }
+    } else {
+        result = Trajectory.OpenTrajectoryFile(name,format,AMBER_TRAJ_CXYZB,mode);
+    }
+
+    if( result ){
+        Name = name;
+        Format = Quantized ? AMBER_TRAJ_UNKNOWN : Trajectory.GetFormat();
+        OpenMode = Quantized ? mode : Trajectory.GetOpenMode();
+    } else {
+        Quantized = false;
+    }
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool QTrajectory::IsFileOpened(void)
+{
+    if( Quantized ) return(QuantizedFile.IsOpened());
+    return(Trajectory.IsItOpened());
+}
+
+//------------------------------------------------------------------------------
+
+ETrajectoryOpenMode QTrajectory::GetOpenMode(void)
+{
+    if( Quantized ) return(OpenMode);
+    return(Trajectory.GetOpenMode());
+}
+
+//------------------------------------------------------------------------------
+
+int QTrajectory::GetNumberOfSnapshots(void)
+{
+    if( Quantized ) return(QuantizedFile.GetNumberOfSnapshots());
     return(Trajectory.GetNumberOfSnapshots());
 }
 
+//------------------------------------------------------------------------------
+
+bool QTrajectory::OpenRandomReader(void)
+{
+    if( RandomState != 0 ) return(RandomState == 1);
+
+    RandomState = -1;
+    if( (Format != AMBER_TRAJ_ASCII) && (Format != AMBER_TRAJ_NETCDF) ) return(false);
+
+    CSmallString name(Name);
+    if( Index.Load(name,Format,Trajectory.GetTopology()) == false ){
+        if( Index.Build(name,Format,Trajectory.GetTopology()) == false ) return(false);
+        Index.Save(name);
+    }
+    if( RandomReader.Open(name,Index) == false ) return(false);
+
+    RandomState = 1;
+    return(true);
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -28,6 +28,9 @@
 #include <QScriptable>
 #include <QCATsScriptable.hpp>
 #include <QTopology.hpp>
+#include <TrajectoryIndex.hpp>
+#include <TrajectoryFrameReader.hpp>
+#include <QuantizedTrajectory.hpp>
 
 //------------------------------------------------------------------------------
 
@@ -59,14 +62,35 @@ public slots:
     QScriptValue open(void);
 
     /// read snapshot
+    /// stride overrides the stride set by setRange for the following read
     /// snapshot read()
     /// snapshot read(snapshot)
+    /// snapshot read([snapshot,]stride)
     QScriptValue read(void);
 
-    /// write snapshot
-    /// bool write(snapshot)
+    /// set index of the snapshot returned by the next read, the first snapshot has index one
+    /// uncompressed ASCII and NetCDF trajectories are accessed directly,
+    /// other formats are read sequentially
+    /// bool seek(index)
+    QScriptValue seek(void);
+
+    /// restrict reading to snapshots first, first+stride, ... not exceeding last
+    /// the range is kept after open and rewind, last equal to zero means the last snapshot
+    /// bool setRange(first[,last[,stride]])
+    QScriptValue setRange(void);
+
+    /// write snapshot, only selected atoms are written to quantized trajectories
+    /// bool write(snapshot[,selection])
     QScriptValue write(void);
 
+    /// set precision of quantized trajectory in quanta per A
+    /// bool setPrecision(precision)
+    QScriptValue setPrecision(void);
+
+    /// write topology of selected atoms, i.e., companion of subset trajectory
+    /// bool writeTopology(name,selection[,key1,...])
+    QScriptValue writeTopology(void);
+
     /// close trajectory
     QScriptValue close(void);
 
@@ -115,8 +139,44 @@ private:
     int                 CurrentSnapshot;
     int                 ProgressSnapshot;
 
+    // random access
+    int                     NextSnapshot;       // index of snapshot returned by the next read
+    int                     FirstSnapshot;
+    int                     LastSnapshot;       // zero - last snapshot in the trajectory
+    int                     Stride;
+    int                     StreamSnapshot;     // number of snapshots consumed from Trajectory
+    CTrajectoryIndex        Index;
+    CTrajectoryFrameReader  RandomReader;
+    int                     RandomState;        // 0 - not tested, 1 - available, -1 - not available
+
+    // quantized trajectory
+    bool                    Quantized;
+    CQuantizedTrajectory    QuantizedFile;
+
     /// clear object data if topology is cleaned - only weak objects
     virtual void CleanData(void);
+
+    /// move reading position to the first snapshot of the range
+    void ResetPosition(void);
+
+    /// read snapshot from the current position
+    /// 0 - OK, 1 - end of trajectory, otherwise error
+    int ReadSnapshot(CAmberRestart* p_rst,int stride);
+
+    /// prepare random access reader if possible
+    bool OpenRandomReader(void);
+
+    /// open trajectory file, quantized trajectories are detected in read mode
+    bool OpenFile(const QString& name,ETrajectoryFormat format,ETrajectoryOpenMode mode,bool quantized);
+
+    /// is amber or quantized trajectory opened
+    bool IsFileOpened(void);
+
+    /// open mode of amber or quantized trajectory
+    ETrajectoryOpenMode GetOpenMode(void);
+
+    /// number of snapshots of amber or quantized trajectory
+    int GetNumberOfSnapshots(void);
 };
 
 //------------------------------------------------------------------------------
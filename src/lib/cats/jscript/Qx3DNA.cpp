@@ -255,7 +255,7 @@ QScriptValue Qx3DNA::analyzeReference(void)
     WorkDir = CFileName(tmp_dir.path());
 	
     // write input data
-    if( WriteInputData(p_qsnap,p_qsel) == false ){
+    if( WriteInputData(p_qsnap,p_qsel,"Qx3DNA") == false ){
         CSmallString error;
         error << "unable to write a reference input data into the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -269,7 +269,7 @@ QScriptValue Qx3DNA::analyzeReference(void)
     }
 
     // parse output data
-    if( ParseReferenceData() == false ){
+    if( ParseReferenceData("Qx3DNA") == false ){
         CSmallString error;
         error << "unable to parse reference output, temporary data were left in the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -329,7 +329,7 @@ QScriptValue Qx3DNA::analyze(void)
     WorkDir = CFileName(tmp_dir.path());
 	
     // write input data
-    if( WriteInputData(p_qsnap,p_qsel) == false ){
+    if( WriteInputData(p_qsnap,p_qsel,"Qx3DNA") == false ){
         CSmallString error;
         error << "unable to write an input data into the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -343,7 +343,7 @@ QScriptValue Qx3DNA::analyze(void)
     }
 
     // parse output data
-    if( ParseOutputData() == false ){
+    if( ParseOutputData("Qx3DNA") == false ){
         CSmallString error;
         error << "unable to parse output, temporary data were left in the working directory: " << tmp_dir.path();
         return( ThrowError("snapshot[,selection]",error) );
@@ -359,6 +359,272 @@ QScriptValue Qx3DNA::analyze(void)
 //------------------------------------------------------------------------------
 //==============================================================================
 
+QScriptValue Qx3DNA::setNumOfWorkers(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: x3DNA::setNumOfWorkers(n)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("n",1);
+    if( value.isError() ) return(value);
+
+    int n;
+    value = GetArgAsInt("n","n",1,n);
+    if( value.isError() ) return(value);
+
+    if( n <= 0 ){
+        return( ThrowError("n","number of workers must be greater than zero") );
+    }
+    if( Queue.size() > 0 ){
+        return( ThrowError("n","number of workers cannot be changed when snapshots are queued") );
+    }
+
+// execute ---------------------------------------
+    Workers.SetNumberOfWorkers(n);
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::getNumOfWorkers(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int x3DNA::getNumOfWorkers()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return(Workers.GetNumberOfWorkers());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::queue(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int x3DNA::queue(snapshot[,selection])" << endl;
+        sout << "       the snapshot is analyzed later by analyzeQueue()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("snapshot[,selection]",1,2);
+    if( value.isError() ) return(value);
+
+    QSnapshot* p_qsnap = NULL;
+    value = GetArgAsObject<QSnapshot*>("snapshot[,selection]","snapshot","Snapshot",1,p_qsnap);
+    if( value.isError() ) return(value);
+
+    QSelection* p_qsel = NULL;
+    if( GetArgumentCount() > 1 ){
+        value = GetArgAsObject<QSelection*>("snapshot,selection","selection","Selection",2,p_qsel);
+        if( value.isError() ) return(value);
+    }
+
+// queue snapshot --------------------------------
+    if( Workers.InitWorkDirs("x3dna") == false ){
+        return( ThrowError("snapshot[,selection]","unable to create working directories") );
+    }
+
+    int frame = Queue.size();
+    WorkDir = Workers.GetWorkDir(Workers.GetFrameWorker(frame));
+
+    // coordinates are written immediately, current results are kept
+    CX3DNAFrame data;
+    data.ResIDMap.swap(ResIDMap);
+    bool result = WriteInputData(p_qsnap,p_qsel,CNABatchWorkers::GetFrameName(frame));
+    data.ResIDMap.swap(ResIDMap);
+
+    if( result == false ){
+        CSmallString error;
+        error << "unable to write an input data into the working directory: " << WorkDir;
+        return( ThrowError("snapshot[,selection]",error) );
+    }
+
+    Queue.push_back(data);
+    return(frame);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::getNumOfQueued(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int x3DNA::getNumOfQueued()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return((int)Queue.size());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::analyzeQueue(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int x3DNA::analyzeQueue()" << endl;
+        sout << "       results are accessible via selectResult(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// do 3DNA analysis -------------------------------
+    int nframes = Queue.size();
+    Results.clear();
+    ClearAll();
+    if( nframes == 0 ) return(0);
+
+    // find_pair accepts a single structure, analyze processes all inputs at once
+    int nworkers = Workers.GetNumberOfWorkers();
+    std::vector<CSmallString> commands(nworkers);
+    bool result = true;
+    for(int w=0; w < nworkers; w++){
+        int count = Workers.WriteFrameList(w,nframes);
+        if( count < 0 ){
+            result = false;
+            break;
+        }
+        if( count == 0 ) continue;
+        commands[w] << "while read f; do find_pair $f.pdb $f.inp >> find_pair.stdout 2>&1 || exit 1; done < frames.lst && "
+                       "sed 's/$/.inp/' frames.lst | xargs analyze > analyze.stdout 2>&1";
+    }
+
+    if( result == true ){
+        result = Workers.RunCommands(commands);
+    }
+
+    if( result == false ){
+        CSmallString error;
+        error << "unable to run analysis, temporary data were left in the working directories: " << Workers.GetWorkDirList();
+        Workers.KeepWorkDirs();
+        Queue.clear();
+        return( ThrowError("",error) );
+    }
+
+    // parse output data
+    Results.resize(nframes);
+    for(int frame=0; frame < nframes; frame++){
+        CSmallString job = CNABatchWorkers::GetFrameName(frame);
+        WorkDir = Workers.GetWorkDir(Workers.GetFrameWorker(frame));
+
+        ClearAll();
+        ResIDMap.swap(Queue[frame].ResIDMap);
+        if( AutoReferenceMode == true ){
+            result = ParseReferenceData(job);
+        }
+        if( result == true ){
+            result = ParseOutputData(job);
+        }
+        if( result == false ){
+            CSmallString error;
+            error << "unable to parse output of frame " << frame << ", temporary data were left in the working directory: " << WorkDir;
+            ClearAll();
+            Results.clear();
+            Workers.KeepWorkDirs();
+            Queue.clear();
+            return( ThrowError("",error) );
+        }
+        SwapFrame(Results[frame]);
+    }
+
+    // working directories are reused by the next batch
+    Workers.CleanWorkDirs();
+    Queue.clear();
+
+    return(nframes);
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::getNumOfResults(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: int x3DNA::getNumOfResults()" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("",0);
+    if( value.isError() ) return(value);
+
+// execute ---------------------------------------
+    return((int)Results.size());
+}
+
+//------------------------------------------------------------------------------
+
+QScriptValue Qx3DNA::selectResult(void)
+{
+    QScriptValue value;
+
+// help ------------------------------------------
+    if( IsHelpRequested() ){
+        CTerminalStr sout;
+        sout << "usage: x3DNA::selectResult(index)" << endl;
+        return(false);
+    }
+
+// check arguments -------------------------------
+    value = CheckNumberOfArguments("index",1);
+    if( value.isError() ) return(value);
+
+    int index;
+    value = GetArgAsInt("index","index",1,index);
+    if( value.isError() ) return(value);
+
+    if( (index < 0) || (index >= (int)Results.size()) ){
+        CSmallString error;
+        error << "index " << index << " is out-of-range <0;" << (int)Results.size()-1 << ">";
+        return( ThrowError("index", error) );
+    }
+
+// execute ---------------------------------------
+    LoadFrame(Results[index]);
+    return(value);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
 QScriptValue Qx3DNA::getNumOfBasePairs(void)
 {
     QScriptValue value;
@@ -797,12 +1063,46 @@ void Qx3DNA::ClearAll(void)
 
 //------------------------------------------------------------------------------
 
-bool Qx3DNA::WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel)
+void Qx3DNA::SwapFrame(CX3DNAFrame& frame)
+{
+    frame.ResIDMap.swap(ResIDMap);
+    frame.BPIDs.swap(BPIDs);
+    frame.BPStepIDs.swap(BPStepIDs);
+    frame.BPPar.swap(BPPar);
+    frame.BPStepPar.swap(BPStepPar);
+    frame.BPHelPar.swap(BPHelPar);
+    frame.PPar.swap(PPar);
+    frame.BPOrigins.swap(BPOrigins);
+    frame.HelAxisPositions.swap(HelAxisPositions);
+    frame.HelAxisVec.swap(HelAxisVec);
+}
+
+//------------------------------------------------------------------------------
+
+void Qx3DNA::LoadFrame(const CX3DNAFrame& frame)
+{
+    ResIDMap = frame.ResIDMap;
+    BPIDs = frame.BPIDs;
+    BPStepIDs = frame.BPStepIDs;
+    BPPar = frame.BPPar;
+    BPStepPar = frame.BPStepPar;
+    BPHelPar = frame.BPHelPar;
+    PPar = frame.PPar;
+    BPOrigins = frame.BPOrigins;
+    HelAxisPositions = frame.HelAxisPositions;
+    HelAxisVec = frame.HelAxisVec;
+}
+
+//------------------------------------------------------------------------------
+
+bool Qx3DNA::WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel,const CSmallString& job)
 {
 // create PDB file -------------------------------
     // open output file
     FILE* p_fout;
-    CFileName fileName = WorkDir / "Qx3DNA.pdb";   // / - is overloaded operator - it merges two strings by path delimiter (/)
+    CSmallString name;
+    name << job << ".pdb";
+    CFileName fileName = WorkDir / CFileName(name);   // / - is overloaded operator - it merges two strings by path delimiter (/)
     if( (p_fout = fopen(fileName,"w")) == NULL ) {
         CSmallString error;
         error << "unable to open output file " << fileName;
@@ -888,13 +1188,15 @@ bool Qx3DNA::RunAnalysis(void)
 
 //------------------------------------------------------------------------------
 
-bool Qx3DNA::ParseReferenceData(void)
+bool Qx3DNA::ParseReferenceData(const CSmallString& job)
 {
     ifstream ifs;
 
 // parse BP  -----------------------------------
     // open file
-    CFileName fileName = WorkDir / "Qx3DNA.inp";
+    CSmallString name;
+    name << job << ".inp";
+    CFileName fileName = WorkDir / CFileName(name);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
@@ -918,7 +1220,9 @@ bool Qx3DNA::ParseReferenceData(void)
     ifs.close();
 
 // parse BP Step -------------------------------
-    fileName = WorkDir / "Qx3DNA.out";
+    CSmallString oname;
+    oname << job << ".out";
+    fileName = WorkDir / CFileName(oname);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
@@ -944,13 +1248,15 @@ bool Qx3DNA::ParseReferenceData(void)
 
 //------------------------------------------------------------------------------
 
-bool Qx3DNA::ParseOutputData(void)
+bool Qx3DNA::ParseOutputData(const CSmallString& job)
 {
     ifstream ifs;
 
 // parse BP indexes -----------------------------------
     // open file
-    CFileName fileName = WorkDir / "Qx3DNA.inp";
+    CSmallString name;
+    name << job << ".inp";
+    CFileName fileName = WorkDir / CFileName(name);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
@@ -975,7 +1281,9 @@ bool Qx3DNA::ParseOutputData(void)
 
 // parse the other data -------------------------------
     // open file
-    fileName = WorkDir / "Qx3DNA.out";
+    CSmallString oname;
+    oname << job << ".out";
+    fileName = WorkDir / CFileName(oname);
     ifs.open( fileName );
     if( ifs.fail() ) {
         CSmallString error;
@@ -32,6 +32,7 @@
 #include <QSelection.hpp>
 #include <FileName.hpp>
 #include <QNAHelper.hpp>
+#include <QNABatch.hpp>
 #include <Point.hpp>
 #include <map>
 
@@ -46,6 +47,24 @@ enum EX3DNAParams {
 
 //------------------------------------------------------------------------------
 
+/// results of one frame analyzed in the batch mode
+
+class CATS_PACKAGE CX3DNAFrame {
+public:
+    std::map<int,int>           ResIDMap;
+    std::map<int,CNABPID>       BPIDs;
+    std::map<int,CNABPStepID>   BPStepIDs;
+    std::vector<CNABPPar>       BPPar;
+    std::vector<CNABPStepPar>   BPStepPar;
+    std::vector<CNABPHelPar>    BPHelPar;
+    std::vector<CNAPPar>        PPar;
+    std::vector<CPoint>         BPOrigins;
+    std::vector<CPoint>         HelAxisPositions;
+    std::vector<CNAHelAxisVec>  HelAxisVec;
+};
+
+//------------------------------------------------------------------------------
+
 /// 3D x3DNA
 
 class CATS_PACKAGE Qx3DNA : public QObject, protected QScriptable, protected QCATsScriptable {
@@ -88,6 +107,36 @@ public slots:
     /// analyze(snapshot[,selection])
     QScriptValue analyze(void);
 
+// batch mode ------------------------------------------------------------------
+    /// set number of concurrent workers used by analyzeQueue()
+    /// setNumOfWorkers(n)
+    QScriptValue setNumOfWorkers(void);
+
+    /// get number of concurrent workers
+    /// int getNumOfWorkers()
+    QScriptValue getNumOfWorkers(void);
+
+    /// queue snapshot for the batch analysis, return index of the queued frame
+    /// int queue(snapshot[,selection])
+    QScriptValue queue(void);
+
+    /// get number of queued snapshots
+    /// int getNumOfQueued()
+    QScriptValue getNumOfQueued(void);
+
+    /// analyze all queued snapshots by single run of 3DNA per worker
+    /// int analyzeQueue()
+    QScriptValue analyzeQueue(void);
+
+    /// get number of frames analyzed by the last analyzeQueue()
+    /// int getNumOfResults()
+    QScriptValue getNumOfResults(void);
+
+    /// make results of the analyzed frame current
+    /// selectResult(index)
+    QScriptValue selectResult(void);
+
+// results ---------------------------------------------------------------------
     /// get number of base pairs
     /// int getNumOfBasePairs()
     QScriptValue getNumOfBasePairs(void);
@@ -192,20 +241,31 @@ private:
     std::vector<CPoint>         HelAxisPositions;
     std::vector<CNAHelAxisVec>  HelAxisVec;
 
+    // batch mode
+    CNABatchWorkers             Workers;
+    std::vector<CX3DNAFrame>    Queue;              // residue maps of queued frames
+    std::vector<CX3DNAFrame>    Results;            // frames analyzed by analyzeQueue()
+
     /// clear all parsed results
     void ClearAll(void);
 
-    /// create input data
-    bool WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel);
+    /// create input data, job is the base name of files in WorkDir
+    bool WriteInputData(QSnapshot* p_qsnap,QSelection* p_qsel,const CSmallString& job);
 
     /// run analysis
     bool RunAnalysis(void);
 
     /// parse reference data
-    bool ParseReferenceData(void);
+    bool ParseReferenceData(const CSmallString& job);
 
     /// parse output data
-    bool ParseOutputData(void);
+    bool ParseOutputData(const CSmallString& job);
+
+    /// exchange current results with the frame
+    void SwapFrame(CX3DNAFrame& frame);
+
+    /// make frame results current
+    void LoadFrame(const CX3DNAFrame& frame);
 
     /// create PDB file from QSnapshot
     bool WritePDB(CAmberTopology* p_top,CAmberRestart* p_crd,CAmberMaskAtoms* p_mask,FILE* p_fout);
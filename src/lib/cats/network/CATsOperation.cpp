@@ -40,6 +40,15 @@ DEFINE_OPERATION(Operation_GetStatistics,
 DEFINE_OPERATION(Operation_GetSnapshot,
                  "{GET_SNAPSHOT:9d834f83-5137-4c03-8d59-8fed0daf5ec0}");
 
+DEFINE_OPERATION(Operation_GetSnapshots,
+                 "{GET_SNAPSHOTS:6b17859c-5f4b-4404-a679-32fe53b0144b}");
+
+DEFINE_OPERATION(Operation_SetSnapshotMask,
+                 "{SET_SNAPSHOT_MASK:78865cc5-ebf5-490f-9966-7a22fac25dfc}");
+
+DEFINE_OPERATION(Operation_AckSnapshots,
+                 "{ACK_SNAPSHOTS:515f9a78-9fb8-42bb-a84e-969518f5e8c8}");
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -41,6 +41,15 @@ DECLARE_OPERATION(CATS_PACKAGE,Operation_GetStatistics);
 /// get trajectory snapshot
 DECLARE_OPERATION(CATS_PACKAGE,Operation_GetSnapshot);
 
+/// get block of trajectory snapshots
+DECLARE_OPERATION(CATS_PACKAGE,Operation_GetSnapshots);
+
+/// set atom subset projected by the trajectory server
+DECLARE_OPERATION(CATS_PACKAGE,Operation_SetSnapshotMask);
+
+/// acknowledge processed leased snapshots
+DECLARE_OPERATION(CATS_PACKAGE,Operation_AckSnapshots);
+
 //------------------------------------------------------------------------------
 
 #endif
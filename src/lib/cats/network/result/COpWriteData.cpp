@@ -32,7 +32,16 @@
 //------------------------------------------------------------------------------
 //==============================================================================
 
-bool CResultClient::WriteData(int client_id,const CSmallString& data_name)
+bool CResultClient::WriteData(int client_id,const CSmallString& data_name,int frame)
+{
+    std::vector<CSmallString> data_names;
+    data_names.push_back(data_name);
+    return( WriteData(client_id,data_names,frame) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultClient::WriteData(int client_id,const std::vector<CSmallString>& data_names,int first_frame)
 {
     CClientCommand* p_command = CreateCommand(Operation_WriteData);
     if( p_command == NULL ) return(false);
@@ -45,40 +54,42 @@ bool CResultClient::WriteData(int client_id,const CSmallString& data_name)
         return(false);
     }
 
-    bool result = true;
     p_ele->SetAttribute("client_id",client_id);
 
-    if( p_ele == NULL ) {
-        ES_ERROR("unable to set client_id");
-        delete p_command;
-        return(false);
-    }
+    // one DATA element per record
+    for(size_t i=0; i < data_names.size(); i++) {
+        CResultFile result_file;
 
-    CResultFile result_file;
+        if( result_file.ReadData(data_names[i],false) == false ) {
+            CSmallString error;
+            error << "unable to read data from '" << data_names[i] << "'";
+            ES_ERROR(error);
+            delete p_command;
+            return(false);
+        }
 
-    if( result_file.ReadData(data_name,false) == false ) {
-        ES_ERROR("unable to read data");
-        return(false);
-    }
+        CXMLElement* p_cele = p_ele->CreateChildElement("DATA");
+        if( p_cele == NULL ) {
+            ES_ERROR("unable to create DATA element");
+            delete p_command;
+            return(false);
+        }
 
-    CXMLElement* p_cele = p_command->GetCommandElementByPath("DATA",true);
-    if( p_cele == NULL ) {
-        ES_ERROR("unable to create DATA element");
-        delete p_command;
-        return(false);
-    }
+        if( result_file.SaveData(p_cele) == false ) {
+            ES_ERROR("unable to save data");
+            delete p_command;
+            return(false);
+        }
 
-    if( result_file.SaveData(p_cele) == false ) {
-        ES_ERROR("unable to save data");
-        delete p_command;
-        return(false);
+        if( first_frame >= 0 ) {
+            p_cele->SetAttribute("frame",first_frame + (int)i);
+        }
     }
 
     // send data and execute command
-    //FIXME
-    //result = ExecuteCommand(p_command);
-
-    if( result == false ) {
+    try {
+        ExecuteCommand(p_command);
+    } catch(...) {
         ES_ERROR("unable to execute command");
         delete p_command;
         return(false);
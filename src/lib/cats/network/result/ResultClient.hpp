@@ -25,6 +25,7 @@
 // =============================================================================
 
 #include <ExtraClient.hpp>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
@@ -45,7 +46,12 @@ public:
     bool GetStatistics(const CSmallString& stat_name);
 
     /// write data to server
-    bool WriteData(int client_id,const CSmallString& data_name);
+    /// if frame >= 0, the data are keyed by the global frame index and written only once
+    bool WriteData(int client_id,const CSmallString& data_name,int frame=-1);
+
+    /// write several data records to server in one command
+    /// if first_frame >= 0, the records are keyed by consecutive global frame indexes
+    bool WriteData(int client_id,const std::vector<CSmallString>& data_names,int first_frame=-1);
 
     /// flush server data
     bool FlushServerData(void);
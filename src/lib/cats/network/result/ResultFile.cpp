@@ -37,6 +37,9 @@
 CResultFile::CResultFile(void)
 {
     ResultFile = NULL;
+    RecordNumber = 0;
+    NextUnwrittenFrame = 1;
+    NumOfDuplicates = 0;
 }
 
 //==============================================================================
@@ -199,6 +202,8 @@ bool CResultFile::LoadTemplate(const CSmallString& name,bool verbose)
         }
     }
 
+    BuildItemIndex();
+
     if( verbose ) {
         printf("\n");
         printf("Following template file was read:\n");
@@ -279,6 +284,8 @@ bool CResultFile::LoadOrCheckTemplate(CXMLElement* p_ele)
                 return(false);
             }
         }
+
+        BuildItemIndex();
     } else {
         // reset checked flag
         CSimpleIterator<CResultItem> I(Items);
@@ -525,6 +532,10 @@ bool CResultFile::OpenResultFile(void)
         return(false);
     }
 
+    // records are appended in batches under the mutex, large buffer keeps
+    // the writes in memory until the buffer is full or data are flushed
+    setvbuf(ResultFile,NULL,_IOFBF,1024*1024);
+
     fprintf(ResultFile,"# Results collected by result-server.\n");
     fprintf(ResultFile,"#\n");
 
@@ -571,89 +582,187 @@ bool CResultFile::CloseResultFile(void)
 
 bool CResultFile::WriteData(CXMLElement* p_ele,int client_id)
 {
-    ResultMutex.Lock();
+    if( p_ele == NULL ) {
+        ES_ERROR("p_ele is NULL");
+        return(false);
+    }
+
+    std::vector<SRecord> records(1);
+
+    if( PrepareRecord(p_ele,records[0]) == false ) {
+        return(false);
+    }
+
+    return( MergeRecords(records,client_id) );
+}
+
+//------------------------------------------------------------------------------
 
+bool CResultFile::WriteRecords(CXMLElement* p_ele,int client_id)
+{
     if( p_ele == NULL ) {
         ES_ERROR("p_ele is NULL");
-        ResultMutex.Unlock();
         return(false);
     }
 
+    std::vector<SRecord> records;
+
+    CXMLElement* p_dele = p_ele->GetFirstChildElement("DATA");
+    while( p_dele != NULL ) {
+        records.push_back(SRecord());
+        if( PrepareRecord(p_dele,records.back()) == false ) {
+            return(false);
+        }
+        p_dele = p_dele->GetNextSiblingElement("DATA");
+    }
+
+    if( records.size() == 0 ) {
+        ES_ERROR("no DATA element");
+        return(false);
+    }
+
+    return( MergeRecords(records,client_id) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultFile::PrepareRecord(CXMLElement* p_ele,SRecord& record)
+{
     if( p_ele->GetName() != "DATA" ) {
         ES_ERROR("p_ele is not DATA");
-        ResultMutex.Unlock();
         return(false);
     }
 
-    // reset all data
-    CSimpleIterator<CResultItem> I(Items);
-    CResultItem* p_item;
+    // optional global frame index
+    record.Frame = -1;
+    p_ele->GetAttribute("frame",record.Frame);
 
-    while( (p_item = I.Current()) != NULL ) {
-        p_item->ResetData();
-        I++;
-    }
+    // assign data to items, missing items are printed as reset items
+    std::vector<CSmallString>   data(ItemSlots.size());
+    std::vector<bool>           assigned(ItemSlots.size(),false);
 
-    // load data
     CXMLElement* p_iele = p_ele->GetFirstChildElement("ITEM");
 
     while( p_iele != NULL ) {
         CSmallString name;
         if( p_iele->GetAttribute("name",name) == false ) {
             ES_ERROR("unable to get name attribute from ITEM");
-            ResultMutex.Unlock();
             return(false);
         }
 
-        p_item = FindItem(name);
-        if( p_item == NULL ) {
+        std::map<std::string,int>::const_iterator it = ItemIndex.find(std::string(name));
+        if( it == ItemIndex.end() ) {
             CSmallString error;
             error << "unable to find item with name '" << name << "'";
             ES_ERROR(error);
-            ResultMutex.Unlock();
             return(false);
         }
 
-        if( p_item->Checked == true ) {
+        int slot = it->second;
+        if( assigned[slot] == true ) {
             CSmallString error;
             error << "data were already assigned to item '" << name
                   << "' (do you not have duplicit items?)";
             ES_ERROR(error);
-            ResultMutex.Unlock();
             return(false);
         }
 
-        if( p_item->LoadAsData(p_iele) == false ) {
-            ES_ERROR("unable to load item");
-            ResultMutex.Unlock();
+        if( p_iele->GetAttribute("data",data[slot]) == false ) {
+            ES_ERROR("unable to get ITEM attributes");
             return(false);
         }
-
-        p_item->Checked = true;
+        assigned[slot] = true;
 
         p_iele = p_iele->GetNextSiblingElement("ITEM");
     }
 
-    RecordNumber++;
+    // convert and format data
+    record.Values.resize(ItemSlots.size());
+
+    for(size_t i=0; i < ItemSlots.size(); i++) {
+        const CSmallString* p_data = assigned[i] ? &data[i] : NULL;
+        if( ItemSlots[i]->FormatData(p_data,record.Line,record.Values[i]) == false ) {
+            ES_ERROR("unable to load item");
+            return(false);
+        }
+        record.Line += " ";
+    }
+    record.Line += "\n";
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultFile::MergeRecords(const std::vector<SRecord>& records,int client_id)
+{
+    std::string         buffer;
+    char                prefix[64];
+    std::vector<bool>   accepted(records.size(),false);
+    std::set<int>       batch_frames;
+    int                 duplicates = 0;
+
+    ResultMutex.Lock();
+
+    int rec_number = RecordNumber;
+
+    // the batch is formatted and written first, counters and statistics
+    // are updated only if the write succeeds
+    for(size_t r=0; r < records.size(); r++) {
+        const SRecord& record = records[r];
+
+        if( record.Frame >= 0 ) {
+            if( IsFrameWritten(record.Frame) || (batch_frames.insert(record.Frame).second == false) ) {
+                // frame was requeued and processed twice - keep the first record
+                duplicates++;
+                continue;
+            }
+        }
+
+        accepted[r] = true;
+        rec_number++;
+
+        if( ResultFile != NULL ) {
+            snprintf(prefix,sizeof(prefix),"  %10d %4d ",
+                     record.Frame >= 0 ? record.Frame : rec_number,client_id);
+            buffer += prefix;
+            buffer += record.Line;
+        }
+    }
 
     // write data to file
-    if( ResultFile != NULL ) {
-        if( PrintData(ResultFile,client_id) == false ) {
-            RecordNumber--; // data are not valid
+    if( (ResultFile != NULL) && (buffer.size() > 0) ) {
+        if( fwrite(buffer.data(),1,buffer.size(),ResultFile) != buffer.size() ) {
             ES_ERROR("unable to print data to result file");
             ResultMutex.Unlock();
             return(false);
         }
     }
 
-    // do statistics
-    I.SetToBegin();
+    RecordNumber = rec_number;
+    NumOfDuplicates += duplicates;
 
-    while( (p_item = I.Current()) != NULL ) {
-        p_item->StatData();
-        I++;
+    for(size_t r=0; r < records.size(); r++) {
+        if( accepted[r] == false ) continue;
+        const SRecord& record = records[r];
+
+        // frames are snapshot indexes starting from 1, the others are fed
+        // in arrival order
+        if( record.Frame >= 1 ) {
+            MarkFrameWritten(record.Frame);
+            PendingStats[record.Frame] = record.Values;
+            continue;
+        }
+        if( record.Frame >= 0 ) MarkFrameWritten(record.Frame);
+
+        // do statistics
+        for(size_t i=0; i < ItemSlots.size(); i++) {
+            ItemSlots[i]->StatData(record.Values[i]);
+        }
     }
 
+    FeedStatistics(false);
+
     ResultMutex.Unlock();
     return(true);
 }
@@ -711,6 +820,8 @@ bool CResultFile::ReadData(const CSmallString& name,bool verbose)
 
     data_file.SetSecAsProcessed();
 
+    BuildItemIndex();
+
     return(true);
 }
 
@@ -806,7 +917,7 @@ bool CResultFile::PrintDataHeader(FILE* p_fout)
 
 //------------------------------------------------------------------------------
 
-bool CResultFile::PrintData(FILE* p_fout,int client_id)
+bool CResultFile::PrintData(FILE* p_fout,int client_id,int frame)
 {
     // use stdout as default
     if( p_fout == NULL ) {
@@ -814,7 +925,7 @@ bool CResultFile::PrintData(FILE* p_fout,int client_id)
     }
 
     // lines
-    fprintf(p_fout,"  %10d %4d ",RecordNumber,client_id);
+    fprintf(p_fout,"  %10d %4d ",frame >= 0 ? frame : RecordNumber,client_id);
 
     CSimpleIterator<CResultItem> I(Items);
     CResultItem* p_item;
@@ -836,6 +947,13 @@ int CResultFile::GetNumberOfCollectedData(void)
     return(RecordNumber);
 }
 
+//------------------------------------------------------------------------------
+
+int CResultFile::GetNumberOfDuplicates(void)
+{
+    return(NumOfDuplicates);
+}
+
 //==============================================================================
 //------------------------------------------------------------------------------
 //==============================================================================
@@ -849,6 +967,8 @@ bool CResultFile::WriteStatistics(void)
 
     ResultMutex.Lock();
 
+    FeedStatistics(true);
+
     FILE* p_stat = fopen(StatFileName,"w");
     if( p_stat == NULL ) {
         CSmallString error;
@@ -878,6 +998,9 @@ bool CResultFile::WriteStatistics(void)
     fprintf(p_stat,"#\n");
     fprintf(p_stat,"# Data statistics:\n");
     fprintf(p_stat,"# ----------------\n");
+    fprintf(p_stat,"#\n");
+    fprintf(p_stat,"# s(<X>) is corrected for correlation by block averaging (Flyvbjerg-Petersen)\n");
+    fprintf(p_stat,"# g(X)   is statistical inefficiency (number of samples per independent sample)\n");
 
     // write header
     fprintf(p_stat,"#\n");
@@ -966,6 +1089,17 @@ bool CResultFile::WriteStatistics(void)
     }
     fprintf(p_stat,"\n");
 
+    // statistical inefficiency of X
+    fprintf(p_stat,"  g(X)    ");
+    I.SetToBegin();
+
+    while( (p_item = I.Current()) != NULL ) {
+        p_item->PrintItemStatIneff(p_stat,RecordNumber);
+        fprintf(p_stat," ");
+        I++;
+    }
+    fprintf(p_stat,"\n");
+
 
     fclose(p_stat);
     ResultMutex.Unlock();
@@ -993,6 +1127,7 @@ bool CResultFile::LoadStatistics(CXMLElement* p_ele)
     }
 
     Items.RemoveAll();
+    BuildItemIndex();
 
     CXMLElement* p_iele = p_ele->GetFirstChildElement("ITEM");
 
@@ -1008,7 +1143,7 @@ bool CResultFile::LoadStatistics(CXMLElement* p_ele)
             return(false);
         }
 
-        if( p_item->LoadStatistics(p_iele) == false ) {
+        if( p_item->LoadStatistics(p_iele,RecordNumber) == false ) {
             ES_ERROR("unable to load item");
             Items.RemoveAll();
             return(false);
@@ -1019,6 +1154,8 @@ bool CResultFile::LoadStatistics(CXMLElement* p_ele)
         p_iele = p_iele->GetNextSiblingElement("ITEM");
     }
 
+    BuildItemIndex();
+
     return(true);
 }
 
@@ -1036,6 +1173,10 @@ bool CResultFile::WriteStatistics(CXMLElement* p_ele)
         return(false);
     }
 
+    ResultMutex.Lock();
+
+    FeedStatistics(true);
+
     p_ele->SetAttribute("num_of_records",RecordNumber);
 
     CSimpleIterator<CResultItem> I(Items);
@@ -1045,15 +1186,18 @@ bool CResultFile::WriteStatistics(CXMLElement* p_ele)
         CXMLElement* p_iele = p_ele->CreateChildElement("ITEM");
         if( p_iele == NULL ) {
             ES_ERROR("unable to create ITEM");
+            ResultMutex.Unlock();
             return(false);
         }
         if( p_item->SaveStatistics(p_iele) == false ) {
             ES_ERROR("unable to save item statistics");
+            ResultMutex.Unlock();
             return(false);
         }
         I++;
     }
 
+    ResultMutex.Unlock();
     return(true);
 }
 
@@ -1083,17 +1227,71 @@ bool CResultFile::FlushData(void)
 
 CResultItem* CResultFile::FindItem(const CSmallString& name)
 {
+    std::map<std::string,int>::const_iterator it = ItemIndex.find(std::string(name));
+    if( it == ItemIndex.end() ) return(NULL);
+    return(ItemSlots[it->second]);
+}
+
+//------------------------------------------------------------------------------
+
+void CResultFile::BuildItemIndex(void)
+{
+    ItemIndex.clear();
+    ItemSlots.clear();
+
     CSimpleIterator<CResultItem> I(Items);
     CResultItem* p_item;
 
     while( (p_item = I.Current()) != NULL ) {
-        if( p_item->Name == name ) {
-            return(p_item);
+        // the first item of duplicit names is used
+        std::string name(p_item->Name);
+        if( ItemIndex.count(name) == 0 ) {
+            ItemIndex[name] = ItemSlots.size();
         }
+        ItemSlots.push_back(p_item);
         I++;
     }
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultFile::IsFrameWritten(int frame) const
+{
+    // frames are snapshot indexes starting from 1, the others are kept in the set
+    if( (frame >= 1) && (frame < NextUnwrittenFrame) ) return(true);
+    return( OutOfOrderFrames.count(frame) > 0 );
+}
+
+//------------------------------------------------------------------------------
+
+void CResultFile::MarkFrameWritten(int frame)
+{
+    if( frame != NextUnwrittenFrame ) {
+        OutOfOrderFrames.insert(frame);
+        return;
+    }
 
-    return(NULL);
+    // fold frames that arrived ahead of time into the low-water mark
+    NextUnwrittenFrame++;
+    while( OutOfOrderFrames.erase(NextUnwrittenFrame) > 0 ) {
+        NextUnwrittenFrame++;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CResultFile::FeedStatistics(bool all)
+{
+    // statistics are written while some frames can be still missing,
+    // frames arriving later are then fed after their successors
+    while( PendingStats.empty() == false ) {
+        std::map<int,std::vector<double> >::iterator it = PendingStats.begin();
+        if( (all == false) && (it->first >= NextUnwrittenFrame) ) break;
+        for(size_t i=0; i < ItemSlots.size(); i++) {
+            ItemSlots[i]->StatData(it->second[i]);
+        }
+        PendingStats.erase(it);
+    }
 }
 
 //==============================================================================
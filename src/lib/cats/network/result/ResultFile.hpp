@@ -28,6 +28,10 @@
 #include <ResultItem.hpp>
 #include <SimpleList.hpp>
 #include <SimpleMutex.hpp>
+#include <set>
+#include <map>
+#include <string>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
@@ -64,8 +68,15 @@ public:
     bool CloseResultFile(void);
 
     /// register data and write them to file if it is opened - mutex protected
+    /// data with the frame attribute are keyed by the global frame index,
+    /// repeated data for already written frame (requeued snapshot) are ignored
     bool WriteData(CXMLElement* p_ele,int client_id);
 
+    /// register all DATA records of the element at once - mutex protected
+    /// records are converted before the mutex is locked, either all records
+    /// are accepted or none of them
+    bool WriteRecords(CXMLElement* p_ele,int client_id);
+
     /// read data from file - not protected by mutex
     bool ReadData(const CSmallString& name,bool verbose=false);
 
@@ -75,12 +86,15 @@ public:
     /// print item specification
     bool PrintDataHeader(FILE* p_fout=NULL);
 
-    /// prit data to result file
-    bool PrintData(FILE* p_fout,int client_id);
+    /// prit data to result file, record is labeled by frame index if frame >= 0
+    bool PrintData(FILE* p_fout,int client_id,int frame=-1);
 
     /// get number of collected data
     int GetNumberOfCollectedData(void);
 
+    /// get number of ignored data for already written frames
+    int GetNumberOfDuplicates(void);
+
 // statistics file ------------------------------------------------------------
     /// write statistics - mutex protected (used by flush command)
     bool WriteStatistics(void);
@@ -103,11 +117,48 @@ public:
 private:
     CSimpleMutex                ResultMutex;
     int                         RecordNumber;
+    int                         NextUnwrittenFrame; // frames 1..NextUnwrittenFrame-1 were written
+    std::set<int>               OutOfOrderFrames;   // written frames above the low-water mark
+    std::map<int,std::vector<double> >  PendingStats;   // values of frames above the low-water mark
+    int                         NumOfDuplicates;
 
     CSimpleList<CResultItem>    Items;
     CSmallString                ResultFileName;
     FILE*                       ResultFile;
     CSmallString                StatFileName;
+
+    // item lookup, it is built when items are loaded and it is read-only
+    // during data collection
+    std::map<std::string,int>   ItemIndex;
+    std::vector<CResultItem*>   ItemSlots;
+
+    // converted record
+    struct SRecord {
+        int                 Frame;
+        std::string         Line;
+        std::vector<double> Values;
+    };
+
+    /// build name to slot index of items
+    void BuildItemIndex(void);
+
+    /// convert DATA element to the record - not protected by mutex
+    bool PrepareRecord(CXMLElement* p_ele,SRecord& record);
+
+    /// write converted records to file and register them if it succeeds - mutex protected
+    bool MergeRecords(const std::vector<SRecord>& records,int client_id);
+
+    /// was the frame already written - not protected by mutex
+    bool IsFrameWritten(int frame) const;
+
+    /// mark the frame as written, advance the low-water mark - not protected by mutex
+    void MarkFrameWritten(int frame);
+
+    /// block statistics depend on the order of samples, values of frames are
+    /// thus fed in frame order once all preceding frames were written,
+    /// all values including those behind missing frames are fed if all is true
+    /// not protected by mutex
+    void FeedStatistics(bool all);
 };
 
 
@@ -26,6 +26,14 @@
 #include <XMLElement.hpp>
 #include <ErrorSystem.hpp>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+//------------------------------------------------------------------------------
+
+// minimum number of blocks for the error estimate to be considered
+const int MinNumOfBlocks = 16;
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -39,8 +47,6 @@ CResultItem::CResultItem(void)
 
     IData = 0;
     RData = 0.0;
-    RDataSum = 0.0;
-    RDataSum2 = 0.0;
 }
 
 //==============================================================================
@@ -284,13 +290,151 @@ void CResultItem::ResetData(void)
 
 void CResultItem::StatData(void)
 {
-    RDataSum += RData;
-    RDataSum2 += RData*RData;
+    AddBlockValue(RData);
+}
+
+//------------------------------------------------------------------------------
+
+void CResultItem::StatData(double value)
+{
+    RData = value;
+    AddBlockValue(RData);
+}
+
+//------------------------------------------------------------------------------
+
+void CResultItem::AddBlockValue(double value)
+{
+    size_t level = 0;
+    for(;;) {
+        if( level >= Blocks.size() ) {
+            SBlockLevel block;
+            block.NumOfBlocks = 0;
+            block.Mean = 0.0;
+            block.M2 = 0.0;
+            block.Pending = 0.0;
+            block.HasPending = false;
+            Blocks.push_back(block);
+        }
+        SBlockLevel& block = Blocks[level];
+
+        // Welford update
+        block.NumOfBlocks++;
+        double delta = value - block.Mean;
+        block.Mean += delta / (double)block.NumOfBlocks;
+        block.M2 += delta*(value - block.Mean);
+
+        // complete the block of the next level
+        if( block.HasPending == false ) {
+            block.Pending = value;
+            block.HasPending = true;
+            return;
+        }
+        value = 0.5*(block.Pending + value);
+        block.HasPending = false;
+        level++;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+double CResultItem::GetSDevAve(void) const
+{
+    if( Blocks.empty() || (Blocks[0].NumOfBlocks < 2) ) return(0.0);
+
+    // the error estimate grows with the block size until blocks become
+    // uncorrelated, the plateau is taken at the smallest block size B
+    // satisfying B^3 > 2N(err_B/err_0)^4 (Lee, Needs, and Towler),
+    // if no level satisfies it, the maximum over levels is used
+    double n0 = Blocks[0].NumOfBlocks;
+    double var0 = Blocks[0].M2 / (n0*(n0 - 1.0));
+    double maxerr = 0.0;
+    double bsize = 1.0;
+
+    for(size_t level = 0; level < Blocks.size(); level++) {
+        const SBlockLevel& block = Blocks[level];
+        if( block.NumOfBlocks < 2 ) break;
+        if( (level > 0) && (block.NumOfBlocks < MinNumOfBlocks) ) break;
+        double var = block.M2 / ((double)block.NumOfBlocks*(block.NumOfBlocks - 1));
+        if( var0 <= 0.0 ) return(sqrt(var));
+        double ratio = var/var0;
+        if( bsize*bsize*bsize > 2.0*n0*ratio*ratio ) return(sqrt(var));
+        if( sqrt(var) > maxerr ) maxerr = sqrt(var);
+        bsize *= 2.0;
+    }
+
+    return(maxerr);
+}
+
+//------------------------------------------------------------------------------
+
+double CResultItem::GetStatIneff(void) const
+{
+    if( Blocks.empty() || (Blocks[0].NumOfBlocks < 2) ) return(1.0);
+    const SBlockLevel& block = Blocks[0];
+    double var = block.M2 / ((double)block.NumOfBlocks*(block.NumOfBlocks - 1));
+    if( var <= 0.0 ) return(1.0);
+    double sdevave = GetSDevAve();
+    return(sdevave*sdevave / var);
 }
 
 //------------------------------------------------------------------------------
 
-bool CResultItem::LoadStatistics(CXMLElement* p_ele)
+const CSmallString CResultItem::GetBlocksState(void) const
+{
+    CSmallString state;
+    char         buffer[128];
+
+    for(size_t level = 0; level < Blocks.size(); level++) {
+        const SBlockLevel& block = Blocks[level];
+        snprintf(buffer,sizeof(buffer),"%s%d %.17g %.17g %.17g %d",
+                 level > 0 ? " " : "",block.NumOfBlocks,block.Mean,block.M2,
+                 block.Pending,block.HasPending ? 1 : 0);
+        state << buffer;
+    }
+    return(state);
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultItem::SetBlocksState(const CSmallString& state)
+{
+    Blocks.clear();
+    if( state == NULL ) return(true);
+
+    const char* p_str = state;
+    char*       p_end;
+
+    for(;;) {
+        while( *p_str == ' ' ) p_str++;
+        if( *p_str == '\0' ) return(true);
+
+        SBlockLevel block;
+        block.NumOfBlocks = strtol(p_str,&p_end,10);
+        if( p_end == p_str ) break;
+        p_str = p_end;
+        block.Mean = strtod(p_str,&p_end);
+        if( p_end == p_str ) break;
+        p_str = p_end;
+        block.M2 = strtod(p_str,&p_end);
+        if( p_end == p_str ) break;
+        p_str = p_end;
+        block.Pending = strtod(p_str,&p_end);
+        if( p_end == p_str ) break;
+        p_str = p_end;
+        block.HasPending = strtol(p_str,&p_end,10) != 0;
+        if( p_end == p_str ) break;
+        p_str = p_end;
+        Blocks.push_back(block);
+    }
+
+    Blocks.clear();
+    return(false);
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultItem::LoadStatistics(CXMLElement* p_ele,int rec_number)
 {
     if( p_ele == NULL ) {
         ES_ERROR("p_ele is NULL");
@@ -319,10 +463,34 @@ bool CResultItem::LoadStatistics(CXMLElement* p_ele)
 
     result &= p_ele->GetAttribute("IData",IData);
     result &= p_ele->GetAttribute("RData",RData);
-    result &= p_ele->GetAttribute("RDataSum",RDataSum);
-    result &= p_ele->GetAttribute("RDataSum2",RDataSum2);
     result &= p_ele->GetAttribute("SData",SData);
 
+    CSmallString blocks;
+    if( p_ele->GetAttribute("Blocks",blocks) == true ) {
+        if( SetBlocksState(blocks) == false ) {
+            ES_ERROR("unable to decode block statistics");
+            result = false;
+        }
+    } else {
+        // legacy statistics - only plain sums are available, thus
+        // the standard deviation of average is not corrected for correlation
+        double sum = 0.0;
+        double sum2 = 0.0;
+        result &= p_ele->GetAttribute("RDataSum",sum);
+        result &= p_ele->GetAttribute("RDataSum2",sum2);
+        Blocks.clear();
+        if( rec_number > 0 ) {
+            SBlockLevel block;
+            block.NumOfBlocks = rec_number;
+            block.Mean = sum / (double)rec_number;
+            block.M2 = sum2 - sum*block.Mean;
+            if( block.M2 < 0.0 ) block.M2 = 0.0;
+            block.Pending = 0.0;
+            block.HasPending = false;
+            Blocks.push_back(block);
+        }
+    }
+
     if( result == false ) {
         ES_ERROR("unable to set ITEM attributes");
     }
@@ -355,9 +523,19 @@ bool CResultItem::SaveStatistics(CXMLElement* p_ele)
 
     p_ele->SetAttribute("IData",IData);
     p_ele->SetAttribute("RData",RData);
-    p_ele->SetAttribute("RDataSum",RDataSum);
-    p_ele->SetAttribute("RDataSum2",RDataSum2);
     p_ele->SetAttribute("SData",SData);
+    p_ele->SetAttribute("Blocks",GetBlocksState());
+
+    // plain sums for older clients
+    double sum = 0.0;
+    double sum2 = 0.0;
+    if( Blocks.empty() == false ) {
+        const SBlockLevel& block = Blocks[0];
+        sum = block.NumOfBlocks*block.Mean;
+        sum2 = block.M2 + sum*block.Mean;
+    }
+    p_ele->SetAttribute("RDataSum",sum);
+    p_ele->SetAttribute("RDataSum2",sum2);
 
     if( result == false ) {
         ES_ERROR("unable to set ITEM attributes");
@@ -430,99 +608,104 @@ bool CResultItem::PrintItem(FILE* p_fout)
 
 //------------------------------------------------------------------------------
 
-bool CResultItem::PrintItemAve(FILE* p_stat,int rec_number)
+static void AppendFormatted(std::string& line,const char* p_format,...)
 {
-    if( rec_number == 0 ) return(false);
+    char    buffer[256];
+    va_list args;
+
+    va_start(args,p_format);
+    int len = vsnprintf(buffer,sizeof(buffer),p_format,args);
+    va_end(args);
 
+    if( len < 0 ) return;
+    if( len < (int)sizeof(buffer) ) {
+        line.append(buffer,len);
+        return;
+    }
+
+    std::vector<char> big(len+1);
+    va_start(args,p_format);
+    vsnprintf(&big[0],big.size(),p_format,args);
+    va_end(args);
+    line.append(&big[0],len);
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultItem::FormatData(const CSmallString* p_data,std::string& line,double& value) const
+{
     unsigned int max_len = 0;
     if( max_len < Name.GetLength() ) max_len = Name.GetLength();
     if( max_len < Format.GetRecordLength() ) {
         max_len = Format.GetRecordLength();
     }
+
+    value = 0.0;
+
     switch(Type) {
     case ERIT_NOT_DEFINED:
-        ES_ERROR("format is not specified");
+        ES_ERROR("format is not defined - no conversion is possible");
         return(false);
     case ERIT_INTEGER: {
-        unsigned int smax_len = Format.GetRecordLength();
-        for(unsigned int i=0; i < (smax_len-1)/2; i++) fprintf(p_stat," ");
-        fprintf(p_stat,"-");
-        for(unsigned int i=0; i < (smax_len-1)/2; i++) fprintf(p_stat," ");
-        if( (smax_len-1) % 2 != 0 ) fprintf(p_stat," ");
+        int idata = 0;
+        if( (p_data != NULL) && (sscanf(*p_data,"%d",&idata) != 1) ) {
+            CSmallString error;
+            error << "unable to convert data (" << *p_data << ")"
+                  << " to integer";
+            ES_ERROR(error);
+            return(false);
+        }
+        AppendFormatted(line,Format.GetFormat(),idata);
     }
     break;
     case ERIT_REAL: {
-        double average = RDataSum/(double)rec_number;
-        fprintf(p_stat,Format.GetFormat(),average);
-    }
-    break;
-    case ERIT_STRING: {
-        unsigned int max_len = Format.GetRecordLength();
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        fprintf(p_stat,"-");
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        if( (max_len-1) % 2 != 0 ) fprintf(p_stat," ");
+        double rdata = 0.0;
+        if( (p_data != NULL) && (sscanf(*p_data,"%lf",&rdata) != 1) ) {
+            CSmallString error;
+            error << "unable to convert data (" << *p_data << ")"
+                  << " to double";
+            ES_ERROR(error);
+            return(false);
+        }
+        AppendFormatted(line,Format.GetFormat(),rdata);
+        value = rdata;
     }
     break;
+    case ERIT_STRING:
+        AppendFormatted(line,Format.GetFormat(),p_data != NULL ? (const char*)*p_data : "");
+        break;
     default:
         ES_ERROR("not implemented");
         return(false);
     }
-    for(unsigned int i=0; i < max_len-Format.GetRecordLength(); i++) {
-        fprintf(p_stat," ");
-    }
+
+    line.append(max_len-Format.GetRecordLength(),' ');
 
     return(true);
 }
 
 //------------------------------------------------------------------------------
 
+bool CResultItem::PrintItemAve(FILE* p_stat,int rec_number)
+{
+    if( rec_number == 0 ) return(false);
+
+    double average = 0.0;
+    if( Blocks.empty() == false ) average = Blocks[0].Mean;
+    return( PrintStatValue(p_stat,average) );
+}
+
+//------------------------------------------------------------------------------
+
 bool CResultItem::PrintItemSDev(FILE* p_stat,int rec_number)
 {
     if( rec_number == 0 ) return(false);
 
-    unsigned int max_len = 0;
-    if( max_len < Name.GetLength() ) max_len = Name.GetLength();
-    if( max_len < Format.GetRecordLength() ) {
-        max_len = Format.GetRecordLength();
-    }
-    switch(Type) {
-    case ERIT_NOT_DEFINED:
-        ES_ERROR("format is not specified");
-        return(false);
-    case ERIT_INTEGER: {
-        unsigned int smax_len = Format.GetRecordLength();
-        for(unsigned int i=0; i < (smax_len-1)/2; i++) fprintf(p_stat," ");
-        fprintf(p_stat,"-");
-        for(unsigned int i=0; i < (smax_len-1)/2; i++) fprintf(p_stat," ");
-        if( (smax_len-1) % 2 != 0 ) fprintf(p_stat," ");
-    }
-    break;
-    case ERIT_REAL: {
-        double sdev = 0.0;
-        if( rec_number*RDataSum2 - RDataSum*RDataSum > 0 ) {
-            sdev = sqrt( rec_number*RDataSum2 - RDataSum*RDataSum )
-                   / (double)rec_number;
-        }
-        fprintf(p_stat,Format.GetFormat(),sdev);
-    }
-    break;
-    case ERIT_STRING: {
-        unsigned int max_len = Format.GetRecordLength();
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        fprintf(p_stat,"-");
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        if( (max_len-1) % 2 != 0 ) fprintf(p_stat," ");
-    }
-    break;
-    default:
-        ES_ERROR("not implemented");
-        return(false);
+    double sdev = 0.0;
+    if( (Blocks.empty() == false) && (Blocks[0].NumOfBlocks > 0) ) {
+        sdev = sqrt( Blocks[0].M2 / (double)Blocks[0].NumOfBlocks );
     }
-    for(unsigned int i=0; i < max_len-Format.GetRecordLength(); i++) {
-        fprintf(p_stat," ");
-    }
-
+    PrintStatValue(p_stat,sdev);
     return(false);
 }
 
@@ -532,6 +715,22 @@ bool CResultItem::PrintItemSDevAve(FILE* p_stat,int rec_number)
 {
     if( rec_number == 0 ) return(false);
 
+    return( PrintStatValue(p_stat,GetSDevAve()) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultItem::PrintItemStatIneff(FILE* p_stat,int rec_number)
+{
+    if( rec_number == 0 ) return(false);
+
+    return( PrintStatValue(p_stat,GetStatIneff()) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CResultItem::PrintStatValue(FILE* p_stat,double value)
+{
     unsigned int max_len = 0;
     if( max_len < Name.GetLength() ) max_len = Name.GetLength();
     if( max_len < Format.GetRecordLength() ) {
@@ -541,7 +740,8 @@ bool CResultItem::PrintItemSDevAve(FILE* p_stat,int rec_number)
     case ERIT_NOT_DEFINED:
         ES_ERROR("format is not specified");
         return(false);
-    case ERIT_INTEGER: {
+    case ERIT_INTEGER:
+    case ERIT_STRING: {
         unsigned int smax_len = Format.GetRecordLength();
         for(unsigned int i=0; i < (smax_len-1)/2; i++) fprintf(p_stat," ");
         fprintf(p_stat,"-");
@@ -549,24 +749,9 @@ bool CResultItem::PrintItemSDevAve(FILE* p_stat,int rec_number)
         if( (smax_len-1) % 2 != 0 ) fprintf(p_stat," ");
     }
     break;
-    case ERIT_REAL: {
-        double sdev = 0.0, sdevx=0.0;
-        if( rec_number*RDataSum2 - RDataSum*RDataSum > 0 ) {
-            sdev = sqrt( rec_number*RDataSum2 - RDataSum*RDataSum )
-                   / (double)rec_number;
-        }
-        sdevx = sdev / sqrt((double)rec_number);
-        fprintf(p_stat,Format.GetFormat(),sdevx);
-    }
-    break;
-    case ERIT_STRING: {
-        unsigned int max_len = Format.GetRecordLength();
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        fprintf(p_stat,"-");
-        for(unsigned int i=0; i < (max_len-1)/2; i++) fprintf(p_stat," ");
-        if( (max_len-1) % 2 != 0 ) fprintf(p_stat," ");
-    }
-    break;
+    case ERIT_REAL:
+        fprintf(p_stat,Format.GetFormat(),value);
+        break;
     default:
         ES_ERROR("not implemented");
         return(false);
@@ -27,6 +27,8 @@
 #include <CATsMainHeader.hpp>
 #include <SmallString.hpp>
 #include <FormatSpec.hpp>
+#include <vector>
+#include <string>
 
 //------------------------------------------------------------------------------
 
@@ -76,8 +78,12 @@ public:
     /// print item data
     bool PrintItem(FILE* p_fout);
 
-    /// load item statistics
-    bool LoadStatistics(CXMLElement* p_ele);
+    /// convert data and append formatted item to the line, the item is not changed
+    /// NULL data are printed as reset item, value is set for statistics
+    bool FormatData(const CSmallString* p_data,std::string& line,double& value) const;
+
+    /// load item statistics, rec_number is needed for legacy data without block statistics
+    bool LoadStatistics(CXMLElement* p_ele,int rec_number);
 
     /// save item statistics
     bool SaveStatistics(CXMLElement* p_ele);
@@ -86,6 +92,9 @@ public:
     /// do statistics on data
     void StatData(void);
 
+    /// do statistics on provided value
+    void StatData(double value);
+
     /// print formated average
     bool PrintItemAve(FILE* p_stat,int rec_number);
 
@@ -93,8 +102,19 @@ public:
     bool PrintItemSDev(FILE* p_stat,int rec_number);
 
     /// print formated standard deviation of average
+    /// it is corrected for correlation by block averaging
     bool PrintItemSDevAve(FILE* p_stat,int rec_number);
 
+    /// print formated statistical inefficiency
+    bool PrintItemStatIneff(FILE* p_stat,int rec_number);
+
+    /// return standard deviation of average from block averaging
+    double GetSDevAve(void) const;
+
+    /// return statistical inefficiency, i.e., the number of samples
+    /// per one independent sample
+    double GetStatIneff(void) const;
+
 // section of public data ----------------------------------------------------
 public:
     bool                Checked;
@@ -112,10 +132,32 @@ private:
     int                 IData;
     // real ----------------------------
     double              RData;
-    double              RDataSum;
-    double              RDataSum2;
-    // real ----------------------------
+    // string --------------------------
     CSmallString        SData;
+
+    // statistics ----------------------
+    // Flyvbjerg-Petersen block averaging, the level k contains means
+    // of blocks of 2^k samples, level 0 is Welford accumulator of samples
+    struct SBlockLevel {
+        int     NumOfBlocks;
+        double  Mean;
+        double  M2;         // sum of squared deviations from Mean
+        double  Pending;    // first half of incomplete block
+        bool    HasPending;
+    };
+    std::vector<SBlockLevel>    Blocks;
+
+    /// add value to the block level
+    void AddBlockValue(double value);
+
+    /// print formated statistical value, only real items have statistics
+    bool PrintStatValue(FILE* p_stat,double value);
+
+    /// serialize block levels
+    const CSmallString GetBlocksState(void) const;
+
+    /// deserialize block levels
+    bool SetBlocksState(const CSmallString& state);
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//    Copyright (C) 2005 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2004 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <TrajectoryClient.hpp>
+#include <CATsOperation.hpp>
+#include <ErrorSystem.hpp>
+#include <ClientCommand.hpp>
+#include <XMLElement.hpp>
+#include <algorithm>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryClient::FlushAcknowledgements(int client_id)
+{
+    if( PendingAcks.size() == 0 ) return(true);
+
+    // create command
+    CClientCommand* p_command = CreateCommand(Operation_AckSnapshots);
+    if( p_command == NULL ) return(false);
+
+    // set client ID
+    CXMLElement* p_ele = p_command->GetRootCommandElement();
+    if( p_ele == NULL ) {
+        ES_ERROR("unable to get root command element");
+        delete p_command;
+        return(false);
+    }
+
+    p_ele->SetAttribute("client_id",client_id);
+    WriteAcknowledgements(p_ele);
+
+    try {
+        ExecuteCommand(p_command);
+    } catch(...) {
+        ES_ERROR("unable to execute command");
+        delete p_command;
+        return(false);
+    }
+
+    PendingAcks.clear();
+    delete p_command;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryClient::WriteAcknowledgements(CXMLElement* p_ele)
+{
+    if( PendingAcks.size() == 0 ) return;
+
+    // compress indexes into continuous ranges
+    std::sort(PendingAcks.begin(),PendingAcks.end());
+
+    size_t i = 0;
+    while( i < PendingAcks.size() ) {
+        int first = PendingAcks[i];
+        int last = first;
+        i++;
+        while( (i < PendingAcks.size()) && (PendingAcks[i] <= last + 1) ) {
+            last = PendingAcks[i];
+            i++;
+        }
+        CXMLElement* p_aele = p_ele->CreateChildElement("ACK");
+        p_aele->SetAttribute("first",first);
+        p_aele->SetAttribute("last",last);
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -29,6 +29,7 @@
 #include <ResultFile.hpp>
 #include <AmberTopology.hpp>
 #include <AmberRestart.hpp>
+#include <SnapshotCodec.hpp>
 
 //==============================================================================
 //------------------------------------------------------------------------------
@@ -37,6 +38,25 @@
 int CTrajectoryClient::GetSnapshot(int client_id,CAmberRestart* p_rst,
         const CSmallString& snapop,bool read_vel)
 {
+    if( read_vel && ProjectionActive ) {
+        ES_ERROR("velocities cannot be transferred for the atom subset");
+        return(-1);
+    }
+
+    if( Leasing == true ) {
+        if( read_vel ) {
+            ES_ERROR("velocities cannot be transferred with leasing");
+            return(-1);
+        }
+        // leased snapshots are handed out only by GetSnapshots
+        std::vector<CAmberRestart>  buffer(1,*p_rst);
+        std::vector<int>            indexes;
+        int count = GetSnapshots(client_id,buffer,indexes);
+        if( count <= 0 ) return(count);
+        *p_rst = buffer[0];
+        return(indexes[0]);
+    }
+
     // create command
     CClientCommand* p_command = CreateCommand(Operation_GetSnapshot);
     if( p_command == NULL ) return(false);
@@ -52,6 +72,12 @@ int CTrajectoryClient::GetSnapshot(int client_id,CAmberRestart* p_rst,
     p_ele->SetAttribute("client_id",client_id);
     p_ele->SetAttribute("snapshot_id",snapop);
 
+    // velocities are always transferred in xml
+    if( (read_vel == false) && (Encoding != ESE_XML) ) {
+        p_ele->SetAttribute("encoding",CSnapshotCodec::EncodeEncoding(Encoding));
+        p_ele->SetAttribute("precision",Precision);
+    }
+
     if( p_ele == NULL ) {
         ES_ERROR("unable to set client_id and/or snapshot_id");
         delete p_command;
@@ -108,7 +134,7 @@ int CTrajectoryClient::GetSnapshot(int client_id,CAmberRestart* p_rst,
         }
     } else {
         // load data
-        if( p_rst->LoadSnapshot(p_sele) == false ) {
+        if( CSnapshotCodec::DecodeSnapshot(p_sele,p_rst,ProjectionActive ? &ProjectionMask : NULL) == false ) {
             ES_ERROR("unable to load snapshot coordinates");
             delete p_command;
             return(-1);
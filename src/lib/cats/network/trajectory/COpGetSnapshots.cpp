@@ -0,0 +1,152 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//    Copyright (C) 2005 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2004 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <unistd.h>
+#include <TrajectoryClient.hpp>
+#include <CATsOperation.hpp>
+#include <ErrorSystem.hpp>
+#include <ClientCommand.hpp>
+#include <AmberTopology.hpp>
+#include <AmberRestart.hpp>
+#include <SnapshotCodec.hpp>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CTrajectoryClient::GetSnapshots(int client_id,std::vector<CAmberRestart>& snapshots,
+                                    std::vector<int>& indexes)
+{
+    if( snapshots.size() == 0 ) {
+        ES_ERROR("no snapshot buffers provided");
+        return(-1);
+    }
+
+    CClientCommand* p_command = NULL;
+    int             waited = 0;
+
+    for(;;) {
+        // create command
+        p_command = CreateCommand(Operation_GetSnapshots);
+        if( p_command == NULL ) return(-1);
+
+        // set client ID
+        CXMLElement* p_ele = p_command->GetRootCommandElement();
+        if( p_ele == NULL ) {
+            ES_ERROR("unable to get root command element");
+            delete p_command;
+            return(-1);
+        }
+
+        p_ele->SetAttribute("client_id",client_id);
+        p_ele->SetAttribute("count",(int)snapshots.size());
+        if( Encoding != ESE_XML ) {
+            p_ele->SetAttribute("encoding",CSnapshotCodec::EncodeEncoding(Encoding));
+            p_ele->SetAttribute("precision",Precision);
+        }
+        if( Leasing == true ) {
+            p_ele->SetAttribute("lease",true);
+            WriteAcknowledgements(p_ele);
+        }
+
+        try {
+            ExecuteCommand(p_command);
+        } catch(...) {
+            ES_ERROR("unable to execute command");
+            delete p_command;
+            return(-1);
+        }
+
+        // acknowledgements were delivered
+        PendingAcks.clear();
+
+        // get total status
+        CXMLElement* p_rele = p_command->GetRootResultElement();
+        if( p_rele == NULL ) {
+            ES_ERROR("unable to get root result element");
+            delete p_command;
+            return(-1);
+        }
+
+        CSmallString status;
+        if( p_rele->GetAttribute("status",status) == false ) {
+            ES_ERROR("unable to get final status");
+            delete p_command;
+            return(-1);
+        }
+
+        if( status == "eof" ) {
+            delete p_command;
+            return(0);
+        }
+
+        if( status != "wait" ) break;
+
+        // snapshots leased to other clients can be requeued - try later
+        int retry = 1;
+        p_rele->GetAttribute("retry",retry);
+        delete p_command;
+        if( retry <= 0 ) retry = 1;
+        if( waited + retry > MaxWaitTime ) {
+            CSmallString error;
+            error << "snapshots leased to other clients were not released within " << MaxWaitTime << " s";
+            ES_ERROR(error);
+            return(-1);
+        }
+        if( waited == 0 ) {
+            ES_WARNING("waiting for snapshots leased to other clients");
+        }
+        sleep(retry);
+        waited += retry;
+    }
+
+    CXMLElement* p_rele = p_command->GetRootResultElement();
+
+    indexes.resize(snapshots.size());
+
+    int count = 0;
+    CXMLElement* p_sele = p_rele->GetFirstChildElement("SNAPSHOT");
+    while( (p_sele != NULL) && (count < (int)snapshots.size()) ) {
+        if( CSnapshotCodec::DecodeSnapshot(p_sele,&snapshots[count],ProjectionActive ? &ProjectionMask : NULL) == false ) {
+            ES_ERROR("unable to load snapshot coordinates");
+            delete p_command;
+            return(-1);
+        }
+        if( p_sele->GetAttribute("index",indexes[count]) == false ) {
+            ES_ERROR("unable to get snapshot index");
+            delete p_command;
+            return(-1);
+        }
+        count++;
+        p_sele = p_sele->GetNextSiblingElement("SNAPSHOT");
+    }
+
+    delete p_command;
+
+    return(count);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,110 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2008 Petr Kulhanek, kulhanek@enzim.hu
+//    Copyright (C) 2005 Petr Kulhanek, kulhanek@chemi.muni.cz
+//    Copyright (C) 2004 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <stdio.h>
+#include <TrajectoryClient.hpp>
+#include <CATsOperation.hpp>
+#include <ErrorSystem.hpp>
+#include <ClientCommand.hpp>
+#include <AmberTopology.hpp>
+#include <AmberRestart.hpp>
+#include <SnapshotCodec.hpp>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryClient::SetSnapshotMask(int client_id,CAmberTopology* p_top,const CSmallString& mask)
+{
+    // prepare local mask, which is used to scatter received atoms
+    bool active = mask.GetLength() > 0;
+    if( active ) {
+        if( p_top == NULL ) {
+            ES_ERROR("p_top is NULL");
+            return(false);
+        }
+        ProjectionMask.AssignTopology(p_top);
+        if( ProjectionMask.SetMask(mask) == false ) {
+            CSmallString error;
+            error << "unable to set mask '" << mask << "'";
+            ES_ERROR(error);
+            return(false);
+        }
+    }
+
+    // create command
+    CClientCommand* p_command = CreateCommand(Operation_SetSnapshotMask);
+    if( p_command == NULL ) return(false);
+
+    // set client ID
+    CXMLElement* p_ele = p_command->GetRootCommandElement();
+    if( p_ele == NULL ) {
+        ES_ERROR("unable to get root command element");
+        delete p_command;
+        return(false);
+    }
+
+    p_ele->SetAttribute("client_id",client_id);
+    p_ele->SetAttribute("mask",mask);
+
+    try {
+        ExecuteCommand(p_command);
+    } catch(...) {
+        ES_ERROR("unable to execute command");
+        delete p_command;
+        return(false);
+    }
+
+    CXMLElement* p_rele = p_command->GetRootResultElement();
+    if( p_rele == NULL ) {
+        ES_ERROR("unable to get root result element");
+        delete p_command;
+        return(false);
+    }
+
+    int natoms = 0;
+    if( p_rele->GetAttribute("natoms",natoms) == false ) {
+        ES_ERROR("unable to get number of projected atoms");
+        delete p_command;
+        return(false);
+    }
+
+    delete p_command;
+
+    // both sides must select the same atoms
+    if( active && (natoms != ProjectionMask.GetNumberOfSelectedAtoms()) ) {
+        CSmallString error;
+        error << "inconsistent number of selected atoms, server (" << natoms << "), client (" << ProjectionMask.GetNumberOfSelectedAtoms() << ")";
+        ES_ERROR(error);
+        ProjectionActive = false;
+        return(false);
+    }
+
+    ProjectionActive = active;
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
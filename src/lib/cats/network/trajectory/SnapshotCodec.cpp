@@ -0,0 +1,349 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SnapshotCodec.hpp>
+#include <ErrorSystem.hpp>
+#include <XMLElement.hpp>
+#include <XMLBinData.hpp>
+#include <AmberRestart.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <AmberAtom.hpp>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+// little-endian helpers - independent of the host byte order
+
+static void PutFloatLE(unsigned char* p_dst,float value)
+{
+    unsigned int bits;
+    memcpy(&bits,&value,sizeof(bits));
+    p_dst[0] = bits & 0xFF;
+    p_dst[1] = (bits >> 8) & 0xFF;
+    p_dst[2] = (bits >> 16) & 0xFF;
+    p_dst[3] = (bits >> 24) & 0xFF;
+}
+
+//------------------------------------------------------------------------------
+
+static float GetFloatLE(const unsigned char* p_src)
+{
+    unsigned int bits = (unsigned int)p_src[0] | ((unsigned int)p_src[1] << 8)
+                      | ((unsigned int)p_src[2] << 16) | ((unsigned int)p_src[3] << 24);
+    float value;
+    memcpy(&value,&bits,sizeof(value));
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+// zig-zag mapped variable length integers
+
+static void PutVarInt(std::vector<unsigned char>& buffer,long long value)
+{
+    unsigned long long uvalue = ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+    while( uvalue >= 0x80 ) {
+        buffer.push_back((uvalue & 0x7F) | 0x80);
+        uvalue >>= 7;
+    }
+    buffer.push_back(uvalue);
+}
+
+//------------------------------------------------------------------------------
+
+static bool GetVarInt(const unsigned char*& p_src,const unsigned char* p_end,long long& value)
+{
+    unsigned long long uvalue = 0;
+    int shift = 0;
+    while( p_src < p_end ) {
+        unsigned char byte = *p_src++;
+        uvalue |= (unsigned long long)(byte & 0x7F) << shift;
+        if( (byte & 0x80) == 0 ) {
+            value = (long long)(uvalue >> 1) ^ -(long long)(uvalue & 1);
+            return(true);
+        }
+        shift += 7;
+        if( shift >= 64 ) return(false);
+    }
+    return(false);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSnapshotCodec::EncodeSnapshot(CXMLElement* p_sele,CAmberRestart* p_rst,
+                                    ESnapshotEncoding encoding,double precision,
+                                    CAmberMaskAtoms* p_mask)
+{
+    if( (p_sele == NULL) || (p_rst == NULL) ) {
+        ES_ERROR("p_sele or p_rst is NULL");
+        return(false);
+    }
+
+    if( encoding == ESE_XML ) {
+        if( p_mask == NULL ) {
+            p_rst->SaveSnapshot(p_sele);
+            return(true);
+        }
+        // xml form cannot hold subset
+        encoding = ESE_FLOAT;
+    }
+
+    if( (encoding == ESE_QUANTIZED) && (precision <= 0.0) ) {
+        ES_ERROR("precision must be greater than zero");
+        return(false);
+    }
+
+    // list of encoded atoms
+    std::vector<int> indexes;
+    int natoms = p_rst->GetNumberOfAtoms();
+    if( p_mask != NULL ) {
+        natoms = p_mask->GetNumberOfSelectedAtoms();
+        indexes.resize(natoms);
+        for(int i=0; i < natoms; i++) {
+            indexes[i] = p_mask->GetSelectedAtomCondensed(i)->GetAtomIndex();
+        }
+    }
+
+    p_sele->SetAttribute("encoding",EncodeEncoding(encoding));
+    p_sele->SetAttribute("natoms",natoms);
+    p_sele->SetAttribute("subset",p_mask != NULL);
+    p_sele->SetAttribute("time",p_rst->GetTime());
+    if( p_rst->IsBoxPresent() ) {
+        CPoint box = p_rst->GetBox();
+        CPoint ang = p_rst->GetAngles();
+        p_sele->SetAttribute("boxa",box.x);
+        p_sele->SetAttribute("boxb",box.y);
+        p_sele->SetAttribute("boxc",box.z);
+        p_sele->SetAttribute("alpha",ang.x);
+        p_sele->SetAttribute("beta",ang.y);
+        p_sele->SetAttribute("gamma",ang.z);
+    }
+
+    CXMLBinData* p_data = p_sele->CreateChildBinData("COORDINATES");
+    if( p_data == NULL ) {
+        ES_ERROR("unable to create COORDINATES element");
+        return(false);
+    }
+
+    if( encoding == ESE_FLOAT ) {
+        p_data->SetLength(3*natoms*4,EXBDT_CHAR);
+        unsigned char* p_dst = (unsigned char*)p_data->GetData();
+        for(int i=0; i < natoms; i++) {
+            const CPoint& pos = p_rst->GetPosition(p_mask != NULL ? indexes[i] : i);
+            PutFloatLE(p_dst,pos.x); p_dst += 4;
+            PutFloatLE(p_dst,pos.y); p_dst += 4;
+            PutFloatLE(p_dst,pos.z); p_dst += 4;
+        }
+        return(true);
+    }
+
+    // ESE_QUANTIZED - consecutive atoms are close in space thus deltas are small
+    p_sele->SetAttribute("precision",precision);
+
+    std::vector<unsigned char> buffer;
+    buffer.reserve(3*natoms*2);
+    long long prev[3] = {0,0,0};
+    for(int i=0; i < natoms; i++) {
+        const CPoint& pos = p_rst->GetPosition(p_mask != NULL ? indexes[i] : i);
+        long long q[3];
+        q[0] = llround(pos.x*precision);
+        q[1] = llround(pos.y*precision);
+        q[2] = llround(pos.z*precision);
+        for(int k=0; k < 3; k++) {
+            PutVarInt(buffer,q[k]-prev[k]);
+            prev[k] = q[k];
+        }
+    }
+
+    p_data->SetLength(buffer.size(),EXBDT_CHAR);
+    if( buffer.size() > 0 ) {
+        memcpy(p_data->GetData(),&buffer[0],buffer.size());
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CSnapshotCodec::DecodeSnapshot(CXMLElement* p_sele,CAmberRestart* p_rst,
+                                    CAmberMaskAtoms* p_mask)
+{
+    if( (p_sele == NULL) || (p_rst == NULL) ) {
+        ES_ERROR("p_sele or p_rst is NULL");
+        return(false);
+    }
+
+    CSmallString sencoding;
+    if( p_sele->GetAttribute("encoding",sencoding) == false ) {
+        // legacy server
+        return( p_rst->LoadSnapshot(p_sele) );
+    }
+
+    ESnapshotEncoding encoding = DecodeEncoding(sencoding);
+    if( encoding == ESE_XML ) {
+        return( p_rst->LoadSnapshot(p_sele) );
+    }
+
+    int natoms = 0;
+    if( p_sele->GetAttribute("natoms",natoms) == false ) {
+        ES_ERROR("unable to get natoms");
+        return(false);
+    }
+
+    bool subset = false;
+    p_sele->GetAttribute("subset",subset);
+
+    // target atoms
+    std::vector<int> indexes;
+    if( subset == true ) {
+        if( p_mask == NULL ) {
+            ES_ERROR("subset snapshot received but no mask is provided");
+            return(false);
+        }
+        if( natoms != p_mask->GetNumberOfSelectedAtoms() ) {
+            CSmallString error;
+            error << "inconsistent number of atoms, received (" << natoms << "), mask (" << p_mask->GetNumberOfSelectedAtoms() << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+        indexes.resize(natoms);
+        for(int i=0; i < natoms; i++) {
+            indexes[i] = p_mask->GetSelectedAtomCondensed(i)->GetAtomIndex();
+        }
+    } else {
+        if( natoms != p_rst->GetNumberOfAtoms() ) {
+            CSmallString error;
+            error << "inconsistent number of atoms, received (" << natoms << "), target (" << p_rst->GetNumberOfAtoms() << ")";
+            ES_ERROR(error);
+            return(false);
+        }
+    }
+
+    double time = 0.0;
+    if( p_sele->GetAttribute("time",time) == true ) {
+        p_rst->SetTime(time);
+    }
+
+    CPoint box,ang;
+    if( p_sele->GetAttribute("boxa",box.x) == true ) {
+        bool result = true;
+        result &= p_sele->GetAttribute("boxb",box.y);
+        result &= p_sele->GetAttribute("boxc",box.z);
+        result &= p_sele->GetAttribute("alpha",ang.x);
+        result &= p_sele->GetAttribute("beta",ang.y);
+        result &= p_sele->GetAttribute("gamma",ang.z);
+        if( result == false ) {
+            ES_ERROR("unable to get box attributes");
+            return(false);
+        }
+        p_rst->SetBox(box);
+        p_rst->SetAngles(ang);
+    }
+
+    CXMLBinData* p_data = p_sele->GetFirstChildBinData("COORDINATES");
+    if( p_data == NULL ) {
+        ES_ERROR("unable to get COORDINATES element");
+        return(false);
+    }
+
+    const unsigned char* p_src = (const unsigned char*)p_data->GetData();
+    const unsigned char* p_end = p_src + p_data->GetLength();
+
+    if( encoding == ESE_FLOAT ) {
+        if( (int)p_data->GetLength() != 3*natoms*4 ) {
+            ES_ERROR("COORDINATES length mismatch");
+            return(false);
+        }
+        for(int i=0; i < natoms; i++) {
+            CPoint pos;
+            pos.x = GetFloatLE(p_src); p_src += 4;
+            pos.y = GetFloatLE(p_src); p_src += 4;
+            pos.z = GetFloatLE(p_src); p_src += 4;
+            p_rst->SetPosition(subset ? indexes[i] : i,pos);
+        }
+        return(true);
+    }
+
+    // ESE_QUANTIZED
+    double precision = 0.0;
+    if( (p_sele->GetAttribute("precision",precision) == false) || (precision <= 0.0) ) {
+        ES_ERROR("unable to get precision");
+        return(false);
+    }
+
+    long long q[3] = {0,0,0};
+    for(int i=0; i < natoms; i++) {
+        for(int k=0; k < 3; k++) {
+            long long delta;
+            if( GetVarInt(p_src,p_end,delta) == false ) {
+                ES_ERROR("COORDINATES are truncated or corrupted");
+                return(false);
+            }
+            q[k] += delta;
+        }
+        CPoint pos;
+        pos.x = q[0] / precision;
+        pos.y = q[1] / precision;
+        pos.z = q[2] / precision;
+        p_rst->SetPosition(subset ? indexes[i] : i,pos);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+ESnapshotEncoding CSnapshotCodec::DecodeEncoding(const CSmallString& name)
+{
+    if( name == "float" ) {
+        return(ESE_FLOAT);
+    } else if( name == "quantized" ) {
+        return(ESE_QUANTIZED);
+    } else {
+        return(ESE_XML);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+const CSmallString CSnapshotCodec::EncodeEncoding(ESnapshotEncoding encoding)
+{
+    switch(encoding) {
+        case ESE_FLOAT:
+            return("float");
+        case ESE_QUANTIZED:
+            return("quantized");
+        default:
+        case ESE_XML:
+            return("xml");
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,69 @@
+#ifndef SnapshotCodecH
+#define SnapshotCodecH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <SmallString.hpp>
+
+//------------------------------------------------------------------------------
+
+class CAmberRestart;
+class CAmberMaskAtoms;
+class CXMLElement;
+
+//------------------------------------------------------------------------------
+
+/// encoding of SNAPSHOT payload
+enum ESnapshotEncoding {
+    ESE_XML,            // text form provided by CAmberRestart (default)
+    ESE_FLOAT,          // raw little-endian floats
+    ESE_QUANTIZED       // integer quantized coordinates, delta and varint packed
+};
+
+//------------------------------------------------------------------------------
+
+/// conversion of snapshot coordinates to/from SNAPSHOT element
+
+class CATS_PACKAGE CSnapshotCodec {
+public:
+    /// encode snapshot coordinates into SNAPSHOT element
+    /// precision is the number of quantization steps per angstrom (ESE_QUANTIZED only)
+    /// if p_mask is provided only selected atoms are encoded (ESE_XML is then replaced by ESE_FLOAT)
+    static bool EncodeSnapshot(CXMLElement* p_sele,CAmberRestart* p_rst,
+                               ESnapshotEncoding encoding,double precision,
+                               CAmberMaskAtoms* p_mask=NULL);
+
+    /// decode snapshot coordinates from SNAPSHOT element
+    /// the encoding is taken from the element, XML is assumed if not specified
+    /// subset snapshots are scattered into p_rst by p_mask, which must select the same atoms
+    static bool DecodeSnapshot(CXMLElement* p_sele,CAmberRestart* p_rst,
+                               CAmberMaskAtoms* p_mask=NULL);
+
+    /// convert encoding name to enum, unknown names fall back to ESE_XML
+    static ESnapshotEncoding DecodeEncoding(const CSmallString& name);
+
+    /// convert encoding to its name
+    static const CSmallString EncodeEncoding(ESnapshotEncoding encoding);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
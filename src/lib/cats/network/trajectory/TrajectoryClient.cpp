@@ -31,6 +31,40 @@
 CTrajectoryClient::CTrajectoryClient(void)
 {
     ActionRequest.SetProtocolName("trj");
+    Encoding = ESE_XML;
+    Precision = 1000.0;
+    ProjectionActive = false;
+    Leasing = false;
+    MaxWaitTime = 3600;
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryClient::SetEncoding(ESnapshotEncoding encoding,double precision)
+{
+    Encoding = encoding;
+    Precision = precision;
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryClient::SetLeasing(bool leasing)
+{
+    Leasing = leasing;
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryClient::SetMaxWaitTime(int sec)
+{
+    MaxWaitTime = sec;
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryClient::AcknowledgeSnapshot(int index)
+{
+    PendingAcks.push_back(index);
 }
 
 //==============================================================================
@@ -26,10 +26,15 @@
 
 #include <CATsMainHeader.hpp>
 #include <ExtraClient.hpp>
+#include <SnapshotCodec.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <vector>
 
 //------------------------------------------------------------------------------
 
 class CAmberRestart;
+class CAmberTopology;
+class CXMLElement;
 
 //------------------------------------------------------------------------------
 
@@ -38,9 +43,51 @@ public:
     // constructor
     CTrajectoryClient(void);
 
+// setup methods --------------------------------------------------------------
+    /// set requested encoding of snapshot coordinates
+    /// precision is the number of quantization steps per angstrom (ESE_QUANTIZED only)
+    void SetEncoding(ESnapshotEncoding encoding,double precision=1000.0);
+
+    /// snapshots received by GetSnapshots are leased and must be acknowledged,
+    /// unacknowledged snapshots are handed out to other clients after timeout
+    void SetLeasing(bool leasing);
+
+    /// give up waiting for snapshots leased to other clients after SEC seconds
+    void SetMaxWaitTime(int sec);
+
+    /// mark leased snapshot as processed, it is sent with the next request
+    void AcknowledgeSnapshot(int index);
+
 // supported operations -------------------------------------------------------
     /// get data from the server
+    /// with leasing, coordinates are transferred by GetSnapshots (velocities are not supported)
     int GetSnapshot(int client_id,CAmberRestart* p_rst,const CSmallString& snapop,bool read_vel);
+
+    /// get block of up to snapshots.size() consecutive snapshots from the server
+    /// snapshots must be already created, indexes receives snapshot indexes
+    /// return number of received snapshots, zero at the end of trajectory, or -1 on error
+    /// with leasing, it waits while snapshots leased to other clients can be still requeued
+    int GetSnapshots(int client_id,std::vector<CAmberRestart>& snapshots,std::vector<int>& indexes);
+
+    /// ask the server to send only atoms selected by the mask, empty mask sends all atoms
+    /// the mask is evaluated on the topology only (no distance operators)
+    bool SetSnapshotMask(int client_id,CAmberTopology* p_top,const CSmallString& mask);
+
+    /// send pending acknowledgements of leased snapshots
+    bool FlushAcknowledgements(int client_id);
+
+// section of private data ----------------------------------------------------
+private:
+    ESnapshotEncoding   Encoding;
+    double              Precision;
+    CAmberMaskAtoms     ProjectionMask;
+    bool                ProjectionActive;
+    bool                Leasing;
+    int                 MaxWaitTime;
+    std::vector<int>    PendingAcks;
+
+    /// write pending acknowledgements as ACK ranges
+    void WriteAcknowledgements(CXMLElement* p_ele);
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,233 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <ParallelContext.hpp>
+#include <set>
+
+//------------------------------------------------------------------------------
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+int                             CParallelContext::NumOfThreads = 1;
+int                             CParallelContext::NumOfActive = 1;
+CSimpleMutex                    CParallelContext::ContextMutex;
+CSimpleCond                     CParallelContext::ContextCond;
+int                             CParallelContext::NumOfArrived = 0;
+int                             CParallelContext::Generation = 0;
+bool                            CParallelContext::ReductionFailed = false;
+bool                            CParallelContext::ResultFailed = false;
+std::vector<double>             CParallelContext::Buffer;
+std::vector<double>             CParallelContext::Result;
+std::map<std::string,CParallelObject*>  CParallelContext::Objects;
+
+// per thread data
+static thread_local int                     ThreadIndex = 0;
+static thread_local std::set<std::string>   ClaimedNames;
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CParallelObject::~CParallelObject(void)
+{
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CParallelContext::Init(int nthreads)
+{
+    if( nthreads < 1 ) nthreads = 1;
+    NumOfThreads = nthreads;
+    NumOfActive = nthreads;
+    NumOfArrived = 0;
+    Generation = 0;
+    ReductionFailed = false;
+    ResultFailed = false;
+}
+
+//------------------------------------------------------------------------------
+
+void CParallelContext::Finalize(void)
+{
+    ContextMutex.Lock();
+    std::map<std::string,CParallelObject*>::iterator it = Objects.begin();
+    while( it != Objects.end() ){
+        delete it->second;
+        it++;
+    }
+    Objects.clear();
+    NumOfThreads = 1;
+    NumOfActive = 1;
+    ContextMutex.Unlock();
+}
+
+//------------------------------------------------------------------------------
+
+void CParallelContext::BeginThread(int index)
+{
+    ThreadIndex = index;
+    ClaimedNames.clear();
+}
+
+//------------------------------------------------------------------------------
+
+void CParallelContext::EndThread(void)
+{
+    ContextMutex.Lock();
+    NumOfActive--;
+    TryComplete();
+    ContextMutex.Unlock();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CParallelContext::IsParallel(void)
+{
+    return(NumOfThreads > 1);
+}
+
+//------------------------------------------------------------------------------
+
+int CParallelContext::GetNumberOfThreads(void)
+{
+    return(NumOfThreads);
+}
+
+//------------------------------------------------------------------------------
+
+int CParallelContext::GetThreadIndex(void)
+{
+    return(ThreadIndex);
+}
+
+//------------------------------------------------------------------------------
+
+bool CParallelContext::IsMaster(void)
+{
+    return(ThreadIndex == 0);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CParallelContext::AllReduce(std::vector<double>& data)
+{
+    if( IsParallel() == false ) return(true);
+
+    ContextMutex.Lock();
+
+    // accumulate
+    if( NumOfArrived == 0 ){
+        Buffer = data;
+        ReductionFailed = false;
+    } else if( Buffer.size() != data.size() ){
+        ReductionFailed = true;
+    } else {
+        for(size_t i=0; i < data.size(); i++){
+            Buffer[i] += data[i];
+        }
+    }
+    NumOfArrived++;
+
+    // wait for others
+    int generation = Generation;
+    TryComplete();
+    while( generation == Generation ){
+        ContextCond.WaitForSignal(ContextMutex);
+    }
+
+    // the result is stable until all workers of this generation leave
+    bool result = ResultFailed == false;
+    if( result ) data = Result;
+
+    ContextMutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+void CParallelContext::Barrier(void)
+{
+    std::vector<double> dummy;
+    AllReduce(dummy);
+}
+
+//------------------------------------------------------------------------------
+
+void CParallelContext::TryComplete(void)
+{
+    if( (NumOfArrived == 0) || (NumOfArrived < NumOfActive) ) return;
+
+    Result = Buffer;
+    ResultFailed = ReductionFailed;
+    NumOfArrived = 0;
+    Generation++;
+    ContextCond.BroadcastSignal();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CParallelContext::ClaimObjectName(const std::string& name)
+{
+    // per thread data - no locking
+    return( ClaimedNames.insert(name).second );
+}
+
+//------------------------------------------------------------------------------
+
+CParallelObject* CParallelContext::RegisterObject(const std::string& name,CParallelObject* p_obj)
+{
+    ContextMutex.Lock();
+    std::map<std::string,CParallelObject*>::iterator it = Objects.find(name);
+    if( it != Objects.end() ){
+        delete p_obj;
+        p_obj = it->second;
+    } else {
+        Objects[name] = p_obj;
+    }
+    ContextMutex.Unlock();
+    return(p_obj);
+}
+
+//------------------------------------------------------------------------------
+
+CParallelObject* CParallelContext::FindObject(const std::string& name)
+{
+    CParallelObject* p_obj = NULL;
+    ContextMutex.Lock();
+    std::map<std::string,CParallelObject*>::iterator it = Objects.find(name);
+    if( it != Objects.end() ) p_obj = it->second;
+    ContextMutex.Unlock();
+    return(p_obj);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,121 @@
+#ifndef ParallelContextH
+#define ParallelContextH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <SimpleMutex.hpp>
+#include <SimpleCond.hpp>
+#include <vector>
+#include <map>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+/// object shared by all script engines
+
+class CATS_PACKAGE CParallelObject {
+public:
+    virtual ~CParallelObject(void);
+};
+
+//------------------------------------------------------------------------------
+
+/// support for in-process parallel execution of one script by several engines
+/// each engine runs in its own thread and executes the same script,
+/// shared objects are matched by names given explicitly by the script
+///
+/// workers also share process-wide state that is not synchronized here:
+/// ErrorSystem collects errors of all workers in one stack (their order is arbitrary),
+/// QCATs script arguments are set before workers start and are read-only afterwards
+
+class CATS_PACKAGE CParallelContext {
+public:
+// setup methods ---------------------------------------------------------------
+    /// initialize context for given number of threads, called before workers start
+    static void Init(int nthreads);
+
+    /// release shared objects, called after all workers finish
+    static void Finalize(void);
+
+    /// bind calling thread to the worker index (0 is the master)
+    static void BeginThread(int index);
+
+    /// worker finished, collective operations no longer wait for it
+    static void EndThread(void);
+
+// information methods ---------------------------------------------------------
+    /// is parallel execution active
+    static bool IsParallel(void);
+
+    /// get number of worker threads
+    static int GetNumberOfThreads(void);
+
+    /// get index of calling thread
+    static int GetThreadIndex(void);
+
+    /// is calling thread the master
+    static bool IsMaster(void);
+
+// collective operations - they must be called by all running workers ----------
+    /// element-wise sum of data over all workers, the result is returned to all of them
+    /// false is returned if workers provided data of different size
+    static bool AllReduce(std::vector<double>& data);
+
+    /// wait for all workers
+    static void Barrier(void);
+
+// shared objects --------------------------------------------------------------
+    /// reserve name of a shared object for the calling thread
+    /// false is returned if the thread already uses the name for another object
+    static bool ClaimObjectName(const std::string& name);
+
+    /// get shared object of given name, p_obj is registered if the name is not used yet,
+    /// otherwise it is destroyed and already registered object is returned
+    static CParallelObject* RegisterObject(const std::string& name,CParallelObject* p_obj);
+
+    /// find shared object, NULL if it does not exist
+    static CParallelObject* FindObject(const std::string& name);
+
+// section of private data -----------------------------------------------------
+private:
+    static int                              NumOfThreads;
+    static int                              NumOfActive;
+    static CSimpleMutex                     ContextMutex;
+    static CSimpleCond                      ContextCond;
+
+    // collective operations
+    static int                              NumOfArrived;
+    static int                              Generation;
+    static bool                             ReductionFailed;
+    static bool                             ResultFailed;
+    static std::vector<double>              Buffer;
+    static std::vector<double>              Result;
+
+    // shared objects
+    static std::map<std::string,CParallelObject*>   Objects;
+
+    /// finish collective operation if all active workers arrived, mutex must be locked
+    static void TryComplete(void);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,79 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <WorkerTask.hpp>
+#include <SimpleThread.hpp>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+class CWorkerTaskThread : public CSimpleThread {
+public:
+    CWorkerTask*    Task;
+    int             Worker;
+    virtual void ExecuteThread(void);
+};
+
+//------------------------------------------------------------------------------
+
+void CWorkerTaskThread::ExecuteThread(void)
+{
+    Task->ExecuteWorker(Worker);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CWorkerTask::~CWorkerTask(void)
+{
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CWorkerTask::RunWorkers(int nworkers)
+{
+    if( nworkers <= 0 ) return;
+
+    std::vector<CWorkerTaskThread>  threads(nworkers);
+    std::vector<bool>               started(nworkers,false);
+    for(int i=0; i < nworkers; i++){
+        threads[i].Task = this;
+        threads[i].Worker = i;
+    }
+
+    for(int i=1; i < nworkers; i++){
+        started[i] = threads[i].StartThread();
+    }
+    ExecuteWorker(0);
+    for(int i=1; i < nworkers; i++){
+        if( started[i] ){
+            threads[i].WaitForThread();
+        } else {
+            ExecuteWorker(i);
+        }
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,45 @@
+#ifndef WorkerTaskH
+#define WorkerTaskH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+
+//------------------------------------------------------------------------------
+
+/// task split among several workers, each worker runs in its own thread,
+/// the calling thread runs the first worker and a worker that cannot be
+/// started is run by the calling thread, thus all workers are always executed
+
+class CATS_PACKAGE CWorkerTask {
+public:
+    virtual ~CWorkerTask(void);
+
+// executive methods -----------------------------------------------------------
+    /// run all workers and wait for them
+    void RunWorkers(int nworkers);
+
+    /// execute part of the task assigned to the worker
+    virtual void ExecuteWorker(int worker) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,145 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2015 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CellGrid.hpp>
+#include <math.h>
+#include <algorithm>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CCellGrid::CCellGrid(void)
+{
+    CellSize = 1.0;
+    NX = NY = NZ = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CCellGrid::Setup(const std::vector<CPoint>& points,double cellsize)
+{
+    Clear();
+
+    int npoints = points.size();
+    if( npoints == 0 ) return;
+
+    CPoint pmin = points[0];
+    CPoint pmax = points[0];
+    for(int i=0; i < npoints; i++){
+        pmin.x = std::min(pmin.x,points[i].x);
+        pmin.y = std::min(pmin.y,points[i].y);
+        pmin.z = std::min(pmin.z,points[i].z);
+        pmax.x = std::max(pmax.x,points[i].x);
+        pmax.y = std::max(pmax.y,points[i].y);
+        pmax.z = std::max(pmax.z,points[i].z);
+    }
+
+    CellSize = cellsize;
+    if( CellSize <= 0.0 ) CellSize = 1.0;
+    Origin = pmin;
+    for(;;){
+        NX = (int)((pmax.x - pmin.x)/CellSize) + 1;
+        NY = (int)((pmax.y - pmin.y)/CellSize) + 1;
+        NZ = (int)((pmax.z - pmin.z)/CellSize) + 1;
+        // sparse systems would produce too many empty cells
+        if( (double)NX*NY*NZ <= 8.0*npoints + 1000.0 ) break;
+        CellSize *= 1.5;
+    }
+
+    // counting sort of points into cells
+    std::vector<int> cells(npoints);
+    CellStart.assign((size_t)NX*NY*NZ+1,0);
+    for(int i=0; i < npoints; i++){
+        int cx,cy,cz;
+        GetCell(points[i],cx,cy,cz);
+        cells[i] = (cz*NY + cy)*NX + cx;
+        CellStart[cells[i]+1]++;
+    }
+    for(size_t c=1; c < CellStart.size(); c++){
+        CellStart[c] += CellStart[c-1];
+    }
+    CellPoints.resize(npoints);
+    std::vector<int> fill(CellStart.begin(),CellStart.end()-1);
+    for(int i=0; i < npoints; i++){
+        CellPoints[fill[cells[i]]++] = i;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CCellGrid::Clear(void)
+{
+    NX = NY = NZ = 0;
+    CellStart.clear();
+    CellPoints.clear();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CCellGrid::GetCell(const CPoint& pos,int& cx,int& cy,int& cz) const
+{
+    cx = (int)floor((pos.x - Origin.x)/CellSize);
+    cy = (int)floor((pos.y - Origin.y)/CellSize);
+    cz = (int)floor((pos.z - Origin.z)/CellSize);
+}
+
+//------------------------------------------------------------------------------
+
+int CCellGrid::GetNX(void) const
+{
+    return(NX);
+}
+
+//------------------------------------------------------------------------------
+
+int CCellGrid::GetNY(void) const
+{
+    return(NY);
+}
+
+//------------------------------------------------------------------------------
+
+int CCellGrid::GetNZ(void) const
+{
+    return(NZ);
+}
+
+//------------------------------------------------------------------------------
+
+const std::vector<int>& CCellGrid::GetCellStart(void) const
+{
+    return(CellStart);
+}
+
+//------------------------------------------------------------------------------
+
+const std::vector<int>& CCellGrid::GetCellPoints(void) const
+{
+    return(CellPoints);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
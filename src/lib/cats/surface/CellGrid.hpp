@@ -0,0 +1,76 @@
+#ifndef CellGridH
+#define CellGridH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2015 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <Point.hpp>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// uniform cell grid for neighbour search, points closer than the requested
+/// cell size are in the same or adjacent cells, points of the cell c are
+/// GetCellPoints()[GetCellStart()[c] .. GetCellStart()[c+1]-1]
+
+class CATS_PACKAGE CCellGrid {
+public:
+// constructor -----------------------------------------------------------------
+    CCellGrid(void);
+
+// executive methods -----------------------------------------------------------
+    /// sort points into cells that are at least cellsize large
+    void Setup(const std::vector<CPoint>& points,double cellsize);
+
+    /// release the grid
+    void Clear(void);
+
+// information methods ---------------------------------------------------------
+    /// get cell coordinates of position, they are outside of the grid for
+    /// positions outside of the bounding box of points
+    void GetCell(const CPoint& pos,int& cx,int& cy,int& cz) const;
+
+    /// get number of cells in x direction
+    int GetNX(void) const;
+
+    /// get number of cells in y direction
+    int GetNY(void) const;
+
+    /// get number of cells in z direction
+    int GetNZ(void) const;
+
+    /// first point of cell in GetCellPoints(), the last item is the number of points
+    const std::vector<int>& GetCellStart(void) const;
+
+    /// indexes of points sorted by cells
+    const std::vector<int>& GetCellPoints(void) const;
+
+// section of private data -----------------------------------------------------
+private:
+    double              CellSize;
+    CPoint              Origin;
+    int                 NX,NY,NZ;
+    std::vector<int>    CellStart;
+    std::vector<int>    CellPoints;
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,225 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2015 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <SASACalculator.hpp>
+#include <ErrorSystem.hpp>
+#include <math.h>
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+// neighbour of the current atom
+struct SSASANeighbour {
+    double  X,Y,Z;      // position relative to the current atom
+    double  R2;         // squared extended radius
+    double  D2;         // squared distance
+};
+
+static bool SortByDistance(const SSASANeighbour& left,const SSASANeighbour& right)
+{
+    return(left.D2 < right.D2);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CSASACalculator::CSASACalculator(void)
+{
+    ProbeRadius = 1.4;
+    NumOfPoints = 256;
+    NumOfThreads = 1;
+    NumOfWorkers = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void CSASACalculator::SetProbeRadius(double radius)
+{
+    ProbeRadius = radius;
+}
+
+//------------------------------------------------------------------------------
+
+void CSASACalculator::SetNumberOfPoints(int npoints)
+{
+    NumOfPoints = npoints;
+}
+
+//------------------------------------------------------------------------------
+
+void CSASACalculator::SetNumberOfThreads(int nthreads)
+{
+    NumOfThreads = nthreads;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CSASACalculator::Calculate(const std::vector<CPoint>& positions,const std::vector<double>& radii,
+                                std::vector<double>& areas)
+{
+    if( positions.size() != radii.size() ){
+        ES_ERROR("inconsistent number of positions and radii");
+        return(false);
+    }
+    if( (NumOfPoints <= 0) || (NumOfThreads <= 0) || (ProbeRadius < 0.0) ){
+        ES_ERROR("illegal setup of SASA calculation");
+        return(false);
+    }
+
+    int natoms = positions.size();
+    Positions = positions;
+    Radii.resize(natoms);
+    for(int i=0; i < natoms; i++){
+        Radii[i] = radii[i] + ProbeRadius;
+    }
+    Areas.assign(natoms,0.0);
+
+    if( natoms > 0 ){
+        SetupSphere();
+
+        // overlapping spheres are in the same or adjacent cells
+        double rmax = 0.0;
+        for(int i=0; i < natoms; i++){
+            if( Radii[i] > rmax ) rmax = Radii[i];
+        }
+        Cells.Setup(Positions,2.0*rmax);
+
+        NumOfWorkers = NumOfThreads;
+        if( NumOfWorkers > natoms ) NumOfWorkers = natoms;
+        RunWorkers(NumOfWorkers);
+    }
+
+    areas = Areas;
+
+    Positions.clear();
+    Radii.clear();
+    Cells.Clear();
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+void CSASACalculator::SetupSphere(void)
+{
+    if( (int)Sphere.size() == NumOfPoints ) return;
+
+    Sphere.resize(NumOfPoints);
+
+    // golden spiral
+    double inc = M_PI*(3.0 - sqrt(5.0));
+    double off = 2.0/NumOfPoints;
+    for(int i=0; i < NumOfPoints; i++){
+        double y = i*off - 1.0 + off*0.5;
+        double r = sqrt(1.0 - y*y);
+        double phi = i*inc;
+        Sphere[i] = CPoint(cos(phi)*r,y,sin(phi)*r);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CSASACalculator::CalculateAtoms(int first,int last)
+{
+    std::vector<SSASANeighbour> neighbours;
+
+    const std::vector<int>& cellstart = Cells.GetCellStart();
+    const std::vector<int>& cellatoms = Cells.GetCellPoints();
+    int nx = Cells.GetNX();
+    int ny = Cells.GetNY();
+    int nz = Cells.GetNZ();
+
+    for(int i=first; i < last; i++){
+        const CPoint& pi = Positions[i];
+        double ri = Radii[i];
+
+        // collect overlapping neighbours
+        neighbours.clear();
+        int cx,cy,cz;
+        Cells.GetCell(pi,cx,cy,cz);
+        for(int z=std::max(cz-1,0); z <= std::min(cz+1,nz-1); z++){
+            for(int y=std::max(cy-1,0); y <= std::min(cy+1,ny-1); y++){
+                for(int x=std::max(cx-1,0); x <= std::min(cx+1,nx-1); x++){
+                    int c = (z*ny + y)*nx + x;
+                    for(int k=cellstart[c]; k < cellstart[c+1]; k++){
+                        int j = cellatoms[k];
+                        if( j == i ) continue;
+                        SSASANeighbour nb;
+                        nb.X = Positions[j].x - pi.x;
+                        nb.Y = Positions[j].y - pi.y;
+                        nb.Z = Positions[j].z - pi.z;
+                        nb.D2 = nb.X*nb.X + nb.Y*nb.Y + nb.Z*nb.Z;
+                        double rij = ri + Radii[j];
+                        if( nb.D2 >= rij*rij ) continue;
+                        nb.R2 = Radii[j]*Radii[j];
+                        neighbours.push_back(nb);
+                    }
+                }
+            }
+        }
+        // the closest neighbours bury the most points
+        std::sort(neighbours.begin(),neighbours.end(),SortByDistance);
+
+        int accessible = 0;
+        int last_buried = 0;
+        int nneighbours = neighbours.size();
+        for(int p=0; p < NumOfPoints; p++){
+            double tx = Sphere[p].x*ri;
+            double ty = Sphere[p].y*ri;
+            double tz = Sphere[p].z*ri;
+
+            // adjacent test points are usually buried by the same neighbour
+            bool buried = false;
+            for(int n=0; n < nneighbours; n++){
+                int k = (n + last_buried) % nneighbours;
+                const SSASANeighbour& nb = neighbours[k];
+                double dx = tx - nb.X;
+                double dy = ty - nb.Y;
+                double dz = tz - nb.Z;
+                if( dx*dx + dy*dy + dz*dz < nb.R2 ){
+                    last_buried = k;
+                    buried = true;
+                    break;
+                }
+            }
+            if( buried == false ) accessible++;
+        }
+
+        Areas[i] = 4.0*M_PI*ri*ri*accessible/NumOfPoints;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CSASACalculator::ExecuteWorker(int worker)
+{
+    // atoms are split into contiguous blocks, thus results do not depend on threads
+    int natoms = Positions.size();
+    CalculateAtoms((long)natoms*worker/NumOfWorkers,(long)natoms*(worker+1)/NumOfWorkers);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,81 @@
+#ifndef SASACalculatorH
+#define SASACalculatorH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2015 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <Point.hpp>
+#include <CellGrid.hpp>
+#include <WorkerTask.hpp>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// solvent accessible surface area by the Shrake-Rupley method
+/// test points are distributed on the golden spiral, neighbours are found
+/// in a uniform cell grid, atoms can be processed by several threads
+
+class CATS_PACKAGE CSASACalculator : private CWorkerTask {
+public:
+// constructor -----------------------------------------------------------------
+    CSASACalculator(void);
+
+// setup methods ---------------------------------------------------------------
+    /// set probe radius
+    void SetProbeRadius(double radius);
+
+    /// set number of test points per atom
+    void SetNumberOfPoints(int npoints);
+
+    /// set number of threads
+    void SetNumberOfThreads(int nthreads);
+
+// executive methods -----------------------------------------------------------
+    /// calculate per atom areas in A^2
+    bool Calculate(const std::vector<CPoint>& positions,const std::vector<double>& radii,
+                   std::vector<double>& areas);
+
+// section of private data -----------------------------------------------------
+private:
+    double                  ProbeRadius;
+    int                     NumOfPoints;
+    int                     NumOfThreads;
+
+    // data of the current calculation
+    std::vector<CPoint>     Sphere;         // unit sphere test points
+    std::vector<CPoint>     Positions;
+    std::vector<double>     Radii;          // extended by probe radius
+    std::vector<double>     Areas;
+    CCellGrid               Cells;
+    int                     NumOfWorkers;
+
+    /// generate test points on unit sphere
+    void SetupSphere(void);
+
+    /// calculate areas of atoms in the range
+    void CalculateAtoms(int first,int last);
+
+    /// calculate areas of the block of atoms assigned to the worker
+    virtual void ExecuteWorker(int worker);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
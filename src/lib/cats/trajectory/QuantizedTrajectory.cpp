@@ -0,0 +1,555 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <QuantizedTrajectory.hpp>
+#include <ErrorSystem.hpp>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// file layout (little-endian):
+//   header:   "CATSQTRJ", int32 version, int32 natoms, float64 precision
+//   snapshot: uint32 size of the rest of the record, float64 time, int32 flags,
+//             [6 x float64 box lengths and angles], 3 x int32 quantized first atom,
+//             bit stream of zigzag encoded differences to the previous atom
+//             in blocks, each block starts with three 6-bit widths (x,y,z)
+
+#define QTRAJ_MAGIC         "CATSQTRJ"
+#define QTRAJ_VERSION       1
+#define QTRAJ_HEADER_SIZE   24
+#define QTRAJ_BLOCK_SIZE    16
+#define QTRAJ_FLAG_BOX      1
+#define QTRAJ_MAX_QUANTUM   1073741823.0
+
+//------------------------------------------------------------------------------
+
+static void PutUInt32(std::vector<unsigned char>& buffer,uint32_t value)
+{
+    for(int i=0; i < 4; i++){
+        buffer.push_back((unsigned char)(value >> (8*i)));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static void PutDouble(std::vector<unsigned char>& buffer,double value)
+{
+    uint64_t bits;
+    memcpy(&bits,&value,sizeof(bits));
+    for(int i=0; i < 8; i++){
+        buffer.push_back((unsigned char)(bits >> (8*i)));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static uint32_t GetUInt32(const unsigned char* p_data)
+{
+    uint32_t value = 0;
+    for(int i=0; i < 4; i++){
+        value |= ((uint32_t)p_data[i]) << (8*i);
+    }
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+static double GetDouble(const unsigned char* p_data)
+{
+    uint64_t bits = 0;
+    for(int i=0; i < 8; i++){
+        bits |= ((uint64_t)p_data[i]) << (8*i);
+    }
+    double value;
+    memcpy(&value,&bits,sizeof(value));
+    return(value);
+}
+
+//------------------------------------------------------------------------------
+
+static inline uint32_t ZigZag(int32_t value)
+{
+    return( ((uint32_t)value << 1) ^ (uint32_t)(value >> 31) );
+}
+
+//------------------------------------------------------------------------------
+
+static inline int32_t UnZigZag(uint32_t value)
+{
+    return( (int32_t)(value >> 1) ^ -(int32_t)(value & 1) );
+}
+
+//------------------------------------------------------------------------------
+
+static inline int BitWidth(uint32_t value)
+{
+    int width = 0;
+    while( value != 0 ){
+        width++;
+        value >>= 1;
+    }
+    return(width);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CQuantizedTrajectory::CQuantizedTrajectory(void)
+{
+    File = NULL;
+    WriteMode = false;
+    Precision = 1000.0;
+    NumOfAtoms = -1;
+}
+
+//------------------------------------------------------------------------------
+
+CQuantizedTrajectory::~CQuantizedTrajectory(void)
+{
+    Close();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CQuantizedTrajectory::IsQuantizedTrajectory(const CSmallString& name)
+{
+    FILE* p_file = fopen(name,"rb");
+    if( p_file == NULL ) return(false);
+
+    char magic[8];
+    bool result = (fread(magic,1,8,p_file) == 8) && (memcmp(magic,QTRAJ_MAGIC,8) == 0);
+    fclose(p_file);
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::OpenForReading(const CSmallString& name)
+{
+    Close();
+
+    File = fopen(name,"rb");
+    if( File == NULL ){
+        CSmallString error;
+        error << "unable to open quantized trajectory '" << name << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    unsigned char header[QTRAJ_HEADER_SIZE];
+    if( (fread(header,1,QTRAJ_HEADER_SIZE,File) != QTRAJ_HEADER_SIZE) ||
+        (memcmp(header,QTRAJ_MAGIC,8) != 0) ){
+        CSmallString error;
+        error << "'" << name << "' is not quantized trajectory";
+        ES_ERROR(error);
+        Close();
+        return(false);
+    }
+    if( GetUInt32(header+8) != QTRAJ_VERSION ){
+        ES_ERROR("unsupported version of quantized trajectory");
+        Close();
+        return(false);
+    }
+    NumOfAtoms = (int)GetUInt32(header+12);
+    Precision = GetDouble(header+16);
+    if( (NumOfAtoms <= 0) || (Precision <= 0.0) ){
+        ES_ERROR("corrupted header of quantized trajectory");
+        Close();
+        return(false);
+    }
+
+    // count snapshots - only record sizes are read
+    off_t offset = QTRAJ_HEADER_SIZE;
+    for(;;){
+        unsigned char size[4];
+        if( fread(size,1,4,File) != 4 ) break;
+        off_t next = offset + 4 + GetUInt32(size);
+        if( fseeko(File,next,SEEK_SET) != 0 ) break;
+        Offsets.push_back(offset);
+        offset = next;
+    }
+
+    // the last record can be truncated if the writer was interrupted
+    if( fseeko(File,0,SEEK_END) == 0 ){
+        off_t end = ftello(File);
+        if( (Offsets.size() > 0) && (offset > end) ){
+            ES_WARNING("the last snapshot of quantized trajectory is incomplete, it is ignored");
+            Offsets.pop_back();
+        }
+    }
+
+    Quanta.resize(3*NumOfAtoms);
+    WriteMode = false;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::OpenForWriting(const CSmallString& name)
+{
+    double precision = Precision;
+    Close();
+    Precision = precision;
+
+    File = fopen(name,"wb");
+    if( File == NULL ){
+        CSmallString error;
+        error << "unable to open quantized trajectory '" << name << "' for writing";
+        ES_ERROR(error);
+        return(false);
+    }
+    WriteMode = true;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CQuantizedTrajectory::Close(void)
+{
+    if( File != NULL ) fclose(File);
+    File = NULL;
+    WriteMode = false;
+    NumOfAtoms = -1;
+    Precision = 1000.0;
+    Offsets.clear();
+    Quanta.clear();
+    Buffer.clear();
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::IsOpened(void) const
+{
+    return(File != NULL);
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::IsOpenedForWriting(void) const
+{
+    return( (File != NULL) && WriteMode );
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::SetPrecision(double precision)
+{
+    if( precision <= 0.0 ){
+        ES_ERROR("precision must be greater than zero");
+        return(false);
+    }
+    if( NumOfAtoms > 0 ){
+        ES_ERROR("precision cannot be changed after the first snapshot");
+        return(false);
+    }
+    Precision = precision;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+double CQuantizedTrajectory::GetPrecision(void) const
+{
+    return(Precision);
+}
+
+//------------------------------------------------------------------------------
+
+int CQuantizedTrajectory::GetNumberOfAtoms(void) const
+{
+    return(NumOfAtoms);
+}
+
+//------------------------------------------------------------------------------
+
+int CQuantizedTrajectory::GetNumberOfSnapshots(void) const
+{
+    if( WriteMode ) return(-1);
+    return((int)Offsets.size());
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CQuantizedTrajectory::WriteSnapshot(CAmberRestart* p_rst,CAmberMaskAtoms* p_mask)
+{
+    if( IsOpenedForWriting() == false ){
+        ES_ERROR("quantized trajectory is not opened for writing");
+        return(false);
+    }
+
+    int natoms = p_rst->GetNumberOfAtoms();
+    if( p_mask != NULL ){
+        if( p_mask->GetNumberOfTopologyAtoms() != natoms ){
+            ES_ERROR("selection and snapshot have different number of atoms");
+            return(false);
+        }
+        natoms = p_mask->GetNumberOfSelectedAtoms();
+    }
+    if( natoms <= 0 ){
+        ES_ERROR("no atoms to write");
+        return(false);
+    }
+
+    if( NumOfAtoms < 0 ){
+        NumOfAtoms = natoms;
+        if( WriteHeader() == false ) return(false);
+        Quanta.resize(3*NumOfAtoms);
+    }
+    if( natoms != NumOfAtoms ){
+        CSmallString error;
+        error << "inconsistent number of atoms, trajectory (" << NumOfAtoms << "), snapshot (" << natoms << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    // quantize coordinates
+    for(int i=0; i < NumOfAtoms; i++){
+        int index = i;
+        if( p_mask != NULL ) index = p_mask->GetSelectedAtomCondensed(i)->GetAtomIndex();
+        CPoint pos = p_rst->GetPosition(index);
+        double q[3];
+        q[0] = pos.x*Precision;
+        q[1] = pos.y*Precision;
+        q[2] = pos.z*Precision;
+        for(int k=0; k < 3; k++){
+            if( fabs(q[k]) > QTRAJ_MAX_QUANTUM ){
+                ES_ERROR("coordinate is out of range for the given precision");
+                return(false);
+            }
+            Quanta[3*i+k] = (int)lrint(q[k]);
+        }
+    }
+
+    // snapshot record
+    Buffer.clear();
+    PutUInt32(Buffer,0);    // size is updated later
+    PutDouble(Buffer,p_rst->GetTime());
+    bool box = p_rst->IsBoxPresent();
+    PutUInt32(Buffer,box ? QTRAJ_FLAG_BOX : 0);
+    if( box ){
+        CPoint lengths = p_rst->GetBox();
+        CPoint angles = p_rst->GetAngles();
+        PutDouble(Buffer,lengths.x);
+        PutDouble(Buffer,lengths.y);
+        PutDouble(Buffer,lengths.z);
+        PutDouble(Buffer,angles.x);
+        PutDouble(Buffer,angles.y);
+        PutDouble(Buffer,angles.z);
+    }
+    EncodeCoordinates();
+
+    uint32_t size = Buffer.size() - 4;
+    for(int i=0; i < 4; i++){
+        Buffer[i] = (unsigned char)(size >> (8*i));
+    }
+
+    if( fwrite(&Buffer[0],1,Buffer.size(),File) != Buffer.size() ){
+        ES_ERROR("unable to write snapshot to quantized trajectory");
+        return(false);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+int CQuantizedTrajectory::ReadSnapshot(int index,CAmberRestart* p_rst)
+{
+    if( (File == NULL) || WriteMode ){
+        ES_ERROR("quantized trajectory is not opened for reading");
+        return(-1);
+    }
+    if( (index < 0) || (index >= (int)Offsets.size()) ) return(1);
+
+    if( p_rst->GetNumberOfAtoms() != NumOfAtoms ){
+        CSmallString error;
+        error << "inconsistent number of atoms, trajectory (" << NumOfAtoms << "), snapshot (" << p_rst->GetNumberOfAtoms() << ")";
+        ES_ERROR(error);
+        return(-1);
+    }
+
+    // load the whole record
+    unsigned char size[4];
+    if( (fseeko(File,Offsets[index],SEEK_SET) != 0) || (fread(size,1,4,File) != 4) ){
+        ES_ERROR("unable to read snapshot from quantized trajectory");
+        return(-1);
+    }
+    Buffer.resize(GetUInt32(size));
+    if( (Buffer.size() < 12) || (fread(&Buffer[0],1,Buffer.size(),File) != Buffer.size()) ){
+        ES_ERROR("unable to read snapshot from quantized trajectory");
+        return(-1);
+    }
+
+    size_t pos = 0;
+    p_rst->SetTime(GetDouble(&Buffer[pos]));
+    pos += 8;
+    uint32_t flags = GetUInt32(&Buffer[pos]);
+    pos += 4;
+    if( flags & QTRAJ_FLAG_BOX ){
+        if( Buffer.size() < pos + 48 ){
+            ES_ERROR("corrupted snapshot in quantized trajectory");
+            return(-1);
+        }
+        p_rst->SetBox(CPoint(GetDouble(&Buffer[pos]),GetDouble(&Buffer[pos+8]),GetDouble(&Buffer[pos+16])));
+        p_rst->SetAngles(CPoint(GetDouble(&Buffer[pos+24]),GetDouble(&Buffer[pos+32]),GetDouble(&Buffer[pos+40])));
+        pos += 48;
+    }
+
+    if( DecodeCoordinates(pos) == false ){
+        ES_ERROR("corrupted snapshot in quantized trajectory");
+        return(-1);
+    }
+
+    double scale = 1.0/Precision;
+    for(int i=0; i < NumOfAtoms; i++){
+        p_rst->SetPosition(i,CPoint(Quanta[3*i]*scale,Quanta[3*i+1]*scale,Quanta[3*i+2]*scale));
+    }
+
+    return(0);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CQuantizedTrajectory::WriteHeader(void)
+{
+    std::vector<unsigned char> header;
+    header.insert(header.end(),QTRAJ_MAGIC,QTRAJ_MAGIC+8);
+    PutUInt32(header,QTRAJ_VERSION);
+    PutUInt32(header,NumOfAtoms);
+    PutDouble(header,Precision);
+
+    if( fwrite(&header[0],1,header.size(),File) != header.size() ){
+        ES_ERROR("unable to write header of quantized trajectory");
+        return(false);
+    }
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CQuantizedTrajectory::EncodeCoordinates(void)
+{
+    // the first atom is stored as is
+    for(int k=0; k < 3; k++){
+        PutUInt32(Buffer,(uint32_t)Quanta[k]);
+    }
+
+    uint64_t    bits = 0;
+    int         nbits = 0;
+
+    for(int first=1; first < NumOfAtoms; first += QTRAJ_BLOCK_SIZE){
+        int last = first + QTRAJ_BLOCK_SIZE;
+        if( last > NumOfAtoms ) last = NumOfAtoms;
+
+        // bit widths of the block
+        int width[3] = {0,0,0};
+        for(int i=first; i < last; i++){
+            for(int k=0; k < 3; k++){
+                int w = BitWidth(ZigZag(Quanta[3*i+k] - Quanta[3*(i-1)+k]));
+                if( w > width[k] ) width[k] = w;
+            }
+        }
+
+        for(int k=0; k < 3; k++){
+            bits |= ((uint64_t)width[k]) << nbits;
+            nbits += 6;
+        }
+        for(int i=first; i < last; i++){
+            for(int k=0; k < 3; k++){
+                uint64_t value = ZigZag(Quanta[3*i+k] - Quanta[3*(i-1)+k]);
+                bits |= value << nbits;
+                nbits += width[k];
+                while( nbits >= 8 ){
+                    Buffer.push_back((unsigned char)bits);
+                    bits >>= 8;
+                    nbits -= 8;
+                }
+            }
+        }
+    }
+
+    if( nbits > 0 ){
+        Buffer.push_back((unsigned char)bits);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool CQuantizedTrajectory::DecodeCoordinates(size_t pos)
+{
+    if( Buffer.size() < pos + 12 ) return(false);
+    for(int k=0; k < 3; k++){
+        Quanta[k] = (int32_t)GetUInt32(&Buffer[pos]);
+        pos += 4;
+    }
+
+    uint64_t    bits = 0;
+    int         nbits = 0;
+
+    for(int first=1; first < NumOfAtoms; first += QTRAJ_BLOCK_SIZE){
+        int last = first + QTRAJ_BLOCK_SIZE;
+        if( last > NumOfAtoms ) last = NumOfAtoms;
+
+        int width[3];
+        for(int k=0; k < 3; k++){
+            while( nbits < 6 ){
+                if( pos >= Buffer.size() ) return(false);
+                bits |= ((uint64_t)Buffer[pos++]) << nbits;
+                nbits += 8;
+            }
+            width[k] = bits & 0x3F;
+            bits >>= 6;
+            nbits -= 6;
+            if( width[k] > 32 ) return(false);
+        }
+
+        for(int i=first; i < last; i++){
+            for(int k=0; k < 3; k++){
+                while( nbits < width[k] ){
+                    if( pos >= Buffer.size() ) return(false);
+                    bits |= ((uint64_t)Buffer[pos++]) << nbits;
+                    nbits += 8;
+                }
+                uint32_t value = (uint32_t)(bits & ((((uint64_t)1) << width[k]) - 1));
+                bits >>= width[k];
+                nbits -= width[k];
+                Quanta[3*i+k] = Quanta[3*(i-1)+k] + UnZigZag(value);
+            }
+        }
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
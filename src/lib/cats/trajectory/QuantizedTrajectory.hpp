@@ -0,0 +1,105 @@
+#ifndef QuantizedTrajectoryH
+#define QuantizedTrajectoryH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <AmberRestart.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <SmallString.hpp>
+#include <stdio.h>
+#include <sys/types.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// compact trajectory with quantized coordinates
+/// coordinates are rounded to integers with given precision (quanta per A),
+/// differences between consecutive atoms are bit-packed in blocks of atoms,
+/// each block uses the smallest bit width that fits its differences
+
+class CATS_PACKAGE CQuantizedTrajectory {
+public:
+// constructor and destructor --------------------------------------------------
+    CQuantizedTrajectory(void);
+    ~CQuantizedTrajectory(void);
+
+// main methods ---------------------------------------------------------------
+    /// is the file quantized trajectory
+    static bool IsQuantizedTrajectory(const CSmallString& name);
+
+    /// open trajectory for reading, snapshots are counted
+    bool OpenForReading(const CSmallString& name);
+
+    /// open trajectory for writing, the header is written with the first snapshot
+    bool OpenForWriting(const CSmallString& name);
+
+    /// close trajectory
+    void Close(void);
+
+    /// is trajectory opened
+    bool IsOpened(void) const;
+
+    /// is trajectory opened for writing
+    bool IsOpenedForWriting(void) const;
+
+    /// set number of quanta per A, it must be set before the first snapshot is written
+    bool SetPrecision(double precision);
+
+    /// get number of quanta per A
+    double GetPrecision(void) const;
+
+    /// get number of atoms, -1 if not known yet
+    int GetNumberOfAtoms(void) const;
+
+    /// get number of snapshots, -1 if trajectory is opened for writing
+    int GetNumberOfSnapshots(void) const;
+
+// input/output methods -------------------------------------------------------
+    /// write snapshot, only atoms selected by the mask are written if provided
+    bool WriteSnapshot(CAmberRestart* p_rst,CAmberMaskAtoms* p_mask=NULL);
+
+    /// read snapshot with given zero-based index
+    /// 0 - OK, 1 - end of trajectory, otherwise error
+    int ReadSnapshot(int index,CAmberRestart* p_rst);
+
+// section of private data -----------------------------------------------------
+private:
+    FILE*                       File;
+    bool                        WriteMode;
+    double                      Precision;
+    int                         NumOfAtoms;
+    std::vector<off_t>          Offsets;        // offsets of snapshot records
+    std::vector<int>            Quanta;         // quantized coordinates x1,y1,z1,x2,...
+    std::vector<unsigned char>  Buffer;         // snapshot record
+
+    /// write file header
+    bool WriteHeader(void);
+
+    /// encode quantized coordinates into the record buffer
+    void EncodeCoordinates(void);
+
+    /// decode quantized coordinates from the record buffer
+    bool DecodeCoordinates(size_t pos);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,454 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <TrajectoryCache.hpp>
+#include <ErrorSystem.hpp>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------------
+
+// file layout (native byte order, checked by the endian tag):
+//   header:   "CATSTCAC", int32 version, int32 endian tag, int32 natoms,
+//             int32 topology atoms, int32 flags, int32 reserved,
+//             int64 number of snapshots, int64 frame size, int64 data offset
+//   subset:   int32 topology indexes of stored atoms (if flag is set)
+//   frames:   float64 time, 3 x float64 box lengths, 3 x float64 box angles,
+//             float32 coordinates x1,y1,z1,x2,... padded to 64 bytes
+
+#define TCACHE_MAGIC        "CATSTCAC"
+#define TCACHE_VERSION      1
+#define TCACHE_ENDIAN_TAG   0x01020304
+#define TCACHE_HEADER_SIZE  64
+#define TCACHE_ALIGNMENT    64
+#define TCACHE_FLAG_BOX     1
+#define TCACHE_FLAG_SUBSET  2
+
+struct STrajectoryCacheHeader {
+    char        Magic[8];
+    int32_t     Version;
+    int32_t     EndianTag;
+    int32_t     NumOfAtoms;
+    int32_t     NumOfTopAtoms;
+    int32_t     Flags;
+    int32_t     Reserved;
+    int64_t     NumOfSnapshots;
+    int64_t     FrameSize;
+    int64_t     DataOffset;
+    char        Padding[8];
+};
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTrajectoryCache::CTrajectoryCache(void)
+{
+    File = NULL;
+    Map = NULL;
+    MapSize = 0;
+    NumOfAtoms = 0;
+    NumOfTopAtoms = 0;
+    NumOfSnapshots = 0;
+    Flags = 0;
+    FrameSize = 0;
+    DataOffset = 0;
+    AtomIndexes = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+CTrajectoryCache::~CTrajectoryCache(void)
+{
+    Close();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryCache::IsTrajectoryCache(const CSmallString& name)
+{
+    FILE* p_file = fopen(name,"rb");
+    if( p_file == NULL ) return(false);
+
+    char magic[8];
+    bool result = (fread(magic,1,8,p_file) == 8) && (memcmp(magic,TCACHE_MAGIC,8) == 0);
+    fclose(p_file);
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::OpenForReading(const CSmallString& name)
+{
+    Close();
+
+    int fd = open(name,O_RDONLY);
+    if( fd < 0 ){
+        CSmallString error;
+        error << "unable to open trajectory cache '" << name << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    struct stat info;
+    if( (fstat(fd,&info) != 0) || (info.st_size < TCACHE_HEADER_SIZE) ){
+        CSmallString error;
+        error << "'" << name << "' is not trajectory cache";
+        ES_ERROR(error);
+        close(fd);
+        return(false);
+    }
+
+    MapSize = info.st_size;
+    void* p_map = mmap(NULL,MapSize,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if( p_map == MAP_FAILED ){
+        CSmallString error;
+        error << "unable to map trajectory cache '" << name << "'";
+        ES_ERROR(error);
+        MapSize = 0;
+        return(false);
+    }
+    Map = (unsigned char*)p_map;
+
+    STrajectoryCacheHeader header;
+    memcpy(&header,Map,sizeof(header));
+    if( memcmp(header.Magic,TCACHE_MAGIC,8) != 0 ){
+        CSmallString error;
+        error << "'" << name << "' is not trajectory cache";
+        ES_ERROR(error);
+        Close();
+        return(false);
+    }
+    if( header.EndianTag != TCACHE_ENDIAN_TAG ){
+        ES_ERROR("trajectory cache was created on a machine with different byte order");
+        Close();
+        return(false);
+    }
+    if( header.Version != TCACHE_VERSION ){
+        ES_ERROR("unsupported version of trajectory cache");
+        Close();
+        return(false);
+    }
+
+    NumOfAtoms = header.NumOfAtoms;
+    NumOfTopAtoms = header.NumOfTopAtoms;
+    NumOfSnapshots = header.NumOfSnapshots;
+    Flags = header.Flags;
+    FrameSize = header.FrameSize;
+    DataOffset = header.DataOffset;
+
+    if( (NumOfAtoms <= 0) || (FrameSize != GetFrameSize(NumOfAtoms)) || (DataOffset > MapSize) ){
+        ES_ERROR("corrupted header of trajectory cache");
+        Close();
+        return(false);
+    }
+
+    // the cache can be incomplete if the converter was interrupted
+    if( DataOffset + NumOfSnapshots*FrameSize > MapSize ){
+        ES_WARNING("trajectory cache is incomplete, missing snapshots are ignored");
+        NumOfSnapshots = (MapSize - DataOffset) / FrameSize;
+    }
+
+    if( Flags & TCACHE_FLAG_SUBSET ){
+        AtomIndexes = (const int32_t*)(Map + TCACHE_HEADER_SIZE);
+    }
+
+    // snapshots are usually read in order
+    madvise(Map,MapSize,MADV_SEQUENTIAL);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::OpenForWriting(const CSmallString& name,int ntopatoms,CAmberMaskAtoms* p_mask)
+{
+    Close();
+
+    NumOfTopAtoms = ntopatoms;
+    NumOfAtoms = ntopatoms;
+    Flags = 0;
+    SubsetIndexes.clear();
+
+    if( p_mask != NULL ){
+        if( p_mask->GetNumberOfTopologyAtoms() != ntopatoms ){
+            ES_ERROR("mask and topology have different number of atoms");
+            return(false);
+        }
+        if( p_mask->GetNumberOfSelectedAtoms() != ntopatoms ){
+            NumOfAtoms = p_mask->GetNumberOfSelectedAtoms();
+            Flags |= TCACHE_FLAG_SUBSET;
+            for(int i=0; i < NumOfAtoms; i++){
+                SubsetIndexes.push_back(p_mask->GetSelectedAtomCondensed(i)->GetAtomIndex());
+            }
+        }
+    }
+
+    if( NumOfAtoms <= 0 ){
+        ES_ERROR("no atoms to store in trajectory cache");
+        return(false);
+    }
+
+    File = fopen(name,"wb");
+    if( File == NULL ){
+        CSmallString error;
+        error << "unable to create trajectory cache '" << name << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    FrameSize = GetFrameSize(NumOfAtoms);
+    DataOffset = TCACHE_HEADER_SIZE + SubsetIndexes.size()*sizeof(int32_t);
+    DataOffset = ((DataOffset + TCACHE_ALIGNMENT - 1)/TCACHE_ALIGNMENT)*TCACHE_ALIGNMENT;
+    NumOfSnapshots = 0;
+
+    // header is completed in Close
+    std::vector<unsigned char> head(DataOffset,0);
+    memcpy(&head[0],TCACHE_MAGIC,8);
+    if( SubsetIndexes.size() > 0 ){
+        memcpy(&head[TCACHE_HEADER_SIZE],&SubsetIndexes[0],SubsetIndexes.size()*sizeof(int32_t));
+    }
+    if( fwrite(&head[0],1,head.size(),File) != head.size() ){
+        ES_ERROR("unable to write header of trajectory cache");
+        Close();
+        return(false);
+    }
+
+    FrameBuffer.resize(FrameSize);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::Close(void)
+{
+    bool result = true;
+
+    if( File != NULL ){
+        STrajectoryCacheHeader header;
+        memset(&header,0,sizeof(header));
+        memcpy(header.Magic,TCACHE_MAGIC,8);
+        header.Version = TCACHE_VERSION;
+        header.EndianTag = TCACHE_ENDIAN_TAG;
+        header.NumOfAtoms = NumOfAtoms;
+        header.NumOfTopAtoms = NumOfTopAtoms;
+        header.Flags = Flags;
+        header.NumOfSnapshots = NumOfSnapshots;
+        header.FrameSize = FrameSize;
+        header.DataOffset = DataOffset;
+
+        if( (fseeko(File,0,SEEK_SET) != 0) || (fwrite(&header,1,sizeof(header),File) != sizeof(header)) ){
+            ES_ERROR("unable to update header of trajectory cache");
+            result = false;
+        }
+        if( fclose(File) != 0 ) result = false;
+        File = NULL;
+    }
+
+    if( Map != NULL ){
+        munmap(Map,MapSize);
+        Map = NULL;
+    }
+
+    MapSize = 0;
+    NumOfAtoms = 0;
+    NumOfTopAtoms = 0;
+    NumOfSnapshots = 0;
+    Flags = 0;
+    FrameSize = 0;
+    DataOffset = 0;
+    AtomIndexes = NULL;
+    SubsetIndexes.clear();
+    FrameBuffer.clear();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::IsOpened(void) const
+{
+    return( (File != NULL) || (Map != NULL) );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+int CTrajectoryCache::GetNumberOfAtoms(void) const
+{
+    return(NumOfAtoms);
+}
+
+//------------------------------------------------------------------------------
+
+int CTrajectoryCache::GetNumberOfTopologyAtoms(void) const
+{
+    return(NumOfTopAtoms);
+}
+
+//------------------------------------------------------------------------------
+
+int CTrajectoryCache::GetNumberOfSnapshots(void) const
+{
+    return(NumOfSnapshots);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::IsSubset(void) const
+{
+    return( (Flags & TCACHE_FLAG_SUBSET) != 0 );
+}
+
+//------------------------------------------------------------------------------
+
+int CTrajectoryCache::GetAtomIndex(int index) const
+{
+    if( AtomIndexes != NULL ) return(AtomIndexes[index]);
+    if( SubsetIndexes.size() > 0 ) return(SubsetIndexes[index]);
+    return(index);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryCache::WriteSnapshot(CAmberRestart* p_rst)
+{
+    if( File == NULL ){
+        ES_ERROR("trajectory cache is not opened for writing");
+        return(false);
+    }
+    if( p_rst->GetNumberOfAtoms() != NumOfTopAtoms ){
+        CSmallString error;
+        error << "inconsistent number of atoms, cache topology (" << NumOfTopAtoms << "), snapshot (" << p_rst->GetNumberOfAtoms() << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    double cell[7];
+    cell[0] = p_rst->GetTime();
+    if( p_rst->IsBoxPresent() ){
+        CPoint lengths = p_rst->GetBox();
+        CPoint angles = p_rst->GetAngles();
+        cell[1] = lengths.x;
+        cell[2] = lengths.y;
+        cell[3] = lengths.z;
+        cell[4] = angles.x;
+        cell[5] = angles.y;
+        cell[6] = angles.z;
+        Flags |= TCACHE_FLAG_BOX;
+    } else {
+        for(int i=1; i < 7; i++) cell[i] = 0.0;
+    }
+    memcpy(&FrameBuffer[0],cell,sizeof(cell));
+
+    float* p_crd = (float*)(&FrameBuffer[sizeof(cell)]);
+    for(int i=0; i < NumOfAtoms; i++){
+        CPoint pos = p_rst->GetPosition(GetAtomIndex(i));
+        *p_crd++ = pos.x;
+        *p_crd++ = pos.y;
+        *p_crd++ = pos.z;
+    }
+
+    if( fwrite(&FrameBuffer[0],1,FrameSize,File) != FrameSize ){
+        ES_ERROR("unable to write snapshot to trajectory cache");
+        return(false);
+    }
+    NumOfSnapshots++;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryCache::ReadSnapshot(int index,CAmberRestart* p_rst,bool partial)
+{
+    const float* p_crd = GetCoordinates(index);
+    if( p_crd == NULL ){
+        ES_ERROR("snapshot is not in trajectory cache");
+        return(false);
+    }
+
+    bool scatter;
+    if( p_rst->GetNumberOfAtoms() == NumOfAtoms ){
+        scatter = false;
+    } else if( (p_rst->GetNumberOfAtoms() == NumOfTopAtoms) && partial ){
+        scatter = true;
+    } else if( p_rst->GetNumberOfAtoms() == NumOfTopAtoms ){
+        // the other atoms would silently keep stale positions
+        CSmallString error;
+        error << "cache contains only a subset of atoms (" << NumOfAtoms << " of " << NumOfTopAtoms
+              << "), use the topology of the subset";
+        ES_ERROR(error);
+        return(false);
+    } else {
+        CSmallString error;
+        error << "inconsistent number of atoms, cache (" << NumOfAtoms << "), snapshot (" << p_rst->GetNumberOfAtoms() << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    const double* p_cell = (const double*)(Map + DataOffset + index*FrameSize);
+    p_rst->SetTime(p_cell[0]);
+    if( Flags & TCACHE_FLAG_BOX ){
+        p_rst->SetBox(CPoint(p_cell[1],p_cell[2],p_cell[3]));
+        p_rst->SetAngles(CPoint(p_cell[4],p_cell[5],p_cell[6]));
+    }
+
+    for(int i=0; i < NumOfAtoms; i++){
+        int j = scatter ? GetAtomIndex(i) : i;
+        p_rst->SetPosition(j,CPoint(p_crd[0],p_crd[1],p_crd[2]));
+        p_crd += 3;
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+const float* CTrajectoryCache::GetCoordinates(int index) const
+{
+    if( (Map == NULL) || (index < 0) || (index >= NumOfSnapshots) ) return(NULL);
+    return( (const float*)(Map + DataOffset + index*FrameSize + 7*sizeof(double)) );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+size_t CTrajectoryCache::GetFrameSize(int natoms)
+{
+    size_t size = 7*sizeof(double) + 3*natoms*sizeof(float);
+    return( ((size + TCACHE_ALIGNMENT - 1)/TCACHE_ALIGNMENT)*TCACHE_ALIGNMENT );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,114 @@
+#ifndef TrajectoryCacheH
+#define TrajectoryCacheH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <AmberRestart.hpp>
+#include <AmberMaskAtoms.hpp>
+#include <SmallString.hpp>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// trajectory cache for repeated analyses
+/// snapshots are stored as fixed-size frames with float coordinates and box,
+/// the file is memory mapped for reading, thus processes on the same node
+/// share decoded snapshots via the page cache, the cache can contain only
+/// a subset of topology atoms
+
+class CATS_PACKAGE CTrajectoryCache {
+public:
+// constructor and destructor --------------------------------------------------
+    CTrajectoryCache(void);
+    ~CTrajectoryCache(void);
+
+// main methods ---------------------------------------------------------------
+    /// is the file trajectory cache
+    static bool IsTrajectoryCache(const CSmallString& name);
+
+    /// open cache for reading
+    bool OpenForReading(const CSmallString& name);
+
+    /// create cache, only atoms selected by the mask are stored if provided
+    bool OpenForWriting(const CSmallString& name,int ntopatoms,CAmberMaskAtoms* p_mask=NULL);
+
+    /// close cache, the number of snapshots is updated in write mode
+    bool Close(void);
+
+    /// is cache opened
+    bool IsOpened(void) const;
+
+// information methods --------------------------------------------------------
+    /// get number of stored atoms
+    int GetNumberOfAtoms(void) const;
+
+    /// get number of atoms of the source topology
+    int GetNumberOfTopologyAtoms(void) const;
+
+    /// get number of snapshots
+    int GetNumberOfSnapshots(void) const;
+
+    /// does the cache contain only a subset of atoms
+    bool IsSubset(void) const;
+
+    /// get topology index of the stored atom
+    int GetAtomIndex(int index) const;
+
+// input/output methods -------------------------------------------------------
+    /// write snapshot
+    bool WriteSnapshot(CAmberRestart* p_rst);
+
+    /// read snapshot with given zero-based index
+    /// the snapshot must have the stored number of atoms, a snapshot of the source
+    /// topology is accepted for subset caches only if partial is true, then only
+    /// stored atoms are updated and the others keep their previous positions
+    bool ReadSnapshot(int index,CAmberRestart* p_rst,bool partial=false);
+
+    /// get mapped coordinates (x1,y1,z1,x2,...) of snapshot
+    const float* GetCoordinates(int index) const;
+
+// section of private data -----------------------------------------------------
+private:
+    FILE*           File;           // write mode
+    unsigned char*  Map;            // read mode
+    size_t          MapSize;
+    int             NumOfAtoms;
+    int             NumOfTopAtoms;
+    int             NumOfSnapshots;
+    int             Flags;
+    size_t          FrameSize;
+    size_t          DataOffset;
+    const int32_t*  AtomIndexes;    // subset of atoms, mapped in read mode
+
+    // write mode
+    std::vector<int32_t>        SubsetIndexes;
+    std::vector<unsigned char>  FrameBuffer;
+
+    /// frame size for given number of atoms
+    static size_t GetFrameSize(int natoms);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,295 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <TrajectoryFrameReader.hpp>
+#include <ErrorSystem.hpp>
+#include <netcdf.h>
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTrajectoryFrameReader::CTrajectoryFrameReader(void)
+{
+    AsciiFile = NULL;
+    NetCDFID = -1;
+    CoordinatesID = -1;
+    CellLengthsID = -1;
+    CellAnglesID = -1;
+    TimeID = -1;
+}
+
+//------------------------------------------------------------------------------
+
+CTrajectoryFrameReader::~CTrajectoryFrameReader(void)
+{
+    Close();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryFrameReader::IsRandomAccessible(const CTrajectoryIndex& index)
+{
+    switch(index.GetFormat()){
+        case AMBER_TRAJ_ASCII:
+            return(index.AreOffsetsAvailable());
+        case AMBER_TRAJ_NETCDF:
+            return(true);
+        default:
+            return(false);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::Open(const CSmallString& name,const CTrajectoryIndex& index)
+{
+    Close();
+
+    if( IsRandomAccessible(index) == false ) return(false);
+    Index = index;
+
+    if( Index.GetFormat() == AMBER_TRAJ_NETCDF ){
+        return(OpenNetCDF(name));
+    }
+
+    AsciiFile = fopen(name,"r");
+    if( AsciiFile == NULL ){
+        CSmallString error;
+        error << "unable to open trajectory '" << name << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+    AsciiBuffer.resize(Index.GetSnapshotSize());
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::OpenNetCDF(const CSmallString& name)
+{
+    if( nc_open(name,NC_NOWRITE,&NetCDFID) != NC_NOERR ){
+        CSmallString error;
+        error << "unable to open NetCDF trajectory '" << name << "'";
+        ES_ERROR(error);
+        NetCDFID = -1;
+        return(false);
+    }
+
+    // check number of atoms
+    int     atom_id;
+    size_t  natoms = 0;
+    if( (nc_inq_dimid(NetCDFID,"atom",&atom_id) != NC_NOERR) ||
+        (nc_inq_dimlen(NetCDFID,atom_id,&natoms) != NC_NOERR) ||
+        ((int)natoms != Index.GetNumberOfAtoms()) ){
+        ES_ERROR("inconsistent number of atoms in NetCDF trajectory");
+        Close();
+        return(false);
+    }
+
+    if( nc_inq_varid(NetCDFID,"coordinates",&CoordinatesID) != NC_NOERR ){
+        ES_ERROR("NetCDF trajectory does not contain coordinates");
+        Close();
+        return(false);
+    }
+
+    if( Index.IsBoxPresent() ){
+        if( (nc_inq_varid(NetCDFID,"cell_lengths",&CellLengthsID) != NC_NOERR) ||
+            (nc_inq_varid(NetCDFID,"cell_angles",&CellAnglesID) != NC_NOERR) ){
+            ES_ERROR("NetCDF trajectory does not contain box information");
+            Close();
+            return(false);
+        }
+    }
+
+    // time is optional
+    if( nc_inq_varid(NetCDFID,"time",&TimeID) != NC_NOERR ){
+        TimeID = -1;
+    }
+
+    Coordinates.resize(3*natoms);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CTrajectoryFrameReader::Close(void)
+{
+    if( AsciiFile != NULL ){
+        fclose(AsciiFile);
+        AsciiFile = NULL;
+    }
+    if( NetCDFID >= 0 ){
+        nc_close(NetCDFID);
+        NetCDFID = -1;
+    }
+    CoordinatesID = -1;
+    CellLengthsID = -1;
+    CellAnglesID = -1;
+    TimeID = -1;
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::IsOpened(void) const
+{
+    return( (AsciiFile != NULL) || (NetCDFID >= 0) );
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::ReadSnapshot(int index,CAmberRestart* p_rst)
+{
+    if( (index < 0) || (index >= Index.GetNumberOfSnapshots()) ){
+        CSmallString error;
+        error << "snapshot index " << index + 1 << " is out of range";
+        ES_ERROR(error);
+        return(false);
+    }
+    if( p_rst->GetNumberOfAtoms() != Index.GetNumberOfAtoms() ){
+        ES_ERROR("inconsistent number of atoms");
+        return(false);
+    }
+
+    if( AsciiFile != NULL ) return(ReadAsciiSnapshot(index,p_rst));
+    if( NetCDFID >= 0 ) return(ReadNetCDFSnapshot(index,p_rst));
+
+    ES_ERROR("trajectory is not opened");
+    return(false);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryFrameReader::ReadAsciiSnapshot(int index,CAmberRestart* p_rst)
+{
+    if( fseeko(AsciiFile,Index.GetSnapshotOffset(index),SEEK_SET) != 0 ){
+        ES_ERROR("unable to seek in the trajectory");
+        return(false);
+    }
+    if( fread(AsciiBuffer.data(),1,AsciiBuffer.size(),AsciiFile) != AsciiBuffer.size() ){
+        ES_ERROR("unable to read the snapshot");
+        return(false);
+    }
+
+    // ten %8.3f items per line
+    int         natoms = Index.GetNumberOfAtoms();
+    const char* p_data = AsciiBuffer.data();
+    double      crd[3];
+    for(int i=0; i < natoms; i++){
+        for(int k=0; k < 3; k++){
+            int item = 3*i + k;
+            if( DecodeField(&p_data[(item/10)*81 + (item%10)*8],crd[k]) == false ){
+                ES_ERROR("unable to decode coordinate");
+                return(false);
+            }
+        }
+        p_rst->SetPosition(i,CPoint(crd[0],crd[1],crd[2]));
+    }
+
+    if( Index.IsBoxPresent() ){
+        int ncrd = 3*natoms;
+        const char* p_box = &p_data[8*ncrd + (ncrd + 9)/10];
+        for(int k=0; k < 3; k++){
+            if( DecodeField(&p_box[8*k],crd[k]) == false ){
+                ES_ERROR("unable to decode box");
+                return(false);
+            }
+        }
+        p_rst->SetBox(CPoint(crd[0],crd[1],crd[2]));
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::ReadNetCDFSnapshot(int index,CAmberRestart* p_rst)
+{
+    int natoms = Index.GetNumberOfAtoms();
+
+    size_t start[3];
+    size_t count[3];
+    start[0] = index;
+    start[1] = 0;
+    start[2] = 0;
+    count[0] = 1;
+    count[1] = natoms;
+    count[2] = 3;
+
+    if( nc_get_vara_float(NetCDFID,CoordinatesID,start,count,Coordinates.data()) != NC_NOERR ){
+        ES_ERROR("unable to read coordinates");
+        return(false);
+    }
+    for(int i=0; i < natoms; i++){
+        p_rst->SetPosition(i,CPoint(Coordinates[3*i],Coordinates[3*i+1],Coordinates[3*i+2]));
+    }
+
+    if( Index.IsBoxPresent() ){
+        double box[3];
+        double angles[3];
+        size_t cstart[2];
+        size_t ccount[2];
+        cstart[0] = index;
+        cstart[1] = 0;
+        ccount[0] = 1;
+        ccount[1] = 3;
+        if( (nc_get_vara_double(NetCDFID,CellLengthsID,cstart,ccount,box) != NC_NOERR) ||
+            (nc_get_vara_double(NetCDFID,CellAnglesID,cstart,ccount,angles) != NC_NOERR) ){
+            ES_ERROR("unable to read box");
+            return(false);
+        }
+        p_rst->SetBox(CPoint(box[0],box[1],box[2]));
+        p_rst->SetAngles(CPoint(angles[0],angles[1],angles[2]));
+    }
+
+    if( TimeID >= 0 ){
+        float time;
+        if( nc_get_var1_float(NetCDFID,TimeID,start,&time) == NC_NOERR ){
+            p_rst->SetTime(time);
+        }
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryFrameReader::DecodeField(const char* p_field,double& value)
+{
+    char    buffer[9];
+    char*   p_end;
+    memcpy(buffer,p_field,8);
+    buffer[8] = '\0';
+    value = strtod(buffer,&p_end);
+    return( p_end != buffer );
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,80 @@
+#ifndef TrajectoryFrameReaderH
+#define TrajectoryFrameReaderH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <CATsMainHeader.hpp>
+#include <TrajectoryIndex.hpp>
+#include <AmberRestart.hpp>
+#include <stdio.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// random access to snapshots of uncompressed ASCII and NetCDF trajectories
+/// ASCII snapshots are located by offsets from the trajectory index,
+/// NetCDF snapshots are read directly from the corresponding record
+
+class CATS_PACKAGE CTrajectoryFrameReader {
+public:
+// constructor and destructor --------------------------------------------------
+    CTrajectoryFrameReader(void);
+    ~CTrajectoryFrameReader(void);
+
+// main methods ---------------------------------------------------------------
+    /// can trajectory described by the index be accessed randomly
+    static bool IsRandomAccessible(const CTrajectoryIndex& index);
+
+    /// open trajectory, false if it cannot be accessed randomly
+    bool Open(const CSmallString& name,const CTrajectoryIndex& index);
+
+    /// close trajectory
+    void Close(void);
+
+    /// is trajectory opened
+    bool IsOpened(void) const;
+
+    /// read snapshot with given zero-based index
+    bool ReadSnapshot(int index,CAmberRestart* p_rst);
+
+// section of private data -----------------------------------------------------
+private:
+    CTrajectoryIndex    Index;
+    FILE*               AsciiFile;
+    std::vector<char>   AsciiBuffer;
+    int                 NetCDFID;
+    int                 CoordinatesID;
+    int                 CellLengthsID;
+    int                 CellAnglesID;
+    int                 TimeID;
+    std::vector<float>  Coordinates;
+
+    bool OpenNetCDF(const CSmallString& name);
+    bool ReadAsciiSnapshot(int index,CAmberRestart* p_rst);
+    bool ReadNetCDFSnapshot(int index,CAmberRestart* p_rst);
+
+    /// decode fixed-width ASCII field
+    static bool DecodeField(const char* p_field,double& value);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
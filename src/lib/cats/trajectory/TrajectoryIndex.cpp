@@ -0,0 +1,378 @@
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <TrajectoryIndex.hpp>
+#include <ErrorSystem.hpp>
+#include <FileName.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+
+#define CATS_TRAJ_INDEX_MAGIC   "CATS_TRAJ_INDEX"
+#define CATS_TRAJ_INDEX_VERSION 1
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CTrajectoryIndex::CTrajectoryIndex(void)
+{
+    FileSize = 0;
+    FileMTime = 0;
+    Format = AMBER_TRAJ_UNKNOWN;
+    NumOfAtoms = 0;
+    BoxPresent = false;
+    NumOfSnapshots = -1;
+    FirstOffset = 0;
+    FrameSize = 0;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryIndex::Load(const CSmallString& name,ETrajectoryFormat format,CAmberTopology* p_top)
+{
+    off_t   size;
+    time_t  mtime;
+    if( GetFileStat(name,size,mtime) == false ) return(false);
+
+    FILE* p_fin = fopen(GetIndexName(name),"r");
+    if( p_fin == NULL ) return(false);
+
+    char        magic[32];
+    char        sformat[32];
+    int         version = 0;
+    long long   fsize = 0;
+    long long   fmtime = 0;
+    int         natoms = 0;
+    int         box = 0;
+    int         nsnapshots = -1;
+    long long   first = 0;
+    long long   frame = 0;
+
+    int nread = fscanf(p_fin,"%31s %d size %lld mtime %lld format %31s atoms %d box %d snapshots %d offsets %lld %lld",
+                       magic,&version,&fsize,&fmtime,sformat,&natoms,&box,&nsnapshots,&first,&frame);
+    fclose(p_fin);
+
+    if( nread != 10 ) return(false);
+    if( CSmallString(magic) != CATS_TRAJ_INDEX_MAGIC ) return(false);
+    if( version != CATS_TRAJ_INDEX_VERSION ) return(false);
+
+    // is index up-to-date?
+    if( (fsize != (long long)size) || (fmtime != (long long)mtime) ) return(false);
+
+    // is it compatible with the topology?
+    if( natoms != p_top->AtomList.GetNumberOfAtoms() ) return(false);
+    if( (box != 0) != (p_top->BoxInfo.GetType() != AMBER_BOX_NONE) ) return(false);
+
+    if( (nsnapshots < 0) || (first < 0) || (frame < 0) ) return(false);
+
+    ETrajectoryFormat fformat = DecodeFormat(sformat);
+    if( fformat == AMBER_TRAJ_UNKNOWN ) return(false);
+    if( (format != AMBER_TRAJ_UNKNOWN) && (format != fformat) ) return(false);
+
+    FileSize = size;
+    FileMTime = mtime;
+    Format = fformat;
+    NumOfAtoms = natoms;
+    BoxPresent = box != 0;
+    NumOfSnapshots = nsnapshots;
+    FirstOffset = first;
+    FrameSize = frame;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::Build(const CSmallString& name,ETrajectoryFormat format,CAmberTopology* p_top)
+{
+    if( GetFileStat(name,FileSize,FileMTime) == false ){
+        CSmallString error;
+        error << "unable to stat file '" << name << "'";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    NumOfAtoms = p_top->AtomList.GetNumberOfAtoms();
+    BoxPresent = p_top->BoxInfo.GetType() != AMBER_BOX_NONE;
+    NumOfSnapshots = -1;
+    FirstOffset = 0;
+    FrameSize = 0;
+
+    // fixed-size records of ASCII trajectories can be counted without reading them
+    if( format == AMBER_TRAJ_ASCII ){
+        Format = format;
+        if( SetupOffsets(name) == true ) return(true);
+    }
+
+    CAmberTrajectory traj;
+    traj.AssignTopology(p_top);
+    if( traj.OpenTrajectoryFile(name,format,AMBER_TRAJ_CXYZB,AMBER_TRAJ_READ) == false ){
+        return(false);
+    }
+    Format = traj.GetFormat();
+    NumOfSnapshots = traj.GetNumberOfSnapshots();
+    traj.CloseTrajectoryFile();
+
+    if( Format == AMBER_TRAJ_ASCII ){
+        SetupOffsets(name);
+    }
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::Save(const CSmallString& name)
+{
+    CSmallString idx_name = GetIndexName(name);
+    CSmallString tmp_name;
+    tmp_name << idx_name << "." << (int)getpid();
+
+    FILE* p_fout = fopen(tmp_name,"w");
+    if( p_fout == NULL ) return(false);    // e.g., read-only directory
+
+    bool result = true;
+    result &= fprintf(p_fout,"%s %d\n",CATS_TRAJ_INDEX_MAGIC,CATS_TRAJ_INDEX_VERSION) > 0;
+    result &= fprintf(p_fout,"size %lld\n",(long long)FileSize) > 0;
+    result &= fprintf(p_fout,"mtime %lld\n",(long long)FileMTime) > 0;
+    result &= fprintf(p_fout,"format %s\n",EncodeFormat(Format)) > 0;
+    result &= fprintf(p_fout,"atoms %d\n",NumOfAtoms) > 0;
+    result &= fprintf(p_fout,"box %d\n",BoxPresent ? 1 : 0) > 0;
+    result &= fprintf(p_fout,"snapshots %d\n",NumOfSnapshots) > 0;
+    result &= fprintf(p_fout,"offsets %lld %lld\n",(long long)FirstOffset,(long long)FrameSize) > 0;
+    result &= fclose(p_fout) == 0;
+
+    // replace index atomically
+    if( (result == false) || (rename(tmp_name,idx_name) != 0) ){
+        unlink(tmp_name);
+        return(false);
+    }
+
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+const CSmallString CTrajectoryIndex::GetIndexName(const CSmallString& name)
+{
+    CFileName    full_name(name);
+    CSmallString dir = full_name.GetFileDirectory();
+    CSmallString idx_name;
+    if( dir != NULL ){
+        idx_name << dir << "/";
+    }
+    idx_name << "." << full_name.GetFileName() << ".cidx";
+    return(idx_name);
+}
+
+//------------------------------------------------------------------------------
+
+ETrajectoryFormat CTrajectoryIndex::GetFormat(void) const
+{
+    return(Format);
+}
+
+//------------------------------------------------------------------------------
+
+int CTrajectoryIndex::GetNumberOfSnapshots(void) const
+{
+    return(NumOfSnapshots);
+}
+
+//------------------------------------------------------------------------------
+
+int CTrajectoryIndex::GetNumberOfAtoms(void) const
+{
+    return(NumOfAtoms);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::IsBoxPresent(void) const
+{
+    return(BoxPresent);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::AreOffsetsAvailable(void) const
+{
+    return(FrameSize > 0);
+}
+
+//------------------------------------------------------------------------------
+
+off_t CTrajectoryIndex::GetSnapshotOffset(int index) const
+{
+    if( FrameSize <= 0 ) return(-1);
+    if( (index < 0) || (index >= NumOfSnapshots) ) return(-1);
+    return(FirstOffset + (off_t)index*FrameSize);
+}
+
+//------------------------------------------------------------------------------
+
+off_t CTrajectoryIndex::GetSnapshotSize(void) const
+{
+    return(FrameSize);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CTrajectoryIndex::GetFileStat(const CSmallString& name,off_t& size,time_t& mtime)
+{
+    struct stat info;
+    if( stat(name,&info) != 0 ) return(false);
+    size = info.st_size;
+    mtime = info.st_mtime;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::SetupOffsets(const CSmallString& name)
+{
+    FirstOffset = 0;
+    FrameSize = 0;
+
+    FILE* p_fin = fopen(name,"r");
+    if( p_fin == NULL ) return(false);
+
+    // the first record is the title
+    off_t   title = 0;
+    int     c;
+    while( (c = fgetc(p_fin)) != EOF ){
+        title++;
+        if( c == '\n' ) break;
+    }
+    if( c != '\n' ){
+        fclose(p_fin);
+        return(false);
+    }
+
+    // coordinates are assumed in %8.3f format, ten items per line
+    off_t ncrd = 3*(off_t)NumOfAtoms;
+    off_t frame = 8*ncrd + (ncrd + 9)/10;
+    if( BoxPresent ) frame += 3*8 + 1;
+
+    off_t data = FileSize - title;
+    bool  result = (frame > 0) && (data >= 0) && (data % frame == 0);
+
+    // consistency with already known number of snapshots
+    if( result && (NumOfSnapshots >= 0) && (data / frame != NumOfSnapshots) ) result = false;
+
+    // the size alone can match by chance (other format, CRLF endings),
+    // thus the first two records are decoded to verify the layout
+    for(off_t i=0; result && (i < 2) && (i < data / frame); i++){
+        result = CheckFrameLayout(p_fin,frame);
+    }
+    fclose(p_fin);
+
+    if( result == false ) return(false);
+
+    NumOfSnapshots = data / frame;
+    FirstOffset = title;
+    FrameSize = frame;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CTrajectoryIndex::CheckFrameLayout(FILE* p_fin,off_t frame)
+{
+    off_t ncrd = 3*(off_t)NumOfAtoms;
+    if( BoxPresent ) ncrd += 3;     // box is on separate line
+
+    off_t   ccrd = 0;       // coordinates of current block
+    off_t   nblock = 3*(off_t)NumOfAtoms;
+    off_t   read = 0;
+    char    field[9];
+
+    while( ccrd < ncrd ){
+        // coordinates and box form separate blocks of lines
+        off_t block_end = ccrd < nblock ? nblock : ncrd;
+        off_t nitems = block_end - ccrd < 10 ? block_end - ccrd : 10;
+
+        for(off_t i=0; i < nitems; i++){
+            if( fread(field,1,8,p_fin) != 8 ) return(false);
+            field[8] = '\0';
+            char* p_end;
+            strtod(field,&p_end);
+            if( (p_end == field) || (*p_end != '\0') ) return(false);
+        }
+        if( fgetc(p_fin) != '\n' ) return(false);
+
+        read += 8*nitems + 1;
+        ccrd += nitems;
+    }
+
+    return(read == frame);
+}
+
+//------------------------------------------------------------------------------
+
+const char* CTrajectoryIndex::EncodeFormat(ETrajectoryFormat format)
+{
+    switch(format) {
+        case AMBER_TRAJ_ASCII:
+            return("ascii");
+        case AMBER_TRAJ_ASCII_GZIP:
+            return("ascii.gzip");
+        case AMBER_TRAJ_ASCII_BZIP2:
+            return("ascii.bzip2");
+        case AMBER_TRAJ_NETCDF:
+            return("netcdf");
+        default:
+        case AMBER_TRAJ_UNKNOWN:
+            return("unknown");
+    }
+}
+
+//------------------------------------------------------------------------------
+
+ETrajectoryFormat CTrajectoryIndex::DecodeFormat(const CSmallString& format)
+{
+    if( format == "ascii" ){
+        return(AMBER_TRAJ_ASCII);
+    } else if ( format == "ascii.gzip" )  {
+        return(AMBER_TRAJ_ASCII_GZIP);
+    } else if ( format == "ascii.bzip2" )  {
+        return(AMBER_TRAJ_ASCII_BZIP2);
+    } else if ( format == "netcdf" )  {
+        return(AMBER_TRAJ_NETCDF);
+    } else {
+        return(AMBER_TRAJ_UNKNOWN);
+    }
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
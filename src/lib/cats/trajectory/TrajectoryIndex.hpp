@@ -0,0 +1,105 @@
+#ifndef TrajectoryIndexH
+#define TrajectoryIndexH
+// =============================================================================
+// CATs - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2011 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+
+#include <CATsMainHeader.hpp>
+#include <SmallString.hpp>
+#include <AmberTrajectory.hpp>
+#include <AmberTopology.hpp>
+#include <sys/types.h>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------
+
+/// persistent description of one trajectory segment
+/// it is stored in the sidecar file .NAME.cidx located next to the trajectory
+/// and it is invalidated if the size or the modification time of the trajectory changes,
+/// byte offsets of snapshots are available only for uncompressed ASCII trajectories
+
+class CATS_PACKAGE CTrajectoryIndex {
+public:
+// constructor -----------------------------------------------------------------
+    CTrajectoryIndex(void);
+
+// main methods ---------------------------------------------------------------
+    /// load index of the trajectory, false if it does not exist, it is outdated,
+    /// or it describes other than requested format (AMBER_TRAJ_UNKNOWN matches any)
+    bool Load(const CSmallString& name,ETrajectoryFormat format,CAmberTopology* p_top);
+
+    /// build index by inspecting the trajectory
+    bool Build(const CSmallString& name,ETrajectoryFormat format,CAmberTopology* p_top);
+
+    /// save index next to the trajectory, failures are not fatal
+    bool Save(const CSmallString& name);
+
+// information methods ---------------------------------------------------------
+    /// get name of the sidecar file
+    static const CSmallString GetIndexName(const CSmallString& name);
+
+    /// get trajectory format
+    ETrajectoryFormat GetFormat(void) const;
+
+    /// get number of snapshots
+    int GetNumberOfSnapshots(void) const;
+
+    /// get number of atoms
+    int GetNumberOfAtoms(void) const;
+
+    /// does trajectory contain box information
+    bool IsBoxPresent(void) const;
+
+    /// are byte offsets of snapshots available
+    bool AreOffsetsAvailable(void) const;
+
+    /// get byte offset of snapshot (zero-based index)
+    off_t GetSnapshotOffset(int index) const;
+
+    /// get size of ASCII snapshot record in bytes
+    off_t GetSnapshotSize(void) const;
+
+// section of private data -----------------------------------------------------
+private:
+    off_t               FileSize;
+    time_t              FileMTime;
+    ETrajectoryFormat   Format;
+    int                 NumOfAtoms;
+    bool                BoxPresent;
+    int                 NumOfSnapshots;
+    off_t               FirstOffset;    // end of title
+    off_t               FrameSize;      // zero if offsets are not available
+
+    /// read size and modification time of the trajectory
+    static bool GetFileStat(const CSmallString& name,off_t& size,time_t& mtime);
+
+    /// determine offsets of fixed-size ASCII records
+    bool SetupOffsets(const CSmallString& name);
+
+    /// decode one ASCII record and check that it has the assumed layout
+    bool CheckFrameLayout(FILE* p_fin,off_t frame);
+
+    static const char* EncodeFormat(ETrajectoryFormat format);
+    static ETrajectoryFormat DecodeFormat(const CSmallString& format);
+};
+
+//------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,408 @@
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <VSArchive.hpp>
+#include <ErrorSystem.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+CVSArchive::CVSArchive(void)
+{
+    SqlDB = NULL;
+    SelectSTM = NULL;
+    InsertSTM = NULL;
+    MaxPartSize = 1024*1024*1024;
+    WritePart = -1;
+    WriteFD = -1;
+    WriteSize = 0;
+}
+
+//------------------------------------------------------------------------------
+
+CVSArchive::~CVSArchive(void)
+{
+    Close();
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CVSArchive::Open(const CSmallString& projectdb,const CFileName& dir)
+{
+    Close();
+
+    Dir = dir;
+
+    if( sqlite3_open_v2(projectdb,&SqlDB,SQLITE_OPEN_READWRITE,NULL) != SQLITE_OK ){
+        CSmallString error;
+        error << "unable to open project database " << projectdb << " (" << sqlite3_errmsg(SqlDB) << ")";
+        ES_ERROR(error);
+        Close();
+        return(false);
+    }
+
+    // the server uses the same database from another connection
+    sqlite3_busy_timeout(SqlDB,60000);
+
+    if( ExecSQL("CREATE TABLE IF NOT EXISTS ARCHIVE (MOLID integer NOT NULL, TYPE text NOT NULL, "
+                "PART integer NOT NULL, OFFSET integer NOT NULL, LENGTH integer NOT NULL, "
+                "PRIMARY KEY (MOLID,TYPE))") == false ){
+        Close();
+        return(false);
+    }
+
+    const char* sql[2] = {
+        "SELECT PART,OFFSET,LENGTH FROM ARCHIVE WHERE MOLID = ? AND TYPE = ?",
+        "INSERT OR REPLACE INTO ARCHIVE (MOLID,TYPE,PART,OFFSET,LENGTH) VALUES (?,?,?,?,?)"
+    };
+    sqlite3_stmt** stm[2] = { &SelectSTM, &InsertSTM };
+    for(int i=0; i < 2; i++){
+        if( sqlite3_prepare_v2(SqlDB,sql[i],-1,stm[i],NULL) != SQLITE_OK ){
+            ES_ERROR(sql[i]);
+            ES_ERROR(sqlite3_errmsg(SqlDB));
+            Close();
+            return(false);
+        }
+    }
+
+    // find the last part, new items are appended to it
+    sqlite3_stmt* p_stm = NULL;
+    WritePart = 0;
+    if( sqlite3_prepare_v2(SqlDB,"SELECT MAX(PART) FROM ARCHIVE",-1,&p_stm,NULL) == SQLITE_OK ){
+        if( (sqlite3_step(p_stm) == SQLITE_ROW) && (sqlite3_column_type(p_stm,0) != SQLITE_NULL) ){
+            WritePart = sqlite3_column_int(p_stm,0);
+        }
+    }
+    sqlite3_finalize(p_stm);
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+void CVSArchive::Close(void)
+{
+    if( WriteFD >= 0 ) close(WriteFD);
+    WriteFD = -1;
+    WritePart = -1;
+    WriteSize = 0;
+
+    for(size_t i=0; i < Mappings.size(); i++){
+        munmap(Mappings[i].Data,Mappings[i].Size);
+    }
+    Mappings.clear();
+    PartMappings.clear();
+
+    if( SelectSTM ) sqlite3_finalize(SelectSTM);
+    if( InsertSTM ) sqlite3_finalize(InsertSTM);
+    if( SqlDB ) sqlite3_close(SqlDB);
+    SelectSTM = NULL;
+    InsertSTM = NULL;
+    SqlDB = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::IsOpened(void) const
+{
+    return(SqlDB != NULL);
+}
+
+//------------------------------------------------------------------------------
+
+void CVSArchive::SetMaxPartSize(size_t size)
+{
+    MaxPartSize = size;
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+bool CVSArchive::GetItem(int molid,const CSmallString& type,const char*& p_data,size_t& length)
+{
+    p_data = NULL;
+    length = 0;
+
+    if( SqlDB == NULL ){
+        ES_ERROR("archive is not opened");
+        return(false);
+    }
+
+    Mutex.Lock();
+
+    sqlite3_reset(SelectSTM);
+    sqlite3_bind_int(SelectSTM,1,molid);
+    sqlite3_bind_text(SelectSTM,2,type,-1,SQLITE_TRANSIENT);
+    if( sqlite3_step(SelectSTM) != SQLITE_ROW ){
+        sqlite3_reset(SelectSTM);
+        Mutex.Unlock();
+        return(false);
+    }
+    int    part = sqlite3_column_int(SelectSTM,0);
+    size_t offset = sqlite3_column_int64(SelectSTM,1);
+    length = sqlite3_column_int64(SelectSTM,2);
+    sqlite3_reset(SelectSTM);
+
+    const char* p_part = MapPart(part,offset,length);
+    if( p_part != NULL ) p_data = p_part + offset;
+
+    Mutex.Unlock();
+
+    return(p_data != NULL);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::AddItem(int molid,const CSmallString& type,const void* p_data,size_t length)
+{
+    if( SqlDB == NULL ){
+        ES_ERROR("archive is not opened");
+        return(false);
+    }
+
+    Mutex.Lock();
+
+    // switch to new part if the current one is full
+    bool result = true;
+    if( WriteFD < 0 ) result = OpenWritePart(WritePart);
+    if( result && (WriteSize > 0) && (WriteSize + length > MaxPartSize) ){
+        result = OpenWritePart(WritePart+1);
+    }
+    if( result == false ){
+        Mutex.Unlock();
+        return(false);
+    }
+
+    // data are written first, the index is updated only for complete items
+    size_t      offset = WriteSize;
+    const char* p_buf = (const char*)p_data;
+    size_t      remain = length;
+    while( remain > 0 ){
+        ssize_t nwritten = write(WriteFD,p_buf,remain);
+        if( nwritten < 0 ){
+            if( errno == EINTR ) continue;
+            CSmallString error;
+            error << "unable to write to archive part " << GetPartName(WritePart) << " (" << strerror(errno) << ")";
+            ES_ERROR(error);
+            result = false;
+            break;
+        }
+        p_buf += nwritten;
+        remain -= nwritten;
+        WriteSize += nwritten;
+    }
+
+    if( result ){
+        sqlite3_reset(InsertSTM);
+        sqlite3_bind_int(InsertSTM,1,molid);
+        sqlite3_bind_text(InsertSTM,2,type,-1,SQLITE_TRANSIENT);
+        sqlite3_bind_int(InsertSTM,3,WritePart);
+        sqlite3_bind_int64(InsertSTM,4,offset);
+        sqlite3_bind_int64(InsertSTM,5,length);
+        if( sqlite3_step(InsertSTM) != SQLITE_DONE ){
+            ES_ERROR(sqlite3_errmsg(SqlDB));
+            result = false;
+        }
+        sqlite3_reset(InsertSTM);
+    }
+
+    Mutex.Unlock();
+
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::GetItemList(std::vector<int>& molids,std::vector<CSmallString>& types)
+{
+    molids.clear();
+    types.clear();
+
+    if( SqlDB == NULL ){
+        ES_ERROR("archive is not opened");
+        return(false);
+    }
+
+    Mutex.Lock();
+
+    sqlite3_stmt* p_stm = NULL;
+    int rcode = sqlite3_prepare_v2(SqlDB,"SELECT MOLID,TYPE FROM ARCHIVE ORDER BY MOLID,TYPE",-1,&p_stm,NULL);
+    if( rcode == SQLITE_OK ){
+        while( (rcode = sqlite3_step(p_stm)) == SQLITE_ROW ){
+            molids.push_back(sqlite3_column_int(p_stm,0));
+            types.push_back((const char*)sqlite3_column_text(p_stm,1));
+        }
+    }
+    if( rcode != SQLITE_DONE ) ES_ERROR(sqlite3_errmsg(SqlDB));
+    sqlite3_finalize(p_stm);
+
+    Mutex.Unlock();
+
+    return(rcode == SQLITE_DONE);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::BeginUpdate(void)
+{
+    Mutex.Lock();
+    bool result = ExecSQL("BEGIN IMMEDIATE");
+    Mutex.Unlock();
+    return(result);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::EndUpdate(void)
+{
+    Mutex.Lock();
+    bool result = ExecSQL("COMMIT");
+    Mutex.Unlock();
+    return(result);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
+
+const CFileName CVSArchive::GetPartName(int part) const
+{
+    char buffer[32];
+    snprintf(buffer,sizeof(buffer),"archive_%04d.dat",part);
+    return( Dir / CFileName(buffer) );
+}
+
+//------------------------------------------------------------------------------
+
+const char* CVSArchive::MapPart(int part,size_t offset,size_t length)
+{
+    if( part < 0 ) return(NULL);
+    if( (int)PartMappings.size() <= part ) PartMappings.resize(part+1,-1);
+
+    int imap = PartMappings[part];
+    if( (imap >= 0) && (offset + length <= Mappings[imap].Size) ){
+        return(Mappings[imap].Data);
+    }
+
+    // map the part, the mapping is as large as the whole part
+    // so that items appended later are accessible as well
+    CFileName name = GetPartName(part);
+    int fd = open(name,O_RDONLY);
+    if( fd < 0 ){
+        CSmallString error;
+        error << "unable to open archive part " << name << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(NULL);
+    }
+
+    struct stat st;
+    if( fstat(fd,&st) != 0 ){
+        close(fd);
+        return(NULL);
+    }
+    size_t size = st.st_size;
+    if( offset + length > size ){
+        close(fd);
+        CSmallString error;
+        error << "archive part " << name << " is truncated";
+        ES_ERROR(error);
+        return(NULL);
+    }
+    if( size < MaxPartSize ) size = MaxPartSize;
+    if( size == 0 ) size = 1;
+
+    void* p_map = mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if( p_map == MAP_FAILED ){
+        CSmallString error;
+        error << "unable to map archive part " << name << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(NULL);
+    }
+
+    // older mapping is kept as data returned from it can be still in use
+    SMapping mapping;
+    mapping.Part = part;
+    mapping.Data = (char*)p_map;
+    mapping.Size = size;
+    Mappings.push_back(mapping);
+    PartMappings[part] = Mappings.size() - 1;
+
+    return(mapping.Data);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::OpenWritePart(int part)
+{
+    if( WriteFD >= 0 ) close(WriteFD);
+    WriteFD = -1;
+    WriteSize = 0;
+    WritePart = part;
+
+    CFileName name = GetPartName(part);
+    WriteFD = open(name,O_WRONLY | O_APPEND | O_CREAT,0644);
+    if( WriteFD < 0 ){
+        CSmallString error;
+        error << "unable to open archive part " << name << " (" << strerror(errno) << ")";
+        ES_ERROR(error);
+        return(false);
+    }
+
+    // possible incomplete data from the interrupted write are skipped
+    struct stat st;
+    if( fstat(WriteFD,&st) != 0 ){
+        close(WriteFD);
+        WriteFD = -1;
+        return(false);
+    }
+    WriteSize = st.st_size;
+
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+
+bool CVSArchive::ExecSQL(const CSmallString& sql)
+{
+    char* zErrMsg = NULL;
+    if( sqlite3_exec(SqlDB,sql,NULL,0,&zErrMsg) != SQLITE_OK ){
+        ES_ERROR(sql);
+        ES_ERROR(zErrMsg);
+        sqlite3_free(zErrMsg);
+        return(false);
+    }
+    return(true);
+}
+
+//==============================================================================
+//------------------------------------------------------------------------------
+//==============================================================================
@@ -0,0 +1,116 @@
+#ifndef VSArchiveH
+#define VSArchiveH
+// =============================================================================
+// CATS - Conversion and Analysis Tools
+// -----------------------------------------------------------------------------
+//    Copyright (C) 2016 Petr Kulhanek, kulhanek@chemi.muni.cz
+//
+//     This program is free software; you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation; either version 2 of the License, or
+//     (at your option) any later version.
+//
+//     This program is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+//
+//     You should have received a copy of the GNU General Public License along
+//     with this program; if not, write to the Free Software Foundation, Inc.,
+//     51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// =============================================================================
+
+#include <CATsMainHeader.hpp>
+#include <SmallString.hpp>
+#include <FileName.hpp>
+#include <SimpleMutex.hpp>
+#include <sqlite3.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// packed storage of structures and results of svs projects
+/// items are appended to large archive parts (archive_NNNN.dat) and their
+/// positions are kept in the ARCHIVE table of the project database,
+/// parts are memory mapped for reading, only one process can write to
+/// the archive at the same time
+
+class CATS_PACKAGE CVSArchive {
+public:
+// constructor and destructor --------------------------------------------------
+    CVSArchive(void);
+    ~CVSArchive(void);
+
+// main methods ---------------------------------------------------------------
+    /// open archive in the directory, the index table is created if necessary
+    bool Open(const CSmallString& projectdb,const CFileName& dir);
+
+    /// close archive, all mapped data become invalid
+    void Close(void);
+
+    /// is archive opened
+    bool IsOpened(void) const;
+
+    /// set size of archive part, larger items are stored in separate parts
+    void SetMaxPartSize(size_t size);
+
+// input/output methods -------------------------------------------------------
+    /// get mapped item data, they are valid until the archive is closed
+    /// false is returned if the item is not in the archive
+    bool GetItem(int molid,const CSmallString& type,const char*& p_data,size_t& length);
+
+    /// append item, previous version of the item is replaced in the index
+    bool AddItem(int molid,const CSmallString& type,const void* p_data,size_t length);
+
+    /// get list of all archived items
+    bool GetItemList(std::vector<int>& molids,std::vector<CSmallString>& types);
+
+    /// group subsequent AddItem calls into single index transaction
+    bool BeginUpdate(void);
+
+    /// commit index transaction
+    bool EndUpdate(void);
+
+// section of private data -----------------------------------------------------
+private:
+    CSimpleMutex        Mutex;
+    sqlite3*            SqlDB;
+    sqlite3_stmt*       SelectSTM;
+    sqlite3_stmt*       InsertSTM;
+    CFileName           Dir;
+    size_t              MaxPartSize;
+
+    // current part for writing
+    int                 WritePart;
+    int                 WriteFD;
+    size_t              WriteSize;
+
+    // mapped parts, older mappings are kept until close
+    struct SMapping {
+        int             Part;
+        char*           Data;
+        size_t          Size;
+    };
+    std::vector<SMapping>   Mappings;
+    std::vector<int>        PartMappings;   // the latest mapping of part
+
+    /// get name of archive part
+    const CFileName GetPartName(int part) const;
+
+    /// map part so that the range is accessible
+    const char* MapPart(int part,size_t offset,size_t length);
+
+    /// open part for writing
+    bool OpenWritePart(int part);
+
+    /// execute SQL statement without results
+    bool ExecSQL(const CSmallString& sql);
+
+    // disable copying
+    CVSArchive(const CVSArchive&);
+    CVSArchive& operator = (const CVSArchive&);
+};
+
+//------------------------------------------------------------------------------
+
+#endif